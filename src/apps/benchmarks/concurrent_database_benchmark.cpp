@@ -0,0 +1,105 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/concurrent_online_database.h"
+#include "features/feature_factory.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+// Every thread plays one localizer: it takes the next query and matches it
+// against the references in a band around the diagonal, like a search that
+// follows the path.
+double runLocalizers(loc::database::ConcurrentOnlineDatabase &database,
+                     int querySize, int numThreads, int band) {
+  std::atomic<int> nextQuery{0};
+  std::vector<std::thread> threads;
+  const auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&]() {
+      const int refSize = database.refSize();
+      for (int q = nextQuery++; q < querySize; q = nextQuery++) {
+        const int center =
+            static_cast<int64_t>(q) * refSize / std::max(querySize, 1);
+        for (int r = std::max(0, center - band);
+             r <= std::min(refSize - 1, center + band); ++r) {
+          database.getCost(q, r);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Concurrent database scalability benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./concurrent_database_benchmark "
+                 "query_features_dir reference_features_dir [max_threads] "
+                 "[band] [buffer_size]";
+    exit(0);
+  }
+  const int maxThreads =
+      argc > 3 ? std::stoi(argv[3])
+               : std::max(1u, std::thread::hardware_concurrency());
+  const int band = argc > 4 ? std::stoi(argv[4]) : 10;
+  const int bufferSize = argc > 5 ? std::stoi(argv[5]) : 1000;
+
+  double baselineSec = 0.0;
+  for (int numThreads = 1; numThreads <= maxThreads; numThreads *= 2) {
+    // A fresh database per run, so every run starts with cold caches.
+    loc::database::ConcurrentOnlineDatabase database(
+        argv[1], argv[2], loc::features::FeatureType::Cnn_Feature, bufferSize);
+    const double seconds =
+        runLocalizers(database, database.querySize(), numThreads, band);
+    if (numThreads == 1) {
+      baselineSec = seconds;
+    }
+    const auto refStats = database.refBufferStats();
+    LOG(INFO) << numThreads << " threads: " << database.computedCosts()
+              << " costs in " << seconds << " s, "
+              << database.computedCosts() / seconds << " costs/s, speedup "
+              << baselineSec / seconds << ", reference buffer "
+              << refStats.hits << " hits, " << refStats.misses << " misses.";
+  }
+  return 0;
+}
@@ -0,0 +1,77 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/dnn_extractor.h"
+
+#include <glog/logging.h>
+
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== DNN descriptor extraction benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./dnn_extraction_benchmark model.onnx "
+                 "images_dir [input_size] [num_threads]";
+    exit(0);
+  }
+  const std::vector<std::string> images =
+      loc::database::listImageDir(argv[2]);
+  LOG_IF(FATAL, images.empty()) << "No images in " << argv[2];
+
+  loc::features::DnnExtractorOptions options;
+  options.modelFile = argv[1];
+  if (argc > 3) {
+    options.inputWidth = std::stoi(argv[3]);
+    options.inputHeight = options.inputWidth;
+  }
+  if (argc > 4) {
+    options.numThreads = std::stoi(argv[4]);
+  }
+  for (const int batchSize : {1, 4, 16, 32}) {
+    options.batchSize = batchSize;
+    loc::features::DnnExtractor extractor(options);
+    // The first batch also sets up the network, it is not measured.
+    extractor.extract({images.front()});
+    const auto warmup = extractor.stats();
+    extractor.extract(images);
+    const auto &stats = extractor.stats();
+    const int numImages = stats.images - warmup.images;
+    const double seconds = stats.totalSeconds - warmup.totalSeconds;
+    LOG(INFO) << "Batch size " << batchSize << ": " << numImages / seconds
+              << " images/s, preprocessing "
+              << stats.preprocessingSeconds - warmup.preprocessingSeconds
+              << " s, inference "
+              << stats.inferenceSeconds - warmup.inferenceSeconds
+              << " s, total " << seconds << " s, descriptors of size "
+              << extractor.dim() << ".";
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/feature_buffer.h"
+#include "online_localizer/online_localizer.h"
+#include "relocalizers/lsh_hashing.h"
+#include "successor_manager/successor_manager.h"
+
+#include <glog/logging.h>
+
+#include <deque>
+#include <memory>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+// Forwards to the database and records the references whose features it
+// needs. A cost is computed once, so only the first request of a pair loads
+// the reference feature.
+class TracingDatabase : public loc::database::iDatabase {
+public:
+  explicit TracingDatabase(loc::database::OnlineDatabase *database)
+      : database_{database} {}
+
+  int refSize() override { return database_->refSize(); }
+  double getCost(int quId, int refId) override {
+    record(quId, refId);
+    return database_->getCost(quId, refId);
+  }
+  std::vector<double> getCosts(int quId,
+                               const std::vector<int> &refIds) override {
+    for (int refId : refIds) {
+      record(quId, refId);
+    }
+    return database_->getCosts(quId, refIds);
+  }
+
+  const std::vector<int> &trace() const { return trace_; }
+
+private:
+  void record(int quId, int refId) {
+    if (computed_.insert({quId, refId}).second) {
+      trace_.push_back(refId);
+    }
+  }
+
+  loc::database::OnlineDatabase *database_ = nullptr;
+  std::set<std::pair<int, int>> computed_;
+  std::vector<int> trace_;
+};
+
+// Features are not needed to replay a trace, only their ids.
+class TraceFeature : public loc::features::iFeature {
+public:
+  double computeSimilarityScore(const iFeature &) const override { return 0; }
+  double score2cost(double) const override { return 0; }
+};
+
+// The policy of the buffer before it became an LRU: the first inserted
+// feature is evicted, a hit does not change the order.
+int fifoReloads(const std::vector<int> &trace, int bufferSize) {
+  std::deque<int> order;
+  std::unordered_set<int> buffered;
+  int reloads = 0;
+  for (int refId : trace) {
+    if (buffered.count(refId)) {
+      continue;
+    }
+    ++reloads;
+    if (static_cast<int>(order.size()) >= bufferSize) {
+      buffered.erase(order.front());
+      order.pop_front();
+    }
+    order.push_back(refId);
+    buffered.insert(refId);
+  }
+  return reloads;
+}
+
+int lruReloads(const std::vector<int> &trace, int bufferSize) {
+  loc::features::FeatureBuffer buffer(bufferSize);
+  for (int refId : trace) {
+    if (!buffer.findFeature(refId)) {
+      buffer.addFeature(refId, std::make_unique<TraceFeature>());
+    }
+  }
+  return buffer.stats().misses;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Feature buffer benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./feature_buffer_benchmark "
+                 "query_features_dir reference_features_dir [fan_out] "
+                 "[expansion_rate] [non_match_cost]";
+    exit(0);
+  }
+  const int fanOut = argc > 3 ? std::stoi(argv[3]) : 10;
+  const double expansionRate = argc > 4 ? std::stod(argv[4]) : 0.6;
+  const double nonMatchCost = argc > 5 ? std::stod(argv[5]) : 1.5;
+
+  // Records the reference accesses of a real search. The buffer of the
+  // database is large enough to never reload, the trace does not depend on
+  // it.
+  loc::database::OnlineDatabase database(
+      argv[1], argv[2], loc::features::FeatureType::Cnn_Feature,
+      /*bufferSize=*/1000);
+  TracingDatabase tracingDatabase(&database);
+  loc::relocalizers::LshHashing relocalizer(&database);
+  relocalizer.train(argv[2]);
+  loc::successor_manager::SuccessorManager successorManager(
+      &tracingDatabase, &relocalizer, fanOut);
+  loc::online_localizer::OnlineLocalizer localizer(
+      &successorManager, expansionRate, nonMatchCost);
+  FLAGS_minloglevel = google::WARNING;
+  localizer.findMatchesTill(database.querySize() - 1);
+  FLAGS_minloglevel = google::INFO;
+
+  const std::vector<int> &trace = tracingDatabase.trace();
+  LOG(INFO) << "Trace of " << trace.size() << " reference accesses over "
+            << database.querySize() << " queries.";
+  for (int bufferSize : {fanOut, 2 * fanOut, 5 * fanOut, 10 * fanOut,
+                         50 * fanOut}) {
+    const int fifo = fifoReloads(trace, bufferSize);
+    const int lru = lruReloads(trace, bufferSize);
+    LOG(INFO) << "Buffer of " << bufferSize << " features: FIFO " << fifo
+              << " reloads, LRU " << lru << " reloads.";
+  }
+  return 0;
+}
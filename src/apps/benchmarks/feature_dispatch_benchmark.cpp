@@ -0,0 +1,101 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_factory.h"
+#include "features/feature_traits.h"
+#include "features/ifeature.h"
+
+#include <glog/logging.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+using FeatureList = std::vector<std::unique_ptr<loc::features::iFeature>>;
+
+// Comparisons per second of one query against all references with the given
+// cost function.
+double measure(const loc::features::iFeature &query, const FeatureList &refs,
+               loc::features::MatchingCostFunction cost) {
+  int64_t comparisons = 0;
+  double checksum = 0.0;
+  double seconds = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  while (seconds < 0.2) {
+    for (const auto &ref : refs) {
+      checksum += cost(query, *ref);
+    }
+    comparisons += refs.size();
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                            start)
+                  .count();
+  }
+  LOG_IF(INFO, checksum == 0.0) << "Unexpected checksum.";
+  return comparisons / seconds;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Feature dispatch benchmark ====\n";
+  const int numRefs = argc > 1 ? std::stoi(argv[1]) : 1024;
+
+  const std::map<std::string, loc::features::FeatureType> types = {
+      {"CnnFeature", loc::features::Cnn_Feature},
+      {"Int8Feature", loc::features::Int8_Feature},
+      {"BinaryFeature", loc::features::Binary_Feature_Median}};
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  auto randomValues = [&](int dim) {
+    std::vector<double> values(dim);
+    for (double &value : values) {
+      value = distribution(generator);
+    }
+    return values;
+  };
+  // The dispatch overhead matters most for short features.
+  for (int dim = 64; dim <= 4096; dim *= 4) {
+    for (const auto &[name, type] : types) {
+      const auto query = loc::features::createFeature(type, randomValues(dim));
+      FeatureList refs;
+      for (int r = 0; r < numRefs; ++r) {
+        refs.push_back(loc::features::createFeature(type, randomValues(dim)));
+      }
+      const double dynamic =
+          measure(*query, refs, loc::features::dynamicMatchingCost);
+      const double typed =
+          measure(*query, refs, loc::features::matchingCostFunction(type));
+      LOG(INFO) << name << ", dim " << dim << ": virtual " << dynamic
+                << " comparisons/s, static " << typed << " comparisons/s ("
+                << typed / dynamic << "x)";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,124 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_factory.h"
+#include "features/feature_loader.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+struct ScoringRun {
+  std::vector<double> scores;
+  double seconds = 0.0;
+  size_t featureBytes = 0;
+};
+
+// Scores every query against every reference, like a full matching run.
+ScoringRun scoreAll(const std::string &queryDir, const std::string &refDir,
+                    loc::features::FeatureType type) {
+  const auto query = loc::features::loadFeatures(queryDir, type);
+  const auto ref = loc::features::loadFeatures(refDir, type);
+  LOG_IF(FATAL, query.empty() || ref.empty()) << "No features to compare.";
+  ScoringRun run;
+  for (const auto &feature : ref) {
+    run.featureBytes += feature->memoryBytes();
+  }
+  run.scores.resize(query.size() * ref.size());
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t q = 0; q < query.size(); ++q) {
+    for (size_t r = 0; r < ref.size(); ++r) {
+      run.scores[q * ref.size() + r] =
+          query[q]->computeSimilarityScore(*ref[r]);
+    }
+  }
+  run.seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  return run;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Feature type accuracy benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./feature_type_accuracy_benchmark "
+                 "query_features_dir reference_features_dir";
+    exit(0);
+  }
+  const int refSize =
+      loc::features::loadFeatures(argv[2], loc::features::Cnn_Feature).size();
+  const ScoringRun baseline =
+      scoreAll(argv[1], argv[2], loc::features::Cnn_Feature);
+  LOG(INFO) << "CnnFeature: " << baseline.scores.size() / baseline.seconds
+            << " comparisons/s, " << baseline.featureBytes
+            << " bytes of reference features.";
+
+  const std::map<std::string, loc::features::FeatureType> types = {
+      {"Int8Feature", loc::features::Int8_Feature}};
+  for (const auto &[name, type] : types) {
+    const ScoringRun run = scoreAll(argv[1], argv[2], type);
+    double errorSum = 0.0;
+    double maxError = 0.0;
+    for (size_t i = 0; i < run.scores.size(); ++i) {
+      const double error = std::abs(run.scores[i] - baseline.scores[i]);
+      errorSum += error;
+      maxError = std::max(maxError, error);
+    }
+    // The share of queries whose best reference stays the same.
+    int sameBest = 0;
+    const int querySize = run.scores.size() / refSize;
+    for (int q = 0; q < querySize; ++q) {
+      const auto rowBegin = [q, refSize](const std::vector<double> &scores) {
+        return scores.begin() + static_cast<size_t>(q) * refSize;
+      };
+      sameBest += std::max_element(rowBegin(run.scores),
+                                   rowBegin(run.scores) + refSize) -
+                      rowBegin(run.scores) ==
+                  std::max_element(rowBegin(baseline.scores),
+                                   rowBegin(baseline.scores) + refSize) -
+                      rowBegin(baseline.scores);
+    }
+    LOG(INFO) << name << ": " << run.scores.size() / run.seconds
+              << " comparisons/s (" << baseline.seconds / run.seconds
+              << "x), " << run.featureBytes << " bytes of reference features ("
+              << static_cast<double>(baseline.featureBytes) / run.featureBytes
+              << "x smaller), mean similarity error "
+              << errorSum / run.scores.size() << ", max " << maxError
+              << ", same best match for "
+              << 100.0 * sameBest / std::max(querySize, 1) << "% of queries.";
+  }
+  return 0;
+}
@@ -0,0 +1,212 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/cnn_feature.h"
+#include "features/feature_loader.h"
+#include "features/feature_traits.h"
+#include "features/patch_descriptor.h"
+#include "features/patch_feature.h"
+#include "features/similarity_kernels.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+std::vector<std::vector<double>> computeDescriptors(const std::string &dir,
+                                                    int numThreads,
+                                                    double &seconds) {
+  const std::vector<std::string> images = loc::database::listImageDir(dir);
+  LOG_IF(FATAL, images.empty()) << "No images in " << dir;
+  std::vector<std::vector<double>> descriptors(images.size());
+  const auto start = std::chrono::steady_clock::now();
+  loc::tools::parallelFor(
+      0, images.size(),
+      [&](int idx) {
+        descriptors[idx] = loc::features::computePatchDescriptor(images[idx]);
+      },
+      numThreads);
+  seconds = secondsSince(start);
+  return descriptors;
+}
+
+struct ScoringRun {
+  std::vector<double> scores;
+  double seconds = 0.0;
+  size_t featureBytes = 0;
+};
+
+// Scores every query against every reference with the statically dispatched
+// scoring, like the database does.
+template <class Feature>
+ScoringRun
+scoreAll(const std::vector<std::unique_ptr<loc::features::iFeature>> &query,
+         const std::vector<std::unique_ptr<loc::features::iFeature>> &ref) {
+  ScoringRun run;
+  for (const auto &feature : ref) {
+    run.featureBytes += feature->memoryBytes();
+  }
+  run.scores.resize(query.size() * ref.size());
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t q = 0; q < query.size(); ++q) {
+    const auto &queryFeature = static_cast<const Feature &>(*query[q]);
+    for (size_t r = 0; r < ref.size(); ++r) {
+      run.scores[q * ref.size() + r] = loc::features::FeatureTraits<
+          Feature>::score(queryFeature, static_cast<const Feature &>(*ref[r]));
+    }
+  }
+  run.seconds = secondsSince(start);
+  return run;
+}
+
+std::vector<std::unique_ptr<loc::features::iFeature>>
+createFeatures(const std::vector<std::vector<double>> &descriptors,
+               loc::features::FeatureType type) {
+  std::vector<std::unique_ptr<loc::features::iFeature>> features;
+  for (const auto &values : descriptors) {
+    features.push_back(loc::features::createFeature(type, values));
+  }
+  return features;
+}
+
+// Share of queries whose best references are at most `tolerance` frames
+// apart in both runs.
+double sameBestMatch(const ScoringRun &run, const ScoringRun &baseline,
+                     int refSize, int tolerance) {
+  const int querySize = run.scores.size() / refSize;
+  int same = 0;
+  for (int q = 0; q < querySize; ++q) {
+    const auto best = [&](const std::vector<double> &scores) {
+      const auto row = scores.begin() + static_cast<size_t>(q) * refSize;
+      return std::max_element(row, row + refSize) - row;
+    };
+    same += std::abs(best(run.scores) - best(baseline.scores)) <= tolerance;
+  }
+  return static_cast<double>(same) / std::max(querySize, 1);
+}
+
+void logRun(const std::string &name, const ScoringRun &run, int refSize) {
+  LOG(INFO) << name << ": " << run.scores.size() / run.seconds
+            << " comparisons/s, " << run.featureBytes / refSize
+            << " bytes per feature.";
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Normalized patch feature benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./patch_feature_benchmark query_images_dir "
+                 "reference_images_dir [query_cnn_features_dir "
+                 "reference_cnn_features_dir]";
+    exit(0);
+  }
+
+  double singleThreadSeconds = 0.0;
+  computeDescriptors(argv[1], /*numThreads=*/1, singleThreadSeconds);
+  double querySeconds = 0.0;
+  double refSeconds = 0.0;
+  const auto queryDescriptors =
+      computeDescriptors(argv[1], /*numThreads=*/0, querySeconds);
+  const auto refDescriptors =
+      computeDescriptors(argv[2], /*numThreads=*/0, refSeconds);
+  LOG(INFO) << "Extraction: "
+            << queryDescriptors.size() / singleThreadSeconds
+            << " images/s on one thread, "
+            << (queryDescriptors.size() + refDescriptors.size()) /
+                   (querySeconds + refSeconds)
+            << " images/s on " << loc::tools::defaultNumThreads()
+            << " threads.";
+
+  const int refSize = refDescriptors.size();
+  const auto queryPatches =
+      createFeatures(queryDescriptors, loc::features::Patch_Feature);
+  const auto refPatches =
+      createFeatures(refDescriptors, loc::features::Patch_Feature);
+  const ScoringRun patchRun =
+      scoreAll<loc::features::PatchFeature>(queryPatches, refPatches);
+  logRun("PatchFeature", patchRun, refSize);
+  const int dim = queryDescriptors.front().size();
+  for (const auto level : loc::features::supportedSimdLevels()) {
+    const auto start = std::chrono::steady_clock::now();
+    uint64_t checksum = 0;
+    for (const auto &query : queryPatches) {
+      for (const auto &ref : refPatches) {
+        checksum += loc::features::sumAbsDiffUint8(
+            static_cast<const loc::features::PatchFeature &>(*query).data(),
+            static_cast<const loc::features::PatchFeature &>(*ref).data(), dim,
+            level);
+      }
+    }
+    LOG(INFO) << "  " << loc::features::simdLevelName(level) << " kernel: "
+              << queryPatches.size() * refPatches.size() / secondsSince(start)
+              << " comparisons/s (checksum " << checksum << ").";
+  }
+
+  // The same descriptors as float features compared by the cosine.
+  const ScoringRun floatRun = scoreAll<loc::features::CnnFeature>(
+      createFeatures(queryDescriptors, loc::features::Cnn_Feature),
+      createFeatures(refDescriptors, loc::features::Cnn_Feature));
+  logRun("Patch descriptors as CnnFeature", floatRun, refSize);
+  LOG(INFO) << "  same best match as PatchFeature for "
+            << 100.0 * sameBestMatch(patchRun, floatRun, refSize, 0)
+            << "% of the queries.";
+
+  if (argc > 4) {
+    const auto queryCnn =
+        loc::features::loadFeatures(argv[3], loc::features::Cnn_Feature);
+    const auto refCnn =
+        loc::features::loadFeatures(argv[4], loc::features::Cnn_Feature);
+    LOG_IF(FATAL, queryCnn.size() != queryDescriptors.size() ||
+                      static_cast<int>(refCnn.size()) != refSize)
+        << "The CNN features do not belong to the images.";
+    const ScoringRun cnnRun =
+        scoreAll<loc::features::CnnFeature>(queryCnn, refCnn);
+    logRun("CnnFeature", cnnRun, refSize);
+    for (const int tolerance : {0, 2, 5}) {
+      LOG(INFO) << "  best PatchFeature match within " << tolerance
+                << " frames of the best CnnFeature match for "
+                << 100.0 * sameBestMatch(patchRun, cnnRun, refSize, tolerance)
+                << "% of the queries.";
+    }
+  }
+  return 0;
+}
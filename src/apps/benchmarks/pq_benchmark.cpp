@@ -0,0 +1,115 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_matrix.h"
+#include "features/pq_store.h"
+#include "features/similarity_kernels.h"
+
+#include <glog/logging.h>
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Product quantization benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./pq_benchmark query_features "
+                 "reference_features [num_subspaces] [num_centroids]";
+    exit(0);
+  }
+  loc::features::PqTrainOptions options;
+  if (argc > 3) {
+    options.numSubspaces = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    options.numCentroids = std::stoi(argv[4]);
+  }
+  const auto query = loc::features::FeatureMatrix::load(argv[1]);
+  const auto ref = loc::features::FeatureMatrix::load(argv[2]);
+  CHECK(query.dim() == ref.dim()) << "Features have different dimensions.";
+  std::vector<std::string> names(ref.rows());
+  const auto store = loc::features::PqStore::encode(
+      loc::features::PqCodebook::train(ref, options), ref, names);
+  const auto &codebook = store->codebook();
+
+  const double floatBytes =
+      static_cast<double>(ref.rows()) * ref.dim() * sizeof(float);
+  LOG(INFO) << "Reference memory: " << floatBytes / (1 << 20)
+            << " MB float32, " << store->memoryBytes() / double(1 << 20)
+            << " MB PQ codes and codebook, "
+            << floatBytes / store->memoryBytes() << "x smaller.";
+
+  // Every query is scored against the whole reference with both methods.
+  std::vector<float> exact(static_cast<size_t>(query.rows()) * ref.rows());
+  auto start = std::chrono::steady_clock::now();
+  for (int q = 0; q < query.rows(); ++q) {
+    for (int r = 0; r < ref.rows(); ++r) {
+      exact[static_cast<size_t>(q) * ref.rows() + r] =
+          loc::features::dotProduct(query.row(q), ref.row(r), ref.dim());
+    }
+  }
+  const double floatSec = secondsSince(start);
+
+  std::vector<float> table(static_cast<size_t>(codebook.numSubspaces()) *
+                           codebook.numCentroids());
+  std::vector<float> approximate(exact.size());
+  start = std::chrono::steady_clock::now();
+  for (int q = 0; q < query.rows(); ++q) {
+    codebook.innerProductTable(query.row(q), table.data());
+    for (int r = 0; r < ref.rows(); ++r) {
+      approximate[static_cast<size_t>(q) * ref.rows() + r] =
+          codebook.score(table.data(), store->code(r));
+    }
+  }
+  const double pqSec = secondsSince(start);
+  double errorSum = 0.0;
+  for (size_t i = 0; i < exact.size(); ++i) {
+    errorSum += std::abs(approximate[i] - exact[i]);
+  }
+
+  const double comparisons = static_cast<double>(query.rows()) * ref.rows();
+  LOG(INFO) << "Float dot products: " << comparisons / floatSec
+            << " comparisons/s.";
+  LOG(INFO) << "PQ table lookups: " << comparisons / pqSec
+            << " comparisons/s including the tables, "
+            << floatSec / pqSec << "x faster.";
+  LOG(INFO) << "Mean absolute cosine similarity error: "
+            << errorSum / comparisons;
+  return 0;
+}
@@ -0,0 +1,134 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_loader.h"
+#include "features/feature_matrix.h"
+#include "features/projection.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+struct ScoringRun {
+  std::vector<double> scores;
+  double seconds = 0.0;
+  size_t featureBytes = 0;
+  int refSize = 0;
+};
+
+// Scores every query against every reference, like a full matching run.
+ScoringRun scoreAll(const std::string &queryDir, const std::string &refDir,
+                    const loc::features::Projection *projection) {
+  const auto query = loc::features::loadFeatures(
+      queryDir, loc::features::Cnn_Feature, /*numThreads=*/0,
+      /*stats=*/nullptr, projection);
+  const auto ref = loc::features::loadFeatures(
+      refDir, loc::features::Cnn_Feature, /*numThreads=*/0, /*stats=*/nullptr,
+      projection);
+  LOG_IF(FATAL, query.empty() || ref.empty()) << "No features to compare.";
+  ScoringRun run;
+  run.refSize = ref.size();
+  for (const auto &feature : ref) {
+    run.featureBytes += feature->memoryBytes();
+  }
+  run.scores.resize(query.size() * ref.size());
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t q = 0; q < query.size(); ++q) {
+    for (size_t r = 0; r < ref.size(); ++r) {
+      run.scores[q * ref.size() + r] =
+          query[q]->computeSimilarityScore(*ref[r]);
+    }
+  }
+  run.seconds = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  return run;
+}
+
+// The share of queries whose best reference stays the same.
+double sameBestMatch(const ScoringRun &run, const ScoringRun &baseline) {
+  const int querySize = run.scores.size() / run.refSize;
+  int sameBest = 0;
+  for (int q = 0; q < querySize; ++q) {
+    const auto rowBegin = [&](const std::vector<double> &scores) {
+      return scores.begin() + static_cast<size_t>(q) * run.refSize;
+    };
+    sameBest += std::max_element(rowBegin(run.scores),
+                                 rowBegin(run.scores) + run.refSize) -
+                    rowBegin(run.scores) ==
+                std::max_element(rowBegin(baseline.scores),
+                                 rowBegin(baseline.scores) + run.refSize) -
+                    rowBegin(baseline.scores);
+  }
+  return static_cast<double>(sameBest) / std::max(querySize, 1);
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Feature projection benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./projection_benchmark "
+                 "query_features_dir reference_features_dir";
+    exit(0);
+  }
+  const ScoringRun baseline = scoreAll(argv[1], argv[2], nullptr);
+  LOG(INFO) << "Original features: "
+            << baseline.scores.size() / baseline.seconds << " comparisons/s, "
+            << baseline.featureBytes << " bytes of reference features.";
+
+  const loc::features::FeatureMatrix refFeatures =
+      loc::features::FeatureMatrix::load(argv[2]);
+  for (const int outputDim : {64, 128, 256, 512}) {
+    if (outputDim >= refFeatures.dim()) {
+      break;
+    }
+    const auto projection =
+        loc::features::Projection::trainPca(refFeatures, outputDim);
+    const ScoringRun run = scoreAll(argv[1], argv[2], projection.get());
+    double errorSum = 0.0;
+    for (size_t i = 0; i < run.scores.size(); ++i) {
+      errorSum += std::abs(run.scores[i] - baseline.scores[i]);
+    }
+    LOG(INFO) << "PCA to " << outputDim << " dimensions: "
+              << 100.0 * projection->explainedVariance()
+              << "% of the variance, " << run.scores.size() / run.seconds
+              << " comparisons/s (" << baseline.seconds / run.seconds
+              << "x), " << run.featureBytes
+              << " bytes of reference features, mean similarity error "
+              << errorSum / run.scores.size() << ", same best match for "
+              << 100.0 * sameBestMatch(run, baseline) << "% of queries.";
+  }
+  return 0;
+}
@@ -0,0 +1,168 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/similarity_matrix.h"
+#include "features/feature_io.h"
+#include "features/proto_values.h"
+#include "localization_protos.pb.h"
+
+#include <glog/logging.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+namespace fs = std::filesystem;
+using loc::features::ProtoValuesFormat;
+
+namespace {
+constexpr int kNumFeatures = 500;
+
+std::vector<double> randomValues(size_t size, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> values(size);
+  for (double &value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+
+// Feature files as written before the values were packed: every value has
+// its own tag.
+void writeUnpackedFeature(const std::string &filename,
+                          const std::vector<double> &values) {
+  std::string wire;
+  for (double value : values) {
+    wire.push_back(0x09);
+    char bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(double));
+    wire.append(bytes, sizeof(double));
+  }
+  std::ofstream(filename, std::ios::binary) << wire;
+}
+
+// The parsing before the arena and the raw formats were introduced.
+std::vector<double> readFeatureFromStream(const std::string &filename) {
+  image_sequence_localizer::Feature feature_proto;
+  std::fstream input(filename, std::ios::in | std::ios::binary);
+  LOG_IF(FATAL, !feature_proto.ParseFromIstream(&input))
+      << "Failed to parse " << filename;
+  return {feature_proto.values().begin(), feature_proto.values().end()};
+}
+
+template <class Read>
+void measureFeatures(const std::string &name,
+                     const std::vector<std::string> &files, int dim,
+                     Read read) {
+  double checksum = 0.0;
+  const auto start = std::chrono::steady_clock::now();
+  for (const std::string &file : files) {
+    checksum += read(file)[0];
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  LOG_IF(INFO, checksum == 0.0) << "Unexpected checksum.";
+  LOG(INFO) << "  " << name << ": " << fs::file_size(files[0]) << " bytes, "
+            << files.size() / seconds << " features/s, "
+            << files.size() * dim * sizeof(float) / seconds / 1e6
+            << " MB/s of float values";
+}
+
+std::vector<std::string> writeFeatures(const fs::path &dir,
+                                       const std::string &prefix, int dim,
+                                       ProtoValuesFormat format, bool unpacked,
+                                       std::mt19937 &generator) {
+  std::vector<std::string> files;
+  for (int idx = 0; idx < kNumFeatures; ++idx) {
+    const std::string file =
+        dir / (prefix + "_" + std::to_string(idx) + ".Feature.pb");
+    const std::vector<double> values = randomValues(dim, generator);
+    if (unpacked) {
+      writeUnpackedFeature(file, values);
+    } else {
+      loc::features::writeFeatureValues(file, values, "benchmark", format);
+    }
+    files.push_back(file);
+  }
+  return files;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Proto parsing benchmark ====\n";
+  const int matrixSize = argc > 1 ? std::stoi(argv[1]) : 2000;
+  const fs::path dir = fs::temp_directory_path() / "proto_io_benchmark";
+  fs::create_directories(dir);
+  std::mt19937 generator(42);
+
+  for (int dim : {256, 4096}) {
+    LOG(INFO) << "Features of dimension " << dim;
+    const auto unpacked = writeFeatures(dir, "unpacked", dim,
+                                        ProtoValuesFormat::RepeatedDouble,
+                                        /*unpacked=*/true, generator);
+    measureFeatures("unpacked doubles, stream parsing", unpacked, dim,
+                    readFeatureFromStream);
+    measureFeatures("unpacked doubles", unpacked, dim,
+                    loc::features::readFeatureValues);
+    measureFeatures("packed doubles",
+                    writeFeatures(dir, "packed", dim,
+                                  ProtoValuesFormat::RepeatedDouble,
+                                  /*unpacked=*/false, generator),
+                    dim, loc::features::readFeatureValues);
+    measureFeatures("raw float32",
+                    writeFeatures(dir, "float32", dim,
+                                  ProtoValuesFormat::RawFloat32,
+                                  /*unpacked=*/false, generator),
+                    dim, loc::features::readFeatureValues);
+  }
+
+  LOG(INFO) << "Similarity matrix " << matrixSize << "x" << matrixSize;
+  loc::database::SimilarityMatrix::Matrix scores(matrixSize);
+  for (auto &row : scores) {
+    row = randomValues(matrixSize, generator);
+  }
+  const loc::database::SimilarityMatrix matrix(scores);
+  const std::string matrixFile = dir / "benchmark.SimilarityMatrix.pb";
+  for (const auto &[name, format] :
+       {std::pair{"packed doubles", ProtoValuesFormat::RepeatedDouble},
+        std::pair{"raw float32", ProtoValuesFormat::RawFloat32}}) {
+    matrix.saveToProto(matrixFile, format);
+    const auto start = std::chrono::steady_clock::now();
+    const loc::database::SimilarityMatrix loaded(matrixFile);
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+            .count();
+    LOG(INFO) << "  " << name << ": " << fs::file_size(matrixFile)
+              << " bytes, loaded in " << seconds * 1e3 << " ms";
+  }
+  fs::remove_all(dir);
+  return 0;
+}
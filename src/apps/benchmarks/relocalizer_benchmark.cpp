@@ -0,0 +1,320 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/feature_factory.h"
+#include "features/feature_loader.h"
+#include "features/similarity_kernels.h"
+#include "relocalizers/dimension_hashing.h"
+#include "relocalizers/lsh_cv_hashing.h"
+#include "relocalizers/lsh_hashing.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+using Features = std::vector<std::unique_ptr<loc::features::iFeature>>;
+
+// The relocalizers return at most 5 candidates, the default of the
+// localizer.
+constexpr int kMaxK = 5;
+
+// The most similar reference of every query, by the cosine of the features.
+std::vector<int> exactBestMatches(const Features &query, const Features &ref) {
+  std::vector<int> best(query.size(), 0);
+  for (size_t q = 0; q < query.size(); ++q) {
+    double bestScore = -1.0;
+    for (size_t r = 0; r < ref.size(); ++r) {
+      const double score = query[q]->computeSimilarityScore(*ref[r]);
+      if (score > bestScore) {
+        bestScore = score;
+        best[q] = r;
+      }
+    }
+  }
+  return best;
+}
+
+// Retrieves the candidates of every query and reports the recall@k of the
+// exact best match and the latency per query.
+void evaluate(
+    const std::string &name, const Features &query,
+    const std::vector<int> &bestMatches,
+    const std::function<std::vector<int>(const loc::features::iFeature &)>
+        &candidatesFor) {
+  std::vector<int> hits(kMaxK + 1, 0);
+  std::vector<double> latencies;
+  latencies.reserve(query.size());
+  // The relocalizers log every query.
+  FLAGS_minloglevel = google::WARNING;
+  for (size_t q = 0; q < query.size(); ++q) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<int> candidates = candidatesFor(*query[q]);
+    latencies.push_back(std::chrono::duration<double, std::micro>(
+                            std::chrono::steady_clock::now() - start)
+                            .count());
+    const auto found =
+        std::find(candidates.begin(), candidates.end(), bestMatches[q]);
+    if (found != candidates.end()) {
+      ++hits[found - candidates.begin() + 1];
+    }
+  }
+  FLAGS_minloglevel = google::INFO;
+  std::sort(latencies.begin(), latencies.end());
+  double meanLatency = 0.0;
+  for (double latency : latencies) {
+    meanLatency += latency / latencies.size();
+  }
+  std::string recalls;
+  int cumulativeHits = 0;
+  for (int k = 1; k <= kMaxK; ++k) {
+    cumulativeHits += hits[k];
+    recalls += " @" + std::to_string(k) + " " +
+               std::to_string(100.0 * cumulativeHits / query.size()) + "%";
+  }
+  LOG(INFO) << name << ": recall" << recalls << ", latency mean "
+            << meanLatency << " us, median "
+            << latencies[latencies.size() / 2] << " us, p99 "
+            << latencies[latencies.size() * 99 / 100] << " us.";
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+// A reference that grows by a new mapping run: the hashing trained on the
+// old part and extended by addFeatures() against retraining it on the whole
+// reference. `makeHashing` returns an untrained hashing.
+template <typename MakeHashing, typename CandidatesFor>
+void compareAppendWithRetrain(const std::string &name,
+                              const std::string &refDir, const Features &query,
+                              const std::vector<int> &bestMatches,
+                              const MakeHashing &makeHashing,
+                              const CandidatesFor &candidatesFor) {
+  Features oldRef =
+      loc::features::loadFeatures(refDir, loc::features::Cnn_Feature);
+  // The last 5% of the reference are the new run, below the share at which
+  // the hashings rebuild their index.
+  const size_t numOld = oldRef.size() - oldRef.size() / 20;
+  Features newRef;
+  for (size_t idx = numOld; idx < oldRef.size(); ++idx) {
+    newRef.push_back(std::move(oldRef[idx]));
+  }
+  oldRef.resize(numOld);
+  Features allRef =
+      loc::features::loadFeatures(refDir, loc::features::Cnn_Feature);
+
+  auto retrained = makeHashing();
+  auto start = std::chrono::steady_clock::now();
+  retrained->train(allRef);
+  const double retrainMs = millisecondsSince(start);
+
+  auto appended = makeHashing();
+  appended->train(oldRef);
+  start = std::chrono::steady_clock::now();
+  appended->addFeatures(newRef);
+  const double appendMs = millisecondsSince(start);
+
+  LOG(INFO) << name << ": appending " << newRef.size() << " features took "
+            << appendMs << " ms, retraining on all " << allRef.size()
+            << " took " << retrainMs << " ms.";
+  evaluate(name + ", retrained", query, bestMatches,
+           [&](const loc::features::iFeature &feature) {
+             return candidatesFor(*retrained, feature);
+           });
+  evaluate(name + ", appended", query, bestMatches,
+           [&](const loc::features::iFeature &feature) {
+             return candidatesFor(*appended, feature);
+           });
+}
+
+// Speed of the vote kernels on a bitmap over the whole reference with half
+// of the bits set, the typical list of a mean-binarized dimension.
+void benchmarkVoteKernels(int refSize) {
+  const int words = (refSize + 63) / 64;
+  std::mt19937_64 generator(1);
+  std::vector<uint64_t> bitmap(words);
+  for (uint64_t &word : bitmap) {
+    word = generator();
+  }
+  std::vector<uint16_t> votes(64 * words, 0);
+  constexpr int kRepetitions = 2000;
+  for (const auto level : loc::features::supportedSimdLevels()) {
+    const auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < kRepetitions; ++rep) {
+      loc::features::addBitmapVotes(bitmap.data(), words, votes.data(), level);
+    }
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    LOG(INFO) << "addBitmapVotes " << loc::features::simdLevelName(level)
+              << ": " << 64.0 * words * kRepetitions / seconds / 1e9
+              << " G references/s.";
+  }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Relocalizer benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./relocalizer_benchmark "
+                 "query_features_dir reference_features_dir";
+    exit(0);
+  }
+  const std::string queryDir = argv[1];
+  const std::string refDir = argv[2];
+  const Features query =
+      loc::features::loadFeatures(queryDir, loc::features::Cnn_Feature);
+  const Features ref =
+      loc::features::loadFeatures(refDir, loc::features::Cnn_Feature);
+  LOG_IF(FATAL, query.empty() || ref.empty()) << "No features to compare.";
+  const std::vector<int> bestMatches = exactBestMatches(query, ref);
+
+  // The relocalizers only use the database in getCandidates().
+  loc::database::OnlineDatabase database(queryDir, refDir,
+                                         loc::features::Cnn_Feature,
+                                         /*bufferSize=*/1);
+
+  // The OpenCV FLANN version is the baseline of the native LSH, both with the
+  // parameters of the localizers.
+  loc::relocalizers::LshCvHashing flannLsh(&database, /*tableNum=*/1,
+                                           /*keySize=*/12,
+                                           /*multiProbeLevel=*/2);
+  flannLsh.train(ref);
+  evaluate("FLANN LSH, 1 table", query, bestMatches,
+           [&flannLsh](const loc::features::iFeature &feature) {
+             return flannLsh.hashFeature(feature);
+           });
+
+  struct LshConfig {
+    std::string name;
+    int numTables;
+    int numThreads;
+  };
+  for (const LshConfig &config :
+       {LshConfig{"LSH, 1 table", 1, 1}, LshConfig{"LSH, 8 tables", 8, 1},
+        LshConfig{"LSH, 8 tables, parallel probing", 8, 0}}) {
+    loc::features::LshOptions options;
+    options.numTables = config.numTables;
+    options.keySize = 12;
+    options.multiProbeLevel = 2;
+    options.numThreads = config.numThreads > 0
+                             ? config.numThreads
+                             : loc::tools::defaultNumThreads();
+    loc::relocalizers::LshHashing lsh(&database, options,
+                                      /*numCandidates=*/kMaxK);
+    lsh.train(ref);
+    evaluate(config.name, query, bestMatches,
+             [&lsh](const loc::features::iFeature &feature) {
+               return lsh.candidatesFor(feature);
+             });
+  }
+
+  {
+    // Cold start: hashing the reference against mapping a saved index.
+    loc::features::LshOptions options;
+    options.numTables = 8;
+    options.keySize = 12;
+    loc::relocalizers::LshHashing lsh(&database, options,
+                                      /*numCandidates=*/kMaxK);
+    auto start = std::chrono::steady_clock::now();
+    lsh.train(ref);
+    const double trainMs = std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    const std::string indexFile =
+        (std::filesystem::temp_directory_path() /
+         "relocalizer_benchmark.LshIndex.bin")
+            .string();
+    lsh.save(indexFile, /*referenceFingerprint=*/0);
+    loc::relocalizers::LshHashing loaded(&database, options,
+                                         /*numCandidates=*/kMaxK);
+    start = std::chrono::steady_clock::now();
+    CHECK(loaded.load(indexFile, /*referenceFingerprint=*/0));
+    const double loadMs = std::chrono::duration<double, std::milli>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+    std::filesystem::remove(indexFile);
+    LOG(INFO) << "LSH index of the features in memory, 8 tables: hashed in "
+              << trainMs << " ms, loaded from disk in " << loadMs << " ms.";
+  }
+
+  compareAppendWithRetrain(
+      "FLANN LSH, 1 table", refDir, query, bestMatches,
+      [&database]() {
+        return std::make_unique<loc::relocalizers::LshCvHashing>(
+            &database, /*tableNum=*/1, /*keySize=*/12,
+            /*multiProbeLevel=*/2);
+      },
+      [](loc::relocalizers::LshCvHashing &hashing,
+         const loc::features::iFeature &feature) {
+        return hashing.hashFeature(feature);
+      });
+  compareAppendWithRetrain(
+      "LSH, 8 tables", refDir, query, bestMatches,
+      [&database]() {
+        loc::features::LshOptions options;
+        options.numTables = 8;
+        options.keySize = 12;
+        options.multiProbeLevel = 2;
+        return std::make_unique<loc::relocalizers::LshHashing>(
+            &database, options, /*numCandidates=*/kMaxK);
+      },
+      [](loc::relocalizers::LshHashing &hashing,
+         const loc::features::iFeature &feature) {
+        return hashing.candidatesFor(feature);
+      });
+
+  loc::relocalizers::DimensionHashing dimensionHashing(
+      &database, /*topFraction=*/1.0, /*maxCandidates=*/kMaxK);
+  dimensionHashing.train(ref);
+  evaluate("Dimension hashing", query, bestMatches,
+           [&dimensionHashing](const loc::features::iFeature &feature) {
+             return dimensionHashing.candidatesFor(feature);
+           });
+  LOG(INFO) << "Dimension hashing index: "
+            << dimensionHashing.index().memoryBytes() / 1024 << " KB, "
+            << dimensionHashing.index().numBitmapLists() << " of "
+            << dimensionHashing.index().numDimensions()
+            << " posting lists are bitmaps.";
+
+  benchmarkVoteKernels(ref.size());
+  return 0;
+}
@@ -0,0 +1,98 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/sharded_database.h"
+#include "features/feature_factory.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+// Matches every query against the references in a band around the diagonal,
+// one row per request, like a search that follows the path.
+double runBandSweep(loc::database::ShardedDatabase &database, int band) {
+  const int querySize = database.querySize();
+  const int refSize = database.refSize();
+  std::vector<int> refIds;
+  const auto start = std::chrono::steady_clock::now();
+  for (int q = 0; q < querySize; ++q) {
+    const int center =
+        static_cast<int64_t>(q) * refSize / std::max(querySize, 1);
+    refIds.clear();
+    for (int r = std::max(0, center - band);
+         r <= std::min(refSize - 1, center + band); ++r) {
+      refIds.push_back(r);
+    }
+    database.getCosts(q, refIds);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Sharded database scalability benchmark ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./sharded_database_benchmark "
+                 "query_features reference_features [max_shards] [band] "
+                 "[buffer_size]";
+    exit(0);
+  }
+  const int maxShards =
+      argc > 3 ? std::stoi(argv[3])
+               : std::max(1u, std::thread::hardware_concurrency());
+  const int band = argc > 4 ? std::stoi(argv[4]) : 200;
+  loc::database::ShardedDatabaseOptions options;
+  options.bufferSize = argc > 5 ? std::stoi(argv[5]) : 1000;
+
+  double baselineSec = 0.0;
+  for (int numShards = 1; numShards <= maxShards; numShards *= 2) {
+    // Fresh workers per run, so every run starts with cold caches.
+    options.numShards = numShards;
+    loc::database::ShardedDatabase database(
+        argv[1], argv[2], loc::features::FeatureType::Cnn_Feature, options);
+    const double seconds = runBandSweep(database, band);
+    if (numShards == 1) {
+      baselineSec = seconds;
+    }
+    const int64_t costs =
+        static_cast<int64_t>(database.querySize()) * (2 * band + 1);
+    LOG(INFO) << database.numShards() << " shards: about " << costs
+              << " costs in " << seconds << " s, " << costs / seconds
+              << " costs/s, speedup " << baselineSec / seconds << ".";
+  }
+  return 0;
+}
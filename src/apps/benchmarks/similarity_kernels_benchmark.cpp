@@ -0,0 +1,169 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/aligned_allocator.h"
+#include "features/similarity_kernels.h"
+
+#include <glog/logging.h>
+
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+namespace {
+// Reads a buffer much larger than the caches, the kernel is fast enough to
+// be limited by the memory.
+double memoryBandwidthGBps() {
+  const size_t size = size_t{1} << 26;
+  loc::features::AlignedFloatVector values(size, 1.f);
+  float checksum = 0.f;
+  const int repetitions = 5;
+  const auto start = std::chrono::steady_clock::now();
+  for (int rep = 0; rep < repetitions; ++rep) {
+    checksum += loc::features::dotProduct(values.data(), values.data(), size);
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  LOG_IF(INFO, checksum == 0.f) << "Unexpected checksum.";
+  return repetitions * size * sizeof(float) / seconds * 1e-9;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Similarity kernels benchmark ====\n";
+  // Number of reference vectors every query is compared against. The
+  // reference does not fit in the cache for large dimensions, like in the
+  // matching.
+  const int numRefs = argc > 1 ? std::stoi(argv[1]) : 256;
+
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  LOG(INFO) << "Best kernel: "
+            << loc::features::simdLevelName(loc::features::bestSimdLevel());
+  const double bandwidth = memoryBandwidthGBps();
+  LOG(INFO) << "Memory bandwidth: " << bandwidth
+            << " GB/s. Scoring references that do not fit in the cache is "
+               "bound by 2 FLOP per 4 byte float read, times the number of "
+               "queries scored at once.";
+  for (int dim = 256; dim <= 32768; dim *= 2) {
+    loc::features::AlignedFloatVector query(dim);
+    loc::features::AlignedFloatVector refs(static_cast<size_t>(dim) * numRefs);
+    for (float &value : query) {
+      value = distribution(generator);
+    }
+    for (float &value : refs) {
+      value = distribution(generator);
+    }
+    for (const auto level : loc::features::supportedSimdLevels()) {
+      // Repeat until the measurement takes long enough to be stable.
+      int64_t comparisons = 0;
+      float checksum = 0.f;
+      const auto start = std::chrono::steady_clock::now();
+      double seconds = 0.0;
+      while (seconds < 0.2) {
+        for (int r = 0; r < numRefs; ++r) {
+          checksum += loc::features::dotProduct(
+              query.data(), refs.data() + static_cast<size_t>(r) * dim, dim,
+              level);
+        }
+        comparisons += numRefs;
+        seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+      }
+      LOG(INFO) << "dim " << dim << ", " << loc::features::simdLevelName(level)
+                << ": " << comparisons / seconds << " comparisons/s, "
+                << 2.0 * comparisons * dim / seconds * 1e-9 << " GFLOP/s"
+                << " (checksum " << checksum << ")";
+    }
+    // One or several queries against all references with the batched
+    // kernel, like the successors of one or several nodes.
+    for (const int numQueries : {1, 4}) {
+      std::vector<const float *> queryRows(numQueries, query.data());
+      std::vector<const float *> refRows(numRefs);
+      for (int r = 0; r < numRefs; ++r) {
+        refRows[r] = refs.data() + static_cast<size_t>(r) * dim;
+      }
+      std::vector<float> scores(static_cast<size_t>(numQueries) * numRefs);
+      for (const auto level : loc::features::supportedSimdLevels()) {
+        int64_t comparisons = 0;
+        float checksum = 0.f;
+        const auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        while (seconds < 0.2) {
+          loc::features::dotProductBatch(queryRows.data(), numQueries,
+                                         refRows.data(), numRefs, dim,
+                                         scores.data(), level);
+          checksum += scores[0];
+          comparisons += static_cast<int64_t>(numQueries) * numRefs;
+          seconds = std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+        }
+        LOG(INFO) << "dim " << dim << ", batch " << numQueries << "x"
+                  << numRefs << " " << loc::features::simdLevelName(level)
+                  << ": " << comparisons / seconds << " comparisons/s, "
+                  << 2.0 * comparisons * dim / seconds * 1e-9
+                  << " GFLOP/s, memory bound "
+                  << bandwidth * 0.5 * numQueries << " GFLOP/s (checksum "
+                  << checksum << ")";
+      }
+    }
+    loc::features::AlignedInt8Vector queryInt8(dim);
+    loc::features::AlignedInt8Vector refsInt8(refs.size());
+    for (int d = 0; d < dim; ++d) {
+      queryInt8[d] = static_cast<int8_t>(query[d] * 127.f);
+    }
+    for (size_t i = 0; i < refs.size(); ++i) {
+      refsInt8[i] = static_cast<int8_t>(refs[i] * 127.f);
+    }
+    for (const auto level : loc::features::supportedSimdLevels()) {
+      int64_t comparisons = 0;
+      int64_t checksum = 0;
+      const auto start = std::chrono::steady_clock::now();
+      double seconds = 0.0;
+      while (seconds < 0.2) {
+        for (int r = 0; r < numRefs; ++r) {
+          checksum += loc::features::dotProductInt8(
+              queryInt8.data(),
+              refsInt8.data() + static_cast<size_t>(r) * dim, dim, level);
+        }
+        comparisons += numRefs;
+        seconds = std::chrono::duration<double>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+      }
+      LOG(INFO) << "dim " << dim << ", int8 "
+                << loc::features::simdLevelName(level) << ": "
+                << comparisons / seconds << " comparisons/s (checksum "
+                << checksum << ")";
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,97 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/fingerprint.h"
+#include "features/binary_feature.h"
+#include "features/feature_factory.h"
+#include "features/feature_loader.h"
+#include "features/lsh_index.h"
+#include "features/projection.h"
+#include "relocalizers/lsh_hashing.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <memory>
+#include <string>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Building of a relocalization index ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./build_relocalization_index "
+                 "reference_features_dir output.LshIndex.bin [num_tables] "
+                 "[key_size] [multi_probe_level] [projection.Projection.bin] "
+                 "[feature_type]";
+    exit(0);
+  }
+  const std::string refDir = argv[1];
+  const std::string output = argv[2];
+  LOG_IF(FATAL, !loc::features::isLshIndexFile(output))
+      << "The output should have the .LshIndex.bin extension.";
+  // The defaults of the localizer config.
+  loc::features::LshOptions options;
+  options.numTables = argc > 3 ? std::stoi(argv[3]) : 1;
+  options.keySize = argc > 4 ? std::stoi(argv[4]) : 12;
+  options.multiProbeLevel = argc > 5 ? std::stoi(argv[5]) : 2;
+  const std::string projectionFile = argc > 6 ? argv[6] : "";
+  // Keep an empty projection argument to only set the feature type.
+  const loc::features::FeatureType type =
+      argc > 7 ? loc::features::featureTypeFromName(argv[7])
+               : loc::features::FeatureType::Cnn_Feature;
+  LOG_IF(FATAL, !loc::features::hasFeatureBits(type))
+      << "An LSH index needs binary codes, "
+      << loc::features::featureTypeName(type) << " features have none.";
+  std::shared_ptr<const loc::features::Projection> projection;
+  if (!projectionFile.empty()) {
+    projection = loc::features::Projection::load(projectionFile);
+  }
+
+  Timer timer;
+  timer.start();
+  const auto features = loc::features::loadFeatures(
+      refDir, type, /*numThreads=*/0,
+      /*stats=*/nullptr, projection.get());
+  LOG_IF(FATAL, features.empty()) << "No features in " << refDir;
+  loc::features::LshIndex index(loc::features::numFeatureBits(*features[0]),
+                                options);
+  for (const auto &feature : features) {
+    index.add(loc::features::packedFeatureBits(*feature).data());
+  }
+  index.rebuild();
+  index.save(output, loc::relocalizers::indexFingerprint(
+                         loc::database::fingerprintFeatures(refDir),
+                         projectionFile, type));
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  LOG(INFO) << "Hashed " << index.size() << " features into "
+            << options.numTables << " tables, "
+            << index.memoryBytes() / 1024 << " KB.";
+  LOG(INFO) << "Done.";
+  return 0;
+}
@@ -0,0 +1,79 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/bow_vocabulary.h"
+#include "features/feature_io.h"
+#include "features/orb_extractor.h"
+#include "tools/parallel/parallel_for.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+namespace fs = std::filesystem;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Computation of bag-of-words features ====\n";
+
+  if (argc < 4) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./compute_bow_features "
+                 "vocabulary.BowVocabulary.bin images_dir output_dir "
+                 "[num_threads]";
+    exit(0);
+  }
+  const auto vocabulary = loc::features::BowVocabulary::load(argv[1]);
+  const fs::path outputDir = argv[3];
+  const int numThreads = argc > 4 ? std::stoi(argv[4]) : 0;
+  fs::create_directories(outputDir);
+
+  Timer timer;
+  timer.start();
+  const std::vector<std::string> images = loc::database::listImageDir(argv[2]);
+  LOG_IF(FATAL, images.empty()) << "No images in " << argv[2];
+  loc::tools::parallelFor(
+      0, images.size(),
+      [&](int idx) {
+        const auto feature = vocabulary->computeFeature(
+            loc::features::extractOrbDescriptors(images[idx]));
+        // The features keep the order of the images.
+        const fs::path output =
+            outputDir / (fs::path(images[idx]).stem().string() + ".Feature.pb");
+        loc::features::writeFeatureValues(output, feature->toDense(),
+                                          feature->type);
+      },
+      numThreads);
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  LOG(INFO) << "Stored the features of " << images.size() << " images in "
+            << outputDir;
+  LOG(INFO) << "Done.";
+  return 0;
+}
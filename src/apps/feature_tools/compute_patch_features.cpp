@@ -0,0 +1,81 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/feature_io.h"
+#include "features/patch_descriptor.h"
+#include "tools/parallel/parallel_for.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+namespace fs = std::filesystem;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Computation of normalized patch features ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./compute_patch_features images_dir "
+                 "output_dir [num_threads] [width height patch_size]";
+    exit(0);
+  }
+  const fs::path outputDir = argv[2];
+  const int numThreads = argc > 3 ? std::stoi(argv[3]) : 0;
+  loc::features::PatchDescriptorOptions options;
+  if (argc > 6) {
+    options.width = std::stoi(argv[4]);
+    options.height = std::stoi(argv[5]);
+    options.patchSize = std::stoi(argv[6]);
+  }
+  fs::create_directories(outputDir);
+
+  Timer timer;
+  timer.start();
+  const std::vector<std::string> images = loc::database::listImageDir(argv[1]);
+  LOG_IF(FATAL, images.empty()) << "No images in " << argv[1];
+  loc::tools::parallelFor(
+      0, images.size(),
+      [&](int idx) {
+        const fs::path output =
+            outputDir / (fs::path(images[idx]).stem().string() + ".Feature.pb");
+        loc::features::writeFeatureValues(
+            output,
+            loc::features::computePatchDescriptor(images[idx], options),
+            "PatchFeature");
+      },
+      numThreads);
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  LOG(INFO) << "Stored the features of " << images.size() << " images in "
+            << outputDir;
+  LOG(INFO) << "Done.";
+  return 0;
+}
@@ -0,0 +1,74 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/pq_store.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <string>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Product quantization of features ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./convert_features_to_pq_store "
+                 "features_dir|features.FeatureStore.bin output.PqStore.bin "
+                 "[num_subspaces] [num_centroids] [num_threads]";
+    exit(0);
+  }
+  const std::string output = argv[2];
+  LOG_IF(FATAL, !loc::features::isPqStoreFile(output))
+      << "The output should have the .PqStore.bin extension.";
+  loc::features::PqTrainOptions options;
+  if (argc > 3) {
+    options.numSubspaces = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    options.numCentroids = std::stoi(argv[4]);
+  }
+  if (argc > 5) {
+    options.numThreads = std::stoi(argv[5]);
+  }
+
+  Timer timer;
+  timer.start();
+  const auto store = loc::features::buildPqStore(argv[1], options);
+  store->save(output);
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  const size_t floatBytes = static_cast<size_t>(store->size()) *
+                            store->codebook().dim() * sizeof(float);
+  LOG(INFO) << "Encoded " << store->size() << " features in "
+            << store->memoryBytes() << " bytes instead of " << floatBytes
+            << " bytes of float32 values ("
+            << static_cast<double>(floatBytes) / store->memoryBytes()
+            << "x smaller).";
+  LOG(INFO) << "Done.";
+  return 0;
+}
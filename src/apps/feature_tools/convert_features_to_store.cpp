@@ -0,0 +1,77 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/feature_store.h"
+#include "features/projection.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Conversion of features to a packed feature store ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./convert_features_to_store features_dir "
+                 "output.FeatureStore.bin|shm:<name> [num_threads] "
+                 "[projection.Projection.bin]";
+    exit(0);
+  }
+  const std::string featuresDir = argv[1];
+  const std::string output = argv[2];
+  LOG_IF(FATAL, !loc::features::isFeatureStoreFile(output))
+      << "The output should have the .FeatureStore.bin extension or name a "
+         "shared store as shm:<name>.";
+  const int numThreads = argc > 3 ? std::stoi(argv[3]) : 0;
+  std::shared_ptr<const loc::features::Projection> projection;
+  if (argc > 4) {
+    projection = loc::features::Projection::load(argv[4]);
+    LOG(INFO) << "Projecting the features from " << projection->inputDim()
+              << " to " << projection->outputDim() << " dimensions.";
+  }
+
+  Timer timer;
+  timer.start();
+  const std::vector<std::string> featureFiles =
+      loc::database::listProtoDir(featuresDir, ".Feature");
+  if (loc::features::isSharedFeatureStore(output)) {
+    loc::features::publishSharedFeatureStore(featureFiles, output, numThreads,
+                                             projection.get());
+  } else {
+    loc::features::writeFeatureStore(featureFiles, output, numThreads,
+                                     projection.get());
+  }
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  LOG(INFO) << "Done.";
+  return 0;
+}
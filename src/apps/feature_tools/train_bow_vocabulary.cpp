@@ -0,0 +1,80 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/bow_vocabulary.h"
+#include "features/orb_extractor.h"
+#include "tools/parallel/parallel_for.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <string>
+#include <vector>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Training of a bag-of-words vocabulary ====\n";
+
+  if (argc < 3) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./train_bow_vocabulary images_dir "
+                 "output.BowVocabulary.bin [num_words] [num_threads]";
+    exit(0);
+  }
+  const std::string output = argv[2];
+  loc::features::BowVocabularyOptions options;
+  if (argc > 3) {
+    options.numWords = std::stoi(argv[3]);
+  }
+  if (argc > 4) {
+    options.numThreads = std::stoi(argv[4]);
+  }
+
+  Timer timer;
+  timer.start();
+  const std::vector<std::string> images = loc::database::listImageDir(argv[1]);
+  LOG_IF(FATAL, images.empty()) << "No images in " << argv[1];
+  std::vector<std::vector<loc::features::BinaryDescriptor>> descriptors(
+      images.size());
+  loc::tools::parallelFor(
+      0, images.size(),
+      [&](int idx) {
+        descriptors[idx] = loc::features::extractOrbDescriptors(images[idx]);
+      },
+      options.numThreads);
+  LOG(INFO) << "Extracted the ORB descriptors of " << images.size()
+            << " images.";
+
+  const auto vocabulary =
+      loc::features::BowVocabulary::train(descriptors, options);
+  vocabulary->save(output);
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  LOG(INFO) << "Trained " << vocabulary->numWords() << " words.";
+  LOG(INFO) << "Done.";
+  return 0;
+}
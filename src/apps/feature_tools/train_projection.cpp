@@ -0,0 +1,82 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_matrix.h"
+#include "features/projection.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <memory>
+#include <string>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Training of a feature projection ====\n";
+
+  if (argc < 4) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./train_projection "
+                 "features_dir|features.FeatureStore.bin "
+                 "output.Projection.bin output_dim [pca|random] [num_threads]";
+    exit(0);
+  }
+  const std::string output = argv[2];
+  LOG_IF(FATAL, !loc::features::isProjectionFile(output))
+      << "The output should have the .Projection.bin extension.";
+  const int outputDim = std::stoi(argv[3]);
+  const std::string method = argc > 4 ? argv[4] : "pca";
+  LOG_IF(FATAL, method != "pca" && method != "random")
+      << "Unknown projection " << method << ", use pca or random.";
+  loc::features::PcaOptions options;
+  if (argc > 5) {
+    options.numThreads = std::stoi(argv[5]);
+  }
+
+  Timer timer;
+  timer.start();
+  const loc::features::FeatureMatrix features =
+      loc::features::FeatureMatrix::load(argv[1], options.numThreads);
+  LOG_IF(FATAL, features.rows() == 0) << "No features in " << argv[1];
+  std::shared_ptr<const loc::features::Projection> projection;
+  if (method == "pca") {
+    projection =
+        loc::features::Projection::trainPca(features, outputDim, options);
+    LOG(INFO) << "The projection keeps "
+              << 100.0 * projection->explainedVariance()
+              << "% of the variance of the features.";
+  } else {
+    projection = loc::features::Projection::randomOrthogonal(features.dim(),
+                                                            outputDim);
+  }
+  projection->save(output);
+  timer.stop();
+  timer.print_elapsed_time(TimeExt::MSec);
+  LOG(INFO) << "Projected " << features.dim() << " to " << outputDim
+            << " dimensions.";
+  LOG(INFO) << "Done.";
+  return 0;
+}
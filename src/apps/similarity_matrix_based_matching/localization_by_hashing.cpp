@@ -1,12 +1,11 @@
 // Created by O.Vysotska in 2023
 
+#include "database/fingerprint.h"
 #include "database/idatabase.h"
-#include "database/list_dir.h"
 #include "database/online_database.h"
-#include "features/cnn_feature.h"
 #include "features/ifeature.h"
 #include "online_localizer/path_element.h"
-#include "relocalizers/lsh_cv_hashing.h"
+#include "relocalizers/lsh_hashing.h"
 #include "tools/config_parser/config_parser.h"
 
 #include <glog/logging.h>
@@ -18,23 +17,6 @@
 
 namespace loc = localization;
 
-std::vector<std::unique_ptr<loc::features::iFeature>>
-loadFeatures(const std::string &path2folder) {
-  LOG(INFO) << "Loading the features to hash with LSH.";
-  std::vector<std::string> featureNames =
-      loc::database::listProtoDir(path2folder, ".Feature");
-  std::vector<std::unique_ptr<loc::features::iFeature>> features;
-
-  for (size_t i = 0; i < featureNames.size(); ++i) {
-    features.emplace_back(
-        std::make_unique<loc::features::CnnFeature>(featureNames[i]));
-    fprintf(stderr, ".");
-  }
-  fprintf(stderr, "\n");
-  LOG(INFO) << "Features were loaded and binarized";
-  return features;
-}
-
 int main(int argc, char *argv[]) {
   google::InitGoogleLogging(argv[0]);
   FLAGS_logtostderr = 1;
@@ -58,12 +40,23 @@ int main(int argc, char *argv[]) {
       /*bufferSize=*/parser.bufferSize,
       /*similarityMatrixFile=*/parser.similarityMatrix);
 
-  auto relocalizer = std::make_unique<loc::relocalizers::LshCvHashing>(
-      /*onlineDatabase=*/database.get(),
-      /*tableNum=*/1,
-      /*keySize=*/12,
-      /*multiProbeLevel=*/2);
-  relocalizer->train(loadFeatures(parser.path2ref));
+  loc::features::LshOptions options;
+  options.numTables = parser.lshNumTables;
+  options.keySize = parser.lshKeySize;
+  options.multiProbeLevel = parser.lshMultiProbeLevel;
+  auto relocalizer = std::make_unique<loc::relocalizers::LshHashing>(
+      /*database=*/database.get(), options,
+      /*numCandidates=*/parser.relocalizationCandidates);
+  if (parser.hashTable.empty()) {
+    relocalizer->train(parser.path2ref);
+  } else {
+    const uint64_t refFingerprint = loc::relocalizers::indexFingerprint(
+        loc::database::fingerprintFeatures(parser.path2ref));
+    if (!relocalizer->load(parser.hashTable, refFingerprint)) {
+      relocalizer->train(parser.path2ref);
+      relocalizer->save(parser.hashTable, refFingerprint);
+    }
+  }
 
   loc::online_localizer::Matches matches;
   for (int queryId = 0; queryId < parser.querySize; ++queryId) {
@@ -21,14 +21,24 @@
 ** SOFTWARE.
 **/
 
+#include "database/cost_cache_database.h"
+#include "database/fingerprint.h"
 #include "database/idatabase.h"
 #include "database/list_dir.h"
 #include "database/online_database.h"
+#include "database/pq_database.h"
+#include "database/sharded_database.h"
 #include "features/cnn_feature.h"
+#include "features/dnn_extractor.h"
+#include "features/feature_loader.h"
+#include "features/feature_store.h"
 #include "features/ifeature.h"
+#include "features/projection.h"
 #include "online_localizer/online_localizer.h"
 #include "online_localizer/path_element.h"
-#include "relocalizers/lsh_cv_hashing.h"
+#include "relocalizers/bow_relocalizer.h"
+#include "relocalizers/dimension_hashing.h"
+#include "relocalizers/lsh_hashing.h"
 #include "tools/config_parser/config_parser.h"
 
 #include <glog/logging.h>
@@ -36,25 +46,34 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace loc = localization;
 
+namespace {
+std::shared_ptr<const loc::features::FeatureStore>
+extractFeatures(loc::features::DnnExtractor &extractor,
+                const std::string &imagesDir,
+                const loc::features::Projection *projection) {
+  const std::vector<std::string> images =
+      loc::database::listImageDir(imagesDir);
+  LOG_IF(FATAL, images.empty()) << "No images in " << imagesDir;
+  return extractor.extractFeatureStore(images, projection);
+}
+
+// The hashing binarizes the values of CnnFeatures.
 std::vector<std::unique_ptr<loc::features::iFeature>>
-loadFeatures(const std::string &path2folder) {
-  LOG(INFO) << "Loading the features to hash with LSH.";
-  std::vector<std::string> featureNames =
-      loc::database::listProtoDir(path2folder, ".Feature");
+toCnnFeatures(const loc::features::FeatureStore &store) {
   std::vector<std::unique_ptr<loc::features::iFeature>> features;
-
-  for (size_t i = 0; i < featureNames.size(); ++i) {
-    features.emplace_back(
-        std::make_unique<loc::features::CnnFeature>(featureNames[i]));
-    fprintf(stderr, ".");
+  features.reserve(store.size());
+  for (int idx = 0; idx < store.size(); ++idx) {
+    const float *row = store.row(idx);
+    features.push_back(std::make_unique<loc::features::CnnFeature>(
+        std::vector<double>(row, row + store.dim())));
   }
-  fprintf(stderr, "\n");
-  LOG(INFO) << "Features were loaded and binarized";
   return features;
 }
+} // namespace
 
 int main(int argc, char *argv[]) {
   google::InitGoogleLogging(argv[0]);
@@ -72,23 +91,198 @@ int main(int argc, char *argv[]) {
   parser.parseYaml(config_file);
   parser.print();
 
-  const auto database = std::make_unique<loc::database::OnlineDatabase>(
-      /*queryFeaturesDir=*/parser.path2qu,
-      /*refFeaturesDir=*/parser.path2ref,
-      /*type=*/loc::features::FeatureType::Cnn_Feature,
-      /*bufferSize=*/parser.bufferSize,
-      /*similarityMatrixFile=*/parser.similarityMatrix);
+  const loc::features::FeatureType featureType =
+      loc::features::featureTypeFromName(parser.featureType);
+  std::shared_ptr<const loc::features::Projection> projection;
+  if (!parser.featureProjection.empty()) {
+    projection = loc::features::Projection::load(parser.featureProjection);
+  }
+
+  // The shard workers are forked, so they are started before any other
+  // threads.
+  std::unique_ptr<loc::database::ShardedDatabase> shardedDatabase;
+  if (parser.numShards > 1) {
+    loc::database::ShardedDatabaseOptions options;
+    options.numShards = parser.numShards;
+    options.bufferSize = parser.bufferSize;
+    options.batchRadius = parser.fanOut;
+    options.projection = projection;
+    shardedDatabase = std::make_unique<loc::database::ShardedDatabase>(
+        parser.path2qu, parser.path2ref, featureType, options);
+  }
+
+  std::unique_ptr<loc::database::OnlineDatabase> database;
+  std::shared_ptr<const loc::features::FeatureStore> extractedRefStore;
+  if (!parser.dnnModel.empty()) {
+    LOG_IF(FATAL, shardedDatabase || !parser.costCache.empty() ||
+                      !parser.similarityMatrix.empty())
+        << "Features computed from images cannot be combined with "
+           "numShards, costCache or similarityMatrix.";
+    LOG_IF(FATAL, featureType != loc::features::Cnn_Feature)
+        << "The features computed from images are Cnn_Feature, not "
+        << parser.featureType;
+    loc::features::DnnExtractorOptions options;
+    options.modelFile = parser.dnnModel;
+    options.inputWidth = parser.dnnInputSize;
+    options.inputHeight = parser.dnnInputSize;
+    options.batchSize = parser.dnnBatchSize;
+    loc::features::DnnExtractor extractor(options);
+    const auto queryStore =
+        extractFeatures(extractor, parser.path2quImg, projection.get());
+    extractedRefStore =
+        extractFeatures(extractor, parser.path2refImg, projection.get());
+    const auto &stats = extractor.stats();
+    LOG(INFO) << "Extracted " << stats.images << " descriptors of size "
+              << extractor.dim() << " at " << stats.imagesPerSecond()
+              << " images/s (preprocessing " << stats.preprocessingSeconds
+              << " s, inference " << stats.inferenceSeconds << " s).";
+    database = std::make_unique<loc::database::OnlineDatabase>(
+        queryStore, extractedRefStore, parser.bufferSize);
+  } else if (!parser.costCache.empty()) {
+    LOG_IF(FATAL, !parser.similarityMatrix.empty())
+        << "The costCache caches costs computed from features, it cannot be "
+           "combined with a precomputed similarityMatrix.";
+    database = std::make_unique<loc::database::CostCacheDatabase>(
+        /*queryFeaturesDir=*/parser.path2qu,
+        /*refFeaturesDir=*/parser.path2ref,
+        /*type=*/featureType,
+        /*bufferSize=*/parser.bufferSize,
+        /*cacheDir=*/parser.costCache);
+  } else {
+    database = std::make_unique<loc::database::OnlineDatabase>(
+        /*queryFeaturesDir=*/parser.path2qu,
+        /*refFeaturesDir=*/parser.path2ref,
+        /*type=*/featureType,
+        /*bufferSize=*/parser.bufferSize,
+        /*similarityMatrixFile=*/parser.similarityMatrix);
+  }
+  if (parser.bufferMemoryMb > 0) {
+    database->setBufferByteBudget(static_cast<size_t>(parser.bufferMemoryMb)
+                                  << 20);
+  }
+  if (projection && !extractedRefStore) {
+    // The extracted features are projected when they are computed.
+    database->setFeatureProjection(projection);
+  }
+  if (parser.prefetchLookahead > 0) {
+    database->enablePrefetching(parser.prefetchLookahead);
+  }
+  if (!parser.appendToReference.empty()) {
+    LOG_IF(FATAL, shardedDatabase || extractedRefStore ||
+                      !parser.similarityMatrix.empty())
+        << "appendToReference cannot be combined with numShards, dnnModel or "
+           "similarityMatrix.";
+    const std::vector<std::string> appendedFiles =
+        loc::database::listProtoDir(parser.appendToReference, ".Feature");
+    LOG_IF(FATAL, appendedFiles.empty())
+        << "No features to append in " << parser.appendToReference;
+    database->appendReferenceFeatures(appendedFiles);
+  }
+
+  // The costs come from the compressed reference, the features of path2ref
+  // are only loaded by the relocalizer.
+  std::unique_ptr<loc::database::PqDatabase> pqDatabase;
+  if (!parser.pqStore.empty()) {
+    LOG_IF(FATAL, shardedDatabase || extractedRefStore || projection ||
+                      !parser.costCache.empty() ||
+                      !parser.similarityMatrix.empty() ||
+                      !parser.appendToReference.empty())
+        << "pqStore cannot be combined with numShards, dnnModel, "
+           "featureProjection, costCache, similarityMatrix or "
+           "appendToReference.";
+    LOG_IF(FATAL, featureType != loc::features::Cnn_Feature)
+        << "The pqStore is matched against Cnn_Feature queries, not "
+        << parser.featureType;
+    pqDatabase = std::make_unique<loc::database::PqDatabase>(
+        parser.path2qu, parser.pqStore, parser.bufferSize);
+    LOG_IF(FATAL, pqDatabase->refSize() != database->refSize())
+        << "The pqStore holds " << pqDatabase->refSize()
+        << " features, but path2ref holds " << database->refSize();
+  }
 
-  auto relocalizer = std::make_unique<loc::relocalizers::LshCvHashing>(
-      /*onlineDatabase=*/database.get(),
-      /*tableNum=*/1,
-      /*keySize=*/12,
-      /*multiProbeLevel=*/2);
-  relocalizer->train(loadFeatures(parser.path2ref));
+  // The hashing relocalizers index the bits of the reference features.
+  LOG_IF(FATAL, parser.relocalizer != "bow" &&
+                    !loc::features::hasFeatureBits(featureType))
+      << "The " << parser.relocalizer
+      << " relocalizer indexes the bits of the features, " << parser.featureType
+      << " features have none. Use the bow relocalizer for Bow_Feature.";
+  const auto trainOnReference = [&](auto &hashing) {
+    if (extractedRefStore) {
+      hashing.train(toCnnFeatures(*extractedRefStore));
+    } else {
+      hashing.train(parser.path2ref, /*numThreads=*/0, projection.get(),
+                    featureType);
+    }
+  };
+  // The index of path2ref, trained or mapped, is extended by the appended
+  // features.
+  const auto appendToReference = [&](auto &hashing) {
+    if (!parser.appendToReference.empty()) {
+      hashing.addFeatures(loc::features::loadFeatures(
+          parser.appendToReference, featureType,
+          /*numThreads=*/0, /*stats=*/nullptr, projection.get()));
+    }
+  };
+  std::unique_ptr<loc::relocalizers::iRelocalizer> relocalizer;
+  if (parser.relocalizer == "bow") {
+    LOG_IF(FATAL, featureType != loc::features::Bow_Feature)
+        << "The bow relocalizer needs featureType Bow_Feature, not "
+        << parser.featureType;
+    LOG_IF(FATAL, !parser.hashTable.empty())
+        << "Only the lsh relocalizer is stored in a hashTable.";
+    auto bow = std::make_unique<loc::relocalizers::BowRelocalizer>(
+        /*database=*/database.get(),
+        /*numCandidates=*/parser.relocalizationCandidates);
+    bow->train(parser.path2ref);
+    appendToReference(*bow);
+    relocalizer = std::move(bow);
+  } else if (parser.relocalizer == "dimension_hashing") {
+    LOG_IF(FATAL, !parser.hashTable.empty())
+        << "Only the lsh relocalizer is stored in a hashTable.";
+    auto hashing = std::make_unique<loc::relocalizers::DimensionHashing>(
+        /*database=*/database.get(), /*topFraction=*/0.3,
+        /*maxCandidates=*/parser.relocalizationCandidates);
+    trainOnReference(*hashing);
+    appendToReference(*hashing);
+    relocalizer = std::move(hashing);
+  } else {
+    LOG_IF(FATAL, parser.relocalizer != "lsh")
+        << "Unknown relocalizer " << parser.relocalizer
+        << ", use lsh, dimension_hashing or bow";
+    loc::features::LshOptions options;
+    options.numTables = parser.lshNumTables;
+    options.keySize = parser.lshKeySize;
+    options.multiProbeLevel = parser.lshMultiProbeLevel;
+    auto hashing = std::make_unique<loc::relocalizers::LshHashing>(
+        /*database=*/database.get(), options,
+        /*numCandidates=*/parser.relocalizationCandidates);
+    if (parser.hashTable.empty()) {
+      trainOnReference(*hashing);
+    } else {
+      const uint64_t refFingerprint = loc::relocalizers::indexFingerprint(
+          extractedRefStore
+              ? loc::database::fingerprintStore(*extractedRefStore,
+                                                extractedRefStore->size())
+              : loc::database::fingerprintFeatures(parser.path2ref),
+          parser.featureProjection, featureType);
+      if (!hashing->load(parser.hashTable, refFingerprint)) {
+        trainOnReference(*hashing);
+        hashing->save(parser.hashTable, refFingerprint);
+      }
+    }
+    appendToReference(*hashing);
+    relocalizer = std::move(hashing);
+  }
 
+  loc::database::iDatabase *costDatabase = database.get();
+  if (shardedDatabase) {
+    costDatabase = shardedDatabase.get();
+  } else if (pqDatabase) {
+    costDatabase = pqDatabase.get();
+  }
   auto successorManager =
       std::make_unique<loc::successor_manager::SuccessorManager>(
-          database.get(), relocalizer.get(), parser.fanOut);
+          costDatabase, relocalizer.get(), parser.fanOut);
   loc::online_localizer::OnlineLocalizer localizer{
       successorManager.get(), parser.expansionRate, parser.matchingThreshold};
   const loc::online_localizer::Matches imageMatches =
@@ -96,6 +290,10 @@ int main(int argc, char *argv[]) {
   loc::online_localizer::storeMatchesAsProto(imageMatches,
                                              parser.matchingResult);
 
+  const auto &refStats = database->refBufferStats();
+  LOG(INFO) << "Reference feature buffer: " << refStats.hits << " hits, "
+            << refStats.misses << " misses, " << refStats.evictions
+            << " evictions.";
   LOG(INFO) << "Done.";
   return 0;
 }
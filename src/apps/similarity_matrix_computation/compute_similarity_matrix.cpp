@@ -0,0 +1,73 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/similarity_matrix_builder.h"
+#include "features/feature_matrix.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <string>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Similarity matrix computation from features ====\n";
+
+  if (argc < 4) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./compute_similarity_matrix "
+                 "query_features reference_features "
+                 "output.SimilarityMatrix.[pb|bin] [num_threads]";
+    exit(0);
+  }
+  // Feature directories or *.FeatureStore.bin files.
+  const std::string queryFeaturesDir = argv[1];
+  const std::string refFeaturesDir = argv[2];
+  const std::string outputFile = argv[3];
+
+  loc::database::SimilarityMatrixBuildOptions options;
+  if (argc > 4) {
+    options.numThreads = std::stoi(argv[4]);
+  }
+
+  Timer timer;
+  timer.start();
+  const auto queryFeatures =
+      loc::features::FeatureMatrix::load(queryFeaturesDir, options.numThreads);
+  const auto refFeatures =
+      loc::features::FeatureMatrix::load(refFeaturesDir, options.numThreads);
+  timer.stop();
+  LOG(INFO) << "Features were loaded";
+  timer.print_elapsed_time(TimeExt::MSec);
+
+  LOG_IF(FATAL, queryFeatures.rows() == 0) << "Query features are not set.";
+  LOG_IF(FATAL, refFeatures.rows() == 0) << "Reference features are not set.";
+
+  loc::database::writeSimilarityMatrix(queryFeatures, refFeatures, outputFile,
+                                       options);
+  LOG(INFO) << "Done.";
+  return 0;
+}
@@ -0,0 +1,59 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/tiled_similarity_matrix_builder.h"
+
+#include <glog/logging.h>
+
+#include <string>
+
+namespace loc = localization;
+
+int main(int argc, char *argv[]) {
+  google::InitGoogleLogging(argv[0]);
+  FLAGS_logtostderr = 1;
+  LOG(INFO) << "===== Out-of-core similarity matrix computation ====\n";
+
+  if (argc < 4) {
+    LOG(ERROR) << "Not enough input parameters.";
+    LOG(INFO) << "Proper usage: ./compute_similarity_matrix_tiled "
+                 "query_features_dir reference_features_dir "
+                 "output.SimilarityMatrix.bin [tile_size] [num_threads]";
+    LOG(INFO) << "Rerun the same command to resume an interrupted run.";
+    exit(0);
+  }
+
+  loc::database::TiledBuildOptions options;
+  if (argc > 4) {
+    options.tileRows = std::stoi(argv[4]);
+    options.tileCols = options.tileRows;
+  }
+  if (argc > 5) {
+    options.numThreads = std::stoi(argv[5]);
+  }
+  loc::database::buildSimilarityMatrixTiled(
+      /*queryFeaturesDir=*/argv[1], /*refFeaturesDir=*/argv[2],
+      /*outputFile=*/argv[3], options);
+  LOG(INFO) << "Done.";
+  return 0;
+}
@@ -0,0 +1,115 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/concurrent_online_database.h"
+#include "database/feature_source.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace localization::database {
+
+namespace {
+uint64_t costKey(int quId, int refId) {
+  return (static_cast<uint64_t>(quId) << 32) | static_cast<uint32_t>(refId);
+}
+} // namespace
+
+ConcurrentOnlineDatabase::ConcurrentOnlineDatabase(
+    const std::string &queryFeaturesDir, const std::string &refFeaturesDir,
+    features::FeatureType type, int bufferSize, int numShards)
+    : featureType_{type}, queryStore_{openFeatureStoreIfNeeded(queryFeaturesDir)},
+      refStore_{openFeatureStoreIfNeeded(refFeaturesDir)},
+      matchingCost_{
+          matchingCostFunction(type, queryStore_.get(), refStore_.get())},
+      queryBuffer_{bufferSize, numShards}, refBuffer_{bufferSize, numShards},
+      costShards_(std::max(numShards, 1)) {
+  quFeaturesNames_ = listFeatureNames(queryFeaturesDir, queryStore_.get());
+  refFeaturesNames_ = listFeatureNames(refFeaturesDir, refStore_.get());
+  LOG_IF(FATAL, quFeaturesNames_.empty()) << "Query features are not set.";
+  LOG_IF(FATAL, refFeaturesNames_.empty()) << "Reference features are not set.";
+}
+
+ConcurrentOnlineDatabase::CostShard &
+ConcurrentOnlineDatabase::costShardOf(uint64_t key) {
+  // Mixes the query and the reference id, the costs of one query are spread
+  // over all shards.
+  key ^= key >> 29;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 32;
+  return costShards_[key % costShards_.size()];
+}
+
+std::shared_ptr<const features::iFeature> ConcurrentOnlineDatabase::feature(
+    features::ConcurrentFeatureBuffer &buffer,
+    const std::vector<std::string> &featureNames,
+    const std::shared_ptr<const features::FeatureStore> &store,
+    int featureId) {
+  auto feature = buffer.findFeature(featureId);
+  if (feature) {
+    return feature;
+  }
+  // Two threads may load the same feature at once, the buffer keeps the copy
+  // added first.
+  return buffer.addFeature(
+      featureId, loadFeature(featureNames, store, featureType_, featureId));
+}
+
+double ConcurrentOnlineDatabase::getCost(int quId, int refId) {
+  CHECK(quId >= 0 && quId < (int)quFeaturesNames_.size())
+      << "Query feature " << quId << " is out of range";
+  CHECK(refId >= 0 && refId < (int)refFeaturesNames_.size())
+      << "Reference feature " << refId << " is out of range";
+  const uint64_t key = costKey(quId, refId);
+  CostShard &shard = costShardOf(key);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto found = shard.costs.find(key);
+    if (found != shard.costs.end()) {
+      return found->second;
+    }
+  }
+  const auto quFeature =
+      feature(queryBuffer_, quFeaturesNames_, queryStore_, quId);
+  const auto refFeature =
+      feature(refBuffer_, refFeaturesNames_, refStore_, refId);
+  const double cost = matchingCost_(*quFeature, *refFeature);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.costs.emplace(key, cost).second) {
+    ++shard.computed;
+  }
+  return cost;
+}
+
+int64_t ConcurrentOnlineDatabase::computedCosts() const {
+  int64_t computed = 0;
+  for (const CostShard &shard : costShards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    computed += shard.computed;
+  }
+  return computed;
+}
+
+} // namespace localization::database
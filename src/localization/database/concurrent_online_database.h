@@ -0,0 +1,100 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_CONCURRENT_ONLINE_DATABASE_H_
+#define SRC_DATABASE_CONCURRENT_ONLINE_DATABASE_H_
+
+#include "database/idatabase.h"
+#include "features/concurrent_feature_buffer.h"
+#include "features/feature_buffer.h"
+#include "features/feature_factory.h"
+#include "features/feature_store.h"
+#include "features/feature_traits.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace localization::database {
+
+/**
+ * @brief      Computes the matching costs from features like OnlineDatabase,
+ * but can be shared by several localizers or relocalizers running in
+ * different threads. The computed costs and the loaded features are kept in
+ * caches split between independently locked shards, and features are loaded
+ * outside of any lock.
+ */
+class ConcurrentOnlineDatabase : public iDatabase {
+public:
+  ConcurrentOnlineDatabase(const std::string &queryFeaturesDir,
+                           const std::string &refFeaturesDir,
+                           features::FeatureType type, int bufferSize,
+                           int numShards = 64);
+
+  int refSize() override { return refFeaturesNames_.size(); }
+  double getCost(int quId, int refId) override;
+  bool isThreadSafe() const override { return true; }
+
+  int querySize() const { return quFeaturesNames_.size(); }
+
+  /** Number of costs computed from features, i.e. cost cache misses. **/
+  int64_t computedCosts() const;
+  features::FeatureBufferStats queryBufferStats() const {
+    return queryBuffer_.stats();
+  }
+  features::FeatureBufferStats refBufferStats() const {
+    return refBuffer_.stats();
+  }
+
+private:
+  struct CostShard {
+    mutable std::mutex mutex;
+    std::unordered_map<uint64_t, double> costs;
+    int64_t computed = 0;
+  };
+
+  std::shared_ptr<const features::iFeature>
+  feature(features::ConcurrentFeatureBuffer &buffer,
+          const std::vector<std::string> &featureNames,
+          const std::shared_ptr<const features::FeatureStore> &store,
+          int featureId);
+  CostShard &costShardOf(uint64_t key);
+
+  const features::FeatureType featureType_;
+  const std::shared_ptr<const features::FeatureStore> queryStore_;
+  const std::shared_ptr<const features::FeatureStore> refStore_;
+  const features::MatchingCostFunction matchingCost_;
+  std::vector<std::string> quFeaturesNames_;
+  std::vector<std::string> refFeaturesNames_;
+
+  features::ConcurrentFeatureBuffer queryBuffer_;
+  features::ConcurrentFeatureBuffer refBuffer_;
+  std::vector<CostShard> costShards_;
+};
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_CONCURRENT_ONLINE_DATABASE_H_
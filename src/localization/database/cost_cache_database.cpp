@@ -0,0 +1,374 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/cost_cache_database.h"
+#include "database/fingerprint.h"
+#include "features/feature_store.h"
+
+#include <glog/logging.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+
+namespace localization::database {
+
+namespace fs = std::filesystem;
+
+namespace {
+// v2 stores NaN costs, v1 used any NaN as the empty cell.
+constexpr auto kMetaVersion = "cost_cache_v2";
+constexpr auto kMetaFile = "cache.meta";
+constexpr auto kTileExtension = ".costs";
+constexpr char kTileMagic[8] = "ISLCOST";
+// Every loaded tile keeps its file open for write-through.
+constexpr size_t kMaxLoadedTiles = 256;
+// Marks the cells that were not computed yet. A NaN with its own payload, so
+// the NaN costs of features without a norm are cached like any other cost.
+constexpr uint64_t kEmptyCellBits = 0x7ff80000c057ca5eULL;
+
+double emptyCell() {
+  double value;
+  std::memcpy(&value, &kEmptyCellBits, sizeof(value));
+  return value;
+}
+
+bool isEmptyCell(double cost) {
+  uint64_t bits;
+  std::memcpy(&bits, &cost, sizeof(bits));
+  return bits == kEmptyCellBits;
+}
+
+struct TileHeader {
+  char magic[8] = {};
+  int32_t tileRow = -1;
+  int32_t tileCol = -1;
+  int32_t tileSize = 0;
+  int32_t reserved = 0;
+};
+
+struct SequenceMeta {
+  int64_t count = -1;
+  uint64_t fingerprint = 0;
+};
+
+struct CacheMeta {
+  int featureType = -1;
+  int tileSize = 0;
+  SequenceMeta query;
+  SequenceMeta reference;
+};
+
+std::optional<CacheMeta> readMeta(const fs::path &metaFile) {
+  std::ifstream in(metaFile);
+  std::string version;
+  if (!(in >> version) || version != kMetaVersion) {
+    return std::nullopt;
+  }
+  CacheMeta meta;
+  std::string key, hex;
+  while (in >> key) {
+    if (key == "featureType") {
+      in >> meta.featureType;
+    } else if (key == "tileSize") {
+      in >> meta.tileSize;
+    } else if (key == "query" || key == "reference") {
+      SequenceMeta &sequence = key == "query" ? meta.query : meta.reference;
+      in >> sequence.count >> hex;
+      sequence.fingerprint = std::stoull(hex, nullptr, 16);
+    } else {
+      return std::nullopt;
+    }
+  }
+  return meta;
+}
+
+void writeMeta(const fs::path &metaFile, const CacheMeta &meta) {
+  std::ofstream out(metaFile, std::ios::trunc);
+  out << kMetaVersion << "\n"
+      << "featureType " << meta.featureType << "\n"
+      << "tileSize " << meta.tileSize << "\n"
+      << "query " << meta.query.count << " "
+      << toHexString(meta.query.fingerprint) << "\n"
+      << "reference " << meta.reference.count << " "
+      << toHexString(meta.reference.fingerprint) << "\n";
+  LOG_IF(FATAL, !out) << "Failed to write the cache meta file " << metaFile;
+}
+
+/** Fingerprint of the first `count` features of a sequence. Features from a
+ * store are hashed from the store, the names are not paths then. **/
+uint64_t fingerprintSequence(const std::vector<std::string> &files,
+                             const features::FeatureStore *store, int count) {
+  if (store) {
+    return fingerprintStore(*store, count);
+  }
+  const std::vector<std::string> prefix(files.begin(), files.begin() + count);
+  return fingerprintFiles(prefix);
+}
+
+/** The cached prefix is still valid if the first features did not change. **/
+bool isValidPrefix(const SequenceMeta &cached,
+                   const std::vector<std::string> &files,
+                   const features::FeatureStore *store,
+                   const SequenceMeta &current) {
+  if (cached.count < 0 || cached.count > current.count) {
+    return false;
+  }
+  if (cached.count == current.count) {
+    return cached.fingerprint == current.fingerprint;
+  }
+  return fingerprintSequence(files, store, cached.count) == cached.fingerprint;
+}
+
+std::string tileFileName(int tileRow, int tileCol) {
+  return "tile_" + std::to_string(tileRow) + "_" + std::to_string(tileCol) +
+         kTileExtension;
+}
+} // namespace
+
+CostCacheDatabase::CostCacheDatabase(const std::string &queryFeaturesDir,
+                                     const std::string &refFeaturesDir,
+                                     features::FeatureType type,
+                                     int bufferSize,
+                                     const std::string &cacheDir, int tileSize)
+    : OnlineDatabase(queryFeaturesDir, refFeaturesDir, type, bufferSize),
+      cacheDir_{cacheDir}, tileSize_{tileSize} {
+  CHECK(!cacheDir_.empty()) << "Cache directory is not set.";
+  CHECK(tileSize_ > 0) << "Invalid tile size " << tileSize_;
+  openCache();
+}
+
+CostCacheDatabase::~CostCacheDatabase() {
+  for (auto &[key, tile] : tiles_) {
+    close(tile.fd);
+  }
+  LOG(INFO) << "Cost cache " << cacheDir_ << ": " << stats_.hits
+            << " hits, " << stats_.computed << " computed costs, "
+            << stats_.tilesLoaded << " tiles loaded.";
+}
+
+void CostCacheDatabase::openCache() {
+  fs::create_directories(cacheDir_);
+  const fs::path metaFile = fs::path(cacheDir_) / kMetaFile;
+
+  const int numQueries = quFeaturesNames_.size();
+  const int numRefs = refFeaturesNames_.size();
+  queryFingerprint_ =
+      fingerprintSequence(quFeaturesNames_, queryStore_.get(), numQueries);
+  if (refStore_) {
+    refFingerprint_ = fingerprintStore(*refStore_, numRefs);
+  } else {
+    // Kept per file, so appended reference features are cheap to account for.
+    refFileFingerprints_ = fingerprintEachFile(refFeaturesNames_);
+    refFingerprint_ = combineFingerprints(refFileFingerprints_);
+  }
+  CacheMeta meta;
+  meta.featureType = featureType_;
+  meta.tileSize = tileSize_;
+  meta.query = {numQueries, queryFingerprint_};
+  meta.reference = {numRefs, refFingerprint_};
+
+  const std::optional<CacheMeta> cached = readMeta(metaFile);
+  const bool valid = cached && cached->featureType == meta.featureType &&
+                     cached->tileSize == meta.tileSize &&
+                     isValidPrefix(cached->query, quFeaturesNames_,
+                                   queryStore_.get(), meta.query) &&
+                     isValidPrefix(cached->reference, refFeaturesNames_,
+                                   refStore_.get(), meta.reference);
+  if (!valid) {
+    if (cached) {
+      LOG(WARNING) << "Cost cache " << cacheDir_
+                   << " belongs to different features. Clearing it.";
+    }
+    for (const auto &entry : fs::directory_iterator(cacheDir_)) {
+      if (entry.path().extension() == kTileExtension) {
+        fs::remove(entry.path());
+      }
+    }
+  } else {
+    LOG(INFO) << "Reusing cost cache " << cacheDir_;
+  }
+  writeCurrentMeta();
+}
+
+void CostCacheDatabase::writeCurrentMeta() const {
+  CacheMeta meta;
+  meta.featureType = featureType_;
+  meta.tileSize = tileSize_;
+  meta.query = {static_cast<int64_t>(quFeaturesNames_.size()),
+                queryFingerprint_};
+  meta.reference = {static_cast<int64_t>(refFeaturesNames_.size()),
+                    refFingerprint_};
+  writeMeta(fs::path(cacheDir_) / kMetaFile, meta);
+}
+
+void CostCacheDatabase::appendReferenceFeatures(
+    const std::vector<std::string> &featureFiles) {
+  OnlineDatabase::appendReferenceFeatures(featureFiles);
+  // The cached costs stay valid, the new references only fill empty cells of
+  // the tiles. Only the meta file has to describe the longer reference.
+  const std::vector<uint64_t> appended = fingerprintEachFile(featureFiles);
+  refFileFingerprints_.insert(refFileFingerprints_.end(), appended.begin(),
+                              appended.end());
+  refFingerprint_ = combineFingerprints(refFileFingerprints_);
+  writeCurrentMeta();
+}
+
+void CostCacheDatabase::setFeatureProjection(
+    std::shared_ptr<const features::Projection> /*projection*/) {
+  // The cache is bound to the fingerprints of the feature files, it would
+  // mix costs of projected and original features.
+  LOG(FATAL) << "The cost cache works on the original features, project "
+                "them into a feature store to cache their costs.";
+}
+
+CostCacheDatabase::Tile &CostCacheDatabase::getTile(int tileRow, int tileCol) {
+  const int64_t key = (static_cast<int64_t>(tileRow) << 32) | tileCol;
+  auto found = tiles_.find(key);
+  if (found != tiles_.end()) {
+    found->second.lastUse = ++useCounter_;
+    return found->second;
+  }
+  evictTileIfNeeded();
+
+  const fs::path tileFile =
+      fs::path(cacheDir_) / tileFileName(tileRow, tileCol);
+  Tile tile;
+  tile.lastUse = ++useCounter_;
+  tile.fd = open(tileFile.c_str(), O_RDWR | O_CREAT, 0644);
+  LOG_IF(FATAL, tile.fd < 0) << "The file cannot be opened " << tileFile
+                             << ": " << std::strerror(errno);
+  const size_t cells = static_cast<size_t>(tileSize_) * tileSize_;
+  tile.costs.resize(cells);
+
+  TileHeader header;
+  const size_t costsBytes = cells * sizeof(double);
+  const bool loaded =
+      pread(tile.fd, &header, sizeof(header), 0) == sizeof(header) &&
+      std::memcmp(header.magic, kTileMagic, sizeof(kTileMagic)) == 0 &&
+      header.tileRow == tileRow && header.tileCol == tileCol &&
+      header.tileSize == tileSize_ &&
+      pread(tile.fd, tile.costs.data(), costsBytes, sizeof(header)) ==
+          static_cast<ssize_t>(costsBytes);
+  if (!loaded) {
+    // New or damaged tile, nothing is computed yet.
+    std::fill(tile.costs.begin(), tile.costs.end(), emptyCell());
+    std::memcpy(header.magic, kTileMagic, sizeof(kTileMagic));
+    header.tileRow = tileRow;
+    header.tileCol = tileCol;
+    header.tileSize = tileSize_;
+    LOG_IF(FATAL,
+           pwrite(tile.fd, &header, sizeof(header), 0) != sizeof(header) ||
+               pwrite(tile.fd, tile.costs.data(), costsBytes,
+                      sizeof(header)) != static_cast<ssize_t>(costsBytes))
+        << "Failed to write the cache tile " << tileFile;
+  }
+  ++stats_.tilesLoaded;
+  return tiles_.emplace(key, std::move(tile)).first->second;
+}
+
+void CostCacheDatabase::evictTileIfNeeded() {
+  if (tiles_.size() < kMaxLoadedTiles) {
+    return;
+  }
+  // The costs are written through, so evicting only releases memory.
+  auto oldest = tiles_.begin();
+  for (auto it = tiles_.begin(); it != tiles_.end(); ++it) {
+    if (it->second.lastUse < oldest->second.lastUse) {
+      oldest = it;
+    }
+  }
+  close(oldest->second.fd);
+  tiles_.erase(oldest);
+}
+
+void CostCacheDatabase::checkRange(int quId, int refId) const {
+  CHECK(quId >= 0 && quId < (int)quFeaturesNames_.size())
+      << "Query feature " << quId << " is out of range";
+  CHECK(refId >= 0 && refId < (int)refFeaturesNames_.size())
+      << "Reference feature " << refId << " is out of range";
+}
+
+std::optional<double> CostCacheDatabase::findCachedCost(int quId, int refId) {
+  const Tile &tile = getTile(quId / tileSize_, refId / tileSize_);
+  const size_t cell = (quId % tileSize_) * tileSize_ + refId % tileSize_;
+  if (isEmptyCell(tile.costs[cell])) {
+    return std::nullopt;
+  }
+  ++stats_.hits;
+  return tile.costs[cell];
+}
+
+void CostCacheDatabase::storeCost(int quId, int refId, double cost) {
+  Tile &tile = getTile(quId / tileSize_, refId / tileSize_);
+  const size_t cell = (quId % tileSize_) * tileSize_ + refId % tileSize_;
+  tile.costs[cell] = cost;
+  const off_t offset = sizeof(TileHeader) + cell * sizeof(double);
+  LOG_IF(FATAL, pwrite(tile.fd, &cost, sizeof(cost), offset) != sizeof(cost))
+      << "Failed to write to the cost cache " << cacheDir_;
+  ++stats_.computed;
+}
+
+double CostCacheDatabase::getCost(int quId, int refId) {
+  checkRange(quId, refId);
+  if (const std::optional<double> cached = findCachedCost(quId, refId)) {
+    return *cached;
+  }
+  const double cost = computeMatchingCost(quId, refId);
+  storeCost(quId, refId, cost);
+  return cost;
+}
+
+std::vector<double>
+CostCacheDatabase::getCosts(int quId, const std::vector<int> &refIds) {
+  std::vector<double> costs(refIds.size());
+  std::vector<int> missing;
+  std::vector<size_t> missingPositions;
+  for (size_t idx = 0; idx < refIds.size(); ++idx) {
+    checkRange(quId, refIds[idx]);
+    if (const std::optional<double> cached =
+            findCachedCost(quId, refIds[idx])) {
+      costs[idx] = *cached;
+    } else {
+      missing.push_back(refIds[idx]);
+      missingPositions.push_back(idx);
+    }
+  }
+  if (missing.empty()) {
+    return costs;
+  }
+  const std::vector<double> computed = computeMatchingCosts(quId, missing);
+  for (size_t idx = 0; idx < missing.size(); ++idx) {
+    costs[missingPositions[idx]] = computed[idx];
+    storeCost(quId, missing[idx], computed[idx]);
+  }
+  return costs;
+}
+
+} // namespace localization::database
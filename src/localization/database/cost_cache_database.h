@@ -0,0 +1,103 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_COST_CACHE_DATABASE_H_
+#define SRC_DATABASE_COST_CACHE_DATABASE_H_
+
+#include "database/online_database.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace localization::database {
+
+/**
+ * @brief      Database that computes the matching costs from features on first
+ * access, like OnlineDatabase, and persists every computed cost in an on-disk
+ * cache. Later runs on the same query and reference features, e.g. parameter
+ * sweeps, read the costs from the cache instead of recomputing them.
+ *
+ * The cache is a directory with one file per square tile of the cost matrix
+ * and a `cache.meta` file. The meta file binds the cache to the feature type
+ * and to the content fingerprints of the query and reference features. If the
+ * features changed, the cache is cleared. Features appended at the end of a
+ * sequence keep the already cached costs valid.
+ */
+class CostCacheDatabase : public OnlineDatabase {
+public:
+  struct CacheStats {
+    int64_t hits = 0;
+    int64_t computed = 0;
+    int64_t tilesLoaded = 0;
+  };
+
+  CostCacheDatabase(const std::string &queryFeaturesDir,
+                    const std::string &refFeaturesDir,
+                    features::FeatureType type, int bufferSize,
+                    const std::string &cacheDir, int tileSize = 64);
+  ~CostCacheDatabase() override;
+
+  double getCost(int quId, int refId) override;
+  std::vector<double> getCosts(int quId,
+                               const std::vector<int> &refIds) override;
+  void appendReferenceFeatures(
+      const std::vector<std::string> &featureFiles) override;
+  void setFeatureProjection(
+      std::shared_ptr<const features::Projection> projection) override;
+
+  const CacheStats &cacheStats() const { return stats_; }
+
+private:
+  struct Tile {
+    std::vector<double> costs;
+    int fd = -1;
+    int64_t lastUse = 0;
+  };
+
+  void openCache();
+  void writeCurrentMeta() const;
+  Tile &getTile(int tileRow, int tileCol);
+  void evictTileIfNeeded();
+  void checkRange(int quId, int refId) const;
+  // Returns the cached cost, counts a hit.
+  std::optional<double> findCachedCost(int quId, int refId);
+  // Caches a computed cost and writes it through to the tile file.
+  void storeCost(int quId, int refId, double cost);
+
+  std::string cacheDir_;
+  int tileSize_ = 0;
+  uint64_t queryFingerprint_ = 0;
+  uint64_t refFingerprint_ = 0;
+  // Empty if the reference features come from a feature store.
+  std::vector<uint64_t> refFileFingerprints_;
+  std::unordered_map<int64_t, Tile> tiles_;
+  int64_t useCounter_ = 0;
+  CacheStats stats_;
+};
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_COST_CACHE_DATABASE_H_
@@ -0,0 +1,133 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/feature_prefetcher.h"
+
+#include <glog/logging.h>
+
+namespace localization::database {
+
+FeaturePrefetcher::FeaturePrefetcher(FeatureLoader loader, int maxLoaded)
+    : loader_{std::move(loader)}, maxLoaded_{maxLoaded} {
+  CHECK(loader_) << "Feature loader is not set.";
+  CHECK(maxLoaded_ > 0) << "Invalid number of prefetched features "
+                        << maxLoaded;
+  worker_ = std::thread(&FeaturePrefetcher::run, this);
+}
+
+FeaturePrefetcher::~FeaturePrefetcher() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeWorker_.notify_all();
+  worker_.join();
+}
+
+void FeaturePrefetcher::request(int begin, int end,
+                                const std::function<bool(int)> &skip) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.clear();
+    pendingIds_.clear();
+    for (auto iter = loaded_.begin(); iter != loaded_.end();) {
+      if (iter->first < begin || iter->first >= end) {
+        iter = loaded_.erase(iter);
+        ++stats_.dropped;
+      } else {
+        ++iter;
+      }
+    }
+    for (int id = begin; id < end; ++id) {
+      if (id == inFlight_ || loaded_.count(id) > 0 || (skip && skip(id))) {
+        continue;
+      }
+      pending_.push_back(id);
+      pendingIds_.insert(id);
+    }
+  }
+  wakeWorker_.notify_one();
+}
+
+std::unique_ptr<features::iFeature> FeaturePrefetcher::take(int id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (pendingIds_.erase(id) > 0) {
+    // Still queued, it is faster to load it right away on the caller thread.
+    return nullptr;
+  }
+  featureLoaded_.wait(lock, [&] { return inFlight_ != id; });
+  auto iter = loaded_.find(id);
+  if (iter == loaded_.end()) {
+    return nullptr;
+  }
+  std::unique_ptr<features::iFeature> feature = std::move(iter->second);
+  loaded_.erase(iter);
+  ++stats_.used;
+  lock.unlock();
+  // Frees a slot for the worker.
+  wakeWorker_.notify_one();
+  return feature;
+}
+
+void FeaturePrefetcher::waitUntilIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  featureLoaded_.wait(lock, [&] {
+    return inFlight_ == -1 &&
+           (pendingIds_.empty() ||
+            static_cast<int>(loaded_.size()) >= maxLoaded_);
+  });
+}
+
+FeaturePrefetcher::Stats FeaturePrefetcher::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void FeaturePrefetcher::run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    wakeWorker_.wait(lock, [&] {
+      return stop_ || (!pending_.empty() &&
+                       static_cast<int>(loaded_.size()) < maxLoaded_);
+    });
+    if (stop_) {
+      return;
+    }
+    const int id = pending_.front();
+    pending_.pop_front();
+    if (pendingIds_.erase(id) == 0) {
+      // Taken by the owner in the meantime.
+      continue;
+    }
+    inFlight_ = id;
+    lock.unlock();
+    std::unique_ptr<features::iFeature> feature = loader_(id);
+    lock.lock();
+    inFlight_ = -1;
+    loaded_[id] = std::move(feature);
+    ++stats_.loaded;
+    featureLoaded_.notify_all();
+  }
+}
+
+} // namespace localization::database
@@ -0,0 +1,104 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_FEATURE_PREFETCHER_H_
+#define SRC_DATABASE_FEATURE_PREFETCHER_H_
+
+#include "features/ifeature.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace localization::database {
+
+/**
+ * @brief      Loads features on a background thread before they are needed.
+ * The owner requests a range of feature ids it expects to use soon and later
+ * takes the loaded features out of the prefetcher instead of loading them on
+ * the calling thread. Only the prefetcher itself is thread-safe, the loaded
+ * features are handed over and never shared.
+ */
+class FeaturePrefetcher {
+public:
+  using FeatureLoader =
+      std::function<std::unique_ptr<features::iFeature>(int id)>;
+
+  struct Stats {
+    int loaded = 0;
+    int used = 0;
+    int dropped = 0;
+  };
+
+  /** The loader must be safe to call from another thread. At most
+   * maxLoaded features are kept waiting to be taken. */
+  FeaturePrefetcher(FeatureLoader loader, int maxLoaded);
+  ~FeaturePrefetcher();
+  FeaturePrefetcher(const FeaturePrefetcher &) = delete;
+  FeaturePrefetcher &operator=(const FeaturePrefetcher &) = delete;
+
+  /**
+   * @brief      Replaces the pending requests by the ids in [begin, end).
+   * Features loaded before that are outside of the range are dropped.
+   */
+  void request(int begin, int end, const std::function<bool(int)> &skip);
+
+  /**
+   * @brief      Hands over the feature if it was prefetched. Waits if the
+   * feature is being loaded right now. Returns nullptr if the feature was not
+   * requested, the caller has to load it itself.
+   */
+  std::unique_ptr<features::iFeature> take(int id);
+
+  /** Blocks until every requested feature is loaded, or until maxLoaded
+   * features wait to be taken. */
+  void waitUntilIdle();
+
+  Stats stats() const;
+
+private:
+  void run();
+
+  FeatureLoader loader_;
+  int maxLoaded_ = 0;
+
+  mutable std::mutex mutex_;
+  std::condition_variable wakeWorker_;
+  std::condition_variable featureLoaded_;
+  std::deque<int> pending_;
+  std::unordered_set<int> pendingIds_;
+  int inFlight_ = -1;
+  std::unordered_map<int, std::unique_ptr<features::iFeature>> loaded_;
+  Stats stats_;
+  bool stop_ = false;
+  std::thread worker_;
+};
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_FEATURE_PREFETCHER_H_
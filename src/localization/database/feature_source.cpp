@@ -0,0 +1,113 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/feature_source.h"
+#include "database/list_dir.h"
+#include "features/stored_feature.h"
+
+#include <glog/logging.h>
+
+namespace localization::database {
+
+std::shared_ptr<const features::FeatureStore>
+openFeatureStoreIfNeeded(const std::string &features) {
+  if (!features::isFeatureStoreFile(features)) {
+    return nullptr;
+  }
+  return features::FeatureStore::open(features);
+}
+
+std::vector<std::string>
+listFeatureNames(const std::string &features,
+                 const features::FeatureStore *store) {
+  if (!store) {
+    return listProtoDir(features, ".Feature");
+  }
+  std::vector<std::string> names;
+  names.reserve(store->size());
+  for (int idx = 0; idx < store->size(); ++idx) {
+    names.emplace_back(store->name(idx));
+  }
+  return names;
+}
+
+FeatureSource openFeatureSource(const std::string &features) {
+  FeatureSource source;
+  source.store = openFeatureStoreIfNeeded(features);
+  source.names = listFeatureNames(features, source.store.get());
+  return source;
+}
+
+FeatureSource sliceFeatureSource(const FeatureSource &source, int begin,
+                                 int end) {
+  CHECK(begin >= 0 && begin <= end && end <= (int)source.names.size())
+      << "Invalid features [" << begin << ", " << end << ") of "
+      << source.names.size();
+  FeatureSource slice;
+  if (source.store) {
+    slice.store =
+        features::FeatureStore::open(source.store->filename(), begin, end);
+  }
+  slice.names.assign(source.names.begin() + begin, source.names.begin() + end);
+  return slice;
+}
+
+std::unique_ptr<features::iFeature>
+loadFeature(const std::vector<std::string> &featureNames,
+            const std::shared_ptr<const features::FeatureStore> &store,
+            features::FeatureType type, int featureId,
+            const features::Projection *projection) {
+  if (store) {
+    CHECK(type == features::Cnn_Feature)
+        << "Feature stores hold float features, other feature types are "
+           "computed from .Feature.pb files.";
+    // Stored features only view the mapped rows, nothing is parsed.
+    return std::make_unique<features::StoredFeature>(store, featureId);
+  }
+  return createFeature(type, featureNames[featureId], projection);
+}
+
+features::MatchingCostFunction
+matchingCostFunction(features::FeatureType type,
+                     const features::FeatureStore *queryStore,
+                     const features::FeatureStore *refStore) {
+  if ((queryStore == nullptr) != (refStore == nullptr)) {
+    // Stored and parsed features are not comparable, the virtual methods
+    // report it.
+    return features::dynamicMatchingCost;
+  }
+  return features::matchingCostFunction(type, /*stored=*/queryStore != nullptr);
+}
+
+features::MatchingCostsFunction
+matchingCostsFunction(features::FeatureType type,
+                      const features::FeatureStore *queryStore,
+                      const features::FeatureStore *refStore) {
+  if ((queryStore == nullptr) != (refStore == nullptr)) {
+    return features::dynamicMatchingCosts;
+  }
+  return features::matchingCostsFunction(type,
+                                         /*stored=*/queryStore != nullptr);
+}
+
+} // namespace localization::database
@@ -0,0 +1,81 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_FEATURE_SOURCE_H_
+#define SRC_DATABASE_FEATURE_SOURCE_H_
+
+#include "features/feature_factory.h"
+#include "features/feature_store.h"
+#include "features/feature_traits.h"
+#include "features/ifeature.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::database {
+
+/** Features of a sequence are either a directory of `.Feature.pb` files or a
+ * packed feature store. Returns the store for the latter, nullptr otherwise.
+ **/
+std::shared_ptr<const features::FeatureStore>
+openFeatureStoreIfNeeded(const std::string &features);
+
+/** Feature files of a directory, or the names of the features in a store. **/
+std::vector<std::string>
+listFeatureNames(const std::string &features,
+                 const features::FeatureStore *store);
+
+/** Opened features of a sequence: the store, if any, and the names. **/
+struct FeatureSource {
+  std::shared_ptr<const features::FeatureStore> store;
+  std::vector<std::string> names;
+};
+FeatureSource openFeatureSource(const std::string &features);
+/** The features [begin, end) of an opened sequence. Only their names are
+ * copied, a store is mapped again with just these rows. **/
+FeatureSource sliceFeatureSource(const FeatureSource &source, int begin,
+                                 int end);
+
+/** Loads one feature, safe to call from several threads at once. The
+ * optional projection is applied to features loaded from files. **/
+std::unique_ptr<features::iFeature>
+loadFeature(const std::vector<std::string> &featureNames,
+            const std::shared_ptr<const features::FeatureStore> &store,
+            features::FeatureType type, int featureId,
+            const features::Projection *projection = nullptr);
+
+/** Statically dispatched cost function for the features loadFeature()
+ * returns for the query and the reference. **/
+features::MatchingCostFunction
+matchingCostFunction(features::FeatureType type,
+                     const features::FeatureStore *queryStore,
+                     const features::FeatureStore *refStore);
+features::MatchingCostsFunction
+matchingCostsFunction(features::FeatureType type,
+                      const features::FeatureStore *queryStore,
+                      const features::FeatureStore *refStore);
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_FEATURE_SOURCE_H_
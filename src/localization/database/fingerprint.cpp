@@ -0,0 +1,117 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/fingerprint.h"
+#include "database/list_dir.h"
+#include "features/feature_store.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+namespace localization::database {
+
+void Fingerprint::update(const void *data, size_t size) {
+  constexpr uint64_t kPrime = 1099511628211ULL;
+  const auto *bytes = static_cast<const unsigned char *>(data);
+  for (size_t idx = 0; idx < size; ++idx) {
+    value_ ^= bytes[idx];
+    value_ *= kPrime;
+  }
+}
+
+uint64_t fingerprintFile(const std::string &filename) {
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  LOG_IF(FATAL, !in) << "The file cannot be opened " << filename;
+  Fingerprint fingerprint;
+  fingerprint.update(std::filesystem::path(filename).filename().string());
+  char buffer[1 << 16];
+  while (in) {
+    in.read(buffer, sizeof(buffer));
+    fingerprint.update(buffer, in.gcount());
+  }
+  return fingerprint.value();
+}
+
+std::vector<uint64_t>
+fingerprintEachFile(const std::vector<std::string> &filenames,
+                    int numThreads) {
+  std::vector<uint64_t> fileFingerprints(filenames.size());
+  tools::parallelFor(
+      0, filenames.size(),
+      [&](int idx) { fileFingerprints[idx] = fingerprintFile(filenames[idx]); },
+      numThreads);
+  return fileFingerprints;
+}
+
+uint64_t combineFingerprints(const std::vector<uint64_t> &fingerprints) {
+  Fingerprint fingerprint;
+  fingerprint.update(static_cast<uint64_t>(fingerprints.size()));
+  for (uint64_t value : fingerprints) {
+    fingerprint.update(value);
+  }
+  return fingerprint.value();
+}
+
+uint64_t fingerprintFiles(const std::vector<std::string> &filenames,
+                          int numThreads) {
+  return combineFingerprints(fingerprintEachFile(filenames, numThreads));
+}
+
+uint64_t fingerprintStore(const features::FeatureStore &store, int count,
+                          int numThreads) {
+  CHECK(count >= 0 && count <= store.size())
+      << "Cannot fingerprint " << count << " features of a store with "
+      << store.size() << " features";
+  std::vector<uint64_t> rowFingerprints(count);
+  tools::parallelFor(
+      0, count,
+      [&](int idx) {
+        Fingerprint fingerprint;
+        fingerprint.update(std::string(store.name(idx)));
+        fingerprint.update(store.row(idx), store.dim() * sizeof(float));
+        rowFingerprints[idx] = fingerprint.value();
+      },
+      numThreads);
+  return combineFingerprints(rowFingerprints);
+}
+
+uint64_t fingerprintFeatures(const std::string &features, int numThreads) {
+  if (features::isFeatureStoreFile(features)) {
+    const auto store = features::FeatureStore::open(features);
+    return fingerprintStore(*store, store->size(), numThreads);
+  }
+  return fingerprintFiles(listProtoDir(features, ".Feature"), numThreads);
+}
+
+std::string toHexString(uint64_t fingerprint) {
+  std::ostringstream out;
+  out << std::hex << std::setw(16) << std::setfill('0') << fingerprint;
+  return out.str();
+}
+
+} // namespace localization::database
@@ -0,0 +1,87 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_FINGERPRINT_H_
+#define SRC_DATABASE_FINGERPRINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+class FeatureStore;
+} // namespace localization::features
+
+namespace localization::database {
+
+/**
+ * @brief      Incremental 64-bit FNV-1a hash. Not cryptographic, only meant to
+ * detect that cached data was produced from different inputs.
+ */
+class Fingerprint {
+public:
+  void update(const void *data, size_t size);
+  void update(const std::string &value) { update(value.data(), value.size()); }
+  void update(uint64_t value) { update(&value, sizeof(value)); }
+  uint64_t value() const { return value_; }
+
+private:
+  uint64_t value_ = 14695981039346656037ULL;
+};
+
+/** Hashes the file name (without the directory) and the content of a file. **/
+uint64_t fingerprintFile(const std::string &filename);
+
+/**
+ * @brief      Hashes the ordered list of feature files, including their
+ * contents. Renaming, reordering or modifying any of the files changes the
+ * fingerprint, moving the whole directory does not.
+ */
+uint64_t fingerprintFiles(const std::vector<std::string> &filenames,
+                          int numThreads = 0);
+
+/** The per-file fingerprints that fingerprintFiles combines. Keeping them
+ * allows to fingerprint a growing list of files without rehashing it. **/
+std::vector<uint64_t>
+fingerprintEachFile(const std::vector<std::string> &filenames,
+                    int numThreads = 0);
+uint64_t combineFingerprints(const std::vector<uint64_t> &fingerprints);
+
+/**
+ * @brief      Hashes the names and values of the first `count` features of a
+ * packed feature store, like fingerprintFiles does for separate files.
+ */
+uint64_t fingerprintStore(const features::FeatureStore &store, int count,
+                          int numThreads = 0);
+
+/** Fingerprints a whole feature sequence, a directory of `.Feature.pb` files
+ * or a feature store. **/
+uint64_t fingerprintFeatures(const std::string &features, int numThreads = 0);
+
+/** Formats a fingerprint as a fixed-width hex string. **/
+std::string toHexString(uint64_t fingerprint);
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_FINGERPRINT_H_
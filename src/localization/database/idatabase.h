@@ -24,6 +24,8 @@
 #ifndef SRC_DATABASE_IDATABASE_H_
 #define SRC_DATABASE_IDATABASE_H_
 
+#include <vector>
+
 namespace localization::database {
 
 /**
@@ -42,6 +44,25 @@ public:
    * @return     The cost.
    */
   virtual double getCost(int quId, int refId) = 0;
+  /**
+   * @brief      Gets the costs of one query to several references, e.g. all
+   * successors of a node. Databases that compute costs from features score
+   * the missing ones in one batch.
+   */
+  virtual std::vector<double> getCosts(int quId,
+                                       const std::vector<int> &refIds) {
+    std::vector<double> costs;
+    costs.reserve(refIds.size());
+    for (int refId : refIds) {
+      costs.push_back(getCost(quId, refId));
+    }
+    return costs;
+  }
+  /**
+   * @brief      Whether refSize() and getCost() may be called from several
+   * threads at once, e.g. by localizers sharing one loaded database.
+   */
+  virtual bool isThreadSafe() const { return false; }
 
   iDatabase() = default;
   iDatabase(const iDatabase &) = delete;
@@ -82,4 +82,22 @@ std::vector<std::string> listProtoDir(const std::string &pathToDir,
   std::sort(proto_files.begin(), proto_files.end());
   return proto_files;
 }
-} // namespace localization::database
\ No newline at end of file
+
+std::vector<std::string> listImageDir(const std::string &pathToDir) {
+  if (!fs::exists(pathToDir)) {
+    LOG(FATAL) << "Image directory does not exist: " << pathToDir;
+  }
+  std::vector<std::string> image_files;
+  for (const auto &entry : fs::directory_iterator(pathToDir)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    const std::string extension = entry.path().extension().string();
+    if (extension == ".jpg" || extension == ".jpeg" || extension == ".png") {
+      image_files.push_back(entry.path().string());
+    }
+  }
+  std::sort(image_files.begin(), image_files.end());
+  return image_files;
+}
+} // namespace localization::database
@@ -34,6 +34,9 @@ std::vector<std::string> listDir(const std::string &dir_name);
 std::vector<std::string> listProtoDir(const std::string &pathToDir,
                                       const std::string &protoExtension);
 
+/** Sorted .jpg, .jpeg and .png files of a directory. **/
+std::vector<std::string> listImageDir(const std::string &pathToDir);
+
 } // namespace localization::database
 
 #endif // SRC_DATABASE_LIST_DIR_H_
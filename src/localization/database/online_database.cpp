@@ -24,13 +24,17 @@
 /* Updated by O. Vysotska in 2022 */
 
 #include "database/online_database.h"
-#include "database/list_dir.h"
+#include "database/feature_prefetcher.h"
+#include "database/feature_source.h"
 #include "features/feature_buffer.h"
+#include "features/feature_store.h"
 #include "features/ifeature.h"
 #include "similarity_matrix.h"
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <limits>
 #include <memory>
@@ -42,12 +46,20 @@ namespace {
 const features::iFeature &
 addFeatureIfNeeded(features::FeatureBuffer &featureBuffer,
                    const std::vector<std::string> &featureNames,
-                   features::FeatureType type, int featureId) {
-  if (featureBuffer.inBuffer(featureId)) {
-    return featureBuffer.getFeature(featureId);
+                   const std::shared_ptr<const features::FeatureStore> &store,
+                   features::FeatureType type,
+                   const features::Projection *projection, int featureId,
+                   FeaturePrefetcher *prefetcher = nullptr) {
+  const features::iFeature *feature = featureBuffer.findFeature(featureId);
+  if (feature) {
+    return *feature;
   }
-  featureBuffer.addFeature(featureId,
-                           createFeature(type, featureNames[featureId]));
+  std::unique_ptr<features::iFeature> loaded =
+      prefetcher ? prefetcher->take(featureId) : nullptr;
+  if (!loaded) {
+    loaded = loadFeature(featureNames, store, type, featureId, projection);
+  }
+  featureBuffer.addFeature(featureId, std::move(loaded));
   return featureBuffer.getFeature(featureId);
 }
 } // namespace
@@ -56,13 +68,37 @@ OnlineDatabase::OnlineDatabase(const std::string &queryFeaturesDir,
                                const std::string &refFeaturesDir,
                                features::FeatureType type, int bufferSize,
                                const std::string &similarityMatrixFile)
-    : quFeaturesNames_{listProtoDir(queryFeaturesDir, ".Feature")},
-      refFeaturesNames_{listProtoDir(refFeaturesDir, ".Feature")},
-      featureType_{type}, refBuffer_{std::make_unique<features::FeatureBuffer>(
-                              bufferSize)},
+    : OnlineDatabase(openFeatureSource(queryFeaturesDir),
+                     openFeatureSource(refFeaturesDir), type, bufferSize,
+                     similarityMatrixFile) {}
+
+OnlineDatabase::OnlineDatabase(
+    std::shared_ptr<const features::FeatureStore> queryStore,
+    std::shared_ptr<const features::FeatureStore> refStore, int bufferSize)
+    : OnlineDatabase(
+          FeatureSource{queryStore, listFeatureNames("", queryStore.get())},
+          FeatureSource{refStore, listFeatureNames("", refStore.get())},
+          features::Cnn_Feature, bufferSize) {}
+
+OnlineDatabase::OnlineDatabase(FeatureSource query, FeatureSource reference,
+                               features::FeatureType type, int bufferSize,
+                               const std::string &similarityMatrixFile)
+    : quFeaturesNames_{std::move(query.names)},
+      refFeaturesNames_{std::move(reference.names)}, featureType_{type},
+      queryStore_{std::move(query.store)},
+      refStore_{std::move(reference.store)},
+      refBuffer_{std::make_unique<features::FeatureBuffer>(bufferSize)},
       queryBuffer_{std::make_unique<features::FeatureBuffer>(bufferSize)} {
+  LOG_IF(FATAL,
+         (queryStore_ || refStore_) && featureType_ != features::Cnn_Feature)
+      << "Feature stores hold float features, other feature types are "
+         "computed from .Feature.pb files.";
   LOG_IF(FATAL, quFeaturesNames_.empty()) << "Query features are not set.";
   LOG_IF(FATAL, refFeaturesNames_.empty()) << "Reference features are not set.";
+  matchingCost_ =
+      matchingCostFunction(featureType_, queryStore_.get(), refStore_.get());
+  matchingCosts_ =
+      matchingCostsFunction(featureType_, queryStore_.get(), refStore_.get());
   if (!similarityMatrixFile.empty()) {
     precomputedScores_ = SimilarityMatrix(similarityMatrixFile);
   }
@@ -74,12 +110,64 @@ double OnlineDatabase::computeMatchingCost(int quId, int refId) {
   CHECK(refId >= 0 && refId < (int)refFeaturesNames_.size())
       << "Reference feature " << refId << " is out of range";
 
-  const auto &quFeature =
-      addFeatureIfNeeded(*queryBuffer_, quFeaturesNames_, featureType_, quId);
+  if (refPrefetcher_) {
+    predictNextFeatures(quId, refId);
+  }
+  const auto &quFeature = pinnedQueryFeature(quId);
   const auto &refFeature =
-      addFeatureIfNeeded(*refBuffer_, refFeaturesNames_, featureType_, refId);
+      addFeatureIfNeeded(*refBuffer_, refFeaturesNames_, refStore_,
+                         featureType_, projection_.get(), refId,
+                         refPrefetcher_.get());
 
-  return quFeature.score2cost(quFeature.computeSimilarityScore(refFeature));
+  return matchingCost_(quFeature, refFeature);
+}
+
+std::vector<double>
+OnlineDatabase::computeMatchingCosts(int quId, const std::vector<int> &refIds) {
+  CHECK(quId >= 0 && quId < (int)quFeaturesNames_.size())
+      << "Query feature " << quId << " is out of range";
+  for (int refId : refIds) {
+    CHECK(refId >= 0 && refId < (int)refFeaturesNames_.size())
+        << "Reference feature " << refId << " is out of range";
+    if (refPrefetcher_) {
+      predictNextFeatures(quId, refId);
+    }
+  }
+  const auto &quFeature = pinnedQueryFeature(quId);
+  // The references of the batch stay pinned until they are scored, loading
+  // one of them must not evict another.
+  std::vector<const features::iFeature *> refFeatures;
+  refFeatures.reserve(refIds.size());
+  for (int refId : refIds) {
+    refFeatures.push_back(&addFeatureIfNeeded(
+        *refBuffer_, refFeaturesNames_, refStore_, featureType_,
+        projection_.get(), refId, refPrefetcher_.get()));
+    refBuffer_->pin(refId);
+  }
+  std::vector<double> costs(refIds.size());
+  matchingCosts_(quFeature, refFeatures.data(), refFeatures.size(),
+                 costs.data());
+  for (int refId : refIds) {
+    refBuffer_->unpin(refId);
+  }
+  return costs;
+}
+
+const features::iFeature &OnlineDatabase::pinnedQueryFeature(int quId) {
+  const auto &quFeature =
+      addFeatureIfNeeded(*queryBuffer_, quFeaturesNames_, queryStore_,
+                         featureType_, projection_.get(), quId,
+                         queryPrefetcher_.get());
+  // The current query is compared against many references in a row, keep it
+  // in the buffer until the search moves on to the next query.
+  if (quId != pinnedQueryId_) {
+    if (pinnedQueryId_ >= 0) {
+      queryBuffer_->unpin(pinnedQueryId_);
+    }
+    queryBuffer_->pin(quId);
+    pinnedQueryId_ = quId;
+  }
+  return quFeature;
 }
 
 double OnlineDatabase::getCost(int quId, int refId) {
@@ -99,8 +187,135 @@ double OnlineDatabase::getCost(int quId, int refId) {
   return cost;
 }
 
+std::vector<double> OnlineDatabase::getCosts(int quId,
+                                             const std::vector<int> &refIds) {
+  if (precomputedScores_) {
+    return iDatabase::getCosts(quId, refIds);
+  }
+  std::vector<double> costs(refIds.size());
+  std::vector<int> missing;
+  std::vector<size_t> missingPositions;
+  const auto rowIter = costs_.find(quId);
+  for (size_t idx = 0; idx < refIds.size(); ++idx) {
+    if (rowIter != costs_.end()) {
+      const auto elementIter = rowIter->second.find(refIds[idx]);
+      if (elementIter != rowIter->second.end()) {
+        costs[idx] = elementIter->second;
+        continue;
+      }
+    }
+    missing.push_back(refIds[idx]);
+    missingPositions.push_back(idx);
+  }
+  if (missing.empty()) {
+    return costs;
+  }
+  const std::vector<double> computed = computeMatchingCosts(quId, missing);
+  auto &row = costs_[quId];
+  for (size_t idx = 0; idx < missing.size(); ++idx) {
+    costs[missingPositions[idx]] = computed[idx];
+    row[missing[idx]] = computed[idx];
+  }
+  return costs;
+}
+
+void OnlineDatabase::setFeatureProjection(
+    std::shared_ptr<const features::Projection> projection) {
+  LOG_IF(FATAL, queryStore_ || refStore_)
+      << "Features from a feature store are projected when the store is "
+         "written.";
+  LOG_IF(FATAL, precomputedScores_)
+      << "A precomputed similarity matrix cannot be projected.";
+  CHECK(costs_.empty() && queryBuffer_->size() == 0 &&
+        refBuffer_->size() == 0 && !queryPrefetcher_)
+      << "Set the projection before computing any costs.";
+  projection_ = std::move(projection);
+}
+
+void OnlineDatabase::setBufferByteBudget(size_t byteBudget) {
+  queryBuffer_->setByteBudget(byteBudget);
+  refBuffer_->setByteBudget(byteBudget);
+}
+
+void OnlineDatabase::enablePrefetching(int lookahead) {
+  CHECK(lookahead > 0) << "Invalid prefetching lookahead " << lookahead;
+  prefetchLookahead_ = lookahead;
+  queryPrefetcher_ = std::make_unique<FeaturePrefetcher>(
+      [this](int id) {
+        return loadFeature(quFeaturesNames_, queryStore_, featureType_, id,
+                           projection_.get());
+      },
+      /*maxLoaded=*/lookahead);
+  refPrefetcher_ = makeRefPrefetcher();
+}
+
+std::unique_ptr<FeaturePrefetcher> OnlineDatabase::makeRefPrefetcher() {
+  return std::make_unique<FeaturePrefetcher>(
+      [this](int id) {
+        return loadFeature(refFeaturesNames_, refStore_, featureType_, id,
+                           projection_.get());
+      },
+      /*maxLoaded=*/std::max(refBuffer_->bufferSize, 1));
+}
+
+void OnlineDatabase::appendReferenceFeatures(
+    const std::vector<std::string> &featureFiles) {
+  LOG_IF(FATAL, refStore_)
+      << "Reference features from a feature store cannot be extended.";
+  LOG_IF(FATAL, precomputedScores_)
+      << "A precomputed similarity matrix cannot be extended.";
+  // The prefetcher thread reads the reference names, stop it while they
+  // change.
+  const bool prefetching = refPrefetcher_ != nullptr;
+  refPrefetcher_.reset();
+  refFeaturesNames_.insert(refFeaturesNames_.end(), featureFiles.begin(),
+                           featureFiles.end());
+  if (prefetching) {
+    refPrefetcher_ = makeRefPrefetcher();
+  }
+  LOG(INFO) << "Appended " << featureFiles.size()
+            << " reference features, the reference has "
+            << refFeaturesNames_.size() << " features now.";
+}
+
+void OnlineDatabase::predictNextFeatures(int quId, int refId) {
+  if (quId == trackedQueryId_) {
+    rowRefMin_ = std::min(rowRefMin_, refId);
+    rowRefMax_ = std::max(rowRefMax_, refId);
+    return;
+  }
+  // The search moved on to a new query. The references the previous query
+  // was matched against tell where the path is, the next queries follow it
+  // with about the same speed.
+  if (trackedQueryId_ >= 0) {
+    const double rowCenter = 0.5 * (rowRefMin_ + rowRefMax_);
+    int step = 1;
+    if (lastRowCenter_ >= 0.0) {
+      step = std::max(1, static_cast<int>(std::lround(rowCenter -
+                                                      lastRowCenter_)));
+    }
+    lastRowCenter_ = rowCenter;
+    const int begin = rowRefMin_;
+    const int end =
+        std::min(refSize(), rowRefMax_ + 1 + prefetchLookahead_ * step);
+    // A wide range means the search is not following a single path, e.g.
+    // after relocalization. There is no motion prior to exploit then.
+    if (end - begin <= refBuffer_->bufferSize) {
+      refPrefetcher_->request(
+          begin, end, [this](int id) { return refBuffer_->inBuffer(id); });
+    }
+  }
+  const int querySize = quFeaturesNames_.size();
+  queryPrefetcher_->request(
+      quId + 1, std::min(querySize, quId + 1 + prefetchLookahead_),
+      [this](int id) { return queryBuffer_->inBuffer(id); });
+  trackedQueryId_ = quId;
+  rowRefMin_ = refId;
+  rowRefMax_ = refId;
+}
+
 const features::iFeature &OnlineDatabase::getQueryFeature(int quId) {
-  return addFeatureIfNeeded(*queryBuffer_, quFeaturesNames_, featureType_,
-                            quId);
+  return addFeatureIfNeeded(*queryBuffer_, quFeaturesNames_, queryStore_,
+                            featureType_, projection_.get(), quId);
 }
 } // namespace localization::database
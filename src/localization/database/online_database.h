@@ -27,9 +27,14 @@
 #define SRC_DATABASE_ONLINE_DATABASE_H_
 
 #include "database/similarity_matrix.h"
+#include "database/feature_prefetcher.h"
+#include "database/feature_source.h"
 #include "database/idatabase.h"
 #include "features/feature_buffer.h"
 #include "features/feature_factory.h"
+#include "features/feature_store.h"
+#include "features/feature_traits.h"
+#include "features/projection.h"
 
 #include <memory>
 #include <optional>
@@ -40,33 +45,115 @@
 namespace localization::database {
 /**
  * @brief      Database for loading and matching features. Caches the computed
- * matching costs.
+ * matching costs. The query and reference features are either directories of
+ * `.Feature.pb` files or packed feature stores (*.FeatureStore.bin).
  */
 class OnlineDatabase : public iDatabase {
 public:
   OnlineDatabase(const std::string &queryFeaturesDir,
                  const std::string &refFeaturesDir, features::FeatureType type,
                  int bufferSize, const std::string &similarityMatrixFile = "");
+  /**
+   * @brief      Database over feature stores that are already open, e.g.
+   * ones holding features computed in this process, see
+   * FeatureStore::fromValues().
+   */
+  OnlineDatabase(std::shared_ptr<const features::FeatureStore> queryStore,
+                 std::shared_ptr<const features::FeatureStore> refStore,
+                 int bufferSize);
+  /**
+   * @brief      Database over already opened feature sources, e.g. the slice
+   * of the reference a shard works on, see sliceFeatureSource().
+   */
+  OnlineDatabase(FeatureSource query, FeatureSource reference,
+                 features::FeatureType type, int bufferSize,
+                 const std::string &similarityMatrixFile = "");
 
   inline int refSize() override { return refFeaturesNames_.size(); }
+  int querySize() const { return quFeaturesNames_.size(); }
   double getCost(int quId, int refId) override;
+  std::vector<double> getCosts(int quId,
+                               const std::vector<int> &refIds) override;
 
   double computeMatchingCost(int quId, int refId);
+  // Scores the query against all the references in one batch.
+  std::vector<double> computeMatchingCosts(int quId,
+                                           const std::vector<int> &refIds);
 
   const features::iFeature &getQueryFeature(int quId);
 
+  /**
+   * @brief      Starts loading features in the background before the search
+   * needs them. The next `lookahead` query features are loaded, and the
+   * reference features along the path the search currently follows, extended
+   * by the reference frames the next `lookahead` queries are expected to
+   * reach.
+   */
+  void enablePrefetching(int lookahead);
+
+  /**
+   * @brief      Extends the reference by the given `.Feature.pb` files. They
+   * get the ids following the current reference features. The already
+   * computed costs stay valid. Not possible for references from feature
+   * stores or with a precomputed similarity matrix.
+   */
+  virtual void appendReferenceFeatures(
+      const std::vector<std::string> &featureFiles);
+
+  /**
+   * @brief      Projects every feature when it is loaded, so that all the
+   * comparisons run on the projected dimensions. Set it before the first
+   * cost is computed. Feature stores are projected when they are written
+   * instead.
+   */
+  virtual void
+  setFeatureProjection(std::shared_ptr<const features::Projection> projection);
+
+  // Limits the memory of each feature buffer, 0 removes the limit.
+  void setBufferByteBudget(size_t byteBudget);
+  const features::FeatureBufferStats &queryBufferStats() const {
+    return queryBuffer_->stats();
+  }
+  const features::FeatureBufferStats &refBufferStats() const {
+    return refBuffer_->stats();
+  }
+
 protected:
   std::vector<std::string> quFeaturesNames_;
   std::vector<std::string> refFeaturesNames_;
   // TODO(olga): Maybe temporary here.
   features::FeatureType featureType_{};
+  // Set if the features come from packed feature stores.
+  std::shared_ptr<const features::FeatureStore> queryStore_{};
+  std::shared_ptr<const features::FeatureStore> refStore_{};
+  std::shared_ptr<const features::Projection> projection_{};
+  // Chosen once for the feature type, see features/feature_traits.h.
+  features::MatchingCostFunction matchingCost_ = nullptr;
+  features::MatchingCostsFunction matchingCosts_ = nullptr;
 
 private:
+  // Loads the query feature and keeps it pinned while the search compares it
+  // against the references.
+  const features::iFeature &pinnedQueryFeature(int quId);
+  void predictNextFeatures(int quId, int refId);
+  std::unique_ptr<FeaturePrefetcher> makeRefPrefetcher();
+
   std::unique_ptr<features::FeatureBuffer> refBuffer_{};
   std::unique_ptr<features::FeatureBuffer> queryBuffer_{};
   std::unordered_map<int, std::unordered_map<int, double>> costs_;
+  int pinnedQueryId_ = -1;
 
   std::optional<SimilarityMatrix> precomputedScores_ = {};
+
+  int prefetchLookahead_ = 0;
+  int trackedQueryId_ = -1;
+  int rowRefMin_ = 0;
+  int rowRefMax_ = 0;
+  double lastRowCenter_ = -1.0;
+  // Declared last, the prefetchers' threads stop before the features they
+  // read are destroyed.
+  std::unique_ptr<FeaturePrefetcher> queryPrefetcher_{};
+  std::unique_ptr<FeaturePrefetcher> refPrefetcher_{};
 };
 } // namespace localization::database
 
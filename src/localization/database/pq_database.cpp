@@ -0,0 +1,127 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/pq_database.h"
+#include "database/feature_source.h"
+#include "features/feature_io.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace localization::database {
+
+namespace {
+double score2cost(double score) {
+  if (score < 1e-09) {
+    return std::numeric_limits<double>::max();
+  }
+  return 1. / score;
+}
+} // namespace
+
+PqDatabase::PqDatabase(const std::string &queryFeaturesDir,
+                       const std::string &refPqStoreFile, int bufferSize)
+    : queryStore_{openFeatureStoreIfNeeded(queryFeaturesDir)},
+      refStore_{features::PqStore::open(refPqStoreFile)},
+      bufferSize_{std::max(bufferSize, 1)} {
+  LOG_IF(FATAL, bufferSize < 0) << "Invalid featureBuffer size.";
+  quFeaturesNames_ = listFeatureNames(queryFeaturesDir, queryStore_.get());
+  LOG_IF(FATAL, quFeaturesNames_.empty()) << "Query features are not set.";
+  LOG_IF(FATAL, refStore_->size() == 0) << "Reference features are not set.";
+}
+
+const std::vector<float> &PqDatabase::queryTable(int quId) {
+  CHECK(quId >= 0 && quId < (int)quFeaturesNames_.size())
+      << "Query feature " << quId << " is out of range";
+  auto found = tables_.find(quId);
+  if (found != tables_.end()) {
+    tablesLru_.splice(tablesLru_.end(), tablesLru_, found->second.lruPos);
+    return found->second.values;
+  }
+  const features::PqCodebook &codebook = refStore_->codebook();
+  std::vector<float> query(codebook.dim());
+  double norm = 0.0;
+  if (queryStore_) {
+    CHECK(queryStore_->dim() == codebook.dim())
+        << "Query features have dimension " << queryStore_->dim()
+        << ", the reference codebook expects " << codebook.dim();
+    std::copy_n(queryStore_->row(quId), codebook.dim(), query.begin());
+    norm = queryStore_->norm(quId);
+  } else {
+    const std::vector<double> values =
+        features::readFeatureValues(quFeaturesNames_[quId]);
+    CHECK(static_cast<int>(values.size()) == codebook.dim())
+        << "Query features have dimension " << values.size()
+        << ", the reference codebook expects " << codebook.dim();
+    for (int d = 0; d < codebook.dim(); ++d) {
+      query[d] = values[d];
+      norm += values[d] * values[d];
+    }
+    norm = std::sqrt(norm);
+  }
+  // The codebook is trained on normalized features, the table entries then
+  // sum up to the cosine similarity.
+  if (norm > 0.0) {
+    for (float &value : query) {
+      value /= norm;
+    }
+  }
+
+  while (static_cast<int>(tables_.size()) >= bufferSize_) {
+    tables_.erase(tablesLru_.front());
+    tablesLru_.pop_front();
+  }
+  Table &table = tables_[quId];
+  table.values.resize(static_cast<size_t>(codebook.numSubspaces()) *
+                      codebook.numCentroids());
+  codebook.innerProductTable(query.data(), table.values.data());
+  table.lruPos = tablesLru_.insert(tablesLru_.end(), quId);
+  return table.values;
+}
+
+double PqDatabase::getCost(int quId, int refId) {
+  CHECK(refId >= 0 && refId < refStore_->size())
+      << "Reference feature " << refId << " is out of range";
+  const std::vector<float> &table = queryTable(quId);
+  return score2cost(
+      refStore_->codebook().score(table.data(), refStore_->code(refId)));
+}
+
+std::vector<double> PqDatabase::getCosts(int quId,
+                                         const std::vector<int> &refIds) {
+  const std::vector<float> &table = queryTable(quId);
+  std::vector<double> costs;
+  costs.reserve(refIds.size());
+  for (int refId : refIds) {
+    CHECK(refId >= 0 && refId < refStore_->size())
+        << "Reference feature " << refId << " is out of range";
+    costs.push_back(score2cost(
+        refStore_->codebook().score(table.data(), refStore_->code(refId))));
+  }
+  return costs;
+}
+
+} // namespace localization::database
@@ -0,0 +1,76 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_PQ_DATABASE_H_
+#define SRC_DATABASE_PQ_DATABASE_H_
+
+#include "database/idatabase.h"
+#include "features/feature_store.h"
+#include "features/pq_store.h"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace localization::database {
+
+/**
+ * @brief      Matches float query features against a reference encoded with
+ * product quantization. For every query an inner product table with all the
+ * centroids is computed once, then scoring a reference feature takes one
+ * table lookup per subspace. The tables of the `bufferSize` most recently
+ * used queries are kept.
+ */
+class PqDatabase : public iDatabase {
+public:
+  PqDatabase(const std::string &queryFeaturesDir,
+             const std::string &refPqStoreFile, int bufferSize);
+
+  int refSize() override { return refStore_->size(); }
+  double getCost(int quId, int refId) override;
+  std::vector<double> getCosts(int quId,
+                               const std::vector<int> &refIds) override;
+
+  const features::PqStore &refStore() const { return *refStore_; }
+
+private:
+  const std::vector<float> &queryTable(int quId);
+
+  const std::shared_ptr<const features::FeatureStore> queryStore_;
+  std::vector<std::string> quFeaturesNames_;
+  std::shared_ptr<const features::PqStore> refStore_;
+
+  int bufferSize_ = 0;
+  std::list<int> tablesLru_;
+  struct Table {
+    std::vector<float> values;
+    std::list<int>::iterator lruPos;
+  };
+  std::unordered_map<int, Table> tables_;
+};
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_PQ_DATABASE_H_
@@ -0,0 +1,270 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/sharded_database.h"
+#include "database/feature_source.h"
+#include "database/online_database.h"
+
+#include <glog/logging.h>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace localization::database {
+
+namespace {
+struct ShardRequest {
+  int32_t quId = -1;
+  int32_t count = 0;
+};
+
+bool sendAll(int fd, const void *data, size_t size) {
+  const auto *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    // MSG_NOSIGNAL: a dead peer is reported as an error, not as SIGPIPE.
+    const ssize_t sent = send(fd, bytes, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+bool receiveAll(int fd, void *data, size_t size) {
+  auto *bytes = static_cast<char *>(data);
+  while (size > 0) {
+    const ssize_t received = recv(fd, bytes, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    bytes += received;
+    size -= received;
+  }
+  return true;
+}
+
+/** Answers cost requests for the references [refBegin, refEnd) until the
+ * owner closes the socket. The worker only opens its own slice of the
+ * reference, the ids are translated to the slice. **/
+void serveShard(int fd, FeatureSource query, const FeatureSource &reference,
+                int refBegin, int refEnd, features::FeatureType type,
+                const ShardedDatabaseOptions &options) {
+  OnlineDatabase database(std::move(query),
+                          sliceFeatureSource(reference, refBegin, refEnd),
+                          type, options.bufferSize);
+  if (options.projection) {
+    database.setFeatureProjection(options.projection);
+  }
+  ShardRequest request;
+  std::vector<int32_t> refIds;
+  std::vector<int> localIds;
+  std::vector<double> costs;
+  while (receiveAll(fd, &request, sizeof(request))) {
+    refIds.resize(request.count);
+    if (!receiveAll(fd, refIds.data(), refIds.size() * sizeof(int32_t))) {
+      return;
+    }
+    localIds.clear();
+    for (int32_t refId : refIds) {
+      localIds.push_back(refId - refBegin);
+    }
+    costs = database.getCosts(request.quId, localIds);
+    if (!sendAll(fd, costs.data(), costs.size() * sizeof(double))) {
+      return;
+    }
+  }
+}
+} // namespace
+
+ShardedDatabase::ShardedDatabase(const std::string &queryFeatures,
+                                 const std::string &refFeatures,
+                                 features::FeatureType type,
+                                 const ShardedDatabaseOptions &options)
+    : batchRadius_{options.batchRadius} {
+  // Opened once in the owner, the workers inherit the names and map only
+  // their slice of a reference store again.
+  FeatureSource query = openFeatureSource(queryFeatures);
+  const FeatureSource reference = openFeatureSource(refFeatures);
+  querySize_ = query.names.size();
+  refSize_ = reference.names.size();
+  LOG_IF(FATAL, querySize_ == 0) << "Query features are not set.";
+  LOG_IF(FATAL, refSize_ == 0) << "Reference features are not set.";
+  CHECK(options.numShards > 0) << "Invalid number of shards "
+                               << options.numShards;
+  CHECK(batchRadius_ >= 0) << "Invalid batch radius " << batchRadius_;
+
+  const int numShards = std::min(options.numShards, refSize_);
+  const int shardSize = (refSize_ + numShards - 1) / numShards;
+  // Buffered output would otherwise be flushed by every child as well.
+  fflush(nullptr);
+  for (int refBegin = 0; refBegin < refSize_; refBegin += shardSize) {
+    int sockets[2];
+    LOG_IF(FATAL, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0)
+        << "Failed to create a socket pair: " << std::strerror(errno);
+    const pid_t pid = fork();
+    LOG_IF(FATAL, pid < 0) << "Failed to start a shard worker: "
+                           << std::strerror(errno);
+    if (pid == 0) {
+      close(sockets[0]);
+      for (const Shard &shard : shards_) {
+        close(shard.fd);
+      }
+      serveShard(sockets[1], std::move(query), reference, refBegin,
+                 std::min(refBegin + shardSize, refSize_), type, options);
+      // Skips the destructors and exit handlers inherited from the owner.
+      _exit(0);
+    }
+    close(sockets[1]);
+    Shard shard;
+    shard.refBegin = refBegin;
+    shard.refEnd = std::min(refBegin + shardSize, refSize_);
+    shard.fd = sockets[0];
+    shard.pid = pid;
+    shards_.push_back(shard);
+  }
+  LOG(INFO) << "Started " << shards_.size() << " shard workers with up to "
+            << shardSize << " reference features each.";
+}
+
+ShardedDatabase::~ShardedDatabase() {
+  for (const Shard &shard : shards_) {
+    close(shard.fd);
+  }
+  for (const Shard &shard : shards_) {
+    waitpid(shard.pid, nullptr, 0);
+  }
+}
+
+int ShardedDatabase::shardOf(int refId) const {
+  const int shardSize = shards_[0].refEnd - shards_[0].refBegin;
+  return refId / shardSize;
+}
+
+std::vector<double>
+ShardedDatabase::requestCosts(int quId, const std::vector<int> &refIds) {
+  CHECK(quId >= 0 && quId < querySize_)
+      << "Query feature " << quId << " is out of range";
+  std::vector<std::vector<int32_t>> shardRefIds(shards_.size());
+  for (int refId : refIds) {
+    CHECK(refId >= 0 && refId < refSize_)
+        << "Reference feature " << refId << " is out of range";
+    shardRefIds[shardOf(refId)].push_back(refId);
+  }
+  // All requests go out before any answer is read, the shards work on them
+  // at the same time.
+  for (size_t s = 0; s < shards_.size(); ++s) {
+    if (shardRefIds[s].empty()) {
+      continue;
+    }
+    ShardRequest request;
+    request.quId = quId;
+    request.count = shardRefIds[s].size();
+    LOG_IF(FATAL,
+           !sendAll(shards_[s].fd, &request, sizeof(request)) ||
+               !sendAll(shards_[s].fd, shardRefIds[s].data(),
+                        shardRefIds[s].size() * sizeof(int32_t)))
+        << "Shard worker " << s << " is not running.";
+  }
+  std::unordered_map<int, double> shardCosts;
+  std::vector<double> received;
+  for (size_t s = 0; s < shards_.size(); ++s) {
+    if (shardRefIds[s].empty()) {
+      continue;
+    }
+    received.resize(shardRefIds[s].size());
+    LOG_IF(FATAL, !receiveAll(shards_[s].fd, received.data(),
+                              received.size() * sizeof(double)))
+        << "Shard worker " << s << " stopped responding.";
+    for (size_t idx = 0; idx < received.size(); ++idx) {
+      shardCosts[shardRefIds[s][idx]] = received[idx];
+    }
+  }
+  std::vector<double> costs;
+  costs.reserve(refIds.size());
+  for (int refId : refIds) {
+    costs.push_back(shardCosts[refId]);
+  }
+  return costs;
+}
+
+double ShardedDatabase::getCost(int quId, int refId) {
+  auto &row = costs_[quId];
+  auto found = row.find(refId);
+  if (found != row.end()) {
+    return found->second;
+  }
+  CHECK(refId >= 0 && refId < refSize_)
+      << "Reference feature " << refId << " is out of range";
+  std::vector<int> batch;
+  for (int id = std::max(refId - batchRadius_, 0);
+       id <= std::min(refId + batchRadius_, refSize_ - 1); ++id) {
+    if (row.count(id) == 0) {
+      batch.push_back(id);
+    }
+  }
+  const std::vector<double> costs = requestCosts(quId, batch);
+  for (size_t idx = 0; idx < batch.size(); ++idx) {
+    row[batch[idx]] = costs[idx];
+  }
+  return row.at(refId);
+}
+
+std::vector<double> ShardedDatabase::getCosts(int quId,
+                                              const std::vector<int> &refIds) {
+  auto &row = costs_[quId];
+  std::vector<int> missing;
+  for (int refId : refIds) {
+    if (row.count(refId) == 0) {
+      missing.push_back(refId);
+    }
+  }
+  if (!missing.empty()) {
+    const std::vector<double> computed = requestCosts(quId, missing);
+    for (size_t idx = 0; idx < missing.size(); ++idx) {
+      row[missing[idx]] = computed[idx];
+    }
+  }
+  std::vector<double> costs;
+  costs.reserve(refIds.size());
+  for (int refId : refIds) {
+    costs.push_back(row.at(refId));
+  }
+  return costs;
+}
+
+} // namespace localization::database
@@ -0,0 +1,98 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_SHARDED_DATABASE_H_
+#define SRC_DATABASE_SHARDED_DATABASE_H_
+
+#include "database/idatabase.h"
+#include "features/feature_factory.h"
+#include "features/projection.h"
+
+#include <memory>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+
+namespace localization::database {
+
+struct ShardedDatabaseOptions {
+  int numShards = 2;
+  // Feature buffer size of every worker.
+  int bufferSize = 100;
+  // A missing cost is requested together with the costs of the neighbouring
+  // references in the same query row, the search usually needs them next.
+  int batchRadius = 16;
+  // Applied by every worker to the features it loads, see
+  // OnlineDatabase::setFeatureProjection().
+  std::shared_ptr<const features::Projection> projection;
+};
+
+/**
+ * @brief      Database that splits the reference into contiguous shards, each
+ * owned by a worker process with its own OnlineDatabase over just that part
+ * of the reference. The costs of a query
+ * row are requested from all involved workers at once over Unix domain
+ * sockets, so the workers load features and compute costs in parallel.
+ *
+ * The workers are forked in the constructor. Create the database before
+ * starting other threads.
+ */
+class ShardedDatabase : public iDatabase {
+public:
+  ShardedDatabase(const std::string &queryFeatures,
+                  const std::string &refFeatures, features::FeatureType type,
+                  const ShardedDatabaseOptions &options = {});
+  ~ShardedDatabase() override;
+
+  int refSize() override { return refSize_; }
+  int querySize() const { return querySize_; }
+  double getCost(int quId, int refId) override;
+  // Computes the missing costs of one query row in a single round trip per
+  // shard.
+  std::vector<double> getCosts(int quId,
+                               const std::vector<int> &refIds) override;
+
+  int numShards() const { return shards_.size(); }
+
+private:
+  struct Shard {
+    int refBegin = 0;
+    int refEnd = 0;
+    int fd = -1;
+    pid_t pid = -1;
+  };
+
+  int shardOf(int refId) const;
+  std::vector<double> requestCosts(int quId, const std::vector<int> &refIds);
+
+  int querySize_ = 0;
+  int refSize_ = 0;
+  int batchRadius_ = 0;
+  std::vector<Shard> shards_;
+  std::unordered_map<int, std::unordered_map<int, double>> costs_;
+};
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_SHARDED_DATABASE_H_
@@ -2,46 +2,148 @@
 
 #include "similarity_matrix.h"
 #include "database/list_dir.h"
+#include "database/similarity_matrix_builder.h"
 #include "features/feature_factory.h"
+#include "features/feature_matrix.h"
+#include "features/feature_traits.h"
+#include "features/proto_values.h"
 #include "localization_protos.pb.h"
+#include "tools/parallel/parallel_for.h"
 
 #include <glog/logging.h>
 
+#include <cstring>
 #include <fstream>
+#include <memory>
 
 namespace localization::database {
 
 namespace {
 constexpr auto kEpsilon = 1e-09;
+constexpr auto kBinaryMatrixExtension = ".SimilarityMatrix.bin";
+
+using FeatureList = std::vector<std::unique_ptr<features::iFeature>>;
+using RowScorer = void (*)(const features::iFeature &query,
+                           const FeatureList &refFeatures,
+                           std::vector<double> &scores);
+
+// The type of all features is known, the loop calls the scoring of the type
+// directly.
+template <class Feature>
+void scoreRow(const features::iFeature &query, const FeatureList &refFeatures,
+              std::vector<double> &scores) {
+  const auto &typedQuery = static_cast<const Feature &>(query);
+  for (const auto &refFeature : refFeatures) {
+    scores.push_back(features::FeatureTraits<Feature>::score(
+        typedQuery, static_cast<const Feature &>(*refFeature)));
+  }
+}
+
+void scoreRowDynamic(const features::iFeature &query,
+                     const FeatureList &refFeatures,
+                     std::vector<double> &scores) {
+  for (const auto &refFeature : refFeatures) {
+    scores.push_back(query.computeSimilarityScore(*refFeature));
+  }
+}
+
+RowScorer rowScorer(features::FeatureType type) {
+  switch (type) {
+  case features::Cnn_Feature:
+    return scoreRow<features::CnnFeature>;
+  case features::Binary_Feature_Mid:
+  case features::Binary_Feature_Mean:
+  case features::Binary_Feature_Median:
+    return scoreRow<features::BinaryFeature>;
+  case features::Int8_Feature:
+    return scoreRow<features::Int8Feature>;
+  case features::Bow_Feature:
+    return scoreRow<features::BowFeature>;
+  case features::Patch_Feature:
+    return scoreRow<features::PatchFeature>;
+  }
+  return scoreRowDynamic;
+}
 } // namespace
 
+SimilarityMatrixBinaryHeader makeBinaryHeader(int64_t rows, int64_t cols) {
+  SimilarityMatrixBinaryHeader header;
+  std::memcpy(header.magic, SimilarityMatrixBinaryHeader::kMagic,
+              sizeof(header.magic));
+  header.version = SimilarityMatrixBinaryHeader::kVersion;
+  header.dtype = SimilarityMatrixBinaryHeader::kFloat32;
+  header.rows = rows;
+  header.cols = cols;
+  header.dataOffset = sizeof(SimilarityMatrixBinaryHeader);
+  return header;
+}
+
+SimilarityMatrixBinaryHeader readBinaryHeader(std::istream &in,
+                                              const std::string &filename) {
+  SimilarityMatrixBinaryHeader header;
+  in.read(reinterpret_cast<char *>(&header), sizeof(header));
+  LOG_IF(FATAL, !in) << "Failed to read binary matrix header: " << filename;
+  LOG_IF(FATAL, std::memcmp(header.magic, SimilarityMatrixBinaryHeader::kMagic,
+                            sizeof(header.magic)) != 0)
+      << "Not a binary similarity matrix: " << filename;
+  LOG_IF(FATAL, header.version != SimilarityMatrixBinaryHeader::kVersion)
+      << "Unsupported binary matrix version " << header.version << " in "
+      << filename;
+  LOG_IF(FATAL, header.dtype != SimilarityMatrixBinaryHeader::kFloat32)
+      << "Unsupported binary matrix dtype " << header.dtype << " in "
+      << filename;
+  LOG_IF(FATAL, header.rows < 0 || header.cols < 0)
+      << "Invalid binary matrix size " << header.rows << "x" << header.cols;
+  return header;
+}
+
+bool isBinaryMatrixFile(const std::string &filename) {
+  const std::string extension = kBinaryMatrixExtension;
+  return filename.size() >= extension.size() &&
+         filename.compare(filename.size() - extension.size(), extension.size(),
+                          extension) == 0;
+}
+
 SimilarityMatrix::SimilarityMatrix(const std::string &similarityMatrixFile) {
   CHECK(!similarityMatrixFile.empty()) << "Similarity matrix file is not set";
-  loadFromProto(similarityMatrixFile);
+  if (isBinaryMatrixFile(similarityMatrixFile)) {
+    loadFromBinary(similarityMatrixFile);
+  } else {
+    loadFromProto(similarityMatrixFile);
+  }
 }
 
 SimilarityMatrix::SimilarityMatrix(const std::string &queryFeaturesDir,
                        const std::string &refFeaturesDir,
                        const features::FeatureType &type) {
+  if (type == features::Cnn_Feature) {
+    // Dense features: every feature is parsed once into a normalized matrix
+    // and the similarities are computed as a blocked matrix product.
+    *this = computeSimilarityMatrix(
+        features::FeatureMatrix::fromFeatureDir(queryFeaturesDir),
+        features::FeatureMatrix::fromFeatureDir(refFeaturesDir));
+    return;
+  }
+
   const std::vector<std::string> queryFeaturesFiles =
       listProtoDir(queryFeaturesDir, ".Feature");
   const std::vector<std::string> refFeaturesFiles =
       listProtoDir(refFeaturesDir, ".Feature");
+  LOG(INFO) << "Query features: " << queryFeaturesFiles.size();
+  LOG(INFO) << "Reference features: " << refFeaturesFiles.size();
 
-  std::cerr << "Query features" << queryFeaturesFiles.size() << std::endl;
-  std::cerr << "ref features" << refFeaturesFiles.size() << std::endl;
-
-  scores_.reserve(queryFeaturesFiles.size());
-  for (const auto &queryFile : queryFeaturesFiles) {
-    auto queryFeature = createFeature(type, queryFile);
-    std::vector<double> row;
-    row.reserve(refFeaturesFiles.size());
-    for (const auto &refFile : refFeaturesFiles) {
-      const auto refFeature = createFeature(type, refFile);
-      row.push_back(queryFeature->computeSimilarityScore(*refFeature));
-    }
-    scores_.push_back(row);
-  }
+  // Other feature types are compared pairwise, but still loaded only once.
+  FeatureList refFeatures(refFeaturesFiles.size());
+  tools::parallelFor(0, refFeaturesFiles.size(), [&](int idx) {
+    refFeatures[idx] = createFeature(type, refFeaturesFiles[idx]);
+  });
+  const RowScorer scoreRowOfType = rowScorer(type);
+  scores_.resize(queryFeaturesFiles.size());
+  tools::parallelFor(0, queryFeaturesFiles.size(), [&](int q) {
+    const auto queryFeature = createFeature(type, queryFeaturesFiles[q]);
+    scores_[q].reserve(refFeatures.size());
+    scoreRowOfType(*queryFeature, refFeatures, scores_[q]);
+  });
   rows_ = scores_.size();
   if (scores_.size() > 0) {
     cols_ = scores_[0].size();
@@ -93,23 +195,80 @@ double SimilarityMatrix::getCost(int row, int col) const {
 
 void SimilarityMatrix::loadFromProto(const std::string &filename) {
   GOOGLE_PROTOBUF_VERIFY_VERSION;
-  image_sequence_localizer::SimilarityMatrix similarity_matrix_proto;
-  std::fstream input(filename, std::ios::in | std::ios::binary);
-
-  if (!similarity_matrix_proto.ParseFromIstream(&input)) {
+  google::protobuf::Arena arena;
+  const auto *similarity_matrix_proto =
+      features::parseProtoFile<image_sequence_localizer::SimilarityMatrix>(
+          filename, &arena);
+  if (!similarity_matrix_proto) {
     LOG(FATAL) << "Failed to parse cost_matrix file: " << filename;
   }
-  std::vector<double> row;
-  for (int idx = 0; idx < similarity_matrix_proto.values_size(); ++idx) {
-    row.push_back(similarity_matrix_proto.values(idx));
-    if (row.size() == similarity_matrix_proto.cols()) {
-      scores_.push_back(row);
-      row.clear();
-    }
+  rows_ = similarity_matrix_proto->rows();
+  cols_ = similarity_matrix_proto->cols();
+  LOG_IF(FATAL, static_cast<int64_t>(rows_) * cols_ !=
+                    features::protoValuesSize(*similarity_matrix_proto))
+      << "The number of values does not match " << rows_ << "x" << cols_
+      << " in " << filename;
+  scores_.assign(rows_, std::vector<double>(cols_));
+  for (int r = 0; r < rows_; ++r) {
+    features::copyProtoValues(*similarity_matrix_proto,
+                              static_cast<int64_t>(r) * cols_, cols_,
+                              scores_[r].data());
+  }
+  LOG(INFO) << "Read cost matrix with " << rows_ << " rows and " << cols_
+            << " cols.";
+}
+
+void SimilarityMatrix::loadFromBinary(const std::string &filename) {
+  std::fstream input(filename, std::ios::in | std::ios::binary);
+  LOG_IF(FATAL, !input) << "The file cannot be opened " << filename;
+  const SimilarityMatrixBinaryHeader header = readBinaryHeader(input, filename);
+  input.seekg(header.dataOffset);
+
+  scores_.clear();
+  scores_.reserve(header.rows);
+  std::vector<float> row(header.cols);
+  for (int64_t r = 0; r < header.rows; ++r) {
+    input.read(reinterpret_cast<char *>(row.data()),
+               row.size() * sizeof(float));
+    LOG_IF(FATAL, !input) << "Binary matrix file is truncated: " << filename;
+    scores_.emplace_back(row.begin(), row.end());
   }
-  cols_ = similarity_matrix_proto.cols();
-  rows_ = similarity_matrix_proto.rows();
+  rows_ = header.rows;
+  cols_ = header.cols;
   LOG(INFO) << "Read cost matrix with " << rows_ << " rows and " << cols_
             << " cols.";
 }
+
+void SimilarityMatrix::saveToProto(const std::string &filename,
+                                   features::ProtoValuesFormat format) const {
+  image_sequence_localizer::SimilarityMatrix similarity_matrix_proto;
+  similarity_matrix_proto.set_rows(rows_);
+  similarity_matrix_proto.set_cols(cols_);
+  features::reserveProtoValues(static_cast<size_t>(rows_) * cols_, format,
+                               &similarity_matrix_proto);
+  for (const auto &row : scores_) {
+    features::appendProtoValues(row.data(), row.size(), format,
+                                &similarity_matrix_proto);
+  }
+  std::fstream out(filename,
+                   std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !similarity_matrix_proto.SerializeToOstream(&out))
+      << "Failed to write the similarity matrix to " << filename;
+}
+
+void SimilarityMatrix::saveToBinary(const std::string &filename) const {
+  std::fstream out(filename,
+                   std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !out) << "The file cannot be opened " << filename;
+  const SimilarityMatrixBinaryHeader header = makeBinaryHeader(rows_, cols_);
+  out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  std::vector<float> row(cols_);
+  for (const auto &scoresRow : scores_) {
+    std::copy(scoresRow.begin(), scoresRow.end(), row.begin());
+    out.write(reinterpret_cast<const char *>(row.data()),
+              row.size() * sizeof(float));
+  }
+  LOG_IF(FATAL, !out) << "Failed to write the similarity matrix to "
+                      << filename;
+}
 } // namespace localization::database
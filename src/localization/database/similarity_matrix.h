@@ -4,11 +4,44 @@
 #define SRC_DATABASE_SIMILARITY_MATRIX_H_
 
 #include "features/feature_factory.h"
+#include "features/proto_values.h"
 
+#include <cstdint>
+#include <iosfwd>
 #include <string>
 #include <vector>
 
 namespace localization::database {
+
+/**
+ * @brief      Header of the binary similarity matrix format
+ * (*.SimilarityMatrix.bin). The header is followed by rows * cols float32
+ * values in row-major order, starting at `dataOffset`. All numbers are stored
+ * in the native (little-endian) byte order.
+ */
+struct SimilarityMatrixBinaryHeader {
+  static constexpr char kMagic[8] = "ISLSMAT";
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kFloat32 = 0;
+
+  char magic[8] = {};
+  uint32_t version = 0;
+  uint32_t dtype = 0;
+  int64_t rows = 0;
+  int64_t cols = 0;
+  uint64_t dataOffset = 0;
+  uint8_t reserved[24] = {};
+};
+static_assert(sizeof(SimilarityMatrixBinaryHeader) == 64,
+              "The binary header should stay 64 bytes long");
+
+SimilarityMatrixBinaryHeader makeBinaryHeader(int64_t rows, int64_t cols);
+/** Reads and validates the header. Dies on a malformed header. **/
+SimilarityMatrixBinaryHeader readBinaryHeader(std::istream &in,
+                                              const std::string &filename);
+/** Returns true if the file name has the binary matrix extension. **/
+bool isBinaryMatrixFile(const std::string &filename);
+
 class SimilarityMatrix {
 public:
   using Matrix = std::vector<std::vector<double>>;
@@ -22,6 +55,11 @@ public:
   void loadFromTxt(const std::string &filename, int rows, int cols);
 
   void loadFromProto(const std::string &filename);
+  void loadFromBinary(const std::string &filename);
+  void saveToProto(const std::string &filename,
+                   features::ProtoValuesFormat format =
+                       features::ProtoValuesFormat::RawFloat32) const;
+  void saveToBinary(const std::string &filename) const;
   const Matrix &getScores() const { return scores_; }
 
   double at(int row, int col) const;
@@ -38,4 +76,4 @@ private:
 };
 } // namespace localization::database
 
-#endif // SRC_DATABASE_SIMILARITY_MATRIX_H_
\ No newline at end of file
+#endif // SRC_DATABASE_SIMILARITY_MATRIX_H_
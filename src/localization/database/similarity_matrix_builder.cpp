@@ -0,0 +1,189 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/similarity_matrix_builder.h"
+#include "features/similarity_kernels.h"
+#include "localization_protos.pb.h"
+#include "tools/parallel/parallel_for.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+namespace localization::database {
+
+namespace {
+int numBlocks(int size, int blockSize) {
+  return (size + blockSize - 1) / blockSize;
+}
+
+void checkOptions(const features::FeatureMatrix &query,
+                  const features::FeatureMatrix &ref,
+                  const SimilarityMatrixBuildOptions &options) {
+  CHECK(query.dim() == ref.dim())
+      << "Query and reference features have different dimensions: "
+      << query.dim() << " vs " << ref.dim();
+  CHECK(options.queryBlock > 0 && options.refBlock > 0 &&
+        options.dimBlock > 0)
+      << "Block sizes should be positive.";
+}
+} // namespace
+
+void computeSimilarityBlock(const features::FeatureMatrix &query,
+                            const features::FeatureMatrix &ref, int queryBegin,
+                            int queryEnd, int refBegin, int refEnd, float *out,
+                            size_t outStride,
+                            const SimilarityMatrixBuildOptions &options) {
+  for (int q = queryBegin; q < queryEnd; ++q) {
+    std::fill_n(out + (q - queryBegin) * outStride, refEnd - refBegin, 0.f);
+  }
+  const int dim = query.dim();
+  const int numQueries = queryEnd - queryBegin;
+  const int numRefs = refEnd - refBegin;
+  std::vector<const float *> queryRows(numQueries);
+  std::vector<const float *> refRows(numRefs);
+  std::vector<float> chunkScores(static_cast<size_t>(numQueries) * numRefs);
+  // Walk over the dimensions in chunks, so that the query and reference
+  // chunks of the current block are reused from cache for every pair.
+  for (int d = 0; d < dim; d += options.dimBlock) {
+    const int length = std::min(options.dimBlock, dim - d);
+    for (int q = 0; q < numQueries; ++q) {
+      queryRows[q] = query.row(queryBegin + q) + d;
+    }
+    for (int r = 0; r < numRefs; ++r) {
+      refRows[r] = ref.row(refBegin + r) + d;
+    }
+    features::dotProductBatch(queryRows.data(), numQueries, refRows.data(),
+                              numRefs, length, chunkScores.data());
+    for (int q = 0; q < numQueries; ++q) {
+      float *outRow = out + q * outStride;
+      const float *chunkRow =
+          chunkScores.data() + static_cast<size_t>(q) * numRefs;
+      for (int r = 0; r < numRefs; ++r) {
+        outRow[r] += chunkRow[r];
+      }
+    }
+  }
+}
+
+void computeSimilarityRows(const features::FeatureMatrix &query,
+                           const features::FeatureMatrix &ref, int queryBegin,
+                           int queryEnd, float *out,
+                           const SimilarityMatrixBuildOptions &options) {
+  checkOptions(query, ref, options);
+  CHECK(queryBegin >= 0 && queryBegin <= queryEnd && queryEnd <= query.rows())
+      << "Invalid query range [" << queryBegin << ", " << queryEnd << ")";
+  const int queryBlocks = numBlocks(queryEnd - queryBegin, options.queryBlock);
+  const int refBlocks = numBlocks(ref.rows(), options.refBlock);
+  tools::parallelFor(
+      0, queryBlocks * refBlocks,
+      [&](int block) {
+        const int qBegin =
+            queryBegin + (block / refBlocks) * options.queryBlock;
+        const int qEnd = std::min(qBegin + options.queryBlock, queryEnd);
+        const int rBegin = (block % refBlocks) * options.refBlock;
+        const int rEnd = std::min(rBegin + options.refBlock, ref.rows());
+        computeSimilarityBlock(
+            query, ref, qBegin, qEnd, rBegin, rEnd,
+            out + static_cast<size_t>(qBegin - queryBegin) * ref.rows() +
+                rBegin,
+            ref.rows(), options);
+      },
+      options.numThreads);
+}
+
+SimilarityMatrix
+computeSimilarityMatrix(const features::FeatureMatrix &query,
+                        const features::FeatureMatrix &ref,
+                        const SimilarityMatrixBuildOptions &options) {
+  std::vector<float> scores(static_cast<size_t>(query.rows()) * ref.rows());
+  computeSimilarityRows(query, ref, 0, query.rows(), scores.data(), options);
+
+  SimilarityMatrix::Matrix matrix(query.rows());
+  for (int q = 0; q < query.rows(); ++q) {
+    const float *row = scores.data() + static_cast<size_t>(q) * ref.rows();
+    matrix[q].assign(row, row + ref.rows());
+  }
+  return SimilarityMatrix(matrix);
+}
+
+void writeSimilarityMatrix(const features::FeatureMatrix &query,
+                           const features::FeatureMatrix &ref,
+                           const std::string &outputFile,
+                           const SimilarityMatrixBuildOptions &options) {
+  checkOptions(query, ref, options);
+  const bool binary = isBinaryMatrixFile(outputFile);
+  std::fstream out(outputFile,
+                   std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !out) << "The file cannot be opened " << outputFile;
+
+  image_sequence_localizer::SimilarityMatrix similarity_matrix_proto;
+  if (binary) {
+    const SimilarityMatrixBinaryHeader header =
+        makeBinaryHeader(query.rows(), ref.rows());
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  } else {
+    similarity_matrix_proto.set_rows(query.rows());
+    similarity_matrix_proto.set_cols(ref.rows());
+    features::reserveProtoValues(static_cast<size_t>(query.rows()) *
+                                     ref.rows(),
+                                 options.protoFormat, &similarity_matrix_proto);
+  }
+
+  // A band has enough query blocks to keep all the threads busy.
+  const int numThreads = options.numThreads > 0 ? options.numThreads
+                                                : tools::defaultNumThreads();
+  const int bandRows = options.queryBlock * numThreads;
+  std::vector<float> band(static_cast<size_t>(bandRows) * ref.rows());
+
+  Timer timer;
+  timer.start();
+  for (int bandBegin = 0; bandBegin < query.rows(); bandBegin += bandRows) {
+    const int bandEnd = std::min(bandBegin + bandRows, query.rows());
+    computeSimilarityRows(query, ref, bandBegin, bandEnd, band.data(),
+                          options);
+    const size_t bandSize = static_cast<size_t>(bandEnd - bandBegin) * ref.rows();
+    if (binary) {
+      out.write(reinterpret_cast<const char *>(band.data()),
+                bandSize * sizeof(float));
+    } else {
+      features::appendProtoValues(band.data(), bandSize, options.protoFormat,
+                                  &similarity_matrix_proto);
+    }
+  }
+  timer.stop();
+  if (!binary) {
+    LOG_IF(FATAL, !similarity_matrix_proto.SerializeToOstream(&out))
+        << "Failed to write the similarity matrix to " << outputFile;
+  }
+  LOG_IF(FATAL, !out) << "Failed to write the similarity matrix to "
+                      << outputFile;
+  LOG(INFO) << "Computed " << query.rows() << "x" << ref.rows()
+            << " similarity matrix in " << timer.get_elapsed_ms().count()
+            << " ms and stored it to " << outputFile;
+}
+
+} // namespace localization::database
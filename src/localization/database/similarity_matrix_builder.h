@@ -0,0 +1,96 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_SIMILARITY_MATRIX_BUILDER_H_
+#define SRC_DATABASE_SIMILARITY_MATRIX_BUILDER_H_
+
+#include "database/similarity_matrix.h"
+#include "features/feature_matrix.h"
+#include "features/proto_values.h"
+
+#include <cstddef>
+#include <string>
+
+namespace localization::database {
+
+/**
+ * @brief      Parameters of the blocked similarity matrix computation. The
+ * block sizes are chosen such that a query block and a reference block of
+ * `dimBlock` values stay in the L2 cache.
+ */
+struct SimilarityMatrixBuildOptions {
+  int numThreads = 0; // <= 0 means all available threads.
+  int queryBlock = 64;
+  int refBlock = 256;
+  int dimBlock = 512;
+  // Format of the values when the matrix is written as a proto.
+  features::ProtoValuesFormat protoFormat =
+      features::ProtoValuesFormat::RawFloat32;
+};
+
+/**
+ * @brief      Computes the similarities of the query rows [queryBegin,
+ * queryEnd) to the reference rows [refBegin, refEnd) on the calling thread.
+ * The result for (q, r) is written to out[(q - queryBegin) * outStride + (r -
+ * refBegin)].
+ */
+void computeSimilarityBlock(const features::FeatureMatrix &query,
+                            const features::FeatureMatrix &ref, int queryBegin,
+                            int queryEnd, int refBegin, int refEnd, float *out,
+                            size_t outStride,
+                            const SimilarityMatrixBuildOptions &options = {});
+
+/**
+ * @brief      Computes the similarities of the query rows [queryBegin,
+ * queryEnd) to all reference rows. The work is split into query x reference
+ * blocks that are processed in parallel. `out` must hold (queryEnd -
+ * queryBegin) * ref.rows() values.
+ */
+void computeSimilarityRows(const features::FeatureMatrix &query,
+                           const features::FeatureMatrix &ref, int queryBegin,
+                           int queryEnd, float *out,
+                           const SimilarityMatrixBuildOptions &options = {});
+
+/** Computes the full similarity matrix in memory. **/
+SimilarityMatrix
+computeSimilarityMatrix(const features::FeatureMatrix &query,
+                        const features::FeatureMatrix &ref,
+                        const SimilarityMatrixBuildOptions &options = {});
+
+/**
+ * @brief      Computes the similarity matrix and writes it to `outputFile`.
+ * The format is selected by the extension: *.SimilarityMatrix.bin for the
+ * binary format, everything else is written as a SimilarityMatrix proto in
+ * `options.protoFormat`. The binary format is written band by band and never
+ * holds the whole matrix in memory. A proto is serialized as one message, so
+ * it holds all values until the end; use the binary format for matrices that
+ * do not fit into memory.
+ */
+void writeSimilarityMatrix(const features::FeatureMatrix &query,
+                           const features::FeatureMatrix &ref,
+                           const std::string &outputFile,
+                           const SimilarityMatrixBuildOptions &options = {});
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_SIMILARITY_MATRIX_BUILDER_H_
@@ -34,7 +34,7 @@ namespace localization::database {
 SimilarityMatrixDatabase::SimilarityMatrixDatabase(const std::string &similarityMatrixFile)
     : similarityMatrix_(SimilarityMatrix(similarityMatrixFile)) {}
 
-double SimilarityMatrixDatabase::getCost(int quId, int refId) {
+double SimilarityMatrixDatabase::cost(int quId, int refId) const {
   return similarityMatrix_.getCost(quId, refId);
 }
 
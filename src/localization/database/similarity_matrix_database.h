@@ -39,10 +39,16 @@ public:
   explicit SimilarityMatrixDatabase(const std::string &costMatrixFile);
 
   int refSize() override { return similarityMatrix_.cols(); }
-  double getCost(int quId, int refId) override;
+  double getCost(int quId, int refId) override { return cost(quId, refId); }
+  /** The matrix is only read after loading, so the database can be shared
+   * between threads. **/
+  bool isThreadSafe() const override { return true; }
+
+  int cols() const { return similarityMatrix_.cols(); }
+  double cost(int quId, int refId) const;
 
 private:
-  SimilarityMatrix similarityMatrix_;
+  const SimilarityMatrix similarityMatrix_;
 };
 
 } // namespace localization::database
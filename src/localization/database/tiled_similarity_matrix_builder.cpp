@@ -0,0 +1,297 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/tiled_similarity_matrix_builder.h"
+#include "database/fingerprint.h"
+#include "features/feature_matrix.h"
+#include "features/feature_store.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
+
+namespace localization::database {
+
+namespace {
+constexpr auto kManifestVersion = "tiled_similarity_matrix_manifest_v1";
+
+int numBlocks(int size, int blockSize) {
+  return (size + blockSize - 1) / blockSize;
+}
+
+void writeAll(int fd, const void *data, size_t size, off_t offset,
+              const std::string &filename) {
+  const auto *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, bytes, size, offset);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    LOG_IF(FATAL, written <= 0)
+        << "Failed to write to " << filename << ": " << std::strerror(errno);
+    bytes += written;
+    size -= written;
+    offset += written;
+  }
+}
+
+/** Everything a resumed run has to agree on with the interrupted one. **/
+std::string manifestHeader(int rows, int cols, const TiledBuildOptions &options,
+                           uint64_t queryFingerprint, uint64_t refFingerprint) {
+  std::ostringstream header;
+  header << kManifestVersion << " rows " << rows << " cols " << cols
+         << " tileRows " << options.tileRows << " tileCols "
+         << options.tileCols << " query " << toHexString(queryFingerprint)
+         << " reference " << toHexString(refFingerprint);
+  return header.str();
+}
+
+/** The finished tiles of a manifest and the bytes of its complete lines. **/
+struct Manifest {
+  std::unordered_set<int> doneTiles;
+  uint64_t completeBytes = 0;
+};
+
+/**
+ * Returns the finished tiles if the manifest matches the `expectedHeader`,
+ * otherwise std::nullopt. A line that was cut by a crash has no newline and
+ * is not counted as complete, so it can be cut off before appending.
+ */
+std::optional<Manifest> readManifest(const std::string &manifestFile,
+                                     const std::string &expectedHeader,
+                                     int tilesTotal) {
+  std::ifstream in(manifestFile);
+  if (!in) {
+    return std::nullopt;
+  }
+  std::string header;
+  if (!std::getline(in, header) || in.eof() || header != expectedHeader) {
+    return std::nullopt;
+  }
+  Manifest manifest;
+  manifest.completeBytes = header.size() + 1;
+  std::string line;
+  while (std::getline(in, line) && !in.eof()) {
+    manifest.completeBytes += line.size() + 1;
+    std::istringstream lineStream(line);
+    std::string tag;
+    int tile = -1;
+    std::string end;
+    if (lineStream >> tag >> tile >> end && tag == "tile" && end == "done" &&
+        tile >= 0 && tile < tilesTotal) {
+      manifest.doneTiles.insert(tile);
+    }
+  }
+  return manifest;
+}
+
+/** Computes one tile as a sequence of cache-sized blocks. **/
+void computeTile(const features::FeatureMatrix &query,
+                 const features::FeatureMatrix &ref, int rowBegin, int rowEnd,
+                 int colBegin, int colEnd, float *out,
+                 const SimilarityMatrixBuildOptions &options) {
+  const size_t stride = colEnd - colBegin;
+  for (int q = rowBegin; q < rowEnd; q += options.queryBlock) {
+    const int qEnd = std::min(q + options.queryBlock, rowEnd);
+    for (int r = colBegin; r < colEnd; r += options.refBlock) {
+      const int rEnd = std::min(r + options.refBlock, colEnd);
+      computeSimilarityBlock(query, ref, q, qEnd, r, rEnd,
+                             out + (q - rowBegin) * stride + (r - colBegin),
+                             stride, options);
+    }
+  }
+}
+} // namespace
+
+double TiledBuildStats::tilesPerSec() const {
+  return elapsedSec > 0 ? tilesComputed / elapsedSec : 0.0;
+}
+
+double TiledBuildStats::writeMBPerSec() const {
+  return elapsedSec > 0 ? bytesWritten / (1024.0 * 1024.0) / elapsedSec : 0.0;
+}
+
+TiledBuildStats buildSimilarityMatrixTiled(const std::string &queryFeaturesDir,
+                                           const std::string &refFeaturesDir,
+                                           const std::string &outputFile,
+                                           const TiledBuildOptions &options) {
+  CHECK(options.tileRows > 0 && options.tileCols > 0)
+      << "Tile sizes should be positive.";
+  CHECK(isBinaryMatrixFile(outputFile))
+      << "Tiled computation writes only the binary format, expected a "
+         "*.SimilarityMatrix.bin file, got "
+      << outputFile;
+
+  const uint64_t queryFingerprint =
+      fingerprintFeatures(queryFeaturesDir, options.numThreads);
+  const uint64_t refFingerprint =
+      fingerprintFeatures(refFeaturesDir, options.numThreads);
+  const auto query =
+      features::FeatureMatrix::load(queryFeaturesDir, options.numThreads);
+  const auto ref =
+      features::FeatureMatrix::load(refFeaturesDir, options.numThreads);
+  LOG_IF(FATAL, query.rows() == 0) << "Query features are not set.";
+  LOG_IF(FATAL, ref.rows() == 0) << "Reference features are not set.";
+  CHECK(query.dim() == ref.dim())
+      << "Query and reference features have different dimensions: "
+      << query.dim() << " vs " << ref.dim();
+
+  const int rows = query.rows();
+  const int cols = ref.rows();
+  const int tileGridCols = numBlocks(cols, options.tileCols);
+  TiledBuildStats stats;
+  stats.tilesTotal = numBlocks(rows, options.tileRows) * tileGridCols;
+
+  const std::string manifestFile = outputFile + ".manifest";
+  const std::string header =
+      manifestHeader(rows, cols, options, queryFingerprint, refFingerprint);
+  std::optional<Manifest> previous;
+  if (std::filesystem::exists(outputFile)) {
+    previous = readManifest(manifestFile, header, stats.tilesTotal);
+  }
+  const bool resume = previous.has_value();
+  const std::unordered_set<int> doneTiles =
+      resume ? previous->doneTiles : std::unordered_set<int>{};
+  stats.tilesSkipped = doneTiles.size();
+
+  const SimilarityMatrixBinaryHeader binaryHeader =
+      makeBinaryHeader(rows, cols);
+  const int fd =
+      open(outputFile.c_str(), O_WRONLY | O_CREAT | (resume ? 0 : O_TRUNC),
+           0644);
+  LOG_IF(FATAL, fd < 0) << "The file cannot be opened " << outputFile << ": "
+                        << std::strerror(errno);
+  const off_t fileSize =
+      binaryHeader.dataOffset +
+      static_cast<off_t>(rows) * cols * static_cast<off_t>(sizeof(float));
+  LOG_IF(FATAL, ftruncate(fd, fileSize) != 0)
+      << "Failed to allocate " << outputFile << ": " << std::strerror(errno);
+
+  std::mutex manifestMutex;
+  std::ofstream manifest;
+  if (resume) {
+    LOG(INFO) << "Resuming from " << manifestFile << ", " << stats.tilesSkipped
+              << " of " << stats.tilesTotal << " tiles are done.";
+    // A line cut by a crash would be glued to the next record.
+    std::filesystem::resize_file(manifestFile, previous->completeBytes);
+    manifest.open(manifestFile, std::ios::out | std::ios::app);
+  } else {
+    writeAll(fd, &binaryHeader, sizeof(binaryHeader), 0, outputFile);
+    manifest.open(manifestFile, std::ios::out | std::ios::trunc);
+    manifest << header << std::endl;
+  }
+  LOG_IF(FATAL, !manifest) << "The file cannot be opened " << manifestFile;
+
+  std::vector<int> pendingTiles;
+  for (int tile = 0; tile < stats.tilesTotal; ++tile) {
+    if (doneTiles.count(tile) == 0) {
+      pendingTiles.push_back(tile);
+    }
+  }
+
+  std::atomic<int> tilesComputed{0};
+  std::atomic<int64_t> bytesWritten{0};
+  const int reportEvery = std::max<int>(1, pendingTiles.size() / 20);
+  const auto wallStart = std::chrono::steady_clock::now();
+  auto elapsedSec = [&wallStart]() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         wallStart)
+        .count();
+  };
+
+  const int numThreads = options.numThreads > 0 ? options.numThreads
+                                                : tools::defaultNumThreads();
+  // Every thread computes whole tiles, so the blocks inside a tile are not
+  // parallelized again.
+  SimilarityMatrixBuildOptions blockOptions = options.blockOptions;
+  blockOptions.numThreads = 1;
+  tools::parallelFor(
+      0, pendingTiles.size(),
+      [&](int idx) {
+        const int tile = pendingTiles[idx];
+        const int rowBegin = (tile / tileGridCols) * options.tileRows;
+        const int rowEnd = std::min(rowBegin + options.tileRows, rows);
+        const int colBegin = (tile % tileGridCols) * options.tileCols;
+        const int colEnd = std::min(colBegin + options.tileCols, cols);
+
+        thread_local std::vector<float> buffer;
+        const size_t tileCols = colEnd - colBegin;
+        buffer.resize((rowEnd - rowBegin) * tileCols);
+        computeTile(query, ref, rowBegin, rowEnd, colBegin, colEnd,
+                    buffer.data(), blockOptions);
+
+        for (int r = rowBegin; r < rowEnd; ++r) {
+          const off_t offset =
+              binaryHeader.dataOffset +
+              (static_cast<off_t>(r) * cols + colBegin) * sizeof(float);
+          writeAll(fd, buffer.data() + (r - rowBegin) * tileCols,
+                   tileCols * sizeof(float), offset, outputFile);
+        }
+        // The tile is recorded only once its data is on disk.
+        LOG_IF(FATAL, fdatasync(fd) != 0)
+            << "Failed to flush " << outputFile << ": " << std::strerror(errno);
+        bytesWritten += (rowEnd - rowBegin) * tileCols * sizeof(float);
+        {
+          std::lock_guard<std::mutex> lock(manifestMutex);
+          manifest << "tile " << tile << " done" << std::endl;
+          LOG_IF(FATAL, !manifest)
+              << "Failed to update the manifest " << manifestFile;
+        }
+        const int computed = ++tilesComputed;
+        if (computed % reportEvery == 0) {
+          const double seconds = elapsedSec();
+          LOG(INFO) << "Tiles " << computed + stats.tilesSkipped << "/"
+                    << stats.tilesTotal << ", " << computed / seconds
+                    << " tiles/s, "
+                    << bytesWritten / (1024.0 * 1024.0) / seconds << " MB/s";
+        }
+      },
+      numThreads);
+  close(fd);
+
+  stats.tilesComputed = tilesComputed;
+  stats.bytesWritten = bytesWritten;
+  stats.elapsedSec = elapsedSec();
+  LOG(INFO) << "Computed " << stats.tilesComputed << " tiles ("
+            << stats.tilesSkipped << " resumed) of the " << rows << "x" << cols
+            << " similarity matrix: " << stats.tilesPerSec() << " tiles/s, "
+            << stats.writeMBPerSec() << " MB/s written to " << outputFile
+            << " in " << stats.elapsedSec << " s.";
+  return stats;
+}
+
+} // namespace localization::database
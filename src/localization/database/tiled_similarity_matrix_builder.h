@@ -0,0 +1,74 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_DATABASE_TILED_SIMILARITY_MATRIX_BUILDER_H_
+#define SRC_DATABASE_TILED_SIMILARITY_MATRIX_BUILDER_H_
+
+#include "database/similarity_matrix_builder.h"
+
+#include <string>
+
+namespace localization::database {
+
+struct TiledBuildOptions {
+  // Size of one tile of the output matrix. Every worker keeps one tile of
+  // tileRows x tileCols floats in memory.
+  int tileRows = 2048;
+  int tileCols = 2048;
+  int numThreads = 0; // <= 0 means all available threads.
+  // Blocking inside a tile.
+  SimilarityMatrixBuildOptions blockOptions;
+};
+
+struct TiledBuildStats {
+  int tilesTotal = 0;
+  int tilesComputed = 0;
+  // Tiles that were already done by a previous, interrupted run.
+  int tilesSkipped = 0;
+  double bytesWritten = 0;
+  double elapsedSec = 0;
+
+  double tilesPerSec() const;
+  double writeMBPerSec() const;
+};
+
+/**
+ * @brief      Computes the similarity matrix between two feature directories
+ * (or packed feature stores) tile by tile and streams the tiles into `outputFile` in the binary
+ * similarity matrix format (*.SimilarityMatrix.bin). The full matrix never
+ * resides in memory, only the (much smaller) features do.
+ *
+ * Finished tiles are recorded in `outputFile + ".manifest"` after their data
+ * was flushed to disk. If the manifest belongs to the same query and
+ * reference features (checked by content fingerprints) and the same tiling,
+ * the recorded tiles are skipped, so an interrupted run resumes where it
+ * stopped. Otherwise the computation starts from scratch.
+ */
+TiledBuildStats buildSimilarityMatrixTiled(const std::string &queryFeaturesDir,
+                                           const std::string &refFeaturesDir,
+                                           const std::string &outputFile,
+                                           const TiledBuildOptions &options = {});
+
+} // namespace localization::database
+
+#endif // SRC_DATABASE_TILED_SIMILARITY_MATRIX_BUILDER_H_
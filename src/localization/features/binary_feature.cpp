@@ -0,0 +1,171 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/binary_feature.h"
+#include "features/feature_io.h"
+#include "features/feature_traits.h"
+#include "features/patch_feature.h"
+#include "features/similarity_kernels.h"
+#include "features/stored_feature.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace localization::features {
+
+namespace {
+// Packs one word without branches, the comparisons of a word are vectorized
+// by the compiler.
+uint64_t packWord(const double *values, int count, double threshold,
+                  bool inclusive) {
+  uint64_t word = 0;
+  for (int b = 0; b < count; ++b) {
+    const bool set =
+        inclusive ? values[b] >= threshold : values[b] > threshold;
+    word |= static_cast<uint64_t>(set) << b;
+  }
+  return word;
+}
+} // namespace
+
+std::vector<uint64_t> packBits(const std::vector<double> &values,
+                               Binarization binarization) {
+  const int size = values.size();
+  std::vector<uint64_t> words((size + 63) / 64, 0);
+  if (values.empty()) {
+    return words;
+  }
+  double threshold = 0.0;
+  switch (binarization) {
+  case Binarization::Mid: {
+    // Same as CnnFeature::binarize: the values are scaled to [0, 255] and
+    // the ones that reach 127 are set.
+    const auto [minIt, maxIt] = std::minmax_element(values.begin(), values.end());
+    const double range = *maxIt - *minIt;
+    std::vector<double> scaled(size);
+    if (range > 0.0) {
+      for (int d = 0; d < size; ++d) {
+        scaled[d] = static_cast<int>((values[d] - *minIt) * 255.0 / range);
+      }
+    }
+    for (int w = 0; w < static_cast<int>(words.size()); ++w) {
+      words[w] = packWord(scaled.data() + w * 64, std::min(64, size - w * 64),
+                          /*threshold=*/127, /*inclusive=*/true);
+    }
+    return words;
+  }
+  case Binarization::Mean:
+    threshold = std::accumulate(values.begin(), values.end(), 0.0) / size;
+    break;
+  case Binarization::Median: {
+    std::vector<double> sorted = values;
+    auto middle = sorted.begin() + (size - 1) / 2;
+    std::nth_element(sorted.begin(), middle, sorted.end());
+    threshold = *middle;
+    break;
+  }
+  }
+  for (int w = 0; w < static_cast<int>(words.size()); ++w) {
+    words[w] = packWord(values.data() + w * 64, std::min(64, size - w * 64),
+                        threshold, /*inclusive=*/false);
+  }
+  return words;
+}
+
+BinaryFeature::BinaryFeature(const std::string &filename,
+                             Binarization binarization)
+    : BinaryFeature(readFeatureValues(filename), binarization) {}
+
+BinaryFeature::BinaryFeature(const std::vector<double> &values,
+                             Binarization binarization)
+    : numBits_(values.size()), words_(packBits(values, binarization)) {
+  type = "BinaryFeature";
+}
+
+int BinaryFeature::hammingDistance(const BinaryFeature &rhs) const {
+  CHECK(numBits_ == rhs.numBits_) << "Features have different dimensions";
+  return features::hammingDistance(words_.data(), rhs.words_.data(),
+                                   words_.size());
+}
+
+double BinaryFeature::computeSimilarityScore(const iFeature &rhs) const {
+  CHECK(this->type == rhs.type) << "Features are not the same type";
+  const auto &other = static_cast<const BinaryFeature &>(rhs);
+  return FeatureTraits<BinaryFeature>::score(*this, other);
+}
+
+double BinaryFeature::score2cost(double score) const {
+  return FeatureTraits<BinaryFeature>::cost(score);
+}
+
+int numFeatureBits(const iFeature &feature) {
+  if (feature.type == "BinaryFeature") {
+    return static_cast<const BinaryFeature &>(feature).numBits();
+  }
+  if (feature.type == "StoredFeature") {
+    return static_cast<const StoredFeature &>(feature).size();
+  }
+  if (feature.type == "PatchFeature") {
+    return static_cast<const PatchFeature &>(feature).size();
+  }
+  return feature.bits.size();
+}
+
+std::vector<uint64_t> packedFeatureBits(const iFeature &feature) {
+  if (feature.type == "BinaryFeature") {
+    return static_cast<const BinaryFeature &>(feature).words();
+  }
+  if (feature.type == "StoredFeature") {
+    // Binarized on the fly like a CnnFeature of the same values, a store
+    // keeps no bits next to the mapped rows.
+    const auto &stored = static_cast<const StoredFeature &>(feature);
+    return packBits(
+        std::vector<double>(stored.data(), stored.data() + stored.size()),
+        Binarization::Mid);
+  }
+  if (feature.type == "PatchFeature") {
+    // A pixel brighter than the mean of its patch is a set bit, the quantized
+    // values are centered at 128.
+    const auto &patch = static_cast<const PatchFeature &>(feature);
+    std::vector<uint64_t> words((patch.size() + 63) / 64, 0);
+    for (int d = 0; d < patch.size(); ++d) {
+      if (patch.data()[d] > 128) {
+        words[d / 64] |= uint64_t{1} << (d % 64);
+      }
+    }
+    return words;
+  }
+  CHECK(!feature.bits.empty())
+      << "Binary features are needed, " << feature.type << " has no bits";
+  std::vector<uint64_t> words((feature.bits.size() + 63) / 64, 0);
+  for (size_t d = 0; d < feature.bits.size(); ++d) {
+    if (feature.bits[d] != 0) {
+      words[d / 64] |= uint64_t{1} << (d % 64);
+    }
+  }
+  return words;
+}
+
+} // namespace localization::features
@@ -0,0 +1,94 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_BINARY_FEATURE_H_
+#define SRC_FEATURES_BINARY_FEATURE_H_
+
+#include "features/ifeature.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+/** Thresholds used to binarize a feature, see relocalizers/readme.md. **/
+enum class Binarization {
+  // Middle of the value range, like CnnFeature::bits.
+  Mid,
+  // Mean of the values.
+  Mean,
+  // Median of the values, sets about half of the bits.
+  Median,
+};
+
+/**
+ * @brief      Binarizes `values` and packs the bits into 64-bit words, bit `d`
+ * is bit `d % 64` of word `d / 64`. The unused bits of the last word are 0.
+ */
+std::vector<uint64_t> packBits(const std::vector<double> &values,
+                               Binarization binarization);
+
+/**
+ * @brief      Binary feature with the bits packed in 64-bit words. Features
+ * are compared by the Hamming distance, computed with hardware popcount.
+ */
+class BinaryFeature : public iFeature {
+public:
+  BinaryFeature(const std::string &filename, Binarization binarization);
+  BinaryFeature(const std::vector<double> &values, Binarization binarization);
+
+  // The share of bits that are equal in both features, 1 for equal features.
+  double computeSimilarityScore(const iFeature &rhs) const override;
+  double score2cost(double score) const override;
+  size_t memoryBytes() const override {
+    return sizeof(*this) + type.capacity() +
+           words_.capacity() * sizeof(uint64_t);
+  }
+
+  int hammingDistance(const BinaryFeature &rhs) const;
+  int numBits() const { return numBits_; }
+  bool bit(int d) const { return (words_[d / 64] >> (d % 64)) & 1; }
+  const std::vector<uint64_t> &words() const { return words_; }
+
+private:
+  int numBits_ = 0;
+  std::vector<uint64_t> words_;
+};
+
+/** Number of bits of a binary feature: numBits() of a BinaryFeature, the
+ * size of a StoredFeature or a PatchFeature, the size of `bits` for the other
+ * features, e.g. CnnFeature. **/
+int numFeatureBits(const iFeature &feature);
+/**
+ * @brief      The bits of a binary feature packed in 64-bit words like
+ * packBits(): the words of a BinaryFeature, the Mid binarization of a
+ * StoredFeature, which equals the bits of a CnnFeature of the same values,
+ * the sign of every normalized pixel of a PatchFeature, or the packed `bits`
+ * of the other features. Dies if the feature has no bits.
+ */
+std::vector<uint64_t> packedFeatureBits(const iFeature &feature);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_BINARY_FEATURE_H_
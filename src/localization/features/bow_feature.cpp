@@ -0,0 +1,141 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/bow_feature.h"
+#include "features/feature_io.h"
+#include "features/feature_traits.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace localization::features {
+
+BowFeature::BowFeature(const std::string &filename)
+    : BowFeature(readFeatureValues(filename)) {}
+
+BowFeature::BowFeature(const std::vector<double> &histogram)
+    : numWords_(histogram.size()) {
+  type = "BowFeature";
+  for (size_t word = 0; word < histogram.size(); ++word) {
+    if (histogram[word] != 0.0) {
+      words_.push_back(word);
+      weights_.push_back(histogram[word]);
+    }
+  }
+  normalize();
+}
+
+BowFeature::BowFeature(int numWords, const std::vector<uint32_t> &words,
+                       const std::vector<float> &weights)
+    : numWords_(numWords) {
+  type = "BowFeature";
+  CHECK_EQ(words.size(), weights.size())
+      << "Every word needs exactly one weight";
+  std::vector<int> order(words.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&words](int lhs, int rhs) { return words[lhs] < words[rhs]; });
+  for (int idx : order) {
+    CHECK_LT(words[idx], static_cast<uint32_t>(numWords))
+        << "Word outside the vocabulary";
+    if (!words_.empty() && words_.back() == words[idx]) {
+      weights_.back() += weights[idx];
+    } else {
+      words_.push_back(words[idx]);
+      weights_.push_back(weights[idx]);
+    }
+  }
+  normalize();
+}
+
+void BowFeature::normalize() {
+  // Words without weight, e.g. ones that occur in every training image, do
+  // not contribute to any score.
+  size_t kept = 0;
+  for (size_t idx = 0; idx < words_.size(); ++idx) {
+    if (weights_[idx] != 0.f) {
+      words_[kept] = words_[idx];
+      weights_[kept] = weights_[idx];
+      ++kept;
+    }
+  }
+  words_.resize(kept);
+  weights_.resize(kept);
+  double norm = 0.0;
+  for (float weight : weights_) {
+    norm += static_cast<double>(weight) * weight;
+  }
+  norm = std::sqrt(norm);
+  if (norm == 0.0) {
+    // An image without words is not similar to anything.
+    words_.clear();
+    weights_.clear();
+    return;
+  }
+  for (float &weight : weights_) {
+    weight /= norm;
+  }
+}
+
+std::vector<double> BowFeature::toDense() const {
+  std::vector<double> histogram(numWords_, 0.0);
+  for (int idx = 0; idx < size(); ++idx) {
+    histogram[words_[idx]] = weights_[idx];
+  }
+  return histogram;
+}
+
+double sparseDotProduct(const BowFeature &lhs, const BowFeature &rhs) {
+  const uint32_t *lhsWords = lhs.words().data();
+  const uint32_t *rhsWords = rhs.words().data();
+  int l = 0;
+  int r = 0;
+  double dot = 0.0;
+  while (l < lhs.size() && r < rhs.size()) {
+    if (lhsWords[l] < rhsWords[r]) {
+      ++l;
+    } else if (rhsWords[r] < lhsWords[l]) {
+      ++r;
+    } else {
+      dot += static_cast<double>(lhs.weights()[l]) * rhs.weights()[r];
+      ++l;
+      ++r;
+    }
+  }
+  return dot;
+}
+
+double BowFeature::computeSimilarityScore(const iFeature &rhs) const {
+  CHECK(this->type == rhs.type) << "Features are not the same type";
+  const auto &other = static_cast<const BowFeature &>(rhs);
+  return FeatureTraits<BowFeature>::score(*this, other);
+}
+
+double BowFeature::score2cost(double score) const {
+  return FeatureTraits<BowFeature>::cost(score);
+}
+
+} // namespace localization::features
@@ -0,0 +1,85 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_BOW_FEATURE_H_
+#define SRC_FEATURES_BOW_FEATURE_H_
+
+#include "features/ifeature.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Bag-of-words feature: a sparse TF-IDF histogram of the visual
+ * words of an image, see features/bow_vocabulary.h. Only the words that occur
+ * in the image are stored, sorted by word id, and the weights are
+ * L2-normalized, so the score of two features is their cosine similarity.
+ *
+ * In `.Feature.pb` files the histogram is stored densely with one value per
+ * word of the vocabulary.
+ */
+class BowFeature : public iFeature {
+public:
+  explicit BowFeature(const std::string &filename);
+  /** Keeps the non-zero values of a dense histogram. **/
+  explicit BowFeature(const std::vector<double> &histogram);
+  /** `words` may be unsorted and contain duplicates, their weights add up.
+   * **/
+  BowFeature(int numWords, const std::vector<uint32_t> &words,
+             const std::vector<float> &weights);
+
+  double computeSimilarityScore(const iFeature &rhs) const override;
+  double score2cost(double score) const override;
+  size_t memoryBytes() const override {
+    return sizeof(*this) + type.capacity() +
+           words_.capacity() * sizeof(uint32_t) +
+           weights_.capacity() * sizeof(float);
+  }
+
+  /** Size of the vocabulary the histogram was computed with. **/
+  int numWords() const { return numWords_; }
+  /** Number of words that occur in the image. **/
+  int size() const { return words_.size(); }
+  const std::vector<uint32_t> &words() const { return words_; }
+  const std::vector<float> &weights() const { return weights_; }
+
+  /** Dense histogram with `numWords()` values, as stored in files. **/
+  std::vector<double> toDense() const;
+
+private:
+  void normalize();
+
+  int numWords_ = 0;
+  std::vector<uint32_t> words_;
+  std::vector<float> weights_;
+};
+
+/** Dot product of two sorted sparse histograms. **/
+double sparseDotProduct(const BowFeature &lhs, const BowFeature &rhs);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_BOW_FEATURE_H_
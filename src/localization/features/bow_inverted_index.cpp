@@ -0,0 +1,95 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/bow_inverted_index.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace localization::features {
+
+BowInvertedIndex::BowInvertedIndex(int numWords) : postings_(numWords) {}
+
+int BowInvertedIndex::add(const BowFeature &feature) {
+  CHECK_EQ(feature.numWords(), numWords())
+      << "The feature was computed with another vocabulary";
+  const int featureId = numFeatures_++;
+  for (int idx = 0; idx < feature.size(); ++idx) {
+    postings_[feature.words()[idx]].push_back(
+        {featureId, feature.weights()[idx]});
+  }
+  return featureId;
+}
+
+std::vector<std::pair<int, double>>
+BowInvertedIndex::score(const BowFeature &query) const {
+  CHECK_EQ(query.numWords(), numWords())
+      << "The query was computed with another vocabulary";
+  // The accumulator is all zeros between the calls, only the touched entries
+  // are read and reset, so no call pays for the size of the index.
+  thread_local std::vector<double> accumulator;
+  thread_local std::vector<int> touched;
+  if (static_cast<int>(accumulator.size()) < numFeatures_) {
+    accumulator.resize(numFeatures_, 0.0);
+  }
+  touched.clear();
+  for (int idx = 0; idx < query.size(); ++idx) {
+    const double queryWeight = query.weights()[idx];
+    for (const Posting &posting : postings_[query.words()[idx]]) {
+      if (accumulator[posting.featureId] == 0.0) {
+        touched.push_back(posting.featureId);
+      }
+      accumulator[posting.featureId] += queryWeight * posting.weight;
+    }
+  }
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+  std::vector<std::pair<int, double>> scores;
+  scores.reserve(touched.size());
+  for (int featureId : touched) {
+    scores.emplace_back(featureId, accumulator[featureId]);
+    accumulator[featureId] = 0.0;
+  }
+  return scores;
+}
+
+std::vector<std::pair<int, double>>
+BowInvertedIndex::topK(const BowFeature &query, int k) const {
+  std::vector<std::pair<int, double>> scores = score(query);
+  const auto moreSimilar = [](const std::pair<int, double> &lhs,
+                              const std::pair<int, double> &rhs) {
+    return lhs.second > rhs.second ||
+           (lhs.second == rhs.second && lhs.first < rhs.first);
+  };
+  if (static_cast<int>(scores.size()) > k) {
+    std::partial_sort(scores.begin(), scores.begin() + k, scores.end(),
+                      moreSimilar);
+    scores.resize(k);
+  } else {
+    std::sort(scores.begin(), scores.end(), moreSimilar);
+  }
+  return scores;
+}
+
+} // namespace localization::features
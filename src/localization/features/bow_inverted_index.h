@@ -0,0 +1,72 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_BOW_INVERTED_INDEX_H_
+#define SRC_FEATURES_BOW_INVERTED_INDEX_H_
+
+#include "features/bow_feature.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Inverted file over bag-of-words features: for every word the
+ * features that contain it, with their weights. A query only visits the lists
+ * of its own words, so scoring it against all features costs the total length
+ * of these lists instead of the number of features.
+ */
+class BowInvertedIndex {
+public:
+  explicit BowInvertedIndex(int numWords);
+
+  /** Adds the feature with the next id, 0 for the first one. **/
+  int add(const BowFeature &feature);
+  int size() const { return numFeatures_; }
+  int numWords() const { return postings_.size(); }
+
+  /**
+   * @brief      Cosine similarities of the query to all features that share
+   * at least one word with it, as (feature id, score) in increasing id
+   * order. The other features have a score of 0.
+   */
+  std::vector<std::pair<int, double>> score(const BowFeature &query) const;
+  /** The `k` most similar features, the most similar first. **/
+  std::vector<std::pair<int, double>> topK(const BowFeature &query,
+                                           int k) const;
+
+private:
+  struct Posting {
+    int featureId;
+    float weight;
+  };
+
+  std::vector<std::vector<Posting>> postings_;
+  int numFeatures_ = 0;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_BOW_INVERTED_INDEX_H_
@@ -0,0 +1,264 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/bow_vocabulary.h"
+#include "features/similarity_kernels.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace localization::features {
+
+namespace {
+constexpr char kMagic[8] = "ISLBOWV";
+constexpr uint32_t kVersion = 1;
+constexpr int kDescriptorBits = 64 * std::tuple_size<BinaryDescriptor>::value;
+
+int distance(const BinaryDescriptor &lhs, const BinaryDescriptor &rhs) {
+  return hammingDistance(lhs.data(), rhs.data(), lhs.size());
+}
+
+int closestWord(const std::vector<BinaryDescriptor> &words,
+                const BinaryDescriptor &descriptor) {
+  int closest = 0;
+  int closestDistance = std::numeric_limits<int>::max();
+  for (size_t word = 0; word < words.size(); ++word) {
+    const int wordDistance = distance(words[word], descriptor);
+    if (wordDistance < closestDistance) {
+      closestDistance = wordDistance;
+      closest = word;
+    }
+  }
+  return closest;
+}
+
+// Sets every bit that is set in more than half of the descriptors of a word.
+BinaryDescriptor majority(const int *bitCounts, int wordSize) {
+  BinaryDescriptor word = {};
+  for (int bit = 0; bit < kDescriptorBits; ++bit) {
+    if (2 * bitCounts[bit] > wordSize) {
+      word[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+  }
+  return word;
+}
+} // namespace
+
+std::shared_ptr<const BowVocabulary> BowVocabulary::train(
+    const std::vector<std::vector<BinaryDescriptor>> &descriptorsPerImage,
+    const BowVocabularyOptions &options) {
+  std::vector<BinaryDescriptor> descriptors;
+  for (const auto &imageDescriptors : descriptorsPerImage) {
+    descriptors.insert(descriptors.end(), imageDescriptors.begin(),
+                       imageDescriptors.end());
+  }
+  CHECK_GE(static_cast<int>(descriptors.size()), options.numWords)
+      << "Not enough descriptors to train " << options.numWords << " words";
+  std::mt19937 generator(options.seed);
+  if (static_cast<int>(descriptors.size()) > options.maxTrainingDescriptors) {
+    std::shuffle(descriptors.begin(), descriptors.end(), generator);
+    descriptors.resize(options.maxTrainingDescriptors);
+  }
+
+  std::shared_ptr<BowVocabulary> vocabulary(new BowVocabulary());
+  auto &words = vocabulary->words_;
+  // k-means++ seeding: every next word is drawn with a probability that
+  // grows with the squared distance to the closest word so far. Uniformly
+  // drawn words often start two words in one cluster and none in another.
+  std::uniform_int_distribution<int> randomDescriptor(0,
+                                                      descriptors.size() - 1);
+  words.push_back(descriptors[randomDescriptor(generator)]);
+  std::vector<double> minSquaredDistance(descriptors.size(),
+                                         std::numeric_limits<double>::max());
+  while (static_cast<int>(words.size()) < options.numWords) {
+    tools::parallelFor(
+        0, descriptors.size(),
+        [&](int idx) {
+          const double wordDistance = distance(words.back(), descriptors[idx]);
+          minSquaredDistance[idx] =
+              std::min(minSquaredDistance[idx], wordDistance * wordDistance);
+        },
+        options.numThreads);
+    const double total = std::accumulate(minSquaredDistance.begin(),
+                                         minSquaredDistance.end(), 0.0);
+    if (total == 0.0) {
+      // Fewer distinct descriptors than words, the rest stay duplicates.
+      words.push_back(descriptors[randomDescriptor(generator)]);
+      continue;
+    }
+    std::discrete_distribution<int> weighted(minSquaredDistance.begin(),
+                                             minSquaredDistance.end());
+    words.push_back(descriptors[weighted(generator)]);
+  }
+
+  std::vector<int> assignment(descriptors.size(), -1);
+  for (int iteration = 0; iteration < options.iterations; ++iteration) {
+    std::vector<char> changed(descriptors.size(), 0);
+    tools::parallelFor(
+        0, descriptors.size(),
+        [&](int idx) {
+          const int word = closestWord(words, descriptors[idx]);
+          changed[idx] = word != assignment[idx];
+          assignment[idx] = word;
+        },
+        options.numThreads);
+    const int numChanged = std::count(changed.begin(), changed.end(), 1);
+    LOG(INFO) << "Vocabulary iteration " << iteration << ": " << numChanged
+              << " descriptors changed their word.";
+    if (numChanged == 0) {
+      break;
+    }
+
+    std::vector<int> bitCounts(static_cast<size_t>(options.numWords) *
+                               kDescriptorBits);
+    std::vector<int> wordSizes(options.numWords, 0);
+    for (size_t idx = 0; idx < descriptors.size(); ++idx) {
+      int *counts = bitCounts.data() +
+                    static_cast<size_t>(assignment[idx]) * kDescriptorBits;
+      ++wordSizes[assignment[idx]];
+      for (int bit = 0; bit < kDescriptorBits; ++bit) {
+        counts[bit] += (descriptors[idx][bit / 64] >> (bit % 64)) & 1;
+      }
+    }
+    tools::parallelFor(
+        0, options.numWords,
+        [&](int word) {
+          if (wordSizes[word] > 0) {
+            words[word] = majority(bitCounts.data() +
+                                       static_cast<size_t>(word) *
+                                           kDescriptorBits,
+                                   wordSizes[word]);
+          }
+        },
+        options.numThreads);
+    // An empty word is restarted at a random descriptor.
+    for (int word = 0; word < options.numWords; ++word) {
+      if (wordSizes[word] == 0) {
+        words[word] = descriptors[randomDescriptor(generator)];
+      }
+    }
+  }
+
+  std::vector<int> imagesWithWord(options.numWords, 0);
+  for (const auto &imageDescriptors : descriptorsPerImage) {
+    std::vector<char> seen(options.numWords, 0);
+    for (const auto &descriptor : imageDescriptors) {
+      seen[vocabulary->quantize(descriptor)] = 1;
+    }
+    for (int word = 0; word < options.numWords; ++word) {
+      imagesWithWord[word] += seen[word];
+    }
+  }
+  const double numImages = descriptorsPerImage.size();
+  vocabulary->idf_.resize(options.numWords);
+  for (int word = 0; word < options.numWords; ++word) {
+    // A word no training image contains is as rare as it gets.
+    vocabulary->idf_[word] =
+        std::log(numImages / std::max(imagesWithWord[word], 1));
+  }
+  return vocabulary;
+}
+
+int BowVocabulary::quantize(const BinaryDescriptor &descriptor) const {
+  return closestWord(words_, descriptor);
+}
+
+std::unique_ptr<BowFeature> BowVocabulary::computeFeature(
+    const std::vector<BinaryDescriptor> &descriptors) const {
+  std::vector<uint32_t> words;
+  words.reserve(descriptors.size());
+  for (const auto &descriptor : descriptors) {
+    words.push_back(quantize(descriptor));
+  }
+  // The term frequency is normalized away with the feature, only the IDF
+  // weights of the occurrences matter.
+  std::vector<float> weights(words.size());
+  for (size_t idx = 0; idx < words.size(); ++idx) {
+    weights[idx] = idf_[words[idx]];
+  }
+  return std::make_unique<BowFeature>(numWords(), words, weights);
+}
+
+void BowVocabulary::save(const std::string &filename) const {
+  std::ofstream out(filename,
+                    std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !out) << "The file cannot be opened " << filename;
+  const int32_t sizes[2] = {numWords(), kDescriptorBits};
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+  out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+  out.write(reinterpret_cast<const char *>(words_.data()),
+            words_.size() * sizeof(BinaryDescriptor));
+  out.write(reinterpret_cast<const char *>(idf_.data()),
+            idf_.size() * sizeof(float));
+  LOG_IF(FATAL, !out) << "Failed to write the vocabulary " << filename;
+}
+
+std::shared_ptr<const BowVocabulary>
+BowVocabulary::load(const std::string &filename) {
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  LOG_IF(FATAL, !in) << "The vocabulary cannot be opened " << filename;
+  char magic[8] = {};
+  uint32_t version = 0;
+  int32_t sizes[2] = {0, 0};
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(sizes), sizeof(sizes));
+  LOG_IF(FATAL, !in || std::memcmp(magic, kMagic, sizeof(magic)) != 0)
+      << "Not a vocabulary: " << filename;
+  LOG_IF(FATAL, version != kVersion)
+      << "Unsupported vocabulary version " << version << " in " << filename;
+  LOG_IF(FATAL, sizes[1] != kDescriptorBits)
+      << "The vocabulary has " << sizes[1] << "-bit descriptors, expected "
+      << kDescriptorBits;
+  // The words must fit into the rest of the file before they are allocated,
+  // a damaged size would otherwise request gigabytes.
+  const std::streampos start = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::streamoff remaining = in.tellg() - start;
+  in.seekg(start);
+  LOG_IF(FATAL, sizes[0] <= 0 ||
+                    static_cast<uint64_t>(sizes[0]) >
+                        static_cast<uint64_t>(remaining) /
+                            (sizeof(BinaryDescriptor) + sizeof(float)))
+      << "Vocabulary is truncated or damaged: " << filename;
+  std::shared_ptr<BowVocabulary> vocabulary(new BowVocabulary());
+  vocabulary->words_.resize(sizes[0]);
+  vocabulary->idf_.resize(sizes[0]);
+  in.read(reinterpret_cast<char *>(vocabulary->words_.data()),
+          vocabulary->words_.size() * sizeof(BinaryDescriptor));
+  in.read(reinterpret_cast<char *>(vocabulary->idf_.data()),
+          vocabulary->idf_.size() * sizeof(float));
+  LOG_IF(FATAL, !in) << "Vocabulary is truncated: " << filename;
+  return vocabulary;
+}
+
+} // namespace localization::features
@@ -0,0 +1,89 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_BOW_VOCABULARY_H_
+#define SRC_FEATURES_BOW_VOCABULARY_H_
+
+#include "features/bow_feature.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+/** 256-bit binary keypoint descriptor, e.g. of ORB. **/
+using BinaryDescriptor = std::array<uint64_t, 4>;
+
+struct BowVocabularyOptions {
+  int numWords = 1000;
+  int iterations = 10;
+  // The words are trained on a random subset of the descriptors.
+  int maxTrainingDescriptors = 200000;
+  uint32_t seed = 0;
+  // <= 0 means all available threads.
+  int numThreads = 0;
+};
+
+/**
+ * @brief      Visual vocabulary of binary descriptors with the inverse
+ * document frequency (IDF) of every word. Turns the descriptors of an image
+ * into a TF-IDF weighted BowFeature.
+ */
+class BowVocabulary {
+public:
+  /**
+   * @brief      Clusters the descriptors with k-means in Hamming space
+   * (k-majority): every descriptor is assigned to the closest word, every word
+   * becomes the bitwise majority of its descriptors. The IDF of a word is
+   * log(N / n), where n of the N training images contain the word.
+   */
+  static std::shared_ptr<const BowVocabulary>
+  train(const std::vector<std::vector<BinaryDescriptor>> &descriptorsPerImage,
+        const BowVocabularyOptions &options = {});
+
+  static std::shared_ptr<const BowVocabulary> load(const std::string &filename);
+  void save(const std::string &filename) const;
+
+  int numWords() const { return words_.size(); }
+  const BinaryDescriptor &word(int id) const { return words_[id]; }
+  float idf(int id) const { return idf_[id]; }
+
+  /** Id of the word closest to the descriptor by the Hamming distance. **/
+  int quantize(const BinaryDescriptor &descriptor) const;
+  /** TF-IDF histogram of the descriptors of one image. **/
+  std::unique_ptr<BowFeature>
+  computeFeature(const std::vector<BinaryDescriptor> &descriptors) const;
+
+private:
+  BowVocabulary() = default;
+
+  std::vector<BinaryDescriptor> words_;
+  std::vector<float> idf_;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_BOW_VOCABULARY_H_
@@ -24,11 +24,12 @@
 /* Updated by O. Vysotska in 2022 */
 
 #include "cnn_feature.h"
+#include "features/feature_io.h"
+#include "features/feature_traits.h"
 #include "features/ifeature.h"
-#include "localization_protos.pb.h"
+#include "features/similarity_kernels.h"
 
 #include <algorithm>
-#include <fstream>
 #include <limits>
 #include <math.h>
 #include <numeric>
@@ -37,18 +38,16 @@
 
 namespace localization::features {
 
-CnnFeature::CnnFeature(const std::string &filename) {
-  GOOGLE_PROTOBUF_VERIFY_VERSION;
-  image_sequence_localizer::Feature feature_proto;
-  std::fstream input(filename, std::ios::in | std::ios::binary);
-  if (!feature_proto.ParseFromIstream(&input)) {
-    LOG(FATAL) << "Failed to parse feature_proto file: " << filename;
-  }
+CnnFeature::CnnFeature(const std::string &filename)
+    : CnnFeature(readFeatureValues(filename)) {}
 
-  for (int idx = 0; idx < feature_proto.values_size(); ++idx) {
-    dimensions.push_back(feature_proto.values(idx));
-  }
+CnnFeature::CnnFeature(const std::vector<double> &values) {
+  dimensions = values;
   binarize();
+  normalize();
+  // Only the bits and the normalized values are used from here on.
+  dimensions.clear();
+  dimensions.shrink_to_fit();
   type = "CnnFeature";
 }
 
@@ -72,24 +71,23 @@ void CnnFeature::binarize() {
   }
 }
 
+void CnnFeature::normalize() {
+  const double norm = std::sqrt(std::inner_product(
+      dimensions.begin(), dimensions.end(), dimensions.begin(), 0.0L));
+  normalized_.resize(dimensions.size());
+  for (size_t d = 0; d < dimensions.size(); ++d) {
+    // A zero feature stays zero and is not similar to anything.
+    normalized_[d] = norm > 0.0 ? dimensions[d] / norm : 0.f;
+  }
+}
+
 double CnnFeature::computeSimilarityScore(const iFeature &rhs) const {
   CHECK(this->type == rhs.type) << "Features are not the same type";
-  double norm_qr = std::sqrt(std::inner_product(
-      dimensions.begin(), dimensions.end(), dimensions.begin(), 0.0L));
-  double norm_db =
-      std::sqrt(std::inner_product(rhs.dimensions.begin(), rhs.dimensions.end(),
-                                   rhs.dimensions.begin(), 0.0L));
-  double prod_qr_db = std::inner_product(
-      rhs.dimensions.begin(), rhs.dimensions.end(), dimensions.begin(), 0.0L);
-  double cos_similarity = prod_qr_db / (norm_qr * norm_db);
-  return cos_similarity;
+  const auto &other = static_cast<const CnnFeature &>(rhs);
+  return FeatureTraits<CnnFeature>::score(*this, other);
 }
 
 double CnnFeature::score2cost(double score) const {
-  if (score < 1e-09) {
-    printf("[INFO] The cost of comparing two images is suspiciously small.\n");
-    return std::numeric_limits<double>::max();
-  }
-  return 1. / score;
+  return FeatureTraits<CnnFeature>::cost(score);
 }
 } // namespace localization::features
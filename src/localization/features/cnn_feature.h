@@ -23,6 +23,7 @@
 
 #ifndef SRC_FEATURES_CNNFEATURE_H_
 #define SRC_FEATURES_CNNFEATURE_H_
+#include "features/aligned_allocator.h"
 #include "features/ifeature.h"
 #include <string>
 #include <vector>
@@ -36,9 +37,11 @@ namespace localization::features {
 class CnnFeature : public iFeature {
 public:
   CnnFeature(const std::string &filename);
+  explicit CnnFeature(const std::vector<double> &values);
 
-  // Computes the cosine similarity between two vectors.
-  // The higher the score the more similar the features are.
+  // Computes the cosine similarity between two vectors as the dot product of
+  // the normalized values. The higher the score the more similar the features
+  // are.
   double computeSimilarityScore(const iFeature &rhs) const override;
   /**
    * @brief      weight/cost is an inverse of a score.
@@ -50,11 +53,25 @@ public:
    */
   double score2cost(double score) const override;
 
+  size_t memoryBytes() const override {
+    return iFeature::memoryBytes() + normalized_.capacity() * sizeof(float);
+  }
+
+  // The normalized values, see FeatureTraits<CnnFeature>.
+  const float *data() const { return normalized_.data(); }
+  int size() const { return normalized_.size(); }
+
   using iFeature::bits;
   using iFeature::dimensions;
 
 protected:
   void binarize();
+  void normalize();
+
+private:
+  // L2-normalized float32 copy of the values, computed once at load. The
+  // double values are released after it is computed.
+  AlignedFloatVector normalized_;
 };
 
 } // namespace localization::features
@@ -0,0 +1,97 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/concurrent_feature_buffer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+
+namespace localization::features {
+
+ConcurrentFeatureBuffer::ConcurrentFeatureBuffer(int size, int numShards)
+    : shards_(std::max(numShards, 1)) {
+  LOG_IF(FATAL, size < 0) << "Invalid featureBuffer size.";
+  const int shardCount = shards_.size();
+  shardCapacity_ = std::max(1, (size + shardCount - 1) / shardCount);
+}
+
+ConcurrentFeatureBuffer::Shard &ConcurrentFeatureBuffer::shardOf(int id) {
+  // Consecutive ids, e.g. the references along a path, go to different
+  // shards and do not contend for the same lock.
+  return shards_[static_cast<unsigned>(id) % shards_.size()];
+}
+
+std::shared_ptr<const iFeature> ConcurrentFeatureBuffer::findFeature(int id) {
+  Shard &shard = shardOf(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.features.find(id);
+  if (found == shard.features.end()) {
+    ++shard.stats.misses;
+    return nullptr;
+  }
+  ++shard.stats.hits;
+  shard.lru.splice(shard.lru.end(), shard.lru, found->second.lruPos);
+  return found->second.feature;
+}
+
+std::shared_ptr<const iFeature>
+ConcurrentFeatureBuffer::addFeature(int id, std::unique_ptr<iFeature> feature) {
+  Shard &shard = shardOf(id);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto found = shard.features.find(id);
+  if (found != shard.features.end()) {
+    return found->second.feature;
+  }
+  while (static_cast<int>(shard.features.size()) >= shardCapacity_) {
+    shard.features.erase(shard.lru.front());
+    shard.lru.pop_front();
+    ++shard.stats.evictions;
+  }
+  Entry entry;
+  entry.feature = std::move(feature);
+  entry.lruPos = shard.lru.insert(shard.lru.end(), id);
+  return shard.features.emplace(id, std::move(entry)).first->second.feature;
+}
+
+int ConcurrentFeatureBuffer::size() const {
+  int size = 0;
+  for (const Shard &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    size += shard.features.size();
+  }
+  return size;
+}
+
+FeatureBufferStats ConcurrentFeatureBuffer::stats() const {
+  FeatureBufferStats total;
+  for (const Shard &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total.hits += shard.stats.hits;
+    total.misses += shard.stats.misses;
+    total.evictions += shard.stats.evictions;
+  }
+  return total;
+}
+
+} // namespace localization::features
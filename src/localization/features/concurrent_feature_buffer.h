@@ -0,0 +1,78 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_CONCURRENT_FEATURE_BUFFER_H_
+#define SRC_FEATURES_CONCURRENT_FEATURE_BUFFER_H_
+
+#include "features/feature_buffer.h"
+#include "features/ifeature.h"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Thread-safe counterpart of FeatureBuffer. The features are
+ * split between independently locked shards, each evicting its least
+ * recently used feature. Features are handed out as shared pointers, so a
+ * feature evicted by one thread stays valid for the threads still using it.
+ */
+class ConcurrentFeatureBuffer {
+public:
+  ConcurrentFeatureBuffer(int size, int numShards = 16);
+
+  /** Returns nullptr if the feature is not in the buffer. */
+  std::shared_ptr<const iFeature> findFeature(int id);
+  /** If another thread added the same feature in the meantime, its copy is
+   * kept and returned. */
+  std::shared_ptr<const iFeature> addFeature(int id,
+                                             std::unique_ptr<iFeature> feature);
+
+  int size() const;
+  FeatureBufferStats stats() const;
+
+private:
+  struct Entry {
+    std::shared_ptr<const iFeature> feature;
+    std::list<int>::iterator lruPos;
+  };
+  struct Shard {
+    mutable std::mutex mutex;
+    std::list<int> lru;
+    std::unordered_map<int, Entry> features;
+    FeatureBufferStats stats;
+  };
+
+  Shard &shardOf(int id);
+
+  int shardCapacity_ = 1;
+  std::vector<Shard> shards_;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_CONCURRENT_FEATURE_BUFFER_H_
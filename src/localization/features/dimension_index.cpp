@@ -0,0 +1,178 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/dimension_index.h"
+#include "features/similarity_kernels.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace localization::features {
+
+namespace {
+void appendVarint(uint32_t value, std::vector<uint8_t> *bytes) {
+  while (value >= 0x80) {
+    bytes->push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  bytes->push_back(static_cast<uint8_t>(value));
+}
+
+// Calls `visit` with every feature id of a delta-encoded list.
+template <class Visit>
+void forEachId(const std::vector<uint8_t> &deltas, Visit visit) {
+  int id = -1;
+  size_t pos = 0;
+  while (pos < deltas.size()) {
+    uint32_t delta = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+      byte = deltas[pos++];
+      delta |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    id += delta;
+    visit(id);
+  }
+}
+
+int roundUpTo64(int value) { return (value + 63) / 64 * 64; }
+} // namespace
+
+DimensionIndex::DimensionIndex(int numDimensions) : lists_(numDimensions) {
+  CHECK(numDimensions > 0 &&
+        numDimensions <= std::numeric_limits<uint16_t>::max())
+      << "The index supports 1 to 65535 dimensions, got " << numDimensions;
+}
+
+void DimensionIndex::append(PostingList *list, int featureId) {
+  if (!list->bitmap.empty()) {
+    list->bitmap.resize(featureId / 64 + 1, 0);
+    list->bitmap[featureId / 64] |= uint64_t{1} << (featureId % 64);
+    list->lastId = featureId;
+    return;
+  }
+  appendVarint(featureId - list->lastId, &list->deltas);
+  list->lastId = featureId;
+  const size_t bitmapBytes = (featureId / 64 + 1) * sizeof(uint64_t);
+  if (list->deltas.size() > bitmapBytes) {
+    list->bitmap.assign(featureId / 64 + 1, 0);
+    forEachId(list->deltas, [list](int id) {
+      list->bitmap[id / 64] |= uint64_t{1} << (id % 64);
+    });
+    list->deltas = {};
+  }
+}
+
+int DimensionIndex::add(const std::vector<int> &activeDimensions) {
+  std::vector<int> dimensions = activeDimensions;
+  std::sort(dimensions.begin(), dimensions.end());
+  dimensions.erase(std::unique(dimensions.begin(), dimensions.end()),
+                   dimensions.end());
+  const int featureId = numFeatures_++;
+  for (int d : dimensions) {
+    CHECK(d >= 0 && d < numDimensions())
+        << "Dimension " << d << " is outside the index of "
+        << numDimensions() << " dimensions";
+    append(&lists_[d], featureId);
+  }
+  return featureId;
+}
+
+void DimensionIndex::vote(const std::vector<int> &activeDimensions,
+                          std::vector<uint16_t> *votes) const {
+  votes->assign(roundUpTo64(numFeatures_), 0);
+  for (int d : activeDimensions) {
+    CHECK(d >= 0 && d < numDimensions())
+        << "Dimension " << d << " is outside the index of "
+        << numDimensions() << " dimensions";
+    const PostingList &list = lists_[d];
+    if (!list.bitmap.empty()) {
+      addBitmapVotes(list.bitmap.data(), list.bitmap.size(), votes->data());
+    } else {
+      forEachId(list.deltas, [votes](int id) { ++(*votes)[id]; });
+    }
+  }
+}
+
+std::vector<std::pair<int, int>>
+DimensionIndex::topK(const std::vector<int> &activeDimensions, int k) const {
+  // Reused between the calls, the query does not allocate.
+  thread_local std::vector<uint16_t> votes;
+  vote(activeDimensions, &votes);
+  const int maxVotes =
+      numFeatures_ == 0
+          ? 0
+          : *std::max_element(votes.begin(), votes.begin() + numFeatures_);
+  if (maxVotes == 0 || k <= 0) {
+    return {};
+  }
+  // Counting selection: the lowest number of votes that still makes it into
+  // the k best, found from a histogram of the votes in one pass.
+  std::vector<int> histogram(maxVotes + 1, 0);
+  for (int f = 0; f < numFeatures_; ++f) {
+    ++histogram[votes[f]];
+  }
+  int threshold = maxVotes;
+  int selected = histogram[maxVotes];
+  while (selected < k && threshold > 1) {
+    --threshold;
+    selected += histogram[threshold];
+  }
+  int tiesLeft = k - (selected - histogram[threshold]);
+  std::vector<std::pair<int, int>> result;
+  result.reserve(std::min(selected, k));
+  for (int f = 0; f < numFeatures_; ++f) {
+    if (votes[f] > threshold) {
+      result.emplace_back(f, votes[f]);
+    } else if (votes[f] == threshold && tiesLeft > 0) {
+      result.emplace_back(f, votes[f]);
+      --tiesLeft;
+    }
+  }
+  std::sort(result.begin(), result.end(),
+            [](const std::pair<int, int> &lhs, const std::pair<int, int> &rhs) {
+              return lhs.second > rhs.second ||
+                     (lhs.second == rhs.second && lhs.first < rhs.first);
+            });
+  return result;
+}
+
+size_t DimensionIndex::memoryBytes() const {
+  size_t bytes = lists_.capacity() * sizeof(PostingList);
+  for (const PostingList &list : lists_) {
+    bytes += list.deltas.capacity() + list.bitmap.capacity() * sizeof(uint64_t);
+  }
+  return bytes;
+}
+
+int DimensionIndex::numBitmapLists() const {
+  return std::count_if(
+      lists_.begin(), lists_.end(),
+      [](const PostingList &list) { return !list.bitmap.empty(); });
+}
+
+} // namespace localization::features
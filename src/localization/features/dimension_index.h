@@ -0,0 +1,93 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_DIMENSION_INDEX_H_
+#define SRC_FEATURES_DIMENSION_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Inverted index from the dimensions of binary features to the
+ * features that have a 1 in them, the index of Dimension Hashing. A query
+ * votes for every feature in the lists of its active dimensions, the features
+ * with the most votes share the most active dimensions with it.
+ *
+ * Every posting list is stored in the smaller of two encodings: the
+ * differences of the increasing feature ids as variable-length bytes, for
+ * rare dimensions, or a bitmap over all feature ids, for frequent ones. The
+ * votes of a bitmap are added with the SIMD kernels of addBitmapVotes(). A
+ * list switches to a bitmap once that is smaller, features can be added at
+ * any time.
+ */
+class DimensionIndex {
+public:
+  /** At most 65535 dimensions, the votes are counted in 16 bits. **/
+  explicit DimensionIndex(int numDimensions);
+
+  /** Adds the feature with the given active dimensions, in any order, as the
+   * next id, 0 for the first one. **/
+  int add(const std::vector<int> &activeDimensions);
+  int size() const { return numFeatures_; }
+  int numDimensions() const { return lists_.size(); }
+
+  /**
+   * @brief      Counts for every feature how many of the distinct query
+   * dimensions are active in it. `votes` is resized to size() rounded up to
+   * a multiple of 64, the entries after size() are 0.
+   */
+  void vote(const std::vector<int> &activeDimensions,
+            std::vector<uint16_t> *votes) const;
+  /** The `k` features with the most votes as (feature id, votes), the most
+   * voted first and ties by increasing id. Features without votes are never
+   * returned. **/
+  std::vector<std::pair<int, int>>
+  topK(const std::vector<int> &activeDimensions, int k) const;
+
+  /** Bytes held by the posting lists. **/
+  size_t memoryBytes() const;
+  /** Number of posting lists stored as bitmaps. **/
+  int numBitmapLists() const;
+
+private:
+  struct PostingList {
+    // Either the varint-encoded id differences or the bitmap is used, an
+    // empty bitmap means the list is delta-encoded.
+    std::vector<uint8_t> deltas;
+    std::vector<uint64_t> bitmap;
+    int lastId = -1;
+  };
+
+  void append(PostingList *list, int featureId);
+
+  std::vector<PostingList> lists_;
+  int numFeatures_ = 0;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_DIMENSION_INDEX_H_
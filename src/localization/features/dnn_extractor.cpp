@@ -0,0 +1,175 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/dnn_extractor.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <utility>
+
+namespace localization::features {
+
+namespace {
+double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+} // namespace
+
+DnnExtractor::DnnExtractor(const DnnExtractorOptions &options)
+    : options_{options} {
+  LOG_IF(FATAL, options_.modelFile.empty()) << "The DNN model is not set.";
+  CHECK(options_.inputWidth > 0 && options_.inputHeight > 0)
+      << "The input size should be positive.";
+  CHECK_GT(options_.batchSize, 0) << "The batch size should be positive.";
+  net_ = cv::dnn::readNetFromONNX(options_.modelFile);
+  LOG_IF(FATAL, net_.empty()) << "The model cannot be read "
+                              << options_.modelFile;
+  net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+  net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+}
+
+void DnnExtractor::preprocess(const std::vector<std::string> &imageFiles,
+                              int begin, int end, cv::Mat &blob) const {
+  const int width = options_.inputWidth;
+  const int height = options_.inputHeight;
+  const int sizes[] = {end - begin, 3, height, width};
+  blob.create(4, sizes, CV_32F);
+  const size_t planeSize = static_cast<size_t>(width) * height;
+  tools::parallelFor(
+      begin, end,
+      [&](int idx) {
+        const cv::Mat image = cv::imread(imageFiles[idx], cv::IMREAD_COLOR);
+        LOG_IF(FATAL, image.empty())
+            << "The image cannot be read " << imageFiles[idx];
+        cv::Mat resized;
+        cv::resize(image, resized, cv::Size(width, height), 0, 0,
+                   cv::INTER_AREA);
+        float *planes = blob.ptr<float>(idx - begin);
+        for (int c = 0; c < 3; ++c) {
+          // The images are read as BGR, the networks expect RGB.
+          const int channel = 2 - c;
+          const float scale = 1.f / (255.f * options_.std[c]);
+          const float offset = -options_.mean[c] / options_.std[c];
+          float *plane = planes + c * planeSize;
+          for (int y = 0; y < height; ++y) {
+            const uchar *row = resized.ptr<uchar>(y);
+            for (int x = 0; x < width; ++x) {
+              plane[y * width + x] = row[3 * x + channel] * scale + offset;
+            }
+          }
+        }
+      },
+      options_.numThreads);
+}
+
+std::vector<float>
+DnnExtractor::extract(const std::vector<std::string> &imageFiles) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<float> descriptors;
+  const int numImages = imageFiles.size();
+  const int numBatches =
+      (numImages + options_.batchSize - 1) / options_.batchSize;
+  const auto preprocessBatch = [&](int batch) {
+    const auto batchStart = std::chrono::steady_clock::now();
+    cv::Mat blob;
+    preprocess(imageFiles, batch * options_.batchSize,
+               std::min(numImages, (batch + 1) * options_.batchSize), blob);
+    return std::make_pair(blob, secondsSince(batchStart));
+  };
+
+  std::future<std::pair<cv::Mat, double>> nextBatch;
+  if (numBatches > 0) {
+    nextBatch = std::async(std::launch::async, preprocessBatch, 0);
+  }
+  for (int batch = 0; batch < numBatches; ++batch) {
+    const auto [blob, seconds] = nextBatch.get();
+    stats_.preprocessingSeconds += seconds;
+    // The next batch is prepared while the network runs on this one.
+    if (batch + 1 < numBatches) {
+      nextBatch = std::async(std::launch::async, preprocessBatch, batch + 1);
+    }
+    const auto inferenceStart = std::chrono::steady_clock::now();
+    net_.setInput(blob);
+    const cv::Mat output = net_.forward();
+    stats_.inferenceSeconds += secondsSince(inferenceStart);
+
+    const int rows = blob.size[0];
+    CHECK(output.type() == CV_32F && output.isContinuous())
+        << "The model should output float32 descriptors";
+    CHECK(output.dims >= 1 && output.size[0] == rows)
+        << "The model should output one descriptor per image, is the batch "
+           "dimension of "
+        << options_.modelFile << " dynamic?";
+    const int dim = output.total() / rows;
+    if (dim_ == 0) {
+      dim_ = dim;
+    }
+    CHECK_EQ(dim, dim_) << "The descriptor size changed between the batches";
+    const float *values = output.ptr<float>();
+    descriptors.insert(descriptors.end(), values, values + output.total());
+  }
+  stats_.images += numImages;
+  stats_.totalSeconds += secondsSince(start);
+  return descriptors;
+}
+
+std::shared_ptr<const FeatureStore>
+DnnExtractor::extractFeatureStore(const std::vector<std::string> &imageFiles,
+                                  const Projection *projection) {
+  LOG_IF(FATAL, imageFiles.empty()) << "No images to extract features from.";
+  std::vector<float> descriptors = extract(imageFiles);
+  int dim = dim_;
+  if (projection) {
+    CHECK_EQ(projection->inputDim(), dim_)
+        << "The projection does not fit the descriptors of "
+        << options_.modelFile;
+    dim = projection->outputDim();
+    std::vector<float> projected(imageFiles.size() * dim);
+    tools::parallelFor(
+        0, imageFiles.size(),
+        [&](int idx) {
+          projection->apply(descriptors.data() + idx * dim_,
+                            projected.data() + idx * dim);
+        },
+        options_.numThreads);
+    descriptors.swap(projected);
+  }
+  std::vector<std::string> names;
+  names.reserve(imageFiles.size());
+  for (const auto &file : imageFiles) {
+    names.push_back(std::filesystem::path(file).filename().string());
+  }
+  return FeatureStore::fromValues(options_.modelFile, names, descriptors, dim);
+}
+
+} // namespace localization::features
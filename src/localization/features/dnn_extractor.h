@@ -0,0 +1,107 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_DNN_EXTRACTOR_H_
+#define SRC_FEATURES_DNN_EXTRACTOR_H_
+
+#include "features/feature_store.h"
+#include "features/projection.h"
+
+#include <opencv2/dnn.hpp>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+struct DnnExtractorOptions {
+  // ONNX model that maps a batch of N x 3 x height x width images to N
+  // descriptors. The batch dimension has to be dynamic.
+  std::string modelFile;
+  int inputWidth = 224;
+  int inputHeight = 224;
+  // Every pixel is scaled to [0, 1] in RGB order, then normalized per
+  // channel as (value - mean) / std.
+  std::array<float, 3> mean = {0.f, 0.f, 0.f};
+  std::array<float, 3> std = {1.f, 1.f, 1.f};
+  int batchSize = 16;
+  // Threads that read and preprocess the images, <= 0 means all.
+  int numThreads = 0;
+};
+
+struct DnnExtractionStats {
+  int images = 0;
+  double preprocessingSeconds = 0.0;
+  double inferenceSeconds = 0.0;
+  double totalSeconds = 0.0;
+
+  double imagesPerSecond() const {
+    return totalSeconds > 0.0 ? images / totalSeconds : 0.0;
+  }
+};
+
+/**
+ * @brief      Computes global image descriptors with a CNN in this process,
+ * on the CPU through the OpenCV DNN module. The images of a batch are read
+ * and preprocessed in parallel, while the network runs on the previous
+ * batch.
+ */
+class DnnExtractor {
+public:
+  explicit DnnExtractor(const DnnExtractorOptions &options);
+
+  /**
+   * @brief      The descriptors of the images, one row of `dim()` values per
+   * image in the order of the files. Dies if an image cannot be read.
+   */
+  std::vector<float> extract(const std::vector<std::string> &imageFiles);
+  /**
+   * @brief      Extracts the descriptors into a store in memory that an
+   * OnlineDatabase reads directly. The features are named after the images.
+   * If `projection` is set, the store holds the projected descriptors.
+   */
+  std::shared_ptr<const FeatureStore>
+  extractFeatureStore(const std::vector<std::string> &imageFiles,
+                      const Projection *projection = nullptr);
+
+  // Size of the descriptors, known after the first batch.
+  int dim() const { return dim_; }
+  // Accumulated over all the calls.
+  const DnnExtractionStats &stats() const { return stats_; }
+
+private:
+  // Fills `blob` with the preprocessed images [begin, end).
+  void preprocess(const std::vector<std::string> &imageFiles, int begin,
+                  int end, cv::Mat &blob) const;
+
+  DnnExtractorOptions options_;
+  cv::dnn::Net net_;
+  int dim_ = 0;
+  DnnExtractionStats stats_;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_DNN_EXTRACTOR_H_
@@ -24,40 +24,124 @@
 #include "feature_buffer.h"
 #include "features/ifeature.h"
 
-#include <iostream>
-#include <limits>
-
 #include <glog/logging.h>
 
+#include <algorithm>
+
 namespace localization::features {
 
-FeatureBuffer::FeatureBuffer(int size) {
+FeatureBuffer::FeatureBuffer(int size, size_t byteBudget)
+    : byteBudget_{byteBudget} {
   LOG_IF(FATAL, size < 0) << "Invalid featureBuffer size.";
   bufferSize = size;
-  featureMap.reserve(size);
+  featureMap_.reserve(size);
 }
 
-bool FeatureBuffer::inBuffer(int id) const { return featureMap.count(id) > 0; }
+bool FeatureBuffer::inBuffer(int id) const {
+  return featureMap_.count(id) > 0;
+}
 
-const iFeature &FeatureBuffer::getFeature(int id) const {
-  return *featureMap.at(id);
+const iFeature &FeatureBuffer::getFeature(int id) {
+  Entry &entry = featureMap_.at(id);
+  touch(entry);
+  return *entry.feature;
 }
 
-/** internal function. deletes the first added feature from the buffer **/
-void FeatureBuffer::deleteFeature() {
-  featureMap.erase(ids[0]);
-  ids.erase(ids.begin());
+const iFeature *FeatureBuffer::findFeature(int id) {
+  auto iter = featureMap_.find(id);
+  if (iter == featureMap_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  ++stats_.hits;
+  touch(iter->second);
+  return iter->second.feature.get();
+}
+
+void FeatureBuffer::touch(Entry &entry) {
+  if (entry.pins == 0) {
+    lru_.splice(lru_.end(), lru_, entry.lruPos);
+  }
+}
+
+int FeatureBuffer::capacity() const {
+  // The feature that was just added always stays in the buffer.
+  return std::max(bufferSize, 1);
+}
+
+bool FeatureBuffer::evictOne() {
+  if (lru_.empty()) {
+    return false;
+  }
+  auto iter = featureMap_.find(lru_.front());
+  bytes_ -= iter->second.bytes;
+  featureMap_.erase(iter);
+  lru_.pop_front();
+  ++stats_.evictions;
+  return true;
 }
 
 void FeatureBuffer::addFeature(int id, std::unique_ptr<iFeature> &&feature) {
+  auto existing = featureMap_.find(id);
+  if (existing != featureMap_.end()) {
+    LOG(WARNING) << "Feature with id " << id << " exists. Overwriting..";
+    bytes_ -= existing->second.bytes;
+    existing->second.bytes = feature->memoryBytes();
+    existing->second.feature = std::move(feature);
+    bytes_ += existing->second.bytes;
+    touch(existing->second);
+    return;
+  }
+  while (static_cast<int>(featureMap_.size()) >= capacity() && evictOne()) {
+  }
+  Entry entry;
+  entry.bytes = feature->memoryBytes();
+  entry.feature = std::move(feature);
+  entry.lruPos = lru_.insert(lru_.end(), id);
+  bytes_ += entry.bytes;
+  featureMap_.emplace(id, std::move(entry));
+  // The new feature itself is never evicted to fit the byte budget, it is
+  // about to be used.
+  while (byteBudget_ > 0 && bytes_ > byteBudget_ && lru_.front() != id &&
+         evictOne()) {
+  }
+  LOG_IF(WARNING, static_cast<int>(featureMap_.size()) > capacity())
+      << "All the features in the buffer are pinned, it grows beyond "
+      << capacity() << " features.";
+}
+
+void FeatureBuffer::pin(int id) {
+  Entry &entry = featureMap_.at(id);
+  if (entry.pins++ == 0) {
+    lru_.erase(entry.lruPos);
+  }
+}
+
+void FeatureBuffer::unpin(int id) {
+  Entry &entry = featureMap_.at(id);
+  CHECK(entry.pins > 0) << "Feature " << id << " is not pinned.";
+  if (--entry.pins == 0) {
+    entry.lruPos = lru_.insert(lru_.end(), id);
+  }
+}
+
+void FeatureBuffer::setByteBudget(size_t byteBudget) {
+  byteBudget_ = byteBudget;
+  while (byteBudget_ > 0 && bytes_ > byteBudget_ && evictOne()) {
+  }
+}
 
-  if (static_cast<int>(ids.size()) == bufferSize) {
-    deleteFeature();
+std::vector<int> FeatureBuffer::ids() const {
+  std::vector<int> ids(lru_.begin(), lru_.end());
+  // Pinned features are not in lru_, they follow in a stable order.
+  const size_t numUnpinned = ids.size();
+  for (const auto &[id, entry] : featureMap_) {
+    if (entry.pins > 0) {
+      ids.push_back(id);
+    }
   }
-  ids.push_back(id);
-  LOG_IF(WARNING, featureMap.count(id) > 0)
-      << "Feature with id " << id << " exists. Overwriting..";
-  featureMap.emplace(id, std::move(feature));
+  std::sort(ids.begin() + numUnpinned, ids.end());
+  return ids;
 }
 
 } // namespace localization::features
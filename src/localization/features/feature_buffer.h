@@ -25,30 +25,76 @@
 #define SRC_FEATURES_FEATURE_BUFFER_H_
 
 #include "ifeature.h"
+
+#include <cstddef>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 namespace localization::features {
 
+struct FeatureBufferStats {
+  int hits = 0;
+  int misses = 0;
+  int evictions = 0;
+};
+
 /**
  * @brief      Class for feature buffer. Stores the features kept in memory
- * during the search
+ * during the search. When full, the least recently used feature that is not
+ * pinned is evicted. The capacity is a number of features and optionally a
+ * memory budget in bytes, whichever is reached first.
  */
 class FeatureBuffer {
 public:
-  FeatureBuffer(int size);
+  /** byteBudget of 0 means that only the number of features is limited. */
+  FeatureBuffer(int size, size_t byteBudget = 0);
   bool inBuffer(int id) const;
-  /** returns empty vector if a feature is not in buffer */
-  const iFeature &getFeature(int id) const;
+  /** Marks the feature as recently used. The feature must be in the buffer. */
+  const iFeature &getFeature(int id);
+  /** Returns nullptr if the feature is not in the buffer. Counts towards the
+   * hit/miss statistics. */
+  const iFeature *findFeature(int id);
   void addFeature(int id, std::unique_ptr<iFeature> &&feature);
 
-  void deleteFeature();
+  /** Pinned features are never evicted. Pins are counted, every pin needs a
+   * matching unpin. */
+  void pin(int id);
+  void unpin(int id);
+
+  void setByteBudget(size_t byteBudget);
+
+  int size() const { return static_cast<int>(featureMap_.size()); }
+  size_t bytes() const { return bytes_; }
+  /** All buffered feature ids: the unpinned ones from the least to the most
+   * recently used, i.e. in eviction order, then the pinned ones in ascending
+   * order. */
+  std::vector<int> ids() const;
+  const FeatureBufferStats &stats() const { return stats_; }
 
-  // this is needed to remember which feature came first.
   int bufferSize = -1;
-  std::vector<int> ids;
-  std::unordered_map<int, std::unique_ptr<iFeature>> featureMap;
+
+private:
+  struct Entry {
+    std::unique_ptr<iFeature> feature;
+    // Position in lru_, only valid if the feature is not pinned.
+    std::list<int>::iterator lruPos;
+    size_t bytes = 0;
+    int pins = 0;
+  };
+
+  void touch(Entry &entry);
+  int capacity() const;
+  // Evicts the least recently used unpinned feature. Returns false if every
+  // feature in the buffer is pinned.
+  bool evictOne();
+
+  size_t byteBudget_ = 0;
+  size_t bytes_ = 0;
+  std::list<int> lru_;
+  std::unordered_map<int, Entry> featureMap_;
+  FeatureBufferStats stats_;
 };
 
 } // namespace localization::features
@@ -22,19 +22,104 @@
 **/
 
 #include "feature_factory.h"
+#include "binary_feature.h"
+#include "bow_feature.h"
 #include "cnn_feature.h"
+#include "int8_feature.h"
+#include "patch_feature.h"
+#include "features/feature_io.h"
+#include "features/projection.h"
 
 #include <glog/logging.h>
 
+#include <utility>
+
 namespace localization::features {
 
+namespace {
+const std::vector<std::pair<FeatureType, std::string>> kFeatureTypeNames = {
+    {Cnn_Feature, "Cnn_Feature"},
+    {Binary_Feature_Mid, "Binary_Feature_Mid"},
+    {Binary_Feature_Mean, "Binary_Feature_Mean"},
+    {Binary_Feature_Median, "Binary_Feature_Median"},
+    {Int8_Feature, "Int8_Feature"},
+    {Bow_Feature, "Bow_Feature"},
+    {Patch_Feature, "Patch_Feature"},
+};
+} // namespace
+
+std::unique_ptr<iFeature> createFeature(FeatureType type,
+                                        const std::string &featureFilename,
+                                        const Projection *projection) {
+  if (projection) {
+    return createFeature(
+        type, projection->apply(readFeatureValues(featureFilename)));
+  }
+  return createFeature(type, readFeatureValues(featureFilename));
+}
+
 std::unique_ptr<iFeature> createFeature(FeatureType type,
-                                        const std::string &featureFilename) {
+                                        const std::vector<double> &values) {
   switch (type) {
   case Cnn_Feature: {
-    return std::make_unique<CnnFeature>(featureFilename);
+    return std::make_unique<CnnFeature>(values);
+  }
+  case Binary_Feature_Mid: {
+    return std::make_unique<BinaryFeature>(values, Binarization::Mid);
+  }
+  case Binary_Feature_Mean: {
+    return std::make_unique<BinaryFeature>(values, Binarization::Mean);
+  }
+  case Binary_Feature_Median: {
+    return std::make_unique<BinaryFeature>(values, Binarization::Median);
+  }
+  case Int8_Feature: {
+    return std::make_unique<Int8Feature>(values);
+  }
+  case Bow_Feature: {
+    return std::make_unique<BowFeature>(values);
+  }
+  case Patch_Feature: {
+    return std::make_unique<PatchFeature>(values);
   }
   }
   LOG(FATAL) << "Unknown feature type";
 }
+
+FeatureType featureTypeFromName(const std::string &name) {
+  std::string known;
+  for (const auto &[type, typeName] : kFeatureTypeNames) {
+    if (typeName == name) {
+      return type;
+    }
+    known += (known.empty() ? "" : ", ") + typeName;
+  }
+  LOG(FATAL) << "Unknown feature type " << name << ", use one of " << known;
+  return Cnn_Feature;
+}
+
+std::string featureTypeName(FeatureType type) {
+  for (const auto &[knownType, name] : kFeatureTypeNames) {
+    if (knownType == type) {
+      return name;
+    }
+  }
+  LOG(FATAL) << "Unknown feature type " << static_cast<int>(type);
+  return "";
+}
+
+bool hasFeatureBits(FeatureType type) {
+  switch (type) {
+  case Cnn_Feature:
+  case Binary_Feature_Mid:
+  case Binary_Feature_Mean:
+  case Binary_Feature_Median:
+  case Patch_Feature:
+    return true;
+  case Int8_Feature:
+  case Bow_Feature:
+    return false;
+  }
+  return false;
+}
 } // namespace localization::features
@@ -26,14 +26,46 @@
 
 #include "features/ifeature.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 namespace localization::features {
 
+class Projection;
+
 enum FeatureType {
   Cnn_Feature,
+  // Packed binary features, see features/binary_feature.h.
+  Binary_Feature_Mid,
+  Binary_Feature_Mean,
+  Binary_Feature_Median,
+  // Int8 quantized features, see features/int8_feature.h.
+  Int8_Feature,
+  // Sparse bag-of-words histograms, see features/bow_feature.h.
+  Bow_Feature,
+  // Handcrafted normalized patch descriptors, see features/patch_feature.h.
+  Patch_Feature,
 };
 
+/**
+ * @brief      Loads a feature from a `.Feature.pb` file. If `projection` is
+ * set, the values are projected before the feature is built, so the feature
+ * and all its comparisons use the projected dimensions.
+ */
 std::unique_ptr<iFeature> createFeature(FeatureType type,
-                                        const std::string &featureFilename);
+                                        const std::string &featureFilename,
+                                        const Projection *projection = nullptr);
+std::unique_ptr<iFeature> createFeature(FeatureType type,
+                                        const std::vector<double> &values);
+
+/** The type of the name it has in the enum, e.g. "Cnn_Feature", as it is set
+ * in the config. Unknown names are fatal. **/
+FeatureType featureTypeFromName(const std::string &name);
+std::string featureTypeName(FeatureType type);
+/** Whether the features carry the bits that LshHashing and DimensionHashing
+ * index. **/
+bool hasFeatureBits(FeatureType type);
 } // namespace localization::features
 
 #endif // SRC_FEATURES_FEATURE_FACTORY_H_
@@ -0,0 +1,68 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_io.h"
+#include "localization_protos.pb.h"
+
+#include <glog/logging.h>
+
+#include <fstream>
+
+namespace localization::features {
+
+namespace {
+// The messages of features up to 4096-D fit into the reused first block of
+// the arena, so parsing them does not allocate arena blocks.
+constexpr size_t kArenaBlockSize = 40 * 1024;
+} // namespace
+
+std::vector<double> readFeatureValues(const std::string &filename) {
+  GOOGLE_PROTOBUF_VERIFY_VERSION;
+  thread_local std::vector<char> arenaBlock(kArenaBlockSize);
+  google::protobuf::ArenaOptions arenaOptions;
+  arenaOptions.initial_block = arenaBlock.data();
+  arenaOptions.initial_block_size = arenaBlock.size();
+  google::protobuf::Arena arena(arenaOptions);
+
+  const auto *feature_proto =
+      parseProtoFile<image_sequence_localizer::Feature>(filename, &arena);
+  if (!feature_proto) {
+    LOG(FATAL) << "Failed to parse feature_proto file: " << filename;
+  }
+  return protoValues(*feature_proto);
+}
+
+void writeFeatureValues(const std::string &filename,
+                        const std::vector<double> &values,
+                        const std::string &type, ProtoValuesFormat format) {
+  image_sequence_localizer::Feature feature_proto;
+  feature_proto.set_type(type);
+  feature_proto.set_size(values.size());
+  appendProtoValues(values.data(), values.size(), format, &feature_proto);
+  std::fstream out(filename,
+                   std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !feature_proto.SerializeToOstream(&out))
+      << "Failed to write the feature to " << filename;
+}
+
+} // namespace localization::features
@@ -0,0 +1,86 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_loader.h"
+#include "database/list_dir.h"
+#include "features/feature_store.h"
+#include "features/stored_feature.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <chrono>
+
+namespace localization::features {
+
+double FeatureLoadStats::featuresPerSec() const {
+  return elapsedSec > 0.0 ? featuresLoaded / elapsedSec : 0.0;
+}
+
+std::vector<std::unique_ptr<iFeature>>
+loadFeatures(const std::string &featuresDir, FeatureType type, int numThreads,
+             FeatureLoadStats *stats, const Projection *projection) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::unique_ptr<iFeature>> features;
+  if (isFeatureStoreFile(featuresDir)) {
+    LOG_IF(FATAL, type != Cnn_Feature)
+        << "Feature stores hold float features, other feature types are "
+           "computed from .Feature.pb files.";
+    LOG_IF(FATAL, projection)
+        << "Features from a feature store are projected when the store is "
+           "written, see convert_features_to_store.";
+    // Stored features only view the mapped rows, nothing is parsed.
+    const auto store = FeatureStore::open(featuresDir);
+    features.reserve(store->size());
+    for (int idx = 0; idx < store->size(); ++idx) {
+      features.push_back(std::make_unique<StoredFeature>(store, idx));
+    }
+  } else {
+    const std::vector<std::string> featureNames =
+        database::listProtoDir(featuresDir, ".Feature");
+    // Every thread writes only into its own slot, so the order of the files
+    // is preserved without any locking.
+    features.resize(featureNames.size());
+    tools::parallelFor(
+        0, featureNames.size(),
+        [&](int idx) {
+          features[idx] = createFeature(type, featureNames[idx], projection);
+        },
+        numThreads);
+  }
+
+  FeatureLoadStats loadStats;
+  loadStats.featuresLoaded = features.size();
+  loadStats.elapsedSec = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  LOG(INFO) << "Loaded " << loadStats.featuresLoaded << " features from "
+            << featuresDir << " in " << loadStats.elapsedSec << " s ("
+            << loadStats.featuresPerSec() << " features/s)";
+  if (stats) {
+    *stats = loadStats;
+  }
+  return features;
+}
+
+} // namespace localization::features
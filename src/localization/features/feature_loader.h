@@ -0,0 +1,65 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_FEATURE_LOADER_H_
+#define SRC_FEATURES_FEATURE_LOADER_H_
+
+#include "features/feature_factory.h"
+#include "features/ifeature.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+struct FeatureLoadStats {
+  int featuresLoaded = 0;
+  double elapsedSec = 0.0;
+
+  double featuresPerSec() const;
+};
+
+/**
+ * @brief      Loads (and thereby binarizes) all the .Feature protos from a
+ * directory on a pool of threads. A feature store is mapped instead and gives
+ * one StoredFeature per row, it needs `Cnn_Feature` and no projection.
+ *
+ * @param[in]  featuresDir  The directory with the features or a feature
+ *                          store.
+ * @param[in]  type         The type of the features to create.
+ * @param[in]  numThreads   The number of threads, 0 uses all available cores.
+ * @param[out] stats        Optional statistics about the loading.
+ * @param[in]  projection   Optional projection applied to every feature.
+ *
+ * @return     The features in the order given by listProtoDir or the
+ *             store.
+ */
+std::vector<std::unique_ptr<iFeature>>
+loadFeatures(const std::string &featuresDir, FeatureType type,
+             int numThreads = 0, FeatureLoadStats *stats = nullptr,
+             const Projection *projection = nullptr);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_FEATURE_LOADER_H_
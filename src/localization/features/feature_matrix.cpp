@@ -0,0 +1,106 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_matrix.h"
+#include "database/list_dir.h"
+#include "features/feature_io.h"
+#include "features/feature_store.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <cmath>
+
+namespace localization::features {
+
+FeatureMatrix::FeatureMatrix(int rows, int dim) : rows_{rows}, dim_{dim} {
+  CHECK(rows >= 0 && dim >= 0) << "Invalid feature matrix size " << rows
+                               << "x" << dim;
+  data_.resize(static_cast<size_t>(rows) * dim, 0.f);
+}
+
+FeatureMatrix FeatureMatrix::fromFeatureDir(const std::string &featuresDir,
+                                            int numThreads) {
+  const std::vector<std::string> files =
+      database::listProtoDir(featuresDir, ".Feature");
+  if (files.empty()) {
+    return FeatureMatrix();
+  }
+  // The first feature defines the dimensionality for all others.
+  const std::vector<double> first = readFeatureValues(files[0]);
+  FeatureMatrix matrix(files.size(), first.size());
+  matrix.setRow(0, first);
+  tools::parallelFor(
+      1, files.size(),
+      [&](int idx) { matrix.setRow(idx, readFeatureValues(files[idx])); },
+      numThreads);
+  LOG(INFO) << "Loaded " << matrix.rows() << " features of size "
+            << matrix.dim() << " from " << featuresDir;
+  return matrix;
+}
+
+FeatureMatrix FeatureMatrix::fromFeatureStore(const FeatureStore &store,
+                                              int numThreads) {
+  FeatureMatrix matrix(store.size(), store.dim());
+  tools::parallelFor(
+      0, store.size(),
+      [&](int idx) {
+        const float *values = store.row(idx);
+        const float norm = store.norm(idx);
+        const float scale = norm > 0.f ? 1.f / norm : 0.f;
+        float *out = matrix.row(idx);
+        for (int d = 0; d < matrix.dim(); ++d) {
+          out[d] = values[d] * scale;
+        }
+      },
+      numThreads);
+  return matrix;
+}
+
+FeatureMatrix FeatureMatrix::load(const std::string &features,
+                                  int numThreads) {
+  if (isFeatureStoreFile(features)) {
+    return fromFeatureStore(*FeatureStore::open(features), numThreads);
+  }
+  return fromFeatureDir(features, numThreads);
+}
+
+void FeatureMatrix::setRow(int row, const std::vector<double> &values) {
+  CHECK(row >= 0 && row < rows_) << "Row outside range " << row;
+  CHECK(static_cast<int>(values.size()) == dim_)
+      << "Feature of size " << values.size() << " does not fit into a matrix "
+      << "with dimension " << dim_;
+  double norm = 0.0;
+  for (double value : values) {
+    norm += value * value;
+  }
+  norm = std::sqrt(norm);
+  // Zero vectors stay zero, their similarity to anything is 0.
+  const double scale = norm > 0.0 ? 1.0 / norm : 0.0;
+  float *out = this->row(row);
+  for (int d = 0; d < dim_; ++d) {
+    out[d] = static_cast<float>(values[d] * scale);
+  }
+}
+
+} // namespace localization::features
@@ -0,0 +1,85 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_FEATURE_MATRIX_H_
+#define SRC_FEATURES_FEATURE_MATRIX_H_
+
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+class FeatureStore;
+
+/**
+ * @brief      Stores a set of dense features as one contiguous row-major
+ * float32 matrix. Every row is L2-normalized, so the cosine similarity of two
+ * features is a plain dot product of their rows.
+ */
+class FeatureMatrix {
+public:
+  FeatureMatrix() = default;
+  FeatureMatrix(int rows, int dim);
+
+  /**
+   * @brief      Loads every `.Feature.pb` file in `featuresDir` exactly once.
+   * The files are parsed in parallel, the row order follows the sorted file
+   * names as given by `listProtoDir`.
+   *
+   * @param[in]  featuresDir  The directory with the features.
+   * @param[in]  numThreads   The number of loading threads, <= 0 means all
+   * available.
+   */
+  static FeatureMatrix fromFeatureDir(const std::string &featuresDir,
+                                      int numThreads = 0);
+
+  /** Copies and normalizes all the rows of a packed feature store. **/
+  static FeatureMatrix fromFeatureStore(const FeatureStore &store,
+                                        int numThreads = 0);
+
+  /**
+   * @brief      Loads the features from a packed feature store if `features`
+   * is a *.FeatureStore.bin file and from a feature directory otherwise.
+   */
+  static FeatureMatrix load(const std::string &features, int numThreads = 0);
+
+  /** Normalizes `values` and copies them into the row `row`. **/
+  void setRow(int row, const std::vector<double> &values);
+
+  float *row(int row) { return data_.data() + offset(row); }
+  const float *row(int row) const { return data_.data() + offset(row); }
+
+  int rows() const { return rows_; }
+  int dim() const { return dim_; }
+
+private:
+  size_t offset(int row) const { return static_cast<size_t>(row) * dim_; }
+
+  std::vector<float> data_;
+  int rows_ = 0;
+  int dim_ = 0;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_FEATURE_MATRIX_H_
@@ -0,0 +1,375 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/feature_store.h"
+#include "features/feature_io.h"
+#include "features/projection.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace localization::features {
+
+namespace {
+constexpr auto kFeatureStoreExtension = ".FeatureStore.bin";
+constexpr size_t kAlignment = 64;
+// Number of features parsed in parallel before they are written out.
+constexpr int kChunkSize = 4096;
+
+uint64_t align(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// "shm:name" is stored in the shared memory object "/name".
+std::string sharedMemoryName(const std::string &path) {
+  const std::string name =
+      path.substr(std::string(kSharedFeatureStorePrefix).size());
+  LOG_IF(FATAL, name.empty() || name.find('/') != std::string::npos)
+      << "Invalid shared feature store name " << path;
+  return "/" + name;
+}
+
+// Lays out a store of `rows` features of size `dim`, see FeatureStoreHeader.
+FeatureStoreHeader makeHeader(int64_t rows, int64_t dim,
+                              const std::vector<std::string> &rowNames,
+                              std::vector<uint64_t> &nameOffsets,
+                              std::string &names) {
+  FeatureStoreHeader header;
+  std::memcpy(header.magic, FeatureStoreHeader::kMagic, sizeof(header.magic));
+  header.version = FeatureStoreHeader::kVersion;
+  header.dtype = FeatureStoreHeader::kFloat32;
+  header.rows = rows;
+  header.dim = dim;
+  header.dataOffset = align(sizeof(header));
+  header.normsOffset =
+      header.dataOffset + header.rows * header.dim * sizeof(float);
+  header.namesOffset = align(header.normsOffset + header.rows * sizeof(float));
+  nameOffsets.assign(1, 0);
+  names.clear();
+  for (const auto &name : rowNames) {
+    names += name;
+    nameOffsets.push_back(names.size());
+  }
+  header.fileSize = header.namesOffset +
+                    nameOffsets.size() * sizeof(uint64_t) + names.size();
+  return header;
+}
+} // namespace
+
+bool isSharedFeatureStore(const std::string &path) {
+  return path.rfind(kSharedFeatureStorePrefix, 0) == 0;
+}
+
+bool isFeatureStoreFile(const std::string &path) {
+  const std::string extension = kFeatureStoreExtension;
+  return isSharedFeatureStore(path) ||
+         (path.size() >= extension.size() &&
+          path.compare(path.size() - extension.size(), extension.size(),
+                       extension) == 0);
+}
+
+std::shared_ptr<const FeatureStore>
+FeatureStore::open(const std::string &filename, int rowBegin, int rowEnd) {
+  const int fd = isSharedFeatureStore(filename)
+                     ? shm_open(sharedMemoryName(filename).c_str(), O_RDONLY, 0)
+                     : ::open(filename.c_str(), O_RDONLY);
+  LOG_IF(FATAL, fd < 0) << "The feature store cannot be opened " << filename
+                        << ": " << std::strerror(errno);
+  struct stat fileStat;
+  LOG_IF(FATAL, fstat(fd, &fileStat) != 0)
+      << "Failed to stat " << filename << ": " << std::strerror(errno);
+  const size_t size = fileStat.st_size;
+  LOG_IF(FATAL, size < sizeof(FeatureStoreHeader))
+      << "Not a feature store: " << filename;
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  LOG_IF(FATAL, data == MAP_FAILED)
+      << "Failed to map " << filename << ": " << std::strerror(errno);
+  auto *store = new FeatureStore(filename, data, size);
+  if (rowEnd < 0) {
+    rowEnd = store->rows_;
+  }
+  LOG_IF(FATAL, rowBegin < 0 || rowBegin > rowEnd || rowEnd > store->rows_)
+      << "Rows [" << rowBegin << ", " << rowEnd << ") are out of range of "
+      << filename;
+  // Only the visible rows are ever touched, the others are not paged in.
+  store->rowBegin_ = rowBegin;
+  store->rows_ = rowEnd - rowBegin;
+  return std::shared_ptr<const FeatureStore>(store);
+}
+
+std::shared_ptr<const FeatureStore>
+FeatureStore::fromValues(const std::string &name,
+                         const std::vector<std::string> &names,
+                         const std::vector<float> &values, int dim) {
+  CHECK_GT(dim, 0) << "The features of " << name << " have no dimensions";
+  CHECK_EQ(values.size(), names.size() * dim)
+      << "Expected " << names.size() << " features of size " << dim;
+  std::vector<uint64_t> nameOffsets;
+  std::string packedNames;
+  const FeatureStoreHeader header =
+      makeHeader(names.size(), dim, names, nameOffsets, packedNames);
+  // Anonymous memory is unmapped like a mapped file, the store does not need
+  // to know where its bytes come from.
+  void *data = mmap(nullptr, header.fileSize, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  LOG_IF(FATAL, data == MAP_FAILED)
+      << "Failed to allocate the feature store " << name << ": "
+      << std::strerror(errno);
+  auto *bytes = static_cast<char *>(data);
+  std::memcpy(bytes + header.dataOffset, values.data(),
+              values.size() * sizeof(float));
+  auto *norms = reinterpret_cast<float *>(bytes + header.normsOffset);
+  for (size_t row = 0; row < names.size(); ++row) {
+    double norm = 0.0;
+    for (int d = 0; d < dim; ++d) {
+      const double value = values[row * dim + d];
+      norm += value * value;
+    }
+    norms[row] = std::sqrt(norm);
+  }
+  std::memcpy(bytes + header.namesOffset, nameOffsets.data(),
+              nameOffsets.size() * sizeof(uint64_t));
+  std::memcpy(bytes + header.namesOffset +
+                  nameOffsets.size() * sizeof(uint64_t),
+              packedNames.data(), packedNames.size());
+  std::memcpy(bytes, &header, sizeof(header));
+  mprotect(data, header.fileSize, PROT_READ);
+  return std::shared_ptr<const FeatureStore>(
+      new FeatureStore(name, data, header.fileSize));
+}
+
+FeatureStore::FeatureStore(const std::string &filename, const void *data,
+                           size_t size)
+    : filename_{filename}, data_{data}, size_{size} {
+  header_ = static_cast<const FeatureStoreHeader *>(data_);
+  LOG_IF(FATAL, std::memcmp(header_->magic, FeatureStoreHeader::kMagic,
+                            sizeof(header_->magic)) != 0)
+      << "Not a feature store: " << filename;
+  LOG_IF(FATAL, header_->version != FeatureStoreHeader::kVersion)
+      << "Unsupported feature store version " << header_->version << " in "
+      << filename;
+  LOG_IF(FATAL, header_->dtype != FeatureStoreHeader::kFloat32)
+      << "Unsupported feature store dtype " << header_->dtype << " in "
+      << filename;
+  LOG_IF(FATAL, header_->fileSize != size_ || header_->rows < 0 ||
+                    header_->dim < 0 || header_->namesOffset > size_)
+      << "Feature store is truncated or damaged: " << filename;
+  // Every section has to lie inside the mapping and after the previous one.
+  // The sizes are bounded by the mapping first, so they cannot overflow.
+  const uint64_t rows = header_->rows;
+  const uint64_t dim = header_->dim;
+  const uint64_t maxValues = size_ / sizeof(float);
+  LOG_IF(FATAL, rows > maxValues || (dim > 0 && rows > maxValues / dim))
+      << "Feature store is truncated or damaged: " << filename;
+  const uint64_t dataOffset = header_->dataOffset;
+  const uint64_t normsOffset = header_->normsOffset;
+  const uint64_t namesOffset = header_->namesOffset;
+  LOG_IF(FATAL, dataOffset < sizeof(FeatureStoreHeader) ||
+                    dataOffset % kAlignment != 0 ||
+                    normsOffset < dataOffset ||
+                    normsOffset - dataOffset < rows * dim * sizeof(float) ||
+                    namesOffset < normsOffset ||
+                    namesOffset - normsOffset < rows * sizeof(float) ||
+                    namesOffset % sizeof(uint64_t) != 0 ||
+                    size_ - namesOffset < (rows + 1) * sizeof(uint64_t))
+      << "Feature store sections are out of bounds: " << filename;
+
+  const auto *bytes = static_cast<const char *>(data_);
+  values_ = reinterpret_cast<const float *>(bytes + dataOffset);
+  norms_ = reinterpret_cast<const float *>(bytes + normsOffset);
+  nameOffsets_ = reinterpret_cast<const uint64_t *>(bytes + namesOffset);
+  names_ = reinterpret_cast<const char *>(nameOffsets_ + rows + 1);
+  const uint64_t namesSize =
+      size_ - namesOffset - (rows + 1) * sizeof(uint64_t);
+  LOG_IF(FATAL, nameOffsets_[0] != 0)
+      << "Feature store names are damaged: " << filename;
+  for (uint64_t idx = 0; idx < rows; ++idx) {
+    LOG_IF(FATAL, nameOffsets_[idx + 1] < nameOffsets_[idx] ||
+                      nameOffsets_[idx + 1] > namesSize)
+        << "Feature store names are damaged: " << filename;
+  }
+  rows_ = rows;
+}
+
+FeatureStore::~FeatureStore() { munmap(const_cast<void *>(data_), size_); }
+
+const float *FeatureStore::row(int idx) const {
+  CHECK(idx >= 0 && idx < size()) << "Feature " << idx << " is out of range";
+  return values_ + static_cast<size_t>(rowBegin_ + idx) * header_->dim;
+}
+
+float FeatureStore::norm(int idx) const {
+  CHECK(idx >= 0 && idx < size()) << "Feature " << idx << " is out of range";
+  return norms_[rowBegin_ + idx];
+}
+
+std::string_view FeatureStore::name(int idx) const {
+  CHECK(idx >= 0 && idx < size()) << "Feature " << idx << " is out of range";
+  const int row = rowBegin_ + idx;
+  return std::string_view(names_ + nameOffsets_[row],
+                          nameOffsets_[row + 1] - nameOffsets_[row]);
+}
+
+namespace {
+void writeAll(int fd, const void *data, size_t size, uint64_t offset,
+              const std::string &name) {
+  const auto *bytes = static_cast<const char *>(data);
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, bytes, size, offset);
+    LOG_IF(FATAL, written < 0)
+        << "Failed to write the feature store " << name << ": "
+        << std::strerror(errno);
+    bytes += written;
+    size -= written;
+    offset += written;
+  }
+}
+
+// Writes the store through the descriptor. The descriptor is never an
+// existing store: files are written next to the output and renamed over it,
+// shared memory objects are created exclusively, so processes that map a
+// store never see it change. The header goes last, so a reader that maps a
+// shared store while it is written fails on the magic instead of reading
+// garbage.
+void writeFeatureStoreToFd(const std::vector<std::string> &featureFiles,
+                           int fd, const std::string &name, int numThreads,
+                           const Projection *projection) {
+  LOG_IF(FATAL, featureFiles.empty()) << "No features to store.";
+  std::vector<std::string> rowNames;
+  rowNames.reserve(featureFiles.size());
+  for (const auto &file : featureFiles) {
+    rowNames.push_back(std::filesystem::path(file).filename().string());
+  }
+  std::vector<uint64_t> nameOffsets;
+  std::string names;
+  const FeatureStoreHeader header = makeHeader(
+      featureFiles.size(),
+      projection ? projection->outputDim()
+                 : readFeatureValues(featureFiles[0]).size(),
+      rowNames, nameOffsets, names);
+  const uint64_t namesBegin =
+      header.namesOffset + nameOffsets.size() * sizeof(uint64_t);
+  // Shared memory objects cannot grow by writing past their end on every
+  // system, so the whole layout is sized up front.
+  LOG_IF(FATAL, ftruncate(fd, header.fileSize) != 0)
+      << "Failed to resize the feature store " << name << ": "
+      << std::strerror(errno);
+
+  std::vector<float> norms(header.rows);
+  std::vector<float> chunk;
+  uint64_t offset = header.dataOffset;
+  for (size_t begin = 0; begin < featureFiles.size(); begin += kChunkSize) {
+    const size_t end = std::min(featureFiles.size(), begin + kChunkSize);
+    chunk.assign((end - begin) * header.dim, 0.f);
+    tools::parallelFor(
+        begin, end,
+        [&](int idx) {
+          std::vector<double> values = readFeatureValues(featureFiles[idx]);
+          if (projection) {
+            values = projection->apply(values);
+          }
+          LOG_IF(FATAL, static_cast<int64_t>(values.size()) != header.dim)
+              << "Feature " << featureFiles[idx] << " has size "
+              << values.size() << ", expected " << header.dim;
+          double norm = 0.0;
+          float *row = chunk.data() + (idx - begin) * header.dim;
+          for (int64_t d = 0; d < header.dim; ++d) {
+            row[d] = values[d];
+            norm += values[d] * values[d];
+          }
+          norms[idx] = std::sqrt(norm);
+        },
+        numThreads);
+    writeAll(fd, chunk.data(), chunk.size() * sizeof(float), offset, name);
+    offset += chunk.size() * sizeof(float);
+  }
+
+  writeAll(fd, norms.data(), norms.size() * sizeof(float), header.normsOffset,
+           name);
+  writeAll(fd, nameOffsets.data(), nameOffsets.size() * sizeof(uint64_t),
+           header.namesOffset, name);
+  writeAll(fd, names.data(), names.size(), namesBegin, name);
+
+  writeAll(fd, &header, sizeof(header), 0, name);
+  LOG(INFO) << "Stored " << header.rows << " features of size " << header.dim
+            << " in " << name;
+}
+} // namespace
+
+void writeFeatureStore(const std::vector<std::string> &featureFiles,
+                       const std::string &outputFile, int numThreads,
+                       const Projection *projection) {
+  // Truncating a mapped store would make its readers fail on the next row
+  // they touch. The new store replaces the old file, readers that mapped the
+  // old one keep it until they unmap it.
+  const std::string tmpFile = outputFile + ".tmp";
+  const int fd = ::open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  LOG_IF(FATAL, fd < 0) << "The file cannot be opened " << tmpFile << ": "
+                        << std::strerror(errno);
+  writeFeatureStoreToFd(featureFiles, fd, outputFile, numThreads, projection);
+  close(fd);
+  LOG_IF(FATAL, std::rename(tmpFile.c_str(), outputFile.c_str()) != 0)
+      << "Failed to replace the feature store " << outputFile << ": "
+      << std::strerror(errno);
+}
+
+void publishSharedFeatureStore(const std::vector<std::string> &featureFiles,
+                               const std::string &name, int numThreads,
+                               const Projection *projection) {
+  CHECK(isSharedFeatureStore(name))
+      << "Shared feature stores are named " << kSharedFeatureStorePrefix
+      << "<name>, got " << name;
+  const std::string objectName = sharedMemoryName(name);
+  // O_EXCL: a store that other processes may have mapped is never rewritten.
+  const int fd = shm_open(objectName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  LOG_IF(FATAL, fd < 0) << "The shared feature store " << name
+                        << " cannot be created: " << std::strerror(errno);
+  writeFeatureStoreToFd(featureFiles, fd, name, numThreads, projection);
+  close(fd);
+}
+
+void removeSharedFeatureStore(const std::string &name) {
+  CHECK(isSharedFeatureStore(name))
+      << "Shared feature stores are named " << kSharedFeatureStorePrefix
+      << "<name>, got " << name;
+  // Processes that still map the store keep their view until they unmap it.
+  LOG_IF(WARNING, shm_unlink(sharedMemoryName(name).c_str()) != 0)
+      << "Failed to remove the shared feature store " << name << ": "
+      << std::strerror(errno);
+}
+
+} // namespace localization::features
@@ -0,0 +1,143 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_FEATURE_STORE_H_
+#define SRC_FEATURES_FEATURE_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace localization::features {
+
+class Projection;
+
+/**
+ * @brief      Header of the packed feature store (*.FeatureStore.bin). One
+ * store holds a whole sequence of dense features:
+ *
+ *   header | rows x dim float32 values | rows float32 L2 norms |
+ *   (rows + 1) uint64 name offsets | names
+ *
+ * The values start at a 64 byte aligned offset and are stored in the native
+ * (little-endian) byte order. The name of a feature is the name of the
+ * `.Feature.pb` file it was converted from.
+ */
+struct FeatureStoreHeader {
+  static constexpr char kMagic[8] = "ISLFEAT";
+  static constexpr uint32_t kVersion = 1;
+  static constexpr uint32_t kFloat32 = 0;
+
+  char magic[8] = {};
+  uint32_t version = 0;
+  uint32_t dtype = 0;
+  int64_t rows = 0;
+  int64_t dim = 0;
+  uint64_t dataOffset = 0;
+  uint64_t normsOffset = 0;
+  uint64_t namesOffset = 0;
+  uint64_t fileSize = 0;
+};
+static_assert(sizeof(FeatureStoreHeader) == 64,
+              "The feature store header should stay 64 bytes long");
+
+/**
+ * @brief      Read-only view of a packed feature store. The file or shared
+ * memory object is memory mapped, so opening a store does not read or parse
+ * the features and the rows are shared between all processes that map it.
+ */
+class FeatureStore {
+public:
+  /** Maps the store. Only the rows [rowBegin, rowEnd) are visible, e.g. the
+   * part of a reference a shard works on, -1 is the end of the store. **/
+  static std::shared_ptr<const FeatureStore>
+  open(const std::string &filename, int rowBegin = 0, int rowEnd = -1);
+  /**
+   * @brief      Store in anonymous memory, e.g. for features computed in the
+   * same process. `values` holds the rows one after another, `names` one
+   * name per row. Nothing is written to disk.
+   */
+  static std::shared_ptr<const FeatureStore>
+  fromValues(const std::string &name, const std::vector<std::string> &names,
+             const std::vector<float> &values, int dim);
+  ~FeatureStore();
+
+  FeatureStore(const FeatureStore &) = delete;
+  FeatureStore &operator=(const FeatureStore &) = delete;
+
+  int size() const { return rows_; }
+  int dim() const { return header_->dim; }
+  const float *row(int idx) const;
+  float norm(int idx) const;
+  std::string_view name(int idx) const;
+  const std::string &filename() const { return filename_; }
+
+private:
+  FeatureStore(const std::string &filename, const void *data, size_t size);
+
+  std::string filename_;
+  const void *data_ = nullptr;
+  size_t size_ = 0;
+  const FeatureStoreHeader *header_ = nullptr;
+  const float *values_ = nullptr;
+  const float *norms_ = nullptr;
+  const uint64_t *nameOffsets_ = nullptr;
+  const char *names_ = nullptr;
+  int rowBegin_ = 0;
+  int rows_ = 0;
+};
+
+/** Feature stores in POSIX shared memory are addressed as "shm:<name>". **/
+constexpr char kSharedFeatureStorePrefix[] = "shm:";
+
+/** Returns true if the path has the feature store extension or names a shared
+ * feature store. **/
+bool isFeatureStoreFile(const std::string &path);
+bool isSharedFeatureStore(const std::string &path);
+
+/**
+ * @brief      Converts the `.Feature.pb` files into one packed feature store.
+ * The files are parsed in parallel in chunks, so the whole sequence never has
+ * to fit into memory. If `projection` is set, the store holds the projected
+ * features.
+ */
+void writeFeatureStore(const std::vector<std::string> &featureFiles,
+                       const std::string &outputFile, int numThreads = 0,
+                       const Projection *projection = nullptr);
+
+/**
+ * @brief      Converts the `.Feature.pb` files into a feature store in shared
+ * memory. Other processes open it read-only with FeatureStore::open("shm:..")
+ * and share one copy of the features. The store stays until it is removed.
+ */
+void publishSharedFeatureStore(const std::vector<std::string> &featureFiles,
+                               const std::string &name, int numThreads = 0,
+                               const Projection *projection = nullptr);
+void removeSharedFeatureStore(const std::string &name);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_FEATURE_STORE_H_
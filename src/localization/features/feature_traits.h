@@ -0,0 +1,294 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_FEATURE_TRAITS_H_
+#define SRC_FEATURES_FEATURE_TRAITS_H_
+
+#include "features/binary_feature.h"
+#include "features/bow_feature.h"
+#include "features/cnn_feature.h"
+#include "features/feature_factory.h"
+#include "features/ifeature.h"
+#include "features/int8_feature.h"
+#include "features/patch_feature.h"
+#include "features/similarity_kernels.h"
+#include "features/stored_feature.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Cost of a graph edge for a similarity score, the inverse of the
+ * score. Returns std::numeric_limits<double>::max() for scores near 0.
+ */
+inline double inverseScoreCost(double score) {
+  if (score < 1e-09) {
+    return std::numeric_limits<double>::max();
+  }
+  return 1. / score;
+}
+
+/**
+ * @brief      Statically dispatched scoring of one feature type. The virtual
+ * iFeature methods of the built-in features are implemented with it, inner
+ * loops that know the feature type call it directly: no virtual calls or
+ * string type checks per comparison, so the calls inline into the loop.
+ *
+ * Every specialization provides
+ *   static double score(const Feature &lhs, const Feature &rhs);
+ *   static double cost(double score);
+ */
+template <class Feature> struct FeatureTraits;
+
+template <> struct FeatureTraits<CnnFeature> {
+  static double score(const CnnFeature &lhs, const CnnFeature &rhs) {
+    CHECK_EQ(lhs.size(), rhs.size()) << "Features have different dimensions";
+    return dotProduct(lhs.data(), rhs.data(), lhs.size());
+  }
+  static double cost(double score) {
+    if (score < 1e-09) {
+      printf(
+          "[INFO] The cost of comparing two images is suspiciously small.\n");
+    }
+    return inverseScoreCost(score);
+  }
+};
+
+template <> struct FeatureTraits<StoredFeature> {
+  static double score(const StoredFeature &lhs, const StoredFeature &rhs) {
+    CHECK_EQ(lhs.size(), rhs.size()) << "Features have different dimensions";
+    return dotProduct(lhs.data(), rhs.data(), lhs.size()) /
+           (static_cast<double>(lhs.norm()) * rhs.norm());
+  }
+  static double cost(double score) { return inverseScoreCost(score); }
+};
+
+template <> struct FeatureTraits<Int8Feature> {
+  static double score(const Int8Feature &lhs, const Int8Feature &rhs) {
+    CHECK_EQ(lhs.size(), rhs.size()) << "Features have different dimensions";
+    return static_cast<double>(lhs.scale()) * rhs.scale() *
+           dotProductInt8(lhs.data(), rhs.data(), lhs.size());
+  }
+  static double cost(double score) { return inverseScoreCost(score); }
+};
+
+template <> struct FeatureTraits<PatchFeature> {
+  static double score(const PatchFeature &lhs, const PatchFeature &rhs) {
+    CHECK_EQ(lhs.size(), rhs.size()) << "Features have different dimensions";
+    return patchScore(sumAbsDiffUint8(lhs.data(), rhs.data(), lhs.size()),
+                      lhs.size());
+  }
+  static double cost(double score) { return inverseScoreCost(score); }
+};
+
+template <> struct FeatureTraits<BinaryFeature> {
+  // The share of bits that are equal in both features.
+  static double score(const BinaryFeature &lhs, const BinaryFeature &rhs) {
+    CHECK_EQ(lhs.numBits(), rhs.numBits())
+        << "Features have different dimensions";
+    if (lhs.numBits() == 0) {
+      return 0.0;
+    }
+    return 1.0 - static_cast<double>(hammingDistance(
+                     lhs.words().data(), rhs.words().data(),
+                     lhs.words().size())) /
+                     lhs.numBits();
+  }
+  static double cost(double score) { return inverseScoreCost(score); }
+};
+
+template <> struct FeatureTraits<BowFeature> {
+  static double score(const BowFeature &lhs, const BowFeature &rhs) {
+    CHECK_EQ(lhs.numWords(), rhs.numWords())
+        << "Features have different vocabularies";
+    return sparseDotProduct(lhs, rhs);
+  }
+  static double cost(double score) { return inverseScoreCost(score); }
+};
+
+template <class Feature>
+double matchingCost(const Feature &query, const Feature &ref) {
+  return FeatureTraits<Feature>::cost(FeatureTraits<Feature>::score(query, ref));
+}
+
+/**
+ * @brief      Scores one query against `numRefs` references. Dense float
+ * features go through the batched dot product kernel, the other types are
+ * scored pair by pair.
+ */
+template <class Feature>
+void scoreBatch(const Feature &query, const Feature *const *refs, int numRefs,
+                double *scores) {
+  for (int r = 0; r < numRefs; ++r) {
+    scores[r] = FeatureTraits<Feature>::score(query, *refs[r]);
+  }
+}
+
+template <>
+inline void scoreBatch<CnnFeature>(const CnnFeature &query,
+                                   const CnnFeature *const *refs, int numRefs,
+                                   double *scores) {
+  thread_local std::vector<const float *> refValues;
+  thread_local std::vector<float> dots;
+  refValues.resize(numRefs);
+  dots.resize(numRefs);
+  for (int r = 0; r < numRefs; ++r) {
+    CHECK_EQ(query.size(), refs[r]->size())
+        << "Features have different dimensions";
+    refValues[r] = refs[r]->data();
+  }
+  const float *queryValues = query.data();
+  dotProductBatch(&queryValues, 1, refValues.data(), numRefs, query.size(),
+                  dots.data());
+  std::copy(dots.begin(), dots.end(), scores);
+}
+
+template <>
+inline void scoreBatch<StoredFeature>(const StoredFeature &query,
+                                      const StoredFeature *const *refs,
+                                      int numRefs, double *scores) {
+  thread_local std::vector<const float *> refValues;
+  thread_local std::vector<float> dots;
+  refValues.resize(numRefs);
+  dots.resize(numRefs);
+  for (int r = 0; r < numRefs; ++r) {
+    CHECK_EQ(query.size(), refs[r]->size())
+        << "Features have different dimensions";
+    refValues[r] = refs[r]->data();
+  }
+  const float *queryValues = query.data();
+  dotProductBatch(&queryValues, 1, refValues.data(), numRefs, query.size(),
+                  dots.data());
+  for (int r = 0; r < numRefs; ++r) {
+    scores[r] = dots[r] / (static_cast<double>(query.norm()) * refs[r]->norm());
+  }
+}
+
+/** Matching cost of two features whose type was fixed once for all of them.
+ * **/
+using MatchingCostFunction = double (*)(const iFeature &query,
+                                        const iFeature &ref);
+
+/** Casts without checks, the caller guarantees the type of both features.
+ * **/
+template <class Feature>
+double staticMatchingCost(const iFeature &query, const iFeature &ref) {
+  return matchingCost(static_cast<const Feature &>(query),
+                      static_cast<const Feature &>(ref));
+}
+
+/** Goes through the virtual iFeature methods, works for any features. **/
+inline double dynamicMatchingCost(const iFeature &query, const iFeature &ref) {
+  return query.score2cost(query.computeSimilarityScore(ref));
+}
+
+/** Matching costs of one query against `numRefs` references, written to
+ * `costs`. **/
+using MatchingCostsFunction = void (*)(const iFeature &query,
+                                       const iFeature *const *refs,
+                                       int numRefs, double *costs);
+
+template <class Feature>
+void staticMatchingCosts(const iFeature &query, const iFeature *const *refs,
+                         int numRefs, double *costs) {
+  thread_local std::vector<const Feature *> typedRefs;
+  typedRefs.resize(numRefs);
+  for (int r = 0; r < numRefs; ++r) {
+    typedRefs[r] = static_cast<const Feature *>(refs[r]);
+  }
+  scoreBatch(static_cast<const Feature &>(query), typedRefs.data(), numRefs,
+             costs);
+  for (int r = 0; r < numRefs; ++r) {
+    costs[r] = FeatureTraits<Feature>::cost(costs[r]);
+  }
+}
+
+inline void dynamicMatchingCosts(const iFeature &query,
+                                 const iFeature *const *refs, int numRefs,
+                                 double *costs) {
+  for (int r = 0; r < numRefs; ++r) {
+    costs[r] = dynamicMatchingCost(query, *refs[r]);
+  }
+}
+
+/**
+ * @brief      Returns the statically dispatched cost function for features
+ * created by createFeature(type), or for features of a feature store if
+ * `stored` is set. Falls back to the virtual methods for other types.
+ */
+inline MatchingCostFunction matchingCostFunction(FeatureType type,
+                                                 bool stored = false) {
+  if (stored) {
+    return type == Cnn_Feature ? staticMatchingCost<StoredFeature>
+                               : dynamicMatchingCost;
+  }
+  switch (type) {
+  case Cnn_Feature:
+    return staticMatchingCost<CnnFeature>;
+  case Binary_Feature_Mid:
+  case Binary_Feature_Mean:
+  case Binary_Feature_Median:
+    return staticMatchingCost<BinaryFeature>;
+  case Int8_Feature:
+    return staticMatchingCost<Int8Feature>;
+  case Bow_Feature:
+    return staticMatchingCost<BowFeature>;
+  case Patch_Feature:
+    return staticMatchingCost<PatchFeature>;
+  }
+  return dynamicMatchingCost;
+}
+
+/** Batched counterpart of matchingCostFunction(). **/
+inline MatchingCostsFunction matchingCostsFunction(FeatureType type,
+                                                   bool stored = false) {
+  if (stored) {
+    return type == Cnn_Feature ? staticMatchingCosts<StoredFeature>
+                               : dynamicMatchingCosts;
+  }
+  switch (type) {
+  case Cnn_Feature:
+    return staticMatchingCosts<CnnFeature>;
+  case Binary_Feature_Mid:
+  case Binary_Feature_Mean:
+  case Binary_Feature_Median:
+    return staticMatchingCosts<BinaryFeature>;
+  case Int8_Feature:
+    return staticMatchingCosts<Int8Feature>;
+  case Bow_Feature:
+    return staticMatchingCosts<BowFeature>;
+  case Patch_Feature:
+    return staticMatchingCosts<PatchFeature>;
+  }
+  return dynamicMatchingCosts;
+}
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_FEATURE_TRAITS_H_
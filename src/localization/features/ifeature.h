@@ -26,6 +26,7 @@
 #ifndef SRC_FEATURES_IFEATURE_H_
 #define SRC_FEATURES_IFEATURE_H_
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -55,6 +56,14 @@ public:
    * std::numeric_limits<double>::max()
    */
   virtual double score2cost(double score) const = 0;
+  /**
+   * @brief      Approximate memory held by the feature. Used by the feature
+   * buffer to respect its memory budget.
+   */
+  virtual size_t memoryBytes() const {
+    return sizeof(*this) + type.capacity() + bits.capacity() * sizeof(int) +
+           dimensions.capacity() * sizeof(double);
+  }
   virtual ~iFeature() {}
   iFeature() = default;
   iFeature(const iFeature &) = delete;
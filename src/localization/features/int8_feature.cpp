@@ -0,0 +1,71 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/int8_feature.h"
+#include "features/feature_io.h"
+#include "features/feature_traits.h"
+#include "features/similarity_kernels.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace localization::features {
+
+Int8Feature::Int8Feature(const std::string &filename)
+    : Int8Feature(readFeatureValues(filename)) {}
+
+Int8Feature::Int8Feature(const std::vector<double> &values)
+    : values_(values.size(), 0) {
+  type = "Int8Feature";
+  double norm = 0.0;
+  double maxAbs = 0.0;
+  for (double value : values) {
+    norm += value * value;
+    maxAbs = std::max(maxAbs, std::abs(value));
+  }
+  norm = std::sqrt(norm);
+  if (norm == 0.0) {
+    // A zero feature stays zero and is not similar to anything.
+    return;
+  }
+  // -128 is not used, so the kernels can take the absolute value of a byte.
+  scale_ = maxAbs / norm / 127.0;
+  const double factor = 127.0 / maxAbs;
+  for (size_t d = 0; d < values.size(); ++d) {
+    values_[d] = static_cast<int8_t>(std::lround(values[d] * factor));
+  }
+}
+
+double Int8Feature::computeSimilarityScore(const iFeature &rhs) const {
+  CHECK(this->type == rhs.type) << "Features are not the same type";
+  const auto &other = static_cast<const Int8Feature &>(rhs);
+  return FeatureTraits<Int8Feature>::score(*this, other);
+}
+
+double Int8Feature::score2cost(double score) const {
+  return FeatureTraits<Int8Feature>::cost(score);
+}
+
+} // namespace localization::features
@@ -0,0 +1,63 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_INT8_FEATURE_H_
+#define SRC_FEATURES_INT8_FEATURE_H_
+
+#include "features/aligned_allocator.h"
+#include "features/ifeature.h"
+
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Feature quantized to one int8 per dimension. The values are
+ * L2-normalized and scaled to [-127, 127] by a per-feature scale, so the
+ * cosine similarity is the integer dot product times both scales. Takes 8
+ * times less memory than the double values of CnnFeature.
+ */
+class Int8Feature : public iFeature {
+public:
+  explicit Int8Feature(const std::string &filename);
+  explicit Int8Feature(const std::vector<double> &values);
+
+  double computeSimilarityScore(const iFeature &rhs) const override;
+  double score2cost(double score) const override;
+  size_t memoryBytes() const override {
+    return sizeof(*this) + type.capacity() + values_.capacity();
+  }
+
+  const int8_t *data() const { return values_.data(); }
+  int size() const { return values_.size(); }
+  float scale() const { return scale_; }
+
+private:
+  AlignedInt8Vector values_;
+  float scale_ = 0.f;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_INT8_FEATURE_H_
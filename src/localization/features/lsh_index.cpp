@@ -0,0 +1,484 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/lsh_index.h"
+#include "features/similarity_kernels.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <type_traits>
+
+namespace localization::features {
+
+namespace {
+// Keys of up to this many bits index the buckets directly, the offsets of a
+// table take 256 KB.
+constexpr int kMaxDirectKeySize = 16;
+// Added codes are searched exhaustively until they make up this share of the
+// hashed ones.
+constexpr double kMaxPendingFraction = 0.1;
+constexpr auto kLshIndexExtension = ".LshIndex.bin";
+constexpr size_t kAlignment = 64;
+
+uint64_t align(uint64_t offset) {
+  return (offset + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Lengths of the bucket offsets, keys and ids of the tables. They are empty
+// while no code is hashed.
+std::array<size_t, 3> tableLengths(const LshOptions &options, int numHashed) {
+  if (numHashed == 0) {
+    return {0, 0, 0};
+  }
+  const size_t ids = static_cast<size_t>(options.numTables) * numHashed;
+  if (options.keySize <= kMaxDirectKeySize) {
+    return {options.numTables * ((size_t{1} << options.keySize) + 1), 0, ids};
+  }
+  return {0, ids, ids};
+}
+
+// Number of keys of `keySize` bits that differ from a key in up to `level`
+// bits, saturated above LshOptions::kMaxProbes.
+size_t numProbes(int keySize, int level) {
+  size_t probes = 0;
+  size_t keys = 1; // keySize choose bits
+  for (int bits = 0; bits <= level && probes <= LshOptions::kMaxProbes;
+       ++bits) {
+    probes += keys;
+    keys = keys * (keySize - bits) / (bits + 1);
+  }
+  return probes;
+}
+
+// Calls `visit` with every mask of `keySize` bits with `bits` set bits that
+// only sets bits from `first` on, added to `mask`.
+template <class Visit>
+void forEachMask(int keySize, int bits, int first, uint32_t mask,
+                 Visit &visit) {
+  if (bits == 0) {
+    visit(mask);
+    return;
+  }
+  for (int b = first; b + bits <= keySize; ++b) {
+    forEachMask(keySize, bits - 1, b + 1, mask | (uint32_t{1} << b), visit);
+  }
+}
+} // namespace
+
+bool isLshIndexFile(const std::string &path) {
+  const std::string extension = kLshIndexExtension;
+  return path.size() >= extension.size() &&
+         path.compare(path.size() - extension.size(), extension.size(),
+                      extension) == 0;
+}
+
+LshIndex::LshIndex(int numBits, const LshOptions &options)
+    : LshIndex(numBits, options, /*sampleBits=*/true) {}
+
+LshIndex::LshIndex(int numBits, const LshOptions &options, bool sampleBits)
+    : options_{options}, numBits_{numBits}, words_{(numBits + 63) / 64} {
+  CHECK(numBits_ > 0) << "The codes need at least one bit.";
+  CHECK(options_.numTables > 0) << "The number of tables should be positive.";
+  CHECK(options_.keySize > 0 && options_.keySize <= 32 &&
+        options_.keySize <= numBits_)
+      << "The key size should be in [1, min(32, " << numBits_ << ")], got "
+      << options_.keySize;
+  CHECK(options_.multiProbeLevel >= 0 &&
+        options_.multiProbeLevel <= options_.keySize)
+      << "The multi-probe level should be in [0, " << options_.keySize
+      << "], got " << options_.multiProbeLevel;
+  CHECK(numProbes(options_.keySize, options_.multiProbeLevel) <=
+        LshOptions::kMaxProbes)
+      << "A multi-probe level of " << options_.multiProbeLevel << " with "
+      << options_.keySize << " bit keys probes more than "
+      << LshOptions::kMaxProbes << " buckets per table, use a lower level.";
+
+  auto addMask = [this](uint32_t mask) { probeMasks_.push_back(mask); };
+  for (int bits = 0; bits <= options_.multiProbeLevel; ++bits) {
+    forEachMask(options_.keySize, bits, 0, 0, addMask);
+  }
+  if (!sampleBits) {
+    return;
+  }
+
+  std::mt19937 generator(options_.seed);
+  std::vector<uint32_t> positions(numBits_);
+  std::iota(positions.begin(), positions.end(), 0);
+  for (int t = 0; t < options_.numTables; ++t) {
+    // Partial Fisher-Yates shuffle, distinct positions within a table.
+    for (int i = 0; i < options_.keySize; ++i) {
+      std::uniform_int_distribution<int> pick(i, numBits_ - 1);
+      std::swap(positions[i], positions[pick(generator)]);
+      sampledBits_.owned().push_back(positions[i]);
+    }
+  }
+}
+
+bool LshIndex::directTables() const {
+  return options_.keySize <= kMaxDirectKeySize;
+}
+
+uint32_t LshIndex::key(int table, const uint64_t *code) const {
+  const uint32_t *positions =
+      sampledBits_.data() + static_cast<size_t>(table) * options_.keySize;
+  uint32_t result = 0;
+  for (int i = 0; i < options_.keySize; ++i) {
+    const uint32_t p = positions[i];
+    result |= static_cast<uint32_t>((code[p / 64] >> (p % 64)) & 1) << i;
+  }
+  return result;
+}
+
+int LshIndex::add(const uint64_t *code) {
+  std::vector<uint64_t> &codes = codes_.owned();
+  codes.insert(codes.end(), code, code + words_);
+  const int id = size_++;
+  if (numHashed_ > 0 && size_ - numHashed_ > kMaxPendingFraction * numHashed_) {
+    LOG(INFO) << "Rebuilding the LSH tables with " << size_ - numHashed_
+              << " added codes.";
+    rebuild();
+  }
+  return id;
+}
+
+void LshIndex::rebuild() {
+  numHashed_ = size_;
+  const int numTables = options_.numTables;
+  std::vector<int32_t> &bucketIds = bucketIds_.reset();
+  std::vector<uint32_t> &bucketOffsets = bucketOffsets_.reset();
+  std::vector<uint32_t> &bucketKeys = bucketKeys_.reset();
+  bucketIds.assign(static_cast<size_t>(numTables) * numHashed_, 0);
+  if (directTables()) {
+    const size_t numBuckets = size_t{1} << options_.keySize;
+    bucketOffsets.assign(numTables * (numBuckets + 1), 0);
+  } else {
+    bucketKeys.assign(static_cast<size_t>(numTables) * numHashed_, 0);
+  }
+  tools::parallelFor(0, numTables, [&](int t) {
+    std::vector<uint32_t> keys(numHashed_);
+    for (int id = 0; id < numHashed_; ++id) {
+      keys[id] = key(t, code(id));
+    }
+    int32_t *ids = bucketIds.data() + static_cast<size_t>(t) * numHashed_;
+    if (directTables()) {
+      // Counting sort by key, the ids of a bucket stay in increasing order.
+      const size_t numBuckets = size_t{1} << options_.keySize;
+      uint32_t *offsets = bucketOffsets.data() + t * (numBuckets + 1);
+      for (uint32_t k : keys) {
+        ++offsets[k + 1];
+      }
+      std::partial_sum(offsets, offsets + numBuckets + 1, offsets);
+      std::vector<uint32_t> next(offsets, offsets + numBuckets);
+      for (int id = 0; id < numHashed_; ++id) {
+        ids[next[keys[id]]++] = id;
+      }
+    } else {
+      std::iota(ids, ids + numHashed_, 0);
+      std::stable_sort(ids, ids + numHashed_, [&keys](int lhs, int rhs) {
+        return keys[lhs] < keys[rhs];
+      });
+      uint32_t *sortedKeys =
+          bucketKeys.data() + static_cast<size_t>(t) * numHashed_;
+      for (int i = 0; i < numHashed_; ++i) {
+        sortedKeys[i] = keys[ids[i]];
+      }
+    }
+  });
+}
+
+void LshIndex::probeTable(int table, const uint64_t *query,
+                          std::vector<int32_t> *ids) const {
+  const uint32_t queryKey = key(table, query);
+  const int32_t *tableIds =
+      bucketIds_.data() + static_cast<size_t>(table) * numHashed_;
+  if (directTables()) {
+    const uint32_t *offsets = bucketOffsets_.data() +
+                              table * ((size_t{1} << options_.keySize) + 1);
+    for (uint32_t mask : probeMasks_) {
+      const uint32_t k = queryKey ^ mask;
+      ids->insert(ids->end(), tableIds + offsets[k], tableIds + offsets[k + 1]);
+    }
+    return;
+  }
+  const uint32_t *keys =
+      bucketKeys_.data() + static_cast<size_t>(table) * numHashed_;
+  for (uint32_t mask : probeMasks_) {
+    const auto [first, last] =
+        std::equal_range(keys, keys + numHashed_, queryKey ^ mask);
+    ids->insert(ids->end(), tableIds + (first - keys),
+                tableIds + (last - keys));
+  }
+}
+
+void LshIndex::rankTables(int firstTable, int lastTable,
+                          const uint64_t *query,
+                          std::vector<std::pair<int, int>> *neighbours) const {
+  std::vector<int32_t> ids;
+  for (int t = firstTable; t < lastTable; ++t) {
+    probeTable(t, query, &ids);
+  }
+  // A code found in several tables or probes is ranked once.
+  std::sort(ids.begin(), ids.end());
+  ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+  constexpr size_t kPrefetchDistance = 4;
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (i + kPrefetchDistance < ids.size()) {
+      __builtin_prefetch(code(ids[i + kPrefetchDistance]));
+    }
+    neighbours->emplace_back(hammingDistance(query, code(ids[i]), words_),
+                             ids[i]);
+  }
+}
+
+std::vector<std::pair<int, int>> LshIndex::knn(const uint64_t *query,
+                                               int k) const {
+  // (distance, id) pairs, sorting them orders by distance, then by id.
+  std::vector<std::pair<int, int>> neighbours;
+  if (numHashed_ > 0) {
+    const int numThreads = std::min(options_.numThreads, options_.numTables);
+    if (numThreads > 1) {
+      // Every thread probes and ranks a share of the tables, the ranking is
+      // the bulk of the work.
+      std::vector<std::vector<std::pair<int, int>>> threadNeighbours(
+          numThreads);
+      tools::parallelFor(
+          0, numThreads,
+          [&](int thread) {
+            rankTables(thread * options_.numTables / numThreads,
+                       (thread + 1) * options_.numTables / numThreads, query,
+                       &threadNeighbours[thread]);
+          },
+          numThreads);
+      for (const auto &ranked : threadNeighbours) {
+        neighbours.insert(neighbours.end(), ranked.begin(), ranked.end());
+      }
+    } else {
+      rankTables(0, options_.numTables, query, &neighbours);
+    }
+  }
+  for (int id = numHashed_; id < size_; ++id) {
+    neighbours.emplace_back(hammingDistance(query, code(id), words_), id);
+  }
+
+  std::sort(neighbours.begin(), neighbours.end());
+  // Codes found by several threads are equal neighbours.
+  neighbours.erase(std::unique(neighbours.begin(), neighbours.end()),
+                   neighbours.end());
+  neighbours.resize(std::min<int>(std::max(k, 0), neighbours.size()));
+  for (auto &[distance, id] : neighbours) {
+    std::swap(distance, id);
+  }
+  return neighbours;
+}
+
+std::unique_ptr<LshIndex> LshIndex::open(const std::string &filename,
+                                         int numThreads) {
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  LOG_IF(FATAL, fd < 0) << "The LSH index cannot be opened " << filename
+                        << ": " << std::strerror(errno);
+  struct stat fileStat;
+  LOG_IF(FATAL, fstat(fd, &fileStat) != 0)
+      << "Failed to stat " << filename << ": " << std::strerror(errno);
+  const size_t size = fileStat.st_size;
+  LOG_IF(FATAL, size < sizeof(LshIndexHeader))
+      << "Not an LSH index: " << filename;
+  void *data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping stays valid after the descriptor is closed.
+  close(fd);
+  LOG_IF(FATAL, data == MAP_FAILED)
+      << "Failed to map " << filename << ": " << std::strerror(errno);
+  std::shared_ptr<const void> mapping(data, [size](const void *mapped) {
+    munmap(const_cast<void *>(mapped), size);
+  });
+
+  const auto &header = *static_cast<const LshIndexHeader *>(data);
+  LOG_IF(FATAL, std::memcmp(header.magic, LshIndexHeader::kMagic,
+                            sizeof(header.magic)) != 0)
+      << "Not an LSH index: " << filename;
+  LOG_IF(FATAL, header.version != LshIndexHeader::kVersion)
+      << "Unsupported LSH index version " << header.version << " in "
+      << filename;
+  LOG_IF(FATAL, header.fileSize != size || header.size < 0 ||
+                    header.size > INT_MAX || header.numHashed < 0 ||
+                    header.numHashed > header.size)
+      << "LSH index is truncated or damaged: " << filename;
+  // The options size the sampled bits and the probes, they are checked
+  // before anything is allocated for them.
+  LOG_IF(FATAL, header.numBits <= 0 || header.numTables <= 0 ||
+                    header.keySize <= 0 || header.keySize > 32 ||
+                    header.keySize > header.numBits ||
+                    header.multiProbeLevel < 0 ||
+                    header.multiProbeLevel > header.keySize ||
+                    numProbes(header.keySize, header.multiProbeLevel) >
+                        LshOptions::kMaxProbes ||
+                    static_cast<uint64_t>(header.numTables) * header.keySize >
+                        size / sizeof(uint32_t))
+      << "LSH index is truncated or damaged: " << filename;
+
+  LshOptions options;
+  options.numTables = header.numTables;
+  options.keySize = header.keySize;
+  options.multiProbeLevel = header.multiProbeLevel;
+  options.numThreads = numThreads;
+  options.seed = header.seed;
+  // The sampled bits are mapped from the file.
+  std::unique_ptr<LshIndex> index(
+      new LshIndex(header.numBits, options, /*sampleBits=*/false));
+  index->size_ = header.size;
+  index->numHashed_ = header.numHashed;
+  index->referenceFingerprint_ = header.referenceFingerprint;
+
+  const auto *bytes = static_cast<const char *>(data);
+  const auto mapArray = [&](auto &array, uint64_t offset, size_t length) {
+    using T = std::remove_cv_t<
+        std::remove_pointer_t<decltype(array.data())>>;
+    LOG_IF(FATAL, offset % kAlignment != 0 || offset > size ||
+                      length > (size - offset) / sizeof(T))
+        << "LSH index is truncated or damaged: " << filename;
+    array.map(reinterpret_cast<const T *>(bytes + offset), length);
+  };
+  const auto [numOffsets, numKeys, numIds] =
+      tableLengths(options, index->numHashed_);
+  mapArray(index->codes_, header.codesOffset,
+           static_cast<size_t>(index->size_) * index->words_);
+  mapArray(index->sampledBits_, header.sampledBitsOffset,
+           static_cast<size_t>(options.numTables) * options.keySize);
+  mapArray(index->bucketOffsets_, header.bucketOffsetsOffset, numOffsets);
+  mapArray(index->bucketKeys_, header.bucketKeysOffset, numKeys);
+  mapArray(index->bucketIds_, header.bucketIdsOffset, numIds);
+
+  // The sections are read without bounds checks when querying, so their
+  // contents have to be valid too.
+  const auto damaged = [&filename](bool condition) {
+    LOG_IF(FATAL, condition)
+        << "LSH index is truncated or damaged: " << filename;
+  };
+  const uint32_t numBits = index->numBits_;
+  const uint32_t *sampledBits = index->sampledBits_.data();
+  damaged(std::any_of(
+      sampledBits, sampledBits + index->sampledBits_.size(),
+      [numBits](uint32_t bit) { return bit >= numBits; }));
+  const int32_t *ids = index->bucketIds_.data();
+  const int32_t numHashed = index->numHashed_;
+  damaged(std::any_of(ids, ids + numIds, [numHashed](int32_t id) {
+    return id < 0 || id >= numHashed;
+  }));
+  if (numOffsets > 0) {
+    const size_t tableOffsets = numOffsets / options.numTables;
+    for (int t = 0; t < options.numTables; ++t) {
+      const uint32_t *offsets =
+          index->bucketOffsets_.data() + static_cast<size_t>(t) * tableOffsets;
+      damaged(offsets[0] != 0 ||
+              !std::is_sorted(offsets, offsets + tableOffsets) ||
+              offsets[tableOffsets - 1] > static_cast<uint32_t>(numHashed));
+    }
+  }
+  if (numKeys > 0) {
+    for (int t = 0; t < options.numTables; ++t) {
+      const uint32_t *keys =
+          index->bucketKeys_.data() + static_cast<size_t>(t) * numHashed;
+      damaged(!std::is_sorted(keys, keys + numHashed));
+    }
+  }
+  index->mapping_ = std::move(mapping);
+  return index;
+}
+
+void LshIndex::save(const std::string &filename,
+                    uint64_t referenceFingerprint) const {
+  const auto [numOffsets, numKeys, numIds] =
+      tableLengths(options_, numHashed_);
+  LshIndexHeader header;
+  std::memcpy(header.magic, LshIndexHeader::kMagic, sizeof(header.magic));
+  header.version = LshIndexHeader::kVersion;
+  header.numBits = numBits_;
+  header.numTables = options_.numTables;
+  header.keySize = options_.keySize;
+  header.multiProbeLevel = options_.multiProbeLevel;
+  header.seed = options_.seed;
+  header.size = size_;
+  header.numHashed = numHashed_;
+  header.referenceFingerprint = referenceFingerprint;
+  header.codesOffset = align(sizeof(header));
+  header.sampledBitsOffset =
+      align(header.codesOffset + codes_.size() * sizeof(uint64_t));
+  header.bucketOffsetsOffset =
+      align(header.sampledBitsOffset + sampledBits_.size() * sizeof(uint32_t));
+  header.bucketKeysOffset =
+      align(header.bucketOffsetsOffset + numOffsets * sizeof(uint32_t));
+  header.bucketIdsOffset =
+      align(header.bucketKeysOffset + numKeys * sizeof(uint32_t));
+  header.fileSize = header.bucketIdsOffset + numIds * sizeof(int32_t);
+
+  // The index is written next to the file and renamed, so a reader never
+  // maps a partly written index.
+  const std::string tmpFile = filename + ".tmp";
+  std::ofstream out(tmpFile,
+                    std::ios::out | std::ios::binary | std::ios::trunc);
+  LOG_IF(FATAL, !out) << "The file cannot be opened " << tmpFile;
+  const auto writeAt = [&out](uint64_t offset, const void *data,
+                              size_t bytes) {
+    out.seekp(offset);
+    out.write(static_cast<const char *>(data), bytes);
+  };
+  writeAt(header.codesOffset, codes_.data(),
+          codes_.size() * sizeof(uint64_t));
+  writeAt(header.sampledBitsOffset, sampledBits_.data(),
+          sampledBits_.size() * sizeof(uint32_t));
+  writeAt(header.bucketOffsetsOffset, bucketOffsets_.data(),
+          numOffsets * sizeof(uint32_t));
+  writeAt(header.bucketKeysOffset, bucketKeys_.data(),
+          numKeys * sizeof(uint32_t));
+  writeAt(header.bucketIdsOffset, bucketIds_.data(),
+          numIds * sizeof(int32_t));
+  writeAt(0, &header, sizeof(header));
+  out.close();
+  LOG_IF(FATAL, !out) << "Failed to write the LSH index " << tmpFile;
+  // Empty trailing arrays leave a gap up to their offset.
+  std::filesystem::resize_file(tmpFile, header.fileSize);
+  std::filesystem::rename(tmpFile, filename);
+  LOG(INFO) << "Saved the LSH index of " << size_ << " codes to " << filename;
+}
+
+size_t LshIndex::memoryBytes() const {
+  return codes_.bytes() + sampledBits_.bytes() +
+         probeMasks_.capacity() * sizeof(uint32_t) + bucketOffsets_.bytes() +
+         bucketKeys_.bytes() + bucketIds_.bytes();
+}
+
+} // namespace localization::features
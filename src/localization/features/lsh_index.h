@@ -0,0 +1,226 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_LSH_INDEX_H_
+#define SRC_FEATURES_LSH_INDEX_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace localization::features {
+
+struct LshOptions {
+  // Number of hash tables, more tables find more of the near neighbours.
+  int numTables = 25;
+  // Bits sampled for the key of a table, 1 to 32.
+  int keySize = 16;
+  // The buckets whose keys differ from the key of the query in up to this
+  // many bits are probed as well, 0 is plain LSH. The number of probed
+  // buckets grows with the binomial coefficients of the key size, at most
+  // kMaxProbes buckets are probed per table.
+  int multiProbeLevel = 2;
+  // Threads that probe the tables of one query, 1 probes them on the calling
+  // thread. Starting the threads costs tens of microseconds, it pays off for
+  // many tables and large buckets.
+  int numThreads = 1;
+  uint32_t seed = 0;
+
+  static constexpr size_t kMaxProbes = size_t{1} << 16;
+};
+
+/**
+ * @brief      Header of a persisted LSH index (*.LshIndex.bin):
+ *
+ *   header | size x words uint64 codes | numTables x keySize uint32 sampled
+ *   bits | uint32 bucket offsets | uint32 bucket keys | int32 bucket ids
+ *
+ * Every array starts at a 64 byte aligned offset and is stored in the native
+ * (little-endian) byte order, so an opened index uses the mapped file as is.
+ * The tables are empty if no code was hashed.
+ */
+struct LshIndexHeader {
+  static constexpr char kMagic[8] = "ISLLSHI";
+  static constexpr uint32_t kVersion = 1;
+
+  char magic[8] = {};
+  uint32_t version = 0;
+  int32_t numBits = 0;
+  int32_t numTables = 0;
+  int32_t keySize = 0;
+  int32_t multiProbeLevel = 0;
+  uint32_t seed = 0;
+  int64_t size = 0;
+  int64_t numHashed = 0;
+  // Identifies the features the index was built from, see LshIndex::save().
+  uint64_t referenceFingerprint = 0;
+  uint64_t codesOffset = 0;
+  uint64_t sampledBitsOffset = 0;
+  uint64_t bucketOffsetsOffset = 0;
+  uint64_t bucketKeysOffset = 0;
+  uint64_t bucketIdsOffset = 0;
+  uint64_t fileSize = 0;
+};
+static_assert(sizeof(LshIndexHeader) == 104,
+              "The LSH index header should stay 104 bytes long");
+
+/**
+ * @brief      Multi-probe bit-sampling LSH over binary codes packed in 64-bit
+ * words, for the Hamming distance. The key of a code in a table are
+ * `keySize` of its bits at random positions, codes with a small Hamming
+ * distance are likely to share a key in some table. The codes found in the
+ * probed buckets are ranked by their Hamming distance to the query.
+ *
+ * All data is kept in flat arrays. The buckets of a table are a range of
+ * `bucketIds_`; keys of up to 16 bits index the range directly through
+ * `bucketOffsets_`, longer keys are found by binary search in the sorted
+ * `bucketKeys_`. A saved index is mapped back by open() without rebuilding
+ * the tables.
+ */
+class LshIndex {
+public:
+  explicit LshIndex(int numBits, const LshOptions &options = {});
+
+  /**
+   * @brief      Maps an index written by save(). Opening does not read the
+   * codes or the tables, the pages are loaded on the first queries and shared
+   * with other processes that map the same file. The options are the saved
+   * ones, except for the `numThreads` that probe a query.
+   */
+  static std::unique_ptr<LshIndex> open(const std::string &filename,
+                                        int numThreads = 1);
+  /**
+   * @brief      Writes the index, codes that were added after the last
+   * rebuild stay pending in the file. `referenceFingerprint` identifies the
+   * features the codes come from, e.g. database::fingerprintFeatures(), so
+   * a stale index can be detected. The file is replaced atomically, indices
+   * mapped from the old file stay valid.
+   */
+  void save(const std::string &filename,
+            uint64_t referenceFingerprint = 0) const;
+
+  /**
+   * @brief      Adds the code of words() words with the next id, 0 for the
+   * first one. Codes added to a built index are searched exhaustively until
+   * they make up a tenth of the hashed ones, then the tables are rebuilt.
+   */
+  int add(const uint64_t *code);
+  /** Hashes all codes, call it once after adding the initial codes. **/
+  void rebuild();
+
+  int size() const { return size_; }
+  int numHashed() const { return numHashed_; }
+  int numBits() const { return numBits_; }
+  int words() const { return words_; }
+  const LshOptions &options() const { return options_; }
+  /** The fingerprint passed to save() for an opened index, 0 otherwise. **/
+  uint64_t referenceFingerprint() const { return referenceFingerprint_; }
+  const uint64_t *code(int id) const {
+    return codes_.data() + static_cast<size_t>(id) * words_;
+  }
+
+  /** The at most `k` nearest codes found by probing the tables, as (id,
+   * Hamming distance), the nearest first and ties by increasing id. **/
+  std::vector<std::pair<int, int>> knn(const uint64_t *query, int k) const;
+
+  /** Bytes held by the codes and the tables, mapped or not. **/
+  size_t memoryBytes() const;
+
+private:
+  // Without `sampleBits` the sampled bits are left empty for open().
+  LshIndex(int numBits, const LshOptions &options, bool sampleBits);
+
+  // An array of the index, built in memory or mapped from a file.
+  template <class T> class Array {
+  public:
+    const T *data() const { return mapped_ ? mapped_ : owned_.data(); }
+    size_t size() const { return mapped_ ? mappedSize_ : owned_.size(); }
+    size_t bytes() const {
+      return (mapped_ ? mappedSize_ : owned_.capacity()) * sizeof(T);
+    }
+    void map(const T *data, size_t size) {
+      owned_ = {};
+      mapped_ = data;
+      mappedSize_ = size;
+    }
+    // The array in memory, a mapped array is copied first.
+    std::vector<T> &owned() {
+      if (mapped_) {
+        owned_.assign(mapped_, mapped_ + mappedSize_);
+        mapped_ = nullptr;
+      }
+      return owned_;
+    }
+    // An empty array in memory, the mapped data is dropped.
+    std::vector<T> &reset() {
+      mapped_ = nullptr;
+      owned_.clear();
+      return owned_;
+    }
+
+  private:
+    std::vector<T> owned_;
+    const T *mapped_ = nullptr;
+    size_t mappedSize_ = 0;
+  };
+
+  uint32_t key(int table, const uint64_t *code) const;
+  // Appends the ids in the probed buckets of the table, with repetitions.
+  void probeTable(int table, const uint64_t *query,
+                  std::vector<int32_t> *ids) const;
+  // Appends the distinct codes found in the tables [firstTable, lastTable)
+  // as (Hamming distance, id).
+  void rankTables(int firstTable, int lastTable, const uint64_t *query,
+                  std::vector<std::pair<int, int>> *neighbours) const;
+  bool directTables() const;
+
+  LshOptions options_;
+  int numBits_ = 0;
+  int words_ = 0;
+  int size_ = 0;
+  int numHashed_ = 0;
+  uint64_t referenceFingerprint_ = 0;
+  // The mapped file of an opened index.
+  std::shared_ptr<const void> mapping_;
+  Array<uint64_t> codes_;
+  // keySize bit positions per table.
+  Array<uint32_t> sampledBits_;
+  // Key differences of the probed buckets, the fewest flipped bits first.
+  std::vector<uint32_t> probeMasks_;
+  // Per table 2^keySize + 1 offsets into its ids, for direct tables.
+  Array<uint32_t> bucketOffsets_;
+  // Per table numHashed_ keys in increasing order, for sorted tables.
+  Array<uint32_t> bucketKeys_;
+  // Per table numHashed_ ids, grouped by key.
+  Array<int32_t> bucketIds_;
+};
+
+/** Returns true if the path has the `.LshIndex.bin` extension. **/
+bool isLshIndexFile(const std::string &path);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_LSH_INDEX_H_
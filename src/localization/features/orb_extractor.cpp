@@ -0,0 +1,77 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/orb_extractor.h"
+
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <glog/logging.h>
+
+#include <cstring>
+
+namespace localization::features {
+
+std::vector<BinaryDescriptor> extractOrbDescriptors(const cv::Mat &image,
+                                                    const OrbOptions &options) {
+  cv::Mat gray;
+  if (image.channels() == 1) {
+    gray = image;
+  } else {
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+  }
+  if (options.maxImageWidth > 0 && gray.cols > options.maxImageWidth) {
+    const double scale = static_cast<double>(options.maxImageWidth) / gray.cols;
+    cv::resize(gray, gray, cv::Size(), scale, scale, cv::INTER_AREA);
+  }
+
+  // A detector must not be shared between threads, every call creates its
+  // own.
+  cv::Ptr<cv::ORB> orb = cv::ORB::create(options.maxKeypoints);
+  std::vector<cv::KeyPoint> keypoints;
+  cv::Mat descriptors;
+  orb->detectAndCompute(gray, cv::noArray(), keypoints, descriptors);
+  if (descriptors.empty()) {
+    return {};
+  }
+  CHECK(descriptors.type() == CV_8UC1 &&
+        descriptors.cols == sizeof(BinaryDescriptor))
+      << "Unexpected ORB descriptor layout";
+
+  std::vector<BinaryDescriptor> result(descriptors.rows);
+  for (int row = 0; row < descriptors.rows; ++row) {
+    std::memcpy(result[row].data(), descriptors.ptr<uchar>(row),
+                sizeof(BinaryDescriptor));
+  }
+  return result;
+}
+
+std::vector<BinaryDescriptor>
+extractOrbDescriptors(const std::string &imageFile, const OrbOptions &options) {
+  const cv::Mat image = cv::imread(imageFile, cv::IMREAD_GRAYSCALE);
+  LOG_IF(FATAL, image.empty()) << "The image cannot be read " << imageFile;
+  return extractOrbDescriptors(image, options);
+}
+
+} // namespace localization::features
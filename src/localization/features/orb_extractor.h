@@ -0,0 +1,54 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_ORB_EXTRACTOR_H_
+#define SRC_FEATURES_ORB_EXTRACTOR_H_
+
+#include "features/bow_vocabulary.h"
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+struct OrbOptions {
+  int maxKeypoints = 1000;
+  // Wider images are scaled down to this width first, larger images only add
+  // keypoints on finer structures.
+  int maxImageWidth = 640;
+};
+
+/** ORB descriptors of a grayscale or color image. **/
+std::vector<BinaryDescriptor>
+extractOrbDescriptors(const cv::Mat &image, const OrbOptions &options = {});
+/** Reads the image and extracts its ORB descriptors. Dies if it cannot be
+ * read. **/
+std::vector<BinaryDescriptor>
+extractOrbDescriptors(const std::string &imageFile,
+                      const OrbOptions &options = {});
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_ORB_EXTRACTOR_H_
@@ -0,0 +1,104 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/patch_descriptor.h"
+
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace localization::features {
+
+namespace {
+// Patches with a smaller standard deviation, in gray levels, are flat.
+constexpr double kMinPatchStd = 1e-3;
+} // namespace
+
+std::vector<double>
+computePatchDescriptor(const cv::Mat &image,
+                       const PatchDescriptorOptions &options) {
+  CHECK(options.patchSize > 0 && options.width % options.patchSize == 0 &&
+        options.height % options.patchSize == 0)
+      << "The patch size " << options.patchSize
+      << " does not divide the descriptor size " << options.width << "x"
+      << options.height;
+  CHECK(!image.empty()) << "The image is empty.";
+  // The gray levels and kMinPatchStd are those of 8-bit images.
+  CHECK(image.depth() == CV_8U)
+      << "Patch descriptors are computed from 8-bit images, got an image of "
+         "depth "
+      << image.depth() << ". Convert it with cv::Mat::convertTo() first.";
+  cv::Mat gray;
+  if (image.channels() == 1) {
+    gray = image;
+  } else {
+    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+  }
+  cv::Mat small;
+  // Area interpolation averages all the pixels, the descriptor does not
+  // alias on fine textures.
+  cv::resize(gray, small, cv::Size(options.width, options.height), 0, 0,
+             cv::INTER_AREA);
+
+  std::vector<double> values(static_cast<size_t>(options.width) *
+                             options.height);
+  const int patchPixels = options.patchSize * options.patchSize;
+  for (int py = 0; py < options.height; py += options.patchSize) {
+    for (int px = 0; px < options.width; px += options.patchSize) {
+      double sum = 0.0;
+      double squaredSum = 0.0;
+      for (int y = py; y < py + options.patchSize; ++y) {
+        const uchar *row = small.ptr<uchar>(y);
+        for (int x = px; x < px + options.patchSize; ++x) {
+          sum += row[x];
+          squaredSum += static_cast<double>(row[x]) * row[x];
+        }
+      }
+      const double mean = sum / patchPixels;
+      const double std =
+          std::sqrt(std::max(0.0, squaredSum / patchPixels - mean * mean));
+      for (int y = py; y < py + options.patchSize; ++y) {
+        const uchar *row = small.ptr<uchar>(y);
+        for (int x = px; x < px + options.patchSize; ++x) {
+          values[static_cast<size_t>(y) * options.width + x] =
+              std < kMinPatchStd ? 0.0 : (row[x] - mean) / std;
+        }
+      }
+    }
+  }
+  return values;
+}
+
+std::vector<double>
+computePatchDescriptor(const std::string &imageFile,
+                       const PatchDescriptorOptions &options) {
+  const cv::Mat image = cv::imread(imageFile, cv::IMREAD_GRAYSCALE);
+  LOG_IF(FATAL, image.empty()) << "The image cannot be read " << imageFile;
+  return computePatchDescriptor(image, options);
+}
+
+} // namespace localization::features
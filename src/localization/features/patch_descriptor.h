@@ -0,0 +1,64 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PATCH_DESCRIPTOR_H_
+#define SRC_FEATURES_PATCH_DESCRIPTOR_H_
+
+#include <opencv2/core.hpp>
+
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+struct PatchDescriptorOptions {
+  // Size of the downsampled image, the SeqSLAM defaults.
+  int width = 64;
+  int height = 32;
+  // Side of the square patches that are normalized separately, has to
+  // divide the width and the height.
+  int patchSize = 8;
+};
+
+/**
+ * @brief      SeqSLAM-style global descriptor of an image: the image is
+ * converted to grayscale, downsampled and every patch is normalized to zero
+ * mean and unit variance. Patch normalization removes most of the effect of
+ * global and local illumination changes. Returns width * height values,
+ * row-major. Flat patches are all 0. The image has to be 8-bit.
+ *
+ * The values are stored as `.Feature.pb` and loaded as `Patch_Feature`, see
+ * features/patch_feature.h.
+ */
+std::vector<double>
+computePatchDescriptor(const cv::Mat &image,
+                       const PatchDescriptorOptions &options = {});
+/** Reads the image and computes its descriptor. Dies if it cannot be read.
+ * **/
+std::vector<double>
+computePatchDescriptor(const std::string &imageFile,
+                       const PatchDescriptorOptions &options = {});
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PATCH_DESCRIPTOR_H_
@@ -0,0 +1,70 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/patch_feature.h"
+#include "features/feature_io.h"
+#include "features/feature_traits.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace localization::features {
+
+namespace {
+// Expected |a - b| of two independent standard normal values.
+const double kUnrelatedMeanAbsDiff = 2.0 / std::sqrt(M_PI);
+} // namespace
+
+PatchFeature::PatchFeature(const std::string &filename)
+    : PatchFeature(readFeatureValues(filename)) {}
+
+PatchFeature::PatchFeature(const std::vector<double> &values)
+    : values_(values.size()) {
+  type = "PatchFeature";
+  for (size_t d = 0; d < values.size(); ++d) {
+    const long quantized = std::lround(values[d] * kScale) + 128;
+    values_[d] = static_cast<uint8_t>(std::clamp(quantized, 0L, 255L));
+  }
+}
+
+double patchScore(uint32_t sumAbsDiff, int dim) {
+  if (dim == 0) {
+    return 0.0;
+  }
+  const double meanAbsDiff = sumAbsDiff / (PatchFeature::kScale * dim);
+  return std::max(0.0, 1.0 - meanAbsDiff / kUnrelatedMeanAbsDiff);
+}
+
+double PatchFeature::computeSimilarityScore(const iFeature &rhs) const {
+  CHECK(this->type == rhs.type) << "Features are not the same type";
+  const auto &other = static_cast<const PatchFeature &>(rhs);
+  return FeatureTraits<PatchFeature>::score(*this, other);
+}
+
+double PatchFeature::score2cost(double score) const {
+  return FeatureTraits<PatchFeature>::cost(score);
+}
+
+} // namespace localization::features
@@ -0,0 +1,75 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PATCH_FEATURE_H_
+#define SRC_FEATURES_PATCH_FEATURE_H_
+
+#include "features/aligned_allocator.h"
+#include "features/ifeature.h"
+
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      Handcrafted SeqSLAM-style descriptor: a downsampled grayscale
+ * image in which every patch is normalized to zero mean and unit variance,
+ * see features/patch_descriptor.h. The normalized values are stored as one
+ * uint8 per pixel and compared by the sum of absolute differences, which
+ * the psadbw instruction computes for 32 or 64 pixels at once.
+ *
+ * The score is 1 minus the mean absolute difference relative to the one of
+ * unrelated images, 2 / sqrt(pi) for independent unit Gaussians. Like the
+ * cosine similarity of CnnFeature, 1 means identical and 0 unrelated, so
+ * the matching threshold keeps its meaning. Less similar pairs score 0.
+ */
+class PatchFeature : public iFeature {
+public:
+  // Quantization steps per standard deviation, values beyond about 4
+  // standard deviations are clipped.
+  static constexpr float kScale = 32.f;
+
+  explicit PatchFeature(const std::string &filename);
+  explicit PatchFeature(const std::vector<double> &values);
+
+  double computeSimilarityScore(const iFeature &rhs) const override;
+  double score2cost(double score) const override;
+  size_t memoryBytes() const override {
+    return sizeof(*this) + type.capacity() + values_.capacity();
+  }
+
+  const uint8_t *data() const { return values_.data(); }
+  int size() const { return values_.size(); }
+
+private:
+  AlignedUint8Vector values_;
+};
+
+/** Score of two patch features with the given sum of absolute differences of
+ * their `dim` quantized values. **/
+double patchScore(uint32_t sumAbsDiff, int dim);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PATCH_FEATURE_H_
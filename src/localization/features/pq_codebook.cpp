@@ -0,0 +1,210 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/pq_codebook.h"
+#include "features/feature_matrix.h"
+#include "features/similarity_kernels.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <numeric>
+#include <ostream>
+#include <random>
+
+namespace localization::features {
+
+namespace {
+float squaredDistance(const float *lhs, const float *rhs, int dim) {
+  float distance = 0.f;
+  for (int d = 0; d < dim; ++d) {
+    const float diff = lhs[d] - rhs[d];
+    distance += diff * diff;
+  }
+  return distance;
+}
+
+int nearestCentroid(const PqCodebook &codebook, int m, const float *values) {
+  const int subDim = codebook.subspaceDim(m);
+  int best = 0;
+  float bestDistance = std::numeric_limits<float>::max();
+  for (int c = 0; c < codebook.numCentroids(); ++c) {
+    const float distance =
+        squaredDistance(values, codebook.centroid(m, c), subDim);
+    if (distance < bestDistance) {
+      bestDistance = distance;
+      best = c;
+    }
+  }
+  return best;
+}
+} // namespace
+
+PqCodebook::PqCodebook(int dim, int numSubspaces, int numCentroids)
+    : dim_{dim}, numSubspaces_{numSubspaces}, numCentroids_{numCentroids} {
+  CHECK(numSubspaces > 0 && numSubspaces <= dim)
+      << "Invalid number of subspaces " << numSubspaces << " for dimension "
+      << dim;
+  CHECK(numCentroids > 0 && numCentroids <= 256)
+      << "Invalid number of centroids " << numCentroids
+      << ", codes are one byte per subspace.";
+  centroids_.resize(static_cast<size_t>(numCentroids) * dim, 0.f);
+}
+
+PqCodebook PqCodebook::train(const FeatureMatrix &features,
+                             const PqTrainOptions &options) {
+  PqCodebook codebook(features.dim(), options.numSubspaces,
+                      options.numCentroids);
+  std::vector<int> samples(features.rows());
+  std::iota(samples.begin(), samples.end(), 0);
+  std::mt19937 generator(options.seed);
+  std::shuffle(samples.begin(), samples.end(), generator);
+  samples.resize(std::min<int>(samples.size(), options.maxTrainingSamples));
+  LOG_IF(FATAL, static_cast<int>(samples.size()) < options.numCentroids)
+      << "Not enough features to train " << options.numCentroids
+      << " centroids: " << samples.size();
+
+  // The subspaces are independent, each one runs its own k-means.
+  tools::parallelFor(
+      0, codebook.numSubspaces(),
+      [&](int m) {
+        const int begin = codebook.subspaceBegin(m);
+        const int subDim = codebook.subspaceDim(m);
+        std::mt19937 subspaceGenerator(options.seed + m);
+        for (int c = 0; c < options.numCentroids; ++c) {
+          std::copy_n(features.row(samples[c]) + begin, subDim,
+                      codebook.centroid(m, c));
+        }
+        std::vector<int> assignment(samples.size(), -1);
+        std::vector<double> sums(static_cast<size_t>(options.numCentroids) *
+                                 subDim);
+        std::vector<int> counts(options.numCentroids);
+        for (int iteration = 0; iteration < options.iterations; ++iteration) {
+          bool changed = false;
+          for (size_t s = 0; s < samples.size(); ++s) {
+            const int nearest =
+                nearestCentroid(codebook, m, features.row(samples[s]) + begin);
+            changed |= nearest != assignment[s];
+            assignment[s] = nearest;
+          }
+          if (!changed) {
+            break;
+          }
+          std::fill(sums.begin(), sums.end(), 0.0);
+          std::fill(counts.begin(), counts.end(), 0);
+          for (size_t s = 0; s < samples.size(); ++s) {
+            const float *values = features.row(samples[s]) + begin;
+            double *sum = sums.data() + assignment[s] * subDim;
+            for (int d = 0; d < subDim; ++d) {
+              sum[d] += values[d];
+            }
+            ++counts[assignment[s]];
+          }
+          std::uniform_int_distribution<int> pick(0, samples.size() - 1);
+          for (int c = 0; c < options.numCentroids; ++c) {
+            float *centroid = codebook.centroid(m, c);
+            if (counts[c] == 0) {
+              // An empty cluster is restarted at a random sample.
+              std::copy_n(features.row(samples[pick(subspaceGenerator)]) +
+                              begin,
+                          subDim, centroid);
+              continue;
+            }
+            for (int d = 0; d < subDim; ++d) {
+              centroid[d] = sums[c * subDim + d] / counts[c];
+            }
+          }
+        }
+      },
+      options.numThreads);
+  LOG(INFO) << "Trained a product quantizer with " << options.numSubspaces
+            << " subspaces of " << options.numCentroids << " centroids on "
+            << samples.size() << " features.";
+  return codebook;
+}
+
+void PqCodebook::encode(const float *values, uint8_t *code) const {
+  for (int m = 0; m < numSubspaces_; ++m) {
+    code[m] = nearestCentroid(*this, m, values + subspaceBegin(m));
+  }
+}
+
+void PqCodebook::decode(const uint8_t *code, float *values) const {
+  for (int m = 0; m < numSubspaces_; ++m) {
+    std::copy_n(centroid(m, code[m]), subspaceDim(m),
+                values + subspaceBegin(m));
+  }
+}
+
+void PqCodebook::innerProductTable(const float *query, float *table) const {
+  for (int m = 0; m < numSubspaces_; ++m) {
+    const float *subQuery = query + subspaceBegin(m);
+    for (int c = 0; c < numCentroids_; ++c) {
+      table[m * numCentroids_ + c] =
+          dotProduct(subQuery, centroid(m, c), subspaceDim(m));
+    }
+  }
+}
+
+float PqCodebook::score(const uint8_t *lhs, const uint8_t *rhs) const {
+  float score = 0.f;
+  for (int m = 0; m < numSubspaces_; ++m) {
+    score += dotProduct(centroid(m, lhs[m]), centroid(m, rhs[m]),
+                        subspaceDim(m));
+  }
+  return score;
+}
+
+void PqCodebook::write(std::ostream &out) const {
+  const int32_t sizes[3] = {dim_, numSubspaces_, numCentroids_};
+  out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+  out.write(reinterpret_cast<const char *>(centroids_.data()),
+            centroids_.size() * sizeof(float));
+}
+
+PqCodebook PqCodebook::read(std::istream &in) {
+  int32_t sizes[3] = {0, 0, 0};
+  in.read(reinterpret_cast<char *>(sizes), sizeof(sizes));
+  LOG_IF(FATAL, !in) << "Failed to read the product quantization codebook.";
+  // The centroids must fit into the rest of the stream before they are
+  // allocated, a damaged size would otherwise request gigabytes.
+  const std::streampos start = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::streamoff remaining = in.tellg() - start;
+  in.seekg(start);
+  LOG_IF(FATAL, sizes[0] <= 0 || sizes[2] <= 0 ||
+                    static_cast<uint64_t>(sizes[0]) * sizes[2] >
+                        static_cast<uint64_t>(remaining) / sizeof(float))
+      << "The product quantization codebook is truncated or damaged.";
+  PqCodebook codebook(sizes[0], sizes[1], sizes[2]);
+  in.read(reinterpret_cast<char *>(codebook.centroids_.data()),
+          codebook.centroids_.size() * sizeof(float));
+  LOG_IF(FATAL, !in) << "Failed to read the product quantization codebook.";
+  return codebook;
+}
+
+} // namespace localization::features
@@ -0,0 +1,120 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PQ_CODEBOOK_H_
+#define SRC_FEATURES_PQ_CODEBOOK_H_
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace localization::features {
+
+class FeatureMatrix;
+
+struct PqTrainOptions {
+  // Number of sub-vectors every feature is split into, i.e. bytes per code.
+  int numSubspaces = 64;
+  // Centroids per subspace, at most 256 so that one code entry is one byte.
+  int numCentroids = 256;
+  int iterations = 25;
+  // The codebook is trained on a random subset of the features.
+  int maxTrainingSamples = 65536;
+  uint32_t seed = 0;
+  // <= 0 means all available threads.
+  int numThreads = 0;
+};
+
+/**
+ * @brief      Product quantization codebook. A feature is split into
+ * `numSubspaces` consecutive sub-vectors and every sub-vector is replaced by
+ * the id of its nearest centroid, so a feature of any dimension is encoded in
+ * `numSubspaces` bytes.
+ *
+ * A query is compared against encoded features through an inner product
+ * table of the query with all the centroids (asymmetric distance
+ * computation): the score of a code is the sum of one table entry per
+ * subspace.
+ */
+class PqCodebook {
+public:
+  PqCodebook() = default;
+  PqCodebook(int dim, int numSubspaces, int numCentroids);
+
+  /** Trains the centroids with k-means on the L2-normalized rows. **/
+  static PqCodebook train(const FeatureMatrix &features,
+                          const PqTrainOptions &options);
+
+  int dim() const { return dim_; }
+  int numSubspaces() const { return numSubspaces_; }
+  int numCentroids() const { return numCentroids_; }
+  /** Subspace `m` covers the dimensions [subspaceBegin(m),
+   * subspaceBegin(m + 1)). **/
+  int subspaceBegin(int m) const {
+    return static_cast<int64_t>(m) * dim_ / numSubspaces_;
+  }
+  int subspaceDim(int m) const { return subspaceBegin(m + 1) - subspaceBegin(m); }
+
+  float *centroid(int m, int c) { return centroids_.data() + offset(m, c); }
+  const float *centroid(int m, int c) const {
+    return centroids_.data() + offset(m, c);
+  }
+
+  /** Writes `numSubspaces` bytes to `code`. **/
+  void encode(const float *values, uint8_t *code) const;
+  /** Writes `dim` values to `values`. **/
+  void decode(const uint8_t *code, float *values) const;
+
+  /** Fills `table[m * numCentroids + c]` with the inner product of the
+   * query sub-vector `m` and the centroid `c`. **/
+  void innerProductTable(const float *query, float *table) const;
+  float score(const float *table, const uint8_t *code) const {
+    float score = 0.f;
+    for (int m = 0; m < numSubspaces_; ++m) {
+      score += table[m * numCentroids_ + code[m]];
+    }
+    return score;
+  }
+  /** Inner product of two decoded codes. **/
+  float score(const uint8_t *lhs, const uint8_t *rhs) const;
+
+  void write(std::ostream &out) const;
+  static PqCodebook read(std::istream &in);
+
+private:
+  size_t offset(int m, int c) const {
+    return static_cast<size_t>(numCentroids_) * subspaceBegin(m) +
+           static_cast<size_t>(c) * subspaceDim(m);
+  }
+
+  int dim_ = 0;
+  int numSubspaces_ = 0;
+  int numCentroids_ = 0;
+  // The centroids of subspace m are stored one after another, each with
+  // subspaceDim(m) values.
+  std::vector<float> centroids_;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PQ_CODEBOOK_H_
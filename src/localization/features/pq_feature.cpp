@@ -0,0 +1,56 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/pq_feature.h"
+
+#include <glog/logging.h>
+
+#include <limits>
+
+namespace localization::features {
+
+PqFeature::PqFeature(std::shared_ptr<const PqStore> store, int id)
+    : store_{std::move(store)} {
+  CHECK(store_) << "PQ store is not set.";
+  CHECK(id >= 0 && id < store_->size()) << "Feature " << id
+                                        << " is out of range";
+  code_ = store_->code(id);
+  type = "PqFeature";
+}
+
+double PqFeature::computeSimilarityScore(const iFeature &rhs) const {
+  CHECK(this->type == rhs.type) << "Features are not the same type";
+  const auto &other = static_cast<const PqFeature &>(rhs);
+  CHECK(store_ == other.store_)
+      << "Features are encoded with different codebooks";
+  return store_->codebook().score(code_, other.code_);
+}
+
+double PqFeature::score2cost(double score) const {
+  if (score < 1e-09) {
+    return std::numeric_limits<double>::max();
+  }
+  return 1. / score;
+}
+
+} // namespace localization::features
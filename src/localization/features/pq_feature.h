@@ -0,0 +1,57 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PQ_FEATURE_H_
+#define SRC_FEATURES_PQ_FEATURE_H_
+
+#include "features/ifeature.h"
+#include "features/pq_store.h"
+
+#include <memory>
+
+namespace localization::features {
+
+/**
+ * @brief      Feature encoded in a PqStore. Two PQ features are compared by
+ * the inner product of their decoded values. Queries are scored against PQ
+ * features more accurately with the asymmetric tables of PqDatabase.
+ */
+class PqFeature : public iFeature {
+public:
+  PqFeature(std::shared_ptr<const PqStore> store, int id);
+
+  double computeSimilarityScore(const iFeature &rhs) const override;
+  double score2cost(double score) const override;
+  // The code lives in the store, not in the feature.
+  size_t memoryBytes() const override { return sizeof(*this); }
+
+  const uint8_t *code() const { return code_; }
+
+private:
+  std::shared_ptr<const PqStore> store_;
+  const uint8_t *code_ = nullptr;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PQ_FEATURE_H_
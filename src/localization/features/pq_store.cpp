@@ -0,0 +1,163 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/pq_store.h"
+#include "database/list_dir.h"
+#include "features/feature_matrix.h"
+#include "features/feature_store.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace localization::features {
+
+namespace {
+constexpr auto kPqStoreExtension = ".PqStore.bin";
+constexpr char kMagic[8] = "ISLPQST";
+constexpr uint32_t kVersion = 1;
+} // namespace
+
+bool isPqStoreFile(const std::string &path) {
+  const std::string extension = kPqStoreExtension;
+  return path.size() >= extension.size() &&
+         path.compare(path.size() - extension.size(), extension.size(),
+                      extension) == 0;
+}
+
+PqStore::PqStore(PqCodebook codebook, std::vector<uint8_t> codes,
+                 std::vector<std::string> names)
+    : codebook_{std::move(codebook)}, codes_{std::move(codes)},
+      names_{std::move(names)} {
+  CHECK(codes_.size() == names_.size() * codebook_.numSubspaces())
+      << "Expected " << names_.size() << " codes of "
+      << codebook_.numSubspaces() << " bytes, got " << codes_.size()
+      << " bytes.";
+}
+
+std::shared_ptr<const PqStore> PqStore::encode(PqCodebook codebook,
+                                               const FeatureMatrix &features,
+                                               std::vector<std::string> names,
+                                               int numThreads) {
+  CHECK(features.rows() == static_cast<int>(names.size()))
+      << "Expected one name per feature.";
+  CHECK(features.dim() == codebook.dim())
+      << "Features have dimension " << features.dim()
+      << ", the codebook expects " << codebook.dim();
+  const int codeSize = codebook.numSubspaces();
+  std::vector<uint8_t> codes(static_cast<size_t>(features.rows()) * codeSize);
+  tools::parallelFor(
+      0, features.rows(),
+      [&](int row) {
+        codebook.encode(features.row(row),
+                        codes.data() + static_cast<size_t>(row) * codeSize);
+      },
+      numThreads);
+  return std::make_shared<const PqStore>(std::move(codebook), std::move(codes),
+                                         std::move(names));
+}
+
+std::shared_ptr<const PqStore> PqStore::open(const std::string &filename) {
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  LOG_IF(FATAL, !in) << "The PQ store cannot be opened " << filename;
+  char magic[8] = {};
+  uint32_t version = 0;
+  int64_t rows = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(&rows), sizeof(rows));
+  LOG_IF(FATAL, !in || std::memcmp(magic, kMagic, sizeof(magic)) != 0)
+      << "Not a PQ store: " << filename;
+  LOG_IF(FATAL, version != kVersion)
+      << "Unsupported PQ store version " << version << " in " << filename;
+  const uint64_t fileSize = std::filesystem::file_size(filename);
+  PqCodebook codebook = PqCodebook::read(in);
+  // Every row takes its code and at least the length of its name.
+  const uint64_t remaining = fileSize - static_cast<uint64_t>(in.tellg());
+  LOG_IF(FATAL, rows < 0 ||
+                    static_cast<uint64_t>(rows) >
+                        remaining / (codebook.numSubspaces() + sizeof(uint32_t)))
+      << "PQ store is truncated or damaged: " << filename;
+  std::vector<uint8_t> codes(rows * codebook.numSubspaces());
+  in.read(reinterpret_cast<char *>(codes.data()), codes.size());
+  std::vector<std::string> names(rows);
+  for (auto &name : names) {
+    uint32_t length = 0;
+    in.read(reinterpret_cast<char *>(&length), sizeof(length));
+    LOG_IF(FATAL, !in || length > fileSize - static_cast<uint64_t>(in.tellg()))
+        << "PQ store is truncated or damaged: " << filename;
+    name.resize(length);
+    in.read(name.data(), length);
+  }
+  LOG_IF(FATAL, !in) << "PQ store is truncated: " << filename;
+  return std::make_shared<const PqStore>(std::move(codebook), std::move(codes),
+                                         std::move(names));
+}
+
+void PqStore::save(const std::string &filename) const {
+  std::ofstream out(filename,
+                    std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !out) << "The file cannot be opened " << filename;
+  const int64_t rows = size();
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+  out.write(reinterpret_cast<const char *>(&rows), sizeof(rows));
+  codebook_.write(out);
+  out.write(reinterpret_cast<const char *>(codes_.data()), codes_.size());
+  for (const auto &name : names_) {
+    const uint32_t length = name.size();
+    out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    out.write(name.data(), length);
+  }
+  LOG_IF(FATAL, !out) << "Failed to write the PQ store " << filename;
+}
+
+size_t PqStore::memoryBytes() const {
+  return codes_.size() +
+         static_cast<size_t>(codebook_.numCentroids()) * codebook_.dim() *
+             sizeof(float);
+}
+
+std::shared_ptr<const PqStore> buildPqStore(const std::string &features,
+                                            const PqTrainOptions &options) {
+  std::vector<std::string> names;
+  if (isFeatureStoreFile(features)) {
+    const auto store = FeatureStore::open(features);
+    for (int idx = 0; idx < store->size(); ++idx) {
+      names.emplace_back(store->name(idx));
+    }
+  } else {
+    for (const auto &file : database::listProtoDir(features, ".Feature")) {
+      names.push_back(std::filesystem::path(file).filename().string());
+    }
+  }
+  const FeatureMatrix matrix = FeatureMatrix::load(features, options.numThreads);
+  LOG_IF(FATAL, matrix.rows() == 0) << "No features to encode in " << features;
+  return PqStore::encode(PqCodebook::train(matrix, options), matrix,
+                         std::move(names), options.numThreads);
+}
+
+} // namespace localization::features
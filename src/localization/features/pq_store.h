@@ -0,0 +1,86 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PQ_STORE_H_
+#define SRC_FEATURES_PQ_STORE_H_
+
+#include "features/pq_codebook.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+class FeatureMatrix;
+
+/**
+ * @brief      A sequence of features encoded with product quantization
+ * (*.PqStore.bin), together with the codebook needed to score them:
+ *
+ *   magic | version | rows | codebook | rows x numSubspaces uint8 codes |
+ *   names
+ *
+ * A 4096-D float feature with 64 subspaces takes 64 bytes instead of 16 KB.
+ */
+class PqStore {
+public:
+  PqStore(PqCodebook codebook, std::vector<uint8_t> codes,
+          std::vector<std::string> names);
+
+  /** Encodes all rows of `features`, one name per row. **/
+  static std::shared_ptr<const PqStore>
+  encode(PqCodebook codebook, const FeatureMatrix &features,
+         std::vector<std::string> names, int numThreads = 0);
+
+  static std::shared_ptr<const PqStore> open(const std::string &filename);
+  void save(const std::string &filename) const;
+
+  int size() const { return names_.size(); }
+  const PqCodebook &codebook() const { return codebook_; }
+  const uint8_t *code(int idx) const {
+    return codes_.data() + static_cast<size_t>(idx) * codebook_.numSubspaces();
+  }
+  const std::string &name(int idx) const { return names_[idx]; }
+  /** Memory taken by the codes and the codebook. **/
+  size_t memoryBytes() const;
+
+private:
+  PqCodebook codebook_;
+  std::vector<uint8_t> codes_;
+  std::vector<std::string> names_;
+};
+
+bool isPqStoreFile(const std::string &path);
+
+/**
+ * @brief      Trains a codebook on the features in `features`, a feature
+ * directory or store, and encodes them all.
+ */
+std::shared_ptr<const PqStore> buildPqStore(const std::string &features,
+                                            const PqTrainOptions &options);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PQ_STORE_H_
@@ -0,0 +1,280 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/projection.h"
+#include "features/feature_matrix.h"
+#include "features/similarity_kernels.h"
+#include "tools/parallel/parallel_for.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+
+namespace localization::features {
+
+namespace {
+constexpr auto kProjectionExtension = ".Projection.bin";
+constexpr char kMagic[8] = "ISLPROJ";
+constexpr uint32_t kVersion = 1;
+
+// Modified Gram-Schmidt on the rows of a rows x dim matrix. A row that
+// becomes degenerate is replaced by a random direction.
+void orthonormalizeRows(std::vector<double> &matrix, int rows, int dim,
+                        std::mt19937 &generator) {
+  std::normal_distribution<double> distribution;
+  for (int r = 0; r < rows; ++r) {
+    double *row = matrix.data() + static_cast<size_t>(r) * dim;
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      for (int prev = 0; prev < r; ++prev) {
+        const double *other = matrix.data() + static_cast<size_t>(prev) * dim;
+        const double dot = std::inner_product(row, row + dim, other, 0.0);
+        for (int d = 0; d < dim; ++d) {
+          row[d] -= dot * other[d];
+        }
+      }
+      const double norm = std::sqrt(std::inner_product(row, row + dim, row, 0.0));
+      if (norm > 1e-10) {
+        for (int d = 0; d < dim; ++d) {
+          row[d] /= norm;
+        }
+        break;
+      }
+      std::generate(row, row + dim, [&]() { return distribution(generator); });
+    }
+  }
+}
+} // namespace
+
+bool isProjectionFile(const std::string &path) {
+  const std::string extension = kProjectionExtension;
+  return path.size() >= extension.size() &&
+         path.compare(path.size() - extension.size(), extension.size(),
+                      extension) == 0;
+}
+
+Projection::Projection(int inputDim, int outputDim)
+    : inputDim_{inputDim}, outputDim_{outputDim}, mean_(inputDim, 0.f),
+      components_(static_cast<size_t>(inputDim) * outputDim, 0.f) {
+  CHECK(outputDim > 0 && outputDim <= inputDim)
+      << "Cannot project " << inputDim << " dimensions to " << outputDim;
+}
+
+std::shared_ptr<const Projection>
+Projection::randomOrthogonal(int inputDim, int outputDim, uint32_t seed) {
+  std::shared_ptr<Projection> projection(new Projection(inputDim, outputDim));
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> distribution;
+  std::vector<double> components(projection->components_.size());
+  std::generate(components.begin(), components.end(),
+                [&]() { return distribution(generator); });
+  orthonormalizeRows(components, outputDim, inputDim, generator);
+  std::copy(components.begin(), components.end(),
+            projection->components_.begin());
+  return projection;
+}
+
+std::shared_ptr<const Projection>
+Projection::trainPca(const FeatureMatrix &features, int outputDim,
+                     const PcaOptions &options) {
+  const int dim = features.dim();
+  std::shared_ptr<Projection> projection(new Projection(dim, outputDim));
+  std::mt19937 generator(options.seed);
+  std::vector<int> samples(features.rows());
+  std::iota(samples.begin(), samples.end(), 0);
+  std::shuffle(samples.begin(), samples.end(), generator);
+  samples.resize(std::min<int>(samples.size(), options.maxTrainingSamples));
+  LOG_IF(FATAL, samples.empty()) << "No features to train the projection on.";
+  const int numSamples = samples.size();
+
+  std::vector<double> mean(dim, 0.0);
+  for (int s : samples) {
+    for (int d = 0; d < dim; ++d) {
+      mean[d] += features.row(s)[d];
+    }
+  }
+  for (double &value : mean) {
+    value /= numSamples;
+  }
+  // Centered samples, numSamples x dim.
+  std::vector<double> centered(static_cast<size_t>(numSamples) * dim);
+  double totalVariance = 0.0;
+  for (int s = 0; s < numSamples; ++s) {
+    for (int d = 0; d < dim; ++d) {
+      const double value = features.row(samples[s])[d] - mean[d];
+      centered[static_cast<size_t>(s) * dim + d] = value;
+      totalVariance += value * value;
+    }
+  }
+
+  // Subspace iteration: V <- orth(X^T X V), V is outputDim x dim. The
+  // products are computed as (X V^T) and X^T (X V^T), never forming X^T X.
+  std::normal_distribution<double> distribution;
+  std::vector<double> basis(static_cast<size_t>(outputDim) * dim);
+  std::generate(basis.begin(), basis.end(),
+                [&]() { return distribution(generator); });
+  orthonormalizeRows(basis, outputDim, dim, generator);
+  std::vector<double> scores(static_cast<size_t>(numSamples) * outputDim);
+  auto computeScores = [&]() {
+    tools::parallelFor(
+        0, numSamples,
+        [&](int s) {
+          const double *sample = centered.data() + static_cast<size_t>(s) * dim;
+          for (int k = 0; k < outputDim; ++k) {
+            scores[static_cast<size_t>(s) * outputDim + k] = std::inner_product(
+                sample, sample + dim,
+                basis.data() + static_cast<size_t>(k) * dim, 0.0);
+          }
+        },
+        options.numThreads);
+  };
+  for (int iteration = 0; iteration < options.iterations; ++iteration) {
+    computeScores();
+    tools::parallelFor(
+        0, outputDim,
+        [&](int k) {
+          double *row = basis.data() + static_cast<size_t>(k) * dim;
+          std::fill(row, row + dim, 0.0);
+          for (int s = 0; s < numSamples; ++s) {
+            const double score = scores[static_cast<size_t>(s) * outputDim + k];
+            const double *sample =
+                centered.data() + static_cast<size_t>(s) * dim;
+            for (int d = 0; d < dim; ++d) {
+              row[d] += score * sample[d];
+            }
+          }
+        },
+        options.numThreads);
+    orthonormalizeRows(basis, outputDim, dim, generator);
+  }
+
+  // Variance along every component, the components are sorted by it.
+  computeScores();
+  std::vector<double> variance(outputDim, 0.0);
+  for (int s = 0; s < numSamples; ++s) {
+    for (int k = 0; k < outputDim; ++k) {
+      const double score = scores[static_cast<size_t>(s) * outputDim + k];
+      variance[k] += score * score;
+    }
+  }
+  std::vector<int> order(outputDim);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(),
+            [&variance](int lhs, int rhs) { return variance[lhs] > variance[rhs]; });
+  for (int k = 0; k < outputDim; ++k) {
+    std::copy_n(basis.data() + static_cast<size_t>(order[k]) * dim, dim,
+                projection->components_.data() + static_cast<size_t>(k) * dim);
+  }
+  std::copy(mean.begin(), mean.end(), projection->mean_.begin());
+  projection->explainedVariance_ =
+      totalVariance > 0.0
+          ? std::accumulate(variance.begin(), variance.end(), 0.0) /
+                totalVariance
+          : 1.0;
+  LOG(INFO) << "Trained a PCA projection from " << dim << " to " << outputDim
+            << " dimensions on " << numSamples << " features, it keeps "
+            << 100.0 * projection->explainedVariance_ << "% of the variance.";
+  return projection;
+}
+
+void Projection::apply(const float *values, float *projected) const {
+  thread_local std::vector<float> centered;
+  centered.resize(inputDim_);
+  const float norm = std::sqrt(dotProduct(values, values, inputDim_));
+  const float scale = norm > 0.f ? 1.f / norm : 0.f;
+  for (int d = 0; d < inputDim_; ++d) {
+    centered[d] = values[d] * scale - mean_[d];
+  }
+  for (int k = 0; k < outputDim_; ++k) {
+    projected[k] = dotProduct(
+        centered.data(),
+        components_.data() + static_cast<size_t>(k) * inputDim_, inputDim_);
+  }
+}
+
+std::vector<double> Projection::apply(const std::vector<double> &values) const {
+  CHECK(static_cast<int>(values.size()) == inputDim_)
+      << "The projection expects " << inputDim_ << " dimensions, got "
+      << values.size();
+  const std::vector<float> input(values.begin(), values.end());
+  std::vector<float> projected(outputDim_);
+  apply(input.data(), projected.data());
+  return {projected.begin(), projected.end()};
+}
+
+void Projection::save(const std::string &filename) const {
+  std::ofstream out(filename,
+                    std::ios::out | std::ios::trunc | std::ios::binary);
+  LOG_IF(FATAL, !out) << "The file cannot be opened " << filename;
+  const int32_t sizes[2] = {inputDim_, outputDim_};
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char *>(&kVersion), sizeof(kVersion));
+  out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+  out.write(reinterpret_cast<const char *>(&explainedVariance_),
+            sizeof(explainedVariance_));
+  out.write(reinterpret_cast<const char *>(mean_.data()),
+            mean_.size() * sizeof(float));
+  out.write(reinterpret_cast<const char *>(components_.data()),
+            components_.size() * sizeof(float));
+  LOG_IF(FATAL, !out) << "Failed to write the projection " << filename;
+}
+
+std::shared_ptr<const Projection> Projection::load(const std::string &filename) {
+  std::ifstream in(filename, std::ios::in | std::ios::binary);
+  LOG_IF(FATAL, !in) << "The projection cannot be opened " << filename;
+  char magic[8] = {};
+  uint32_t version = 0;
+  int32_t sizes[2] = {0, 0};
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char *>(&version), sizeof(version));
+  in.read(reinterpret_cast<char *>(sizes), sizeof(sizes));
+  LOG_IF(FATAL, !in || std::memcmp(magic, kMagic, sizeof(magic)) != 0)
+      << "Not a projection: " << filename;
+  LOG_IF(FATAL, version != kVersion)
+      << "Unsupported projection version " << version << " in " << filename;
+  // The mean and the components must fit into the rest of the file before
+  // they are allocated, a damaged size would otherwise request gigabytes.
+  const std::streampos start = in.tellg();
+  in.seekg(0, std::ios::end);
+  const std::streamoff remaining = in.tellg() - start;
+  in.seekg(start);
+  LOG_IF(FATAL, sizes[0] <= 0 || sizes[1] <= 0 || sizes[1] > sizes[0] ||
+                    (static_cast<uint64_t>(sizes[0]) * sizes[1] + sizes[0]) >
+                        static_cast<uint64_t>(remaining) / sizeof(float))
+      << "Projection is truncated or damaged: " << filename;
+  std::shared_ptr<Projection> projection(new Projection(sizes[0], sizes[1]));
+  in.read(reinterpret_cast<char *>(&projection->explainedVariance_),
+          sizeof(projection->explainedVariance_));
+  in.read(reinterpret_cast<char *>(projection->mean_.data()),
+          projection->mean_.size() * sizeof(float));
+  in.read(reinterpret_cast<char *>(projection->components_.data()),
+          projection->components_.size() * sizeof(float));
+  LOG_IF(FATAL, !in) << "Projection is truncated: " << filename;
+  return projection;
+}
+
+} // namespace localization::features
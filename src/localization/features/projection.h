@@ -0,0 +1,95 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PROJECTION_H_
+#define SRC_FEATURES_PROJECTION_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+class FeatureMatrix;
+
+struct PcaOptions {
+  // Subspace iterations, a handful is enough for the leading components.
+  int iterations = 8;
+  // The projection is trained on a random subset of the features.
+  int maxTrainingSamples = 20000;
+  uint32_t seed = 0;
+  // <= 0 means all available threads.
+  int numThreads = 0;
+};
+
+/**
+ * @brief      Linear projection of features to fewer dimensions, applied
+ * when the features are loaded, so that every comparison runs on the short
+ * features: y = P (x / |x| - mean), with orthonormal rows in P. The input is
+ * L2-normalized first, like the FeatureMatrix rows the PCA is trained on, so
+ * the mean is subtracted from features of the same scale.
+ */
+class Projection {
+public:
+  /**
+   * @brief      Learns the `outputDim` principal components of the features
+   * with randomized subspace iteration, without forming the covariance.
+   */
+  static std::shared_ptr<const Projection>
+  trainPca(const FeatureMatrix &features, int outputDim,
+           const PcaOptions &options = {});
+  /** Random orthogonal projection, needs no training data. **/
+  static std::shared_ptr<const Projection>
+  randomOrthogonal(int inputDim, int outputDim, uint32_t seed = 0);
+
+  static std::shared_ptr<const Projection> load(const std::string &filename);
+  void save(const std::string &filename) const;
+
+  int inputDim() const { return inputDim_; }
+  int outputDim() const { return outputDim_; }
+
+  std::vector<double> apply(const std::vector<double> &values) const;
+  /** Reads `inputDim` values and writes `outputDim` values. **/
+  void apply(const float *values, float *projected) const;
+
+  /** Share of the training features' variance the projection keeps, set
+   * only for a trained PCA. **/
+  double explainedVariance() const { return explainedVariance_; }
+
+private:
+  Projection(int inputDim, int outputDim);
+
+  int inputDim_ = 0;
+  int outputDim_ = 0;
+  std::vector<float> mean_;
+  // outputDim x inputDim, row-major.
+  std::vector<float> components_;
+  double explainedVariance_ = 0.0;
+};
+
+bool isProjectionFile(const std::string &path);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PROJECTION_H_
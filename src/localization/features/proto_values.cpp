@@ -0,0 +1,220 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/proto_values.h"
+#include "localization_protos.pb.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace localization::features {
+
+namespace {
+using image_sequence_localizer::ValueType;
+
+// Larger read buffers are released after parsing, not kept per thread.
+constexpr size_t kMaxCachedBufferSize = size_t{1} << 20;
+
+bool hostIsLittleEndian() {
+  const uint16_t one = 1;
+  uint8_t firstByte = 0;
+  std::memcpy(&firstByte, &one, 1);
+  return firstByte == 1;
+}
+
+template <class T> T byteSwapped(T value) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, &value, sizeof(T));
+  std::reverse(bytes, bytes + sizeof(T));
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+size_t valueTypeSize(ValueType type) {
+  switch (type) {
+  case image_sequence_localizer::VALUE_TYPE_FLOAT32:
+    return sizeof(float);
+  case image_sequence_localizer::VALUE_TYPE_FLOAT64:
+    return sizeof(double);
+  default:
+    break;
+  }
+  LOG(FATAL) << "Unknown value type " << type << " of the proto data";
+  return 0;
+}
+
+template <class Stored>
+void decode(const char *bytes, int64_t count, bool swap, double *out) {
+  // The common case without swapping is a plain conversion loop that the
+  // compiler vectorizes.
+  if (!swap) {
+    for (int64_t idx = 0; idx < count; ++idx) {
+      Stored value;
+      std::memcpy(&value, bytes + idx * sizeof(Stored), sizeof(Stored));
+      out[idx] = value;
+    }
+    return;
+  }
+  for (int64_t idx = 0; idx < count; ++idx) {
+    Stored value;
+    std::memcpy(&value, bytes + idx * sizeof(Stored), sizeof(Stored));
+    out[idx] = byteSwapped(value);
+  }
+}
+
+template <class Stored, class Value>
+void encode(const Value *values, size_t count, std::string *data) {
+  const bool swap = !hostIsLittleEndian();
+  const size_t offset = data->size();
+  data->resize(offset + count * sizeof(Stored));
+  char *bytes = data->data() + offset;
+  for (size_t idx = 0; idx < count; ++idx) {
+    Stored value = static_cast<Stored>(values[idx]);
+    if (swap) {
+      value = byteSwapped(value);
+    }
+    std::memcpy(bytes + idx * sizeof(Stored), &value, sizeof(Stored));
+  }
+}
+
+ValueType storedType(ProtoValuesFormat format) {
+  return format == ProtoValuesFormat::RawFloat64
+             ? image_sequence_localizer::VALUE_TYPE_FLOAT64
+             : image_sequence_localizer::VALUE_TYPE_FLOAT32;
+}
+// The data of a proto that is written in a raw format.
+template <class Proto>
+std::string *rawData(ProtoValuesFormat format, Proto *proto) {
+  CHECK_EQ(proto->values_size(), 0) << "The proto already stores values";
+  CHECK(!proto->has_data() || proto->value_type() == storedType(format))
+      << "The proto already stores data of another value type";
+  proto->set_value_type(storedType(format));
+  proto->set_byte_order(image_sequence_localizer::BYTE_ORDER_LITTLE_ENDIAN);
+  return proto->mutable_data();
+}
+} // namespace
+
+template <class Proto> int64_t protoValuesSize(const Proto &proto) {
+  if (!proto.has_data()) {
+    return proto.values_size();
+  }
+  const size_t valueSize = valueTypeSize(proto.value_type());
+  LOG_IF(FATAL, proto.data().size() % valueSize != 0)
+      << "The proto data is not a whole number of values";
+  return proto.data().size() / valueSize;
+}
+
+template <class Proto>
+void copyProtoValues(const Proto &proto, int64_t first, int64_t count,
+                     double *out) {
+  CHECK(first >= 0 && count >= 0 && first + count <= protoValuesSize(proto))
+      << "Values [" << first << ", " << first + count
+      << ") are outside the stored values";
+  if (!proto.has_data()) {
+    std::copy_n(proto.values().begin() + first, count, out);
+    return;
+  }
+  const bool swap =
+      (proto.byte_order() == image_sequence_localizer::BYTE_ORDER_LITTLE_ENDIAN) !=
+      hostIsLittleEndian();
+  if (proto.value_type() == image_sequence_localizer::VALUE_TYPE_FLOAT32) {
+    decode<float>(proto.data().data() + first * sizeof(float), count, swap,
+                  out);
+  } else {
+    decode<double>(proto.data().data() + first * sizeof(double), count, swap,
+                   out);
+  }
+}
+
+template <class Proto, class Value>
+void appendProtoValues(const Value *values, size_t count,
+                       ProtoValuesFormat format, Proto *proto) {
+  if (format == ProtoValuesFormat::RepeatedDouble) {
+    CHECK(!proto->has_data()) << "The proto already stores raw data";
+    for (size_t idx = 0; idx < count; ++idx) {
+      proto->add_values(values[idx]);
+    }
+    return;
+  }
+  if (format == ProtoValuesFormat::RawFloat32) {
+    encode<float>(values, count, rawData(format, proto));
+  } else {
+    encode<double>(values, count, rawData(format, proto));
+  }
+}
+
+template <class Proto>
+void reserveProtoValues(size_t count, ProtoValuesFormat format, Proto *proto) {
+  if (format == ProtoValuesFormat::RepeatedDouble) {
+    proto->mutable_values()->Reserve(proto->values_size() + count);
+    return;
+  }
+  const size_t valueSize =
+      format == ProtoValuesFormat::RawFloat64 ? sizeof(double) : sizeof(float);
+  std::string *data = rawData(format, proto);
+  data->reserve(data->size() + count * valueSize);
+}
+
+template <class Proto>
+Proto *parseProtoFile(const std::string &filename,
+                      google::protobuf::Arena *arena) {
+  std::error_code error;
+  const uintmax_t size = std::filesystem::file_size(filename, error);
+  std::ifstream input(filename, std::ios::in | std::ios::binary);
+  if (error || !input) {
+    return nullptr;
+  }
+  // Reading the file in one go and parsing from memory is much faster than
+  // parsing from the stream.
+  thread_local std::string buffer;
+  buffer.resize(size);
+  input.read(buffer.data(), buffer.size());
+  Proto *proto = google::protobuf::Arena::CreateMessage<Proto>(arena);
+  const bool parsed = input && proto->ParseFromString(buffer);
+  if (buffer.capacity() > kMaxCachedBufferSize) {
+    std::string().swap(buffer);
+  }
+  return parsed ? proto : nullptr;
+}
+
+#define INSTANTIATE_PROTO_VALUES(Proto)                                       \
+  template int64_t protoValuesSize(const Proto &);                           \
+  template void copyProtoValues(const Proto &, int64_t, int64_t, double *);  \
+  template void appendProtoValues(const float *, size_t, ProtoValuesFormat,  \
+                                  Proto *);                                  \
+  template void appendProtoValues(const double *, size_t, ProtoValuesFormat, \
+                                  Proto *);                                  \
+  template void reserveProtoValues(size_t, ProtoValuesFormat, Proto *);      \
+  template Proto *parseProtoFile(const std::string &,                        \
+                                 google::protobuf::Arena *);
+
+INSTANTIATE_PROTO_VALUES(image_sequence_localizer::Feature)
+INSTANTIATE_PROTO_VALUES(image_sequence_localizer::SimilarityMatrix)
+
+#undef INSTANTIATE_PROTO_VALUES
+
+} // namespace localization::features
@@ -0,0 +1,90 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_PROTO_VALUES_H_
+#define SRC_FEATURES_PROTO_VALUES_H_
+
+#include <google/protobuf/arena.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace localization::features {
+
+/**
+ * @brief      How the values of Feature and SimilarityMatrix protos are
+ * written, see ValueType in localization_protos.proto. Readers accept all
+ * formats.
+ */
+enum class ProtoValuesFormat {
+  // Version 1, `repeated double values`. Readable by old readers.
+  RepeatedDouble,
+  // Version 2, little-endian float32 bytes in `data`.
+  RawFloat32,
+  // Version 2, little-endian float64 bytes in `data`.
+  RawFloat64,
+};
+
+/** Number of values stored in a Feature or SimilarityMatrix proto. **/
+template <class Proto> int64_t protoValuesSize(const Proto &proto);
+
+/**
+ * @brief      Copies `count` values starting at `first` to `out`, converting
+ * them from the stored type and byte order. Dies if the range is outside the
+ * stored values or the value type is unknown.
+ */
+template <class Proto>
+void copyProtoValues(const Proto &proto, int64_t first, int64_t count,
+                     double *out);
+
+template <class Proto> std::vector<double> protoValues(const Proto &proto) {
+  std::vector<double> values(protoValuesSize(proto));
+  copyProtoValues(proto, 0, values.size(), values.data());
+  return values;
+}
+
+/**
+ * @brief      Appends values to a proto. All values of one proto have to be
+ * appended in the same format. `Value` is float or double.
+ */
+template <class Proto, class Value>
+void appendProtoValues(const Value *values, size_t count,
+                       ProtoValuesFormat format, Proto *proto);
+
+/** Reserves the space for `count` values that will be appended. **/
+template <class Proto>
+void reserveProtoValues(size_t count, ProtoValuesFormat format, Proto *proto);
+
+/**
+ * @brief      Reads the whole file and parses it into a message allocated on
+ * `arena`. Returns nullptr if the file cannot be read or parsed.
+ */
+template <class Proto>
+Proto *parseProtoFile(const std::string &filename,
+                      google::protobuf::Arena *arena);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_PROTO_VALUES_H_
@@ -0,0 +1,818 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/similarity_kernels.h"
+
+#include <glog/logging.h>
+
+#include <cstdlib>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LOCALIZATION_X86_KERNELS
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define LOCALIZATION_NEON_KERNELS
+#endif
+
+namespace localization::features {
+
+namespace {
+using DotProductKernel = float (*)(const float *, const float *, int);
+
+float dotProductScalar(const float *lhs, const float *rhs, int dim) {
+  // Independent accumulators break the dependency chain of the reduction and
+  // let the compiler keep them in vector registers.
+  constexpr int kLanes = 8;
+  float acc[kLanes] = {0.f};
+  int d = 0;
+  for (; d + kLanes <= dim; d += kLanes) {
+    for (int l = 0; l < kLanes; ++l) {
+      acc[l] += lhs[d + l] * rhs[d + l];
+    }
+  }
+  float result = 0.f;
+  for (int l = 0; l < kLanes; ++l) {
+    result += acc[l];
+  }
+  for (; d < dim; ++d) {
+    result += lhs[d] * rhs[d];
+  }
+  return result;
+}
+
+#ifdef LOCALIZATION_X86_KERNELS
+// The kernels are compiled for their instruction set independently of the
+// compiler flags and only called if the CPU supports it.
+__attribute__((target("avx2,fma"))) float
+dotProductAvx2(const float *lhs, const float *rhs, int dim) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  __m256 acc2 = _mm256_setzero_ps();
+  __m256 acc3 = _mm256_setzero_ps();
+  int d = 0;
+  for (; d + 32 <= dim; d += 32) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + d), _mm256_loadu_ps(rhs + d),
+                           acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + d + 8),
+                           _mm256_loadu_ps(rhs + d + 8), acc1);
+    acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + d + 16),
+                           _mm256_loadu_ps(rhs + d + 16), acc2);
+    acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + d + 24),
+                           _mm256_loadu_ps(rhs + d + 24), acc3);
+  }
+  for (; d + 8 <= dim; d += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(lhs + d), _mm256_loadu_ps(rhs + d),
+                           acc0);
+  }
+  const __m256 acc =
+      _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+                          _mm256_extractf128_ps(acc, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  float result = _mm_cvtss_f32(sum);
+  for (; d < dim; ++d) {
+    result += lhs[d] * rhs[d];
+  }
+  return result;
+}
+
+__attribute__((target("avx512f"))) float
+dotProductAvx512(const float *lhs, const float *rhs, int dim) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  int d = 0;
+  for (; d + 32 <= dim; d += 32) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + d), _mm512_loadu_ps(rhs + d),
+                           acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + d + 16),
+                           _mm512_loadu_ps(rhs + d + 16), acc1);
+  }
+  for (; d + 16 <= dim; d += 16) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(lhs + d), _mm512_loadu_ps(rhs + d),
+                           acc0);
+  }
+  if (d < dim) {
+    // Masked loads read only the remaining values.
+    const __mmask16 mask = (1u << (dim - d)) - 1;
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, lhs + d),
+                           _mm512_maskz_loadu_ps(mask, rhs + d), acc1);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+__attribute__((target("avx2"))) int32_t
+dotProductInt8Avx2(const int8_t *lhs, const int8_t *rhs, int dim) {
+  const __m256i ones = _mm256_set1_epi16(1);
+  __m256i acc = _mm256_setzero_si256();
+  int d = 0;
+  for (; d + 32 <= dim; d += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + d));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + d));
+    // maddubs multiplies unsigned with signed bytes, the sign of `a` is moved
+    // to `b`. Two products of values in [-127, 127] do not saturate int16.
+    const __m256i products =
+        _mm256_maddubs_epi16(_mm256_sign_epi8(a, a), _mm256_sign_epi8(b, a));
+    acc = _mm256_add_epi32(acc, _mm256_madd_epi16(products, ones));
+  }
+  __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+  int32_t result = _mm_cvtsi128_si32(sum);
+  for (; d < dim; ++d) {
+    result += static_cast<int32_t>(lhs[d]) * rhs[d];
+  }
+  return result;
+}
+
+// dpbusd multiplies unsigned with signed bytes like maddubs, the sign of `a`
+// is moved to `b`.
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) inline __m512i
+accumulateInt8Vnni(__m512i acc, __m512i a, __m512i b) {
+  const __mmask64 negative = _mm512_movepi8_mask(a);
+  const __m512i signedB =
+      _mm512_mask_sub_epi8(b, negative, _mm512_setzero_si512(), b);
+  return _mm512_dpbusd_epi32(acc, _mm512_abs_epi8(a), signedB);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vnni"))) int32_t
+dotProductInt8Vnni(const int8_t *lhs, const int8_t *rhs, int dim) {
+  __m512i acc = _mm512_setzero_si512();
+  int d = 0;
+  for (; d + 64 <= dim; d += 64) {
+    acc = accumulateInt8Vnni(acc, _mm512_loadu_si512(lhs + d),
+                             _mm512_loadu_si512(rhs + d));
+  }
+  if (d < dim) {
+    const __mmask64 mask = ~0ULL >> (64 - (dim - d));
+    acc = accumulateInt8Vnni(acc, _mm512_maskz_loadu_epi8(mask, lhs + d),
+                             _mm512_maskz_loadu_epi8(mask, rhs + d));
+  }
+  return _mm512_reduce_add_epi32(acc);
+}
+
+__attribute__((target("avx2"))) uint32_t
+sumAbsDiffUint8Avx2(const uint8_t *lhs, const uint8_t *rhs, int dim) {
+  __m256i acc = _mm256_setzero_si256();
+  int d = 0;
+  for (; d + 32 <= dim; d += 32) {
+    const __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + d));
+    const __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + d));
+    // psadbw sums the differences of 8 bytes into each 64-bit lane.
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(a, b));
+  }
+  __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(acc),
+                              _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi64(sum, _mm_unpackhi_epi64(sum, sum));
+  // The sum of fewer than 2^24 bytes fits the low 32 bits.
+  uint32_t result = _mm_cvtsi128_si32(sum);
+  for (; d < dim; ++d) {
+    result += std::abs(static_cast<int>(lhs[d]) - rhs[d]);
+  }
+  return result;
+}
+
+__attribute__((target("avx512f,avx512bw"))) uint32_t
+sumAbsDiffUint8Avx512(const uint8_t *lhs, const uint8_t *rhs, int dim) {
+  __m512i acc = _mm512_setzero_si512();
+  int d = 0;
+  for (; d + 64 <= dim; d += 64) {
+    acc = _mm512_add_epi64(acc, _mm512_sad_epu8(_mm512_loadu_si512(lhs + d),
+                                                _mm512_loadu_si512(rhs + d)));
+  }
+  if (d < dim) {
+    // The masked out bytes are 0 on both sides and add nothing.
+    const __mmask64 mask = ~0ULL >> (64 - (dim - d));
+    acc = _mm512_add_epi64(
+        acc, _mm512_sad_epu8(_mm512_maskz_loadu_epi8(mask, lhs + d),
+                             _mm512_maskz_loadu_epi8(mask, rhs + d)));
+  }
+  return _mm512_reduce_add_epi64(acc);
+}
+
+__attribute__((target("avx2"))) void
+addBitmapVotesAvx2(const uint64_t *bitmap, int words, uint16_t *votes) {
+  // Lane l of a group of 16 votes tests bit l of the 16 bits of the group.
+  const __m256i laneBits = _mm256_setr_epi16(
+      0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0020, 0x0040, 0x0080, 0x0100,
+      0x0200, 0x0400, 0x0800, 0x1000, 0x2000, 0x4000,
+      static_cast<short>(0x8000));
+  for (int w = 0; w < words; ++w) {
+    const uint64_t word = bitmap[w];
+    if (word == 0) {
+      continue;
+    }
+    for (int group = 0; group < 4; ++group) {
+      const uint16_t bits = word >> (16 * group);
+      if (bits == 0) {
+        continue;
+      }
+      auto *groupVotes =
+          reinterpret_cast<__m256i *>(votes + 64 * w + 16 * group);
+      // Lanes of set bits compare equal and are all ones, -1, subtracting
+      // them adds one vote.
+      const __m256i isSet = _mm256_cmpeq_epi16(
+          _mm256_and_si256(_mm256_set1_epi16(static_cast<short>(bits)),
+                           laneBits),
+          laneBits);
+      _mm256_storeu_si256(
+          groupVotes, _mm256_sub_epi16(_mm256_loadu_si256(groupVotes), isSet));
+    }
+  }
+}
+
+__attribute__((target("avx512f,avx512bw"))) void
+addBitmapVotesAvx512(const uint64_t *bitmap, int words, uint16_t *votes) {
+  const __m512i ones = _mm512_set1_epi16(1);
+  for (int w = 0; w < words; ++w) {
+    const uint64_t word = bitmap[w];
+    if (word == 0) {
+      continue;
+    }
+    // The bits are the mask of the add, 32 votes per instruction.
+    for (int half = 0; half < 2; ++half) {
+      const __mmask32 bits = word >> (32 * half);
+      uint16_t *halfVotes = votes + 64 * w + 32 * half;
+      const __m512i current = _mm512_loadu_si512(halfVotes);
+      _mm512_storeu_si512(halfVotes,
+                          _mm512_mask_add_epi16(current, bits, current, ones));
+    }
+  }
+}
+#endif
+
+#ifdef LOCALIZATION_NEON_KERNELS
+int32_t dotProductInt8Neon(const int8_t *lhs, const int8_t *rhs, int dim) {
+  int32x4_t acc = vdupq_n_s32(0);
+  int d = 0;
+  for (; d + 16 <= dim; d += 16) {
+    const int8x16_t a = vld1q_s8(lhs + d);
+    const int8x16_t b = vld1q_s8(rhs + d);
+    acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(a), vget_low_s8(b)));
+    acc = vpadalq_s16(acc, vmull_high_s8(a, b));
+  }
+  int32_t result = vaddvq_s32(acc);
+  for (; d < dim; ++d) {
+    result += static_cast<int32_t>(lhs[d]) * rhs[d];
+  }
+  return result;
+}
+
+uint32_t sumAbsDiffUint8Neon(const uint8_t *lhs, const uint8_t *rhs, int dim) {
+  uint32x4_t acc = vdupq_n_u32(0);
+  int d = 0;
+  for (; d + 16 <= dim; d += 16) {
+    const uint8x16_t diff = vabdq_u8(vld1q_u8(lhs + d), vld1q_u8(rhs + d));
+    acc = vpadalq_u16(acc, vpaddlq_u8(diff));
+  }
+  uint32_t result = vaddvq_u32(acc);
+  for (; d < dim; ++d) {
+    result += std::abs(static_cast<int>(lhs[d]) - rhs[d]);
+  }
+  return result;
+}
+
+void addBitmapVotesNeon(const uint64_t *bitmap, int words, uint16_t *votes) {
+  static const uint16_t kLaneBits[8] = {1, 2, 4, 8, 16, 32, 64, 128};
+  const uint16x8_t laneBits = vld1q_u16(kLaneBits);
+  for (int w = 0; w < words; ++w) {
+    const uint64_t word = bitmap[w];
+    if (word == 0) {
+      continue;
+    }
+    for (int group = 0; group < 8; ++group) {
+      const uint16_t bits = (word >> (8 * group)) & 0xff;
+      if (bits == 0) {
+        continue;
+      }
+      uint16_t *groupVotes = votes + 64 * w + 8 * group;
+      // The lanes of set bits are all ones, subtracting them adds one vote.
+      const uint16x8_t isSet = vtstq_u16(vdupq_n_u16(bits), laneBits);
+      vst1q_u16(groupVotes, vsubq_u16(vld1q_u16(groupVotes), isSet));
+    }
+  }
+}
+
+float dotProductNeon(const float *lhs, const float *rhs, int dim) {
+  float32x4_t acc0 = vdupq_n_f32(0.f);
+  float32x4_t acc1 = vdupq_n_f32(0.f);
+  float32x4_t acc2 = vdupq_n_f32(0.f);
+  float32x4_t acc3 = vdupq_n_f32(0.f);
+  int d = 0;
+  for (; d + 16 <= dim; d += 16) {
+    acc0 = vfmaq_f32(acc0, vld1q_f32(lhs + d), vld1q_f32(rhs + d));
+    acc1 = vfmaq_f32(acc1, vld1q_f32(lhs + d + 4), vld1q_f32(rhs + d + 4));
+    acc2 = vfmaq_f32(acc2, vld1q_f32(lhs + d + 8), vld1q_f32(rhs + d + 8));
+    acc3 = vfmaq_f32(acc3, vld1q_f32(lhs + d + 12), vld1q_f32(rhs + d + 12));
+  }
+  for (; d + 4 <= dim; d += 4) {
+    acc0 = vfmaq_f32(acc0, vld1q_f32(lhs + d), vld1q_f32(rhs + d));
+  }
+  float result =
+      vaddvq_f32(vaddq_f32(vaddq_f32(acc0, acc1), vaddq_f32(acc2, acc3)));
+  for (; d < dim; ++d) {
+    result += lhs[d] * rhs[d];
+  }
+  return result;
+}
+#endif
+
+int32_t dotProductInt8Scalar(const int8_t *lhs, const int8_t *rhs, int dim) {
+  int32_t result = 0;
+  for (int d = 0; d < dim; ++d) {
+    result += static_cast<int32_t>(lhs[d]) * rhs[d];
+  }
+  return result;
+}
+
+uint32_t sumAbsDiffUint8Scalar(const uint8_t *lhs, const uint8_t *rhs,
+                               int dim) {
+  uint32_t result = 0;
+  for (int d = 0; d < dim; ++d) {
+    result += std::abs(static_cast<int>(lhs[d]) - rhs[d]);
+  }
+  return result;
+}
+
+void addBitmapVotesScalar(const uint64_t *bitmap, int words,
+                          uint16_t *votes) {
+  for (int w = 0; w < words; ++w) {
+    // Visits only the set bits, sparse bitmaps cost little.
+    for (uint64_t word = bitmap[w]; word != 0; word &= word - 1) {
+      ++votes[64 * w + __builtin_ctzll(word)];
+    }
+  }
+}
+
+int hammingDistanceGeneric(const uint64_t *lhs, const uint64_t *rhs,
+                           int words) {
+  int distance = 0;
+  for (int w = 0; w < words; ++w) {
+    distance += __builtin_popcountll(lhs[w] ^ rhs[w]);
+  }
+  return distance;
+}
+
+#ifdef LOCALIZATION_X86_KERNELS
+// Without -mpopcnt the builtin is a table lookup, this copy is compiled to
+// the instruction.
+__attribute__((target("popcnt"))) int
+hammingDistancePopcnt(const uint64_t *lhs, const uint64_t *rhs, int words) {
+  int distance = 0;
+  for (int w = 0; w < words; ++w) {
+    distance += __builtin_popcountll(lhs[w] ^ rhs[w]);
+  }
+  return distance;
+}
+#endif
+
+// Batched kernels: a block of kQueries x kRefs dot products is computed at
+// once with one accumulator per pair. Every loaded reference value is used
+// for all queries of the block and every query value for all references, so
+// the block needs kQueries + kRefs loads for kQueries * kRefs FMAs instead
+// of two loads per FMA.
+using DotProductBatchKernel = void (*)(const float *const *, int,
+                                       const float *const *, int, int, float *);
+
+template <class Block>
+void dotProductBatchBlocked(const float *const *queries, int numQueries,
+                            const float *const *refs, int numRefs, int dim,
+                            float *scores) {
+  constexpr int kQueries = Block::kQueries;
+  constexpr int kRefs = Block::kRefs;
+  auto queryRows = [&](auto queryBlock, int q) {
+    constexpr int kBlockQueries = decltype(queryBlock)::value;
+    float *rows = scores + static_cast<size_t>(q) * numRefs;
+    int r = 0;
+    for (; r + kRefs <= numRefs; r += kRefs) {
+      Block::template compute<kBlockQueries, kRefs>(queries + q, refs + r, dim,
+                                                    rows + r, numRefs);
+    }
+    for (; r < numRefs; ++r) {
+      Block::template compute<kBlockQueries, 1>(queries + q, refs + r, dim,
+                                                rows + r, numRefs);
+    }
+  };
+  int q = 0;
+  for (; q + kQueries <= numQueries; q += kQueries) {
+    queryRows(std::integral_constant<int, kQueries>{}, q);
+  }
+  for (; q < numQueries; ++q) {
+    queryRows(std::integral_constant<int, 1>{}, q);
+  }
+}
+
+// Without vector registers blocking does not pay off, the pairs are scored
+// one by one.
+struct ScalarBlock {
+  static constexpr int kQueries = 1;
+  static constexpr int kRefs = 1;
+  template <int Q, int R>
+  static void compute(const float *const *queries, const float *const *refs,
+                      int dim, float *scores, int scoresStride) {
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        scores[q * scoresStride + r] =
+            dotProductScalar(queries[q], refs[r], dim);
+      }
+    }
+  }
+};
+
+#ifdef LOCALIZATION_X86_KERNELS
+__attribute__((target("avx2,fma"))) inline float
+horizontalSumAvx2(__m256 acc) {
+  __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc),
+                          _mm256_extractf128_ps(acc, 1));
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+}
+
+// 8 accumulators, 4 reference and 1 query register of the 16 ymm registers.
+struct Avx2Block {
+  static constexpr int kQueries = 2;
+  static constexpr int kRefs = 4;
+  template <int Q, int R>
+  __attribute__((target("avx2,fma"))) static void
+  compute(const float *const *queries, const float *const *refs, int dim,
+          float *scores, int scoresStride) {
+    __m256 acc[Q][R];
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        acc[q][r] = _mm256_setzero_ps();
+      }
+    }
+    int d = 0;
+    for (; d + 8 <= dim; d += 8) {
+      __m256 refValues[R];
+      for (int r = 0; r < R; ++r) {
+        refValues[r] = _mm256_loadu_ps(refs[r] + d);
+      }
+      for (int q = 0; q < Q; ++q) {
+        const __m256 queryValues = _mm256_loadu_ps(queries[q] + d);
+        for (int r = 0; r < R; ++r) {
+          acc[q][r] = _mm256_fmadd_ps(queryValues, refValues[r], acc[q][r]);
+        }
+      }
+    }
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        float result = horizontalSumAvx2(acc[q][r]);
+        for (int tail = d; tail < dim; ++tail) {
+          result += queries[q][tail] * refs[r][tail];
+        }
+        scores[q * scoresStride + r] = result;
+      }
+    }
+  }
+};
+
+// 16 accumulators, 4 reference and 1 query register of the 32 zmm
+// registers.
+struct Avx512Block {
+  static constexpr int kQueries = 4;
+  static constexpr int kRefs = 4;
+  template <int Q, int R>
+  __attribute__((target("avx512f"))) static void
+  compute(const float *const *queries, const float *const *refs, int dim,
+          float *scores, int scoresStride) {
+    __m512 acc[Q][R];
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        acc[q][r] = _mm512_setzero_ps();
+      }
+    }
+    int d = 0;
+    for (; d + 16 <= dim; d += 16) {
+      __m512 refValues[R];
+      for (int r = 0; r < R; ++r) {
+        refValues[r] = _mm512_loadu_ps(refs[r] + d);
+      }
+      for (int q = 0; q < Q; ++q) {
+        const __m512 queryValues = _mm512_loadu_ps(queries[q] + d);
+        for (int r = 0; r < R; ++r) {
+          acc[q][r] = _mm512_fmadd_ps(queryValues, refValues[r], acc[q][r]);
+        }
+      }
+    }
+    if (d < dim) {
+      const __mmask16 mask = (1u << (dim - d)) - 1;
+      __m512 refValues[R];
+      for (int r = 0; r < R; ++r) {
+        refValues[r] = _mm512_maskz_loadu_ps(mask, refs[r] + d);
+      }
+      for (int q = 0; q < Q; ++q) {
+        const __m512 queryValues = _mm512_maskz_loadu_ps(mask, queries[q] + d);
+        for (int r = 0; r < R; ++r) {
+          acc[q][r] = _mm512_fmadd_ps(queryValues, refValues[r], acc[q][r]);
+        }
+      }
+    }
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        scores[q * scoresStride + r] = _mm512_reduce_add_ps(acc[q][r]);
+      }
+    }
+  }
+};
+#endif
+
+#ifdef LOCALIZATION_NEON_KERNELS
+struct NeonBlock {
+  static constexpr int kQueries = 4;
+  static constexpr int kRefs = 4;
+  template <int Q, int R>
+  static void compute(const float *const *queries, const float *const *refs,
+                      int dim, float *scores, int scoresStride) {
+    float32x4_t acc[Q][R];
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        acc[q][r] = vdupq_n_f32(0.f);
+      }
+    }
+    int d = 0;
+    for (; d + 4 <= dim; d += 4) {
+      float32x4_t refValues[R];
+      for (int r = 0; r < R; ++r) {
+        refValues[r] = vld1q_f32(refs[r] + d);
+      }
+      for (int q = 0; q < Q; ++q) {
+        const float32x4_t queryValues = vld1q_f32(queries[q] + d);
+        for (int r = 0; r < R; ++r) {
+          acc[q][r] = vfmaq_f32(acc[q][r], queryValues, refValues[r]);
+        }
+      }
+    }
+    for (int q = 0; q < Q; ++q) {
+      for (int r = 0; r < R; ++r) {
+        float result = vaddvq_f32(acc[q][r]);
+        for (int tail = d; tail < dim; ++tail) {
+          result += queries[q][tail] * refs[r][tail];
+        }
+        scores[q * scoresStride + r] = result;
+      }
+    }
+  }
+};
+#endif
+
+bool isSupported(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::Scalar:
+    return true;
+#ifdef LOCALIZATION_X86_KERNELS
+  case SimdLevel::Avx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case SimdLevel::Avx512:
+    return __builtin_cpu_supports("avx512f");
+  case SimdLevel::Avx512Vnni:
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512bw") &&
+           __builtin_cpu_supports("avx512vnni");
+#endif
+#ifdef LOCALIZATION_NEON_KERNELS
+  case SimdLevel::Neon:
+    return true;
+#endif
+  default:
+    return false;
+  }
+}
+
+DotProductKernel dotProductKernel(SimdLevel level) {
+  switch (level) {
+#ifdef LOCALIZATION_X86_KERNELS
+  case SimdLevel::Avx2:
+    return dotProductAvx2;
+  case SimdLevel::Avx512:
+  case SimdLevel::Avx512Vnni:
+    return dotProductAvx512;
+#endif
+#ifdef LOCALIZATION_NEON_KERNELS
+  case SimdLevel::Neon:
+    return dotProductNeon;
+#endif
+  default:
+    return dotProductScalar;
+  }
+}
+
+DotProductBatchKernel dotProductBatchKernel(SimdLevel level) {
+  switch (level) {
+#ifdef LOCALIZATION_X86_KERNELS
+  case SimdLevel::Avx2:
+    return dotProductBatchBlocked<Avx2Block>;
+  case SimdLevel::Avx512:
+  case SimdLevel::Avx512Vnni:
+    return dotProductBatchBlocked<Avx512Block>;
+#endif
+#ifdef LOCALIZATION_NEON_KERNELS
+  case SimdLevel::Neon:
+    return dotProductBatchBlocked<NeonBlock>;
+#endif
+  default:
+    return dotProductBatchBlocked<ScalarBlock>;
+  }
+}
+
+using DotProductInt8Kernel = int32_t (*)(const int8_t *, const int8_t *, int);
+
+DotProductInt8Kernel dotProductInt8Kernel(SimdLevel level) {
+  switch (level) {
+#ifdef LOCALIZATION_X86_KERNELS
+  case SimdLevel::Avx2:
+  case SimdLevel::Avx512:
+    return dotProductInt8Avx2;
+  case SimdLevel::Avx512Vnni:
+    return dotProductInt8Vnni;
+#endif
+#ifdef LOCALIZATION_NEON_KERNELS
+  case SimdLevel::Neon:
+    return dotProductInt8Neon;
+#endif
+  default:
+    return dotProductInt8Scalar;
+  }
+}
+
+using SumAbsDiffUint8Kernel = uint32_t (*)(const uint8_t *, const uint8_t *,
+                                           int);
+
+SumAbsDiffUint8Kernel sumAbsDiffUint8Kernel(SimdLevel level) {
+  switch (level) {
+#ifdef LOCALIZATION_X86_KERNELS
+  case SimdLevel::Avx2:
+  case SimdLevel::Avx512:
+    return sumAbsDiffUint8Avx2;
+  case SimdLevel::Avx512Vnni:
+    return sumAbsDiffUint8Avx512;
+#endif
+#ifdef LOCALIZATION_NEON_KERNELS
+  case SimdLevel::Neon:
+    return sumAbsDiffUint8Neon;
+#endif
+  default:
+    return sumAbsDiffUint8Scalar;
+  }
+}
+
+using AddBitmapVotesKernel = void (*)(const uint64_t *, int, uint16_t *);
+
+AddBitmapVotesKernel addBitmapVotesKernel(SimdLevel level) {
+  switch (level) {
+#ifdef LOCALIZATION_X86_KERNELS
+  case SimdLevel::Avx2:
+  case SimdLevel::Avx512:
+    return addBitmapVotesAvx2;
+  case SimdLevel::Avx512Vnni:
+    return addBitmapVotesAvx512;
+#endif
+#ifdef LOCALIZATION_NEON_KERNELS
+  case SimdLevel::Neon:
+    return addBitmapVotesNeon;
+#endif
+  default:
+    return addBitmapVotesScalar;
+  }
+}
+} // namespace
+
+const char *simdLevelName(SimdLevel level) {
+  switch (level) {
+  case SimdLevel::Scalar:
+    return "scalar";
+  case SimdLevel::Avx2:
+    return "avx2";
+  case SimdLevel::Avx512:
+    return "avx512";
+  case SimdLevel::Avx512Vnni:
+    return "avx512vnni";
+  case SimdLevel::Neon:
+    return "neon";
+  }
+  return "unknown";
+}
+
+std::vector<SimdLevel> supportedSimdLevels() {
+  std::vector<SimdLevel> levels;
+  for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Neon, SimdLevel::Avx2,
+                          SimdLevel::Avx512, SimdLevel::Avx512Vnni}) {
+    if (isSupported(level)) {
+      levels.push_back(level);
+    }
+  }
+  return levels;
+}
+
+SimdLevel bestSimdLevel() {
+  static const SimdLevel best = supportedSimdLevels().back();
+  return best;
+}
+
+float dotProduct(const float *lhs, const float *rhs, int dim) {
+  static const DotProductKernel kernel = dotProductKernel(bestSimdLevel());
+  return kernel(lhs, rhs, dim);
+}
+
+void dotProductBatch(const float *const *queries, int numQueries,
+                     const float *const *refs, int numRefs, int dim,
+                     float *scores) {
+  static const DotProductBatchKernel kernel =
+      dotProductBatchKernel(bestSimdLevel());
+  kernel(queries, numQueries, refs, numRefs, dim, scores);
+}
+
+void dotProductBatch(const float *const *queries, int numQueries,
+                     const float *const *refs, int numRefs, int dim,
+                     float *scores, SimdLevel level) {
+  CHECK(isSupported(level)) << "The " << simdLevelName(level)
+                            << " kernel is not supported by this CPU.";
+  dotProductBatchKernel(level)(queries, numQueries, refs, numRefs, dim, scores);
+}
+
+int32_t dotProductInt8(const int8_t *lhs, const int8_t *rhs, int dim) {
+  static const DotProductInt8Kernel kernel =
+      dotProductInt8Kernel(bestSimdLevel());
+  return kernel(lhs, rhs, dim);
+}
+
+int32_t dotProductInt8(const int8_t *lhs, const int8_t *rhs, int dim,
+                       SimdLevel level) {
+  CHECK(isSupported(level)) << "The " << simdLevelName(level)
+                            << " kernel is not supported by this CPU.";
+  return dotProductInt8Kernel(level)(lhs, rhs, dim);
+}
+
+uint32_t sumAbsDiffUint8(const uint8_t *lhs, const uint8_t *rhs, int dim) {
+  static const SumAbsDiffUint8Kernel kernel =
+      sumAbsDiffUint8Kernel(bestSimdLevel());
+  return kernel(lhs, rhs, dim);
+}
+
+uint32_t sumAbsDiffUint8(const uint8_t *lhs, const uint8_t *rhs, int dim,
+                         SimdLevel level) {
+  CHECK(isSupported(level)) << "The " << simdLevelName(level)
+                            << " kernel is not supported by this CPU.";
+  return sumAbsDiffUint8Kernel(level)(lhs, rhs, dim);
+}
+
+void addBitmapVotes(const uint64_t *bitmap, int words, uint16_t *votes) {
+  static const AddBitmapVotesKernel kernel =
+      addBitmapVotesKernel(bestSimdLevel());
+  kernel(bitmap, words, votes);
+}
+
+void addBitmapVotes(const uint64_t *bitmap, int words, uint16_t *votes,
+                    SimdLevel level) {
+  CHECK(isSupported(level)) << "The " << simdLevelName(level)
+                            << " kernel is not supported by this CPU.";
+  addBitmapVotesKernel(level)(bitmap, words, votes);
+}
+
+int hammingDistance(const uint64_t *lhs, const uint64_t *rhs, int words) {
+  using HammingKernel = int (*)(const uint64_t *, const uint64_t *, int);
+#ifdef LOCALIZATION_X86_KERNELS
+  static const HammingKernel kernel = __builtin_cpu_supports("popcnt")
+                                          ? hammingDistancePopcnt
+                                          : hammingDistanceGeneric;
+#else
+  static const HammingKernel kernel = hammingDistanceGeneric;
+#endif
+  return kernel(lhs, rhs, words);
+}
+
+float dotProduct(const float *lhs, const float *rhs, int dim, SimdLevel level) {
+  CHECK(isSupported(level)) << "The " << simdLevelName(level)
+                            << " kernel is not supported by this CPU.";
+  return dotProductKernel(level)(lhs, rhs, dim);
+}
+
+} // namespace localization::features
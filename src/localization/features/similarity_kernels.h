@@ -0,0 +1,106 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_SIMILARITY_KERNELS_H_
+#define SRC_FEATURES_SIMILARITY_KERNELS_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace localization::features {
+
+/** Instruction sets the similarity kernels are implemented for. **/
+enum class SimdLevel { Scalar, Avx2, Avx512, Avx512Vnni, Neon };
+
+const char *simdLevelName(SimdLevel level);
+/** Kernels the running CPU supports, starting with the scalar fallback. **/
+std::vector<SimdLevel> supportedSimdLevels();
+/** The fastest supported kernel, used by dotProduct(). **/
+SimdLevel bestSimdLevel();
+
+/**
+ * @brief      Computes the dot product of two float vectors of length `dim`.
+ * For L2-normalized vectors this is the cosine similarity. The kernel is
+ * chosen once for the running CPU.
+ */
+float dotProduct(const float *lhs, const float *rhs, int dim);
+/** Same with the kernel of the given, supported, `level`. **/
+float dotProduct(const float *lhs, const float *rhs, int dim, SimdLevel level);
+
+/**
+ * @brief      Computes the dot products of `numQueries` query vectors with
+ * `numRefs` reference vectors of length `dim` and writes them row-major to
+ * scores[q * numRefs + r]. The vectors are passed as pointers, e.g. to the
+ * rows of a matrix or to features scattered in a buffer.
+ *
+ * The products are computed in register blocks of several queries and
+ * references, every loaded value is used for several pairs. Scoring one
+ * query against many references is thus limited by the memory bandwidth,
+ * not by the loads of the query.
+ */
+void dotProductBatch(const float *const *queries, int numQueries,
+                     const float *const *refs, int numRefs, int dim,
+                     float *scores);
+void dotProductBatch(const float *const *queries, int numQueries,
+                     const float *const *refs, int numRefs, int dim,
+                     float *scores, SimdLevel level);
+
+/**
+ * @brief      Computes the dot product of two int8 vectors of length `dim`
+ * with values in [-127, 127]. Uses the maddubs (AVX2), VNNI (AVX-512) or
+ * NEON integer kernels. Without VNNI the AVX-512 level uses the AVX2 kernel.
+ */
+int32_t dotProductInt8(const int8_t *lhs, const int8_t *rhs, int dim);
+int32_t dotProductInt8(const int8_t *lhs, const int8_t *rhs, int dim,
+                       SimdLevel level);
+
+/**
+ * @brief      Sum of the absolute differences of two uint8 vectors of length
+ * `dim`. Uses the psadbw (AVX2, AVX-512) or NEON kernels. The AVX-512 kernel
+ * needs AVX-512BW, which only the Avx512Vnni level guarantees, the Avx512
+ * level uses the AVX2 kernel.
+ */
+uint32_t sumAbsDiffUint8(const uint8_t *lhs, const uint8_t *rhs, int dim);
+uint32_t sumAbsDiffUint8(const uint8_t *lhs, const uint8_t *rhs, int dim,
+                         SimdLevel level);
+
+/**
+ * @brief      Adds one vote for every set bit of a bitmap of `words` 64-bit
+ * words: votes[i] is incremented if bit i % 64 of bitmap[i / 64] is set, for
+ * i < 64 * words. The AVX2 and NEON kernels update 16 and 8 votes per
+ * instruction, the AVX-512 kernel 32 under a mask of the bits, it needs
+ * AVX-512BW like sumAbsDiffUint8(). The votes wrap around at 65536.
+ */
+void addBitmapVotes(const uint64_t *bitmap, int words, uint16_t *votes);
+void addBitmapVotes(const uint64_t *bitmap, int words, uint16_t *votes,
+                    SimdLevel level);
+
+/**
+ * @brief      Number of different bits in two bit vectors packed in `words`
+ * 64-bit words. Uses the popcount instruction if the CPU has it.
+ */
+int hammingDistance(const uint64_t *lhs, const uint64_t *rhs, int words);
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_SIMILARITY_KERNELS_H_
@@ -0,0 +1,49 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/stored_feature.h"
+#include "features/feature_traits.h"
+
+#include <glog/logging.h>
+
+namespace localization::features {
+
+StoredFeature::StoredFeature(std::shared_ptr<const FeatureStore> store, int id)
+    : store_{std::move(store)} {
+  CHECK(store_) << "Feature store is not set.";
+  values_ = store_->row(id);
+  norm_ = store_->norm(id);
+  type = "StoredFeature";
+}
+
+double StoredFeature::computeSimilarityScore(const iFeature &rhs) const {
+  CHECK(this->type == rhs.type) << "Features are not the same type";
+  const auto &other = static_cast<const StoredFeature &>(rhs);
+  return FeatureTraits<StoredFeature>::score(*this, other);
+}
+
+double StoredFeature::score2cost(double score) const {
+  return FeatureTraits<StoredFeature>::cost(score);
+}
+
+} // namespace localization::features
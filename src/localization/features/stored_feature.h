@@ -0,0 +1,62 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_FEATURES_STORED_FEATURE_H_
+#define SRC_FEATURES_STORED_FEATURE_H_
+
+#include "features/feature_store.h"
+#include "features/ifeature.h"
+
+#include <memory>
+
+namespace localization::features {
+
+/**
+ * @brief      Dense feature that views one row of a memory-mapped feature
+ * store. The values are not copied, the feature only keeps the store alive.
+ * Comparable only with other stored features.
+ */
+class StoredFeature : public iFeature {
+public:
+  StoredFeature(std::shared_ptr<const FeatureStore> store, int id);
+
+  // Computes the cosine similarity between two vectors.
+  // The higher the score the more similar the features are.
+  double computeSimilarityScore(const iFeature &rhs) const override;
+  double score2cost(double score) const override;
+  // The values live in the mapped store, not in the feature.
+  size_t memoryBytes() const override { return sizeof(*this); }
+
+  const float *data() const { return values_; }
+  int size() const { return store_->dim(); }
+  float norm() const { return norm_; }
+
+private:
+  std::shared_ptr<const FeatureStore> store_;
+  const float *values_ = nullptr;
+  float norm_ = 0.f;
+};
+
+} // namespace localization::features
+
+#endif // SRC_FEATURES_STORED_FEATURE_H_
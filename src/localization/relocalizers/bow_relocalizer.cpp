@@ -0,0 +1,95 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "relocalizers/bow_relocalizer.h"
+#include "features/feature_loader.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+namespace localization::relocalizers {
+
+namespace {
+const features::BowFeature &asBowFeature(const features::iFeature &feature) {
+  CHECK(feature.type == "BowFeature")
+      << "The bag-of-words relocalizer needs Bow_Feature features, got "
+      << feature.type;
+  return static_cast<const features::BowFeature &>(feature);
+}
+} // namespace
+
+BowRelocalizer::BowRelocalizer(database::OnlineDatabase *database,
+                               int numCandidates)
+    : database_{database}, numCandidates_{numCandidates} {
+  CHECK(database_) << "Database is not set\n";
+  CHECK(numCandidates_ > 0) << "The number of candidates should be positive.";
+}
+
+void BowRelocalizer::train(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(!features.empty()) << "No features to train on.";
+  index_ = std::make_unique<features::BowInvertedIndex>(
+      asBowFeature(*features[0]).numWords());
+  addFeatures(features);
+  LOG(INFO) << "Indexed " << index_->size() << " bag-of-words features.";
+}
+
+void BowRelocalizer::train(const std::string &featuresDir, int numThreads) {
+  LOG(INFO) << "Loading the features to index.";
+  const auto features = features::loadFeatures(
+      featuresDir, features::FeatureType::Bow_Feature, numThreads);
+  CHECK(!features.empty()) << "No features to train on in " << featuresDir;
+  train(features);
+}
+
+void BowRelocalizer::addFeatures(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(index_) << "Train the relocalizer before adding features.";
+  for (const auto &feature : features) {
+    index_->add(asBowFeature(*feature));
+  }
+}
+
+std::vector<int>
+BowRelocalizer::candidatesFor(const features::BowFeature &feature) const {
+  CHECK(index_) << "Train the relocalizer before getting candidates.";
+  std::vector<int> candidates;
+  for (const auto &[refId, score] : index_->topK(feature, numCandidates_)) {
+    candidates.push_back(refId);
+  }
+  return candidates;
+}
+
+std::vector<int> BowRelocalizer::getCandidates(int quId) {
+  const auto &feature = asBowFeature(database_->getQueryFeature(quId));
+  Timer timer;
+  timer.start();
+  std::vector<int> candidates = candidatesFor(feature);
+  timer.stop();
+  LOG(INFO) << "Inverted file retrieval time";
+  timer.print_elapsed_time(TimeExt::MicroSec);
+  LOG(INFO) << "Candidates size: " << candidates.size();
+  return candidates;
+}
+
+} // namespace localization::relocalizers
@@ -0,0 +1,70 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_RELOCALIZERS_BOW_RELOCALIZER_H_
+#define SRC_RELOCALIZERS_BOW_RELOCALIZER_H_
+
+#include "database/online_database.h"
+#include "features/bow_feature.h"
+#include "features/bow_inverted_index.h"
+#include "features/ifeature.h"
+#include "relocalizers/irelocalizer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::relocalizers {
+
+/**
+ * @brief      Relocalizes with bag-of-words features: the candidates are the
+ * reference images whose TF-IDF histograms are most similar to the query,
+ * found through an inverted file. Works with `Bow_Feature` databases.
+ */
+class BowRelocalizer : public iRelocalizer {
+public:
+  explicit BowRelocalizer(database::OnlineDatabase *database,
+                          int numCandidates = 5);
+
+  std::vector<int> getCandidates(int quId) override;
+
+  void train(const std::vector<std::unique_ptr<features::iFeature>> &features);
+  /** Loads the reference features from the directory in parallel and indexes
+   * them. **/
+  void train(const std::string &featuresDir, int numThreads = 0);
+  /** Indexes features appended to the reference after training. Appending to
+   * an inverted file is cheap, nothing is rebuilt. **/
+  void addFeatures(
+      const std::vector<std::unique_ptr<features::iFeature>> &features);
+
+  std::vector<int> candidatesFor(const features::BowFeature &feature) const;
+
+private:
+  database::OnlineDatabase *database_ = nullptr;
+  int numCandidates_ = 5;
+  std::unique_ptr<features::BowInvertedIndex> index_;
+};
+
+} // namespace localization::relocalizers
+
+#endif // SRC_RELOCALIZERS_BOW_RELOCALIZER_H_
@@ -0,0 +1,126 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "relocalizers/dimension_hashing.h"
+#include "features/binary_feature.h"
+#include "features/feature_loader.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace localization::relocalizers {
+
+std::vector<int> activeDimensions(const features::iFeature &feature) {
+  const std::vector<uint64_t> words = features::packedFeatureBits(feature);
+  std::vector<int> dimensions;
+  for (size_t w = 0; w < words.size(); ++w) {
+    for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+      dimensions.push_back(64 * w + __builtin_ctzll(word));
+    }
+  }
+  return dimensions;
+}
+
+DimensionHashing::DimensionHashing(database::OnlineDatabase *database,
+                                   double topFraction, int maxCandidates)
+    : database_{database}, topFraction_{topFraction},
+      maxCandidates_{maxCandidates} {
+  CHECK(database_) << "Database is not set\n";
+  CHECK(topFraction_ > 0.0 && topFraction_ <= 1.0)
+      << "The fraction of candidates should be in (0, 1].";
+  CHECK(maxCandidates_ > 0) << "The number of candidates should be positive.";
+}
+
+void DimensionHashing::train(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(!features.empty()) << "No features to train on.";
+  index_ = std::make_unique<features::DimensionIndex>(
+      features::numFeatureBits(*features[0]));
+  addFeatures(features);
+  LOG(INFO) << "Indexed " << index_->size() << " features in "
+            << index_->memoryBytes() / 1024 << " KB, "
+            << index_->numBitmapLists() << " of " << index_->numDimensions()
+            << " dimensions are bitmaps.";
+}
+
+void DimensionHashing::train(const std::string &featuresDir, int numThreads,
+                             const features::Projection *projection,
+                             features::FeatureType type) {
+  LOG_IF(FATAL, !features::hasFeatureBits(type))
+      << "Dimension hashing indexes the bits of the features, "
+      << features::featureTypeName(type) << " features have none.";
+  LOG(INFO) << "Loading the features to index with dimension hashing.";
+  const auto features =
+      features::loadFeatures(featuresDir, type, numThreads,
+                             /*stats=*/nullptr, projection);
+  CHECK(!features.empty()) << "No features to train on in " << featuresDir;
+  train(features);
+}
+
+void DimensionHashing::addFeatures(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(index_) << "Train the dimension hashing before adding features.";
+  for (const auto &feature : features) {
+    CHECK_EQ(features::numFeatureBits(*feature), index_->numDimensions())
+        << "The feature has another number of bits than the indexed ones";
+    index_->add(activeDimensions(*feature));
+  }
+}
+
+const features::DimensionIndex &DimensionHashing::index() const {
+  CHECK(index_) << "Train the dimension hashing first.";
+  return *index_;
+}
+
+std::vector<int>
+DimensionHashing::candidatesFor(const features::iFeature &feature) const {
+  const features::DimensionIndex &idx = index();
+  CHECK_EQ(features::numFeatureBits(feature), idx.numDimensions())
+      << "The query has another number of bits than the indexed features";
+  const int numCandidates = std::min(
+      maxCandidates_,
+      std::max(1, static_cast<int>(std::ceil(topFraction_ * idx.size()))));
+  std::vector<int> candidates;
+  for (const auto &[refId, votes] :
+       idx.topK(activeDimensions(feature), numCandidates)) {
+    candidates.push_back(refId);
+  }
+  return candidates;
+}
+
+std::vector<int> DimensionHashing::getCandidates(int quId) {
+  const auto &feature = database_->getQueryFeature(quId);
+  Timer timer;
+  timer.start();
+  std::vector<int> candidates = candidatesFor(feature);
+  timer.stop();
+  LOG(INFO) << "Dimension hashing retrieval time";
+  timer.print_elapsed_time(TimeExt::MicroSec);
+  LOG(INFO) << "Candidates size: " << candidates.size();
+  return candidates;
+}
+
+} // namespace localization::relocalizers
@@ -0,0 +1,85 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_RELOCALIZERS_DIMENSION_HASHING_H_
+#define SRC_RELOCALIZERS_DIMENSION_HASHING_H_
+
+#include "database/online_database.h"
+#include "features/dimension_index.h"
+#include "features/feature_factory.h"
+#include "features/ifeature.h"
+#include "features/projection.h"
+#include "relocalizers/irelocalizer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::relocalizers {
+
+/**
+ * @brief      Dimension Hashing: relocalizes with an inverted index from the
+ * active dimensions of binary features to the reference images, see
+ * readme.md. Every active dimension of the query votes for the references
+ * that share it, the `topFraction` of the references with the most votes are
+ * the candidates, at most `maxCandidates` of them.
+ *
+ * Works with the bits of `Cnn_Feature` features, which are mid-binarized,
+ * and with the packed `Binary_Feature_*` features.
+ */
+class DimensionHashing : public iRelocalizer {
+public:
+  explicit DimensionHashing(database::OnlineDatabase *database,
+                            double topFraction = 0.3, int maxCandidates = 5);
+
+  std::vector<int> getCandidates(int quId) override;
+
+  void train(const std::vector<std::unique_ptr<features::iFeature>> &features);
+  // Loads the reference features from the directory in parallel and indexes
+  // their bits. Use the projection of the database, if any, so the indexed
+  // bits match the ones of the queries. `type` is the feature type of the
+  // database, it sets how the values are binarized.
+  void train(const std::string &featuresDir, int numThreads = 0,
+             const features::Projection *projection = nullptr,
+             features::FeatureType type = features::Cnn_Feature);
+  /** Indexes features appended to the reference after training, nothing is
+   * rebuilt. **/
+  void addFeatures(
+      const std::vector<std::unique_ptr<features::iFeature>> &features);
+
+  std::vector<int> candidatesFor(const features::iFeature &feature) const;
+  const features::DimensionIndex &index() const;
+
+private:
+  database::OnlineDatabase *database_ = nullptr;
+  double topFraction_ = 0.3;
+  int maxCandidates_ = 5;
+  std::unique_ptr<features::DimensionIndex> index_;
+};
+
+/** The dimensions that are 1 in the bits of a binary feature. **/
+std::vector<int> activeDimensions(const features::iFeature &feature);
+
+} // namespace localization::relocalizers
+
+#endif // SRC_RELOCALIZERS_DIMENSION_HASHING_H_
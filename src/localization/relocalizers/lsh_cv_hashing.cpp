@@ -23,10 +23,15 @@
 
 #include "lsh_cv_hashing.h"
 #include "database/list_dir.h"
+#include "features/binary_feature.h"
+#include "features/feature_loader.h"
+#include "tools/parallel/parallel_for.h"
 #include "tools/timer/timer.h"
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 namespace localization::relocalizers {
 
 const int kMaxCandidateNum = 5;
@@ -39,54 +44,138 @@ LshCvHashing::LshCvHashing(database::OnlineDatabase *database, int tableNum,
       new cv::flann::LshIndexParams(tableNum, keySize, multiProbeLevel);
 }
 
+namespace {
+// Appended features are searched exhaustively until they make up this share
+// of the trained ones, then the LSH index is rebuilt over all features.
+constexpr double kMaxAppendedFraction = 0.1;
+
+// One byte per bit, the matcher compares the rows byte by byte. The bits
+// come from features::packedFeatureBits(), so features without their own
+// bits, e.g. StoredFeatures, are binarized like CnnFeatures.
+void copyBits(const features::iFeature &feature, uchar *row) {
+  const std::vector<uint64_t> words = features::packedFeatureBits(feature);
+  const int numBits = features::numFeatureBits(feature);
+  for (int d = 0; d < numBits; ++d) {
+    row[d] = (words[d / 64] >> (d % 64)) & 1;
+  }
+}
+
+cv::Mat
+toBitsMatrix(const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  cv::Mat matFeatures(features.size(), features::numFeatureBits(*features[0]),
+                      CV_8UC1);
+  tools::parallelFor(0, features.size(), [&](int f) {
+    const int numBits = features::numFeatureBits(*features[f]);
+    CHECK(numBits == matFeatures.cols)
+        << "Feature " << f << " has " << numBits << " bits, expected "
+        << matFeatures.cols;
+    copyBits(*features[f], matFeatures.ptr<uchar>(f));
+  });
+  return matFeatures;
+}
+} // namespace
+
 void LshCvHashing::train(
     const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  train(toBitsMatrix(features));
+}
+
+void LshCvHashing::train(const cv::Mat &matFeatures) {
   matcherPtr_ =
       cv::Ptr<cv::FlannBasedMatcher>(new cv::FlannBasedMatcher(indexParam_));
-  // transform to cv::Mat array of arrays
-  cv::Mat matFeatures(features.size(), features[0]->bits.size(), CV_8UC1);
-  for (int f = 0; f < features.size(); ++f) {
-    for (int d = 0; d < features[f]->bits.size(); ++d) {
-      matFeatures.at<uchar>(f, d) = features[f]->bits[d];
-    }
-  }
+  trainedFeatures_ = matFeatures;
+  appendedFeatures_ = cv::Mat();
+  appendedMatcher_ = cv::Ptr<cv::BFMatcher>(new cv::BFMatcher(cv::NORM_HAMMING));
 
   LOG(INFO) << "Features were converted to Mat type " << matFeatures.type();
-  matcherPtr_->add(matFeatures);
+  matcherPtr_->add(trainedFeatures_);
   matcherPtr_->train();
 
   LOG(INFO) << "Training completed";
 }
 
+void LshCvHashing::addFeatures(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(matcherPtr_) << "Train the hashing before adding features.";
+  if (features.empty()) {
+    return;
+  }
+  const cv::Mat matFeatures = toBitsMatrix(features);
+  CHECK(matFeatures.cols == trainedFeatures_.cols)
+      << "Added features have " << matFeatures.cols << " bits, expected "
+      << trainedFeatures_.cols;
+  appendedFeatures_.push_back(matFeatures);
+  if (appendedFeatures_.rows > kMaxAppendedFraction * trainedFeatures_.rows) {
+    LOG(INFO) << "Rebuilding the hash index with " << appendedFeatures_.rows
+              << " added features.";
+    cv::Mat allFeatures;
+    cv::vconcat(trainedFeatures_, appendedFeatures_, allFeatures);
+    train(allFeatures);
+    return;
+  }
+  // Brute force matching only keeps the matrix, adding to it is cheap.
+  appendedMatcher_->clear();
+  appendedMatcher_->add(appendedFeatures_);
+  LOG(INFO) << "Added " << features.size() << " features, "
+            << appendedFeatures_.rows << " are not hashed yet.";
+}
+
+void LshCvHashing::train(const std::string &featuresDir, int numThreads,
+                         const features::Projection *projection,
+                         features::FeatureType type) {
+  LOG_IF(FATAL, !features::hasFeatureBits(type))
+      << "LSH hashes the bits of the features, "
+      << features::featureTypeName(type) << " features have none.";
+  LOG(INFO) << "Loading the features to hash with LSH.";
+  const auto features =
+      features::loadFeatures(featuresDir, type, numThreads,
+                             /*stats=*/nullptr, projection);
+  CHECK(!features.empty()) << "No features to train on in " << featuresDir;
+  train(features);
+}
+
 std::vector<int> LshCvHashing::hashFeature(const features::iFeature &feature) {
   std::vector<std::vector<cv::DMatch>> matches;
-  cv::Mat featureCV(1, feature.bits.size(), CV_8UC1);
-  for (int i = 0; i < feature.bits.size(); ++i) {
-    featureCV.at<uchar>(0, i) = feature.bits[i];
-  }
+  CHECK(features::numFeatureBits(feature) == trainedFeatures_.cols)
+      << "The query has " << features::numFeatureBits(feature)
+      << " bits, expected " << trainedFeatures_.cols;
+  cv::Mat featureCV(1, trainedFeatures_.cols, CV_8UC1);
+  copyBits(feature, featureCV.ptr<uchar>(0));
   Timer timer;
   timer.start();
   matcherPtr_->knnMatch(featureCV, matches, kMaxCandidateNum);
+  std::vector<cv::DMatch> candidates;
+  for (int k = 0; k < matches.size(); ++k) {
+    candidates.insert(candidates.end(), matches[k].begin(), matches[k].end());
+  }
+  if (!appendedFeatures_.empty()) {
+    std::vector<std::vector<cv::DMatch>> appendedMatches;
+    appendedMatcher_->knnMatch(featureCV, appendedMatches, kMaxCandidateNum);
+    for (const auto &queryMatches : appendedMatches) {
+      for (cv::DMatch match : queryMatches) {
+        // Appended features follow the trained ones in the reference.
+        match.trainIdx += trainedFeatures_.rows;
+        candidates.push_back(match);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const cv::DMatch &lhs, const cv::DMatch &rhs) {
+                return lhs.distance < rhs.distance;
+              });
+    if (candidates.size() > kMaxCandidateNum) {
+      candidates.resize(kMaxCandidateNum);
+    }
+  }
   timer.stop();
   LOG(INFO) << "Time to extract neighbours:";
   timer.print_elapsed_time(TimeExt::MicroSec);
 
   std::vector<int> matchedIds;
-  for (int k = 0; k < matches.size(); ++k) {
-    for (const auto &match : matches[k]) {
-      matchedIds.push_back(match.trainIdx);
-    }
+  for (const auto &match : candidates) {
+    matchedIds.push_back(match.trainIdx);
   }
   return matchedIds;
 }
-void LshCvHashing::saveHashes() {
-  cv::FileStorage fs("trained_trees.yaml", cv::FileStorage::WRITE);
-  matcherPtr_->write(fs);
-
-  cv::FileStorage fsRead("trained_trees.yaml", cv::FileStorage::READ);
-  cv::FileNode node = fsRead["indexParams"];
-  matcherPtr_->read(node);
-}
 
 std::vector<int> LshCvHashing::getCandidates(int quId) {
   LOG(INFO) << "Getting candidates for a query image";
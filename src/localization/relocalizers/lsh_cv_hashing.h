@@ -25,7 +25,9 @@
 #define SRC_RELOCALIZERS_LSH_CV_HASHING_H_
 
 #include "database/online_database.h"
+#include "features/feature_factory.h"
 #include "features/ifeature.h"
+#include "features/projection.h"
 #include "relocalizers/irelocalizer.h"
 
 #include "opencv2/features2d/features2d.hpp"
@@ -40,7 +42,9 @@ namespace localization::relocalizers {
 
 /**
  * @brief      Performs locality sensitive hashing for angle-based similarity
- * measures.
+ * measures with OpenCV FLANN. The localizers use the native LshHashing, this
+ * version is kept as the baseline of relocalizer_benchmark. Its index cannot
+ * be saved, the one of LshHashing can.
  */
 class LshCvHashing : public iRelocalizer {
 public:
@@ -53,15 +57,29 @@ public:
   std::vector<int> getCandidates(int quId) override;
 
   void train(const std::vector<std::unique_ptr<features::iFeature>> &features);
+  // Loads and binarizes the reference features from the directory in
+  // parallel, then trains on them. Use the projection of the database, if
+  // any, so the hashed bits match the ones of the queries. `type` is the
+  // feature type of the database, it sets how the values are binarized.
+  void train(const std::string &featuresDir, int numThreads = 0,
+             const features::Projection *projection = nullptr,
+             features::FeatureType type = features::Cnn_Feature);
   /**
-   * @brief      Not working for now, for unknown reason
+   * @brief      Adds features appended to the reference after training. They
+   * are matched exhaustively until there are enough of them to be worth
+   * rebuilding the hash tables over all features.
    */
-  void saveHashes();
-
+  void addFeatures(
+      const std::vector<std::unique_ptr<features::iFeature>> &features);
   std::vector<int> hashFeature(const features::iFeature &fPtr);
 
 private:
+  void train(const cv::Mat &matFeatures);
+
   cv::Ptr<cv::FlannBasedMatcher> matcherPtr_;
+  cv::Ptr<cv::BFMatcher> appendedMatcher_;
+  cv::Mat trainedFeatures_;
+  cv::Mat appendedFeatures_;
   cv::Ptr<cv::flann::IndexParams> indexParam_;
   database::OnlineDatabase *database_ = nullptr;
 };
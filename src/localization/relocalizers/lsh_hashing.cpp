@@ -0,0 +1,159 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "relocalizers/lsh_hashing.h"
+#include "database/fingerprint.h"
+#include "features/binary_feature.h"
+#include "features/feature_loader.h"
+#include "tools/timer/timer.h"
+
+#include <glog/logging.h>
+
+#include <filesystem>
+
+namespace localization::relocalizers {
+
+LshHashing::LshHashing(database::OnlineDatabase *database,
+                       const features::LshOptions &options, int numCandidates)
+    : database_{database}, options_{options}, numCandidates_{numCandidates} {
+  CHECK(database_) << "Database is not set\n";
+  CHECK(numCandidates_ > 0) << "The number of candidates should be positive.";
+}
+
+void LshHashing::train(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(!features.empty()) << "No features to train on.";
+  index_ = std::make_unique<features::LshIndex>(
+      features::numFeatureBits(*features[0]), options_);
+  addFeatures(features);
+  index_->rebuild();
+  LOG(INFO) << "Hashed " << index_->size() << " features into "
+            << options_.numTables << " tables, "
+            << index_->memoryBytes() / 1024 << " KB.";
+}
+
+void LshHashing::train(const std::string &featuresDir, int numThreads,
+                       const features::Projection *projection,
+                       features::FeatureType type) {
+  LOG_IF(FATAL, !features::hasFeatureBits(type))
+      << "LSH hashes the bits of the features, "
+      << features::featureTypeName(type) << " features have none.";
+  LOG(INFO) << "Loading the features to hash with LSH.";
+  const auto features =
+      features::loadFeatures(featuresDir, type, numThreads,
+                             /*stats=*/nullptr, projection);
+  CHECK(!features.empty()) << "No features to train on in " << featuresDir;
+  train(features);
+}
+
+void LshHashing::addFeatures(
+    const std::vector<std::unique_ptr<features::iFeature>> &features) {
+  CHECK(index_) << "Train the hashing before adding features.";
+  for (const auto &feature : features) {
+    CHECK_EQ(features::numFeatureBits(*feature), index_->numBits())
+        << "The feature has another number of bits than the hashed ones";
+    index_->add(features::packedFeatureBits(*feature).data());
+  }
+}
+
+void LshHashing::save(const std::string &filename,
+                      uint64_t referenceFingerprint) const {
+  index().save(filename, referenceFingerprint);
+}
+
+bool LshHashing::load(const std::string &filename,
+                      uint64_t referenceFingerprint) {
+  if (!std::filesystem::exists(filename)) {
+    LOG(INFO) << "There is no LSH index " << filename;
+    return false;
+  }
+  auto loaded = features::LshIndex::open(filename, options_.numThreads);
+  const features::LshOptions &saved = loaded->options();
+  if (loaded->referenceFingerprint() != referenceFingerprint) {
+    LOG(WARNING) << "The LSH index " << filename
+                 << " was built from other reference features.";
+    return false;
+  }
+  if (saved.numTables != options_.numTables ||
+      saved.keySize != options_.keySize ||
+      saved.multiProbeLevel != options_.multiProbeLevel ||
+      saved.seed != options_.seed) {
+    LOG(WARNING) << "The LSH index " << filename
+                 << " was built with other options.";
+    return false;
+  }
+  index_ = std::move(loaded);
+  LOG(INFO) << "Loaded the LSH index of " << index_->size()
+            << " features from " << filename;
+  return true;
+}
+
+const features::LshIndex &LshHashing::index() const {
+  CHECK(index_) << "Train the hashing first.";
+  return *index_;
+}
+
+std::vector<int>
+LshHashing::candidatesFor(const features::iFeature &feature) const {
+  const features::LshIndex &idx = index();
+  CHECK_EQ(features::numFeatureBits(feature), idx.numBits())
+      << "The query has another number of bits than the hashed features";
+  std::vector<int> candidates;
+  for (const auto &[refId, distance] :
+       idx.knn(features::packedFeatureBits(feature).data(), numCandidates_)) {
+    candidates.push_back(refId);
+  }
+  return candidates;
+}
+
+std::vector<int> LshHashing::getCandidates(int quId) {
+  const auto &feature = database_->getQueryFeature(quId);
+  Timer timer;
+  timer.start();
+  std::vector<int> candidates = candidatesFor(feature);
+  timer.stop();
+  LOG(INFO) << "Hash retrieval time";
+  timer.print_elapsed_time(TimeExt::MicroSec);
+  LOG(INFO) << "Candidates size: " << candidates.size();
+  return candidates;
+}
+
+uint64_t indexFingerprint(uint64_t featuresFingerprint,
+                          const std::string &projectionFile,
+                          features::FeatureType type) {
+  uint64_t fingerprint = featuresFingerprint;
+  if (!projectionFile.empty()) {
+    // The projection changes the hashed bits of the same features.
+    fingerprint = database::combineFingerprints(
+        {fingerprint, database::fingerprintFile(projectionFile)});
+  }
+  if (type != features::Cnn_Feature) {
+    // So does another binarization. Indexes of CnnFeatures keep the
+    // fingerprint they were saved with.
+    fingerprint = database::combineFingerprints(
+        {fingerprint, static_cast<uint64_t>(type)});
+  }
+  return fingerprint;
+}
+
+} // namespace localization::relocalizers
@@ -0,0 +1,104 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_RELOCALIZERS_LSH_HASHING_H_
+#define SRC_RELOCALIZERS_LSH_HASHING_H_
+
+#include "database/online_database.h"
+#include "features/feature_factory.h"
+#include "features/ifeature.h"
+#include "features/lsh_index.h"
+#include "features/projection.h"
+#include "relocalizers/irelocalizer.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace localization::relocalizers {
+
+/**
+ * @brief      Relocalizes with multi-probe LSH on the packed bits of the
+ * features, see features/lsh_index.h. The candidates are the
+ * `numCandidates` references with the smallest Hamming distance among the
+ * ones found in the probed buckets.
+ *
+ * Works with the bits of `Cnn_Feature` features and with the packed
+ * `Binary_Feature_*` features. We find that mean-binarization works best.
+ */
+class LshHashing : public iRelocalizer {
+public:
+  explicit LshHashing(database::OnlineDatabase *database,
+                      const features::LshOptions &options = {},
+                      int numCandidates = 5);
+
+  std::vector<int> getCandidates(int quId) override;
+
+  void train(const std::vector<std::unique_ptr<features::iFeature>> &features);
+  // Loads the reference features from the directory in parallel and hashes
+  // their bits. Use the projection of the database, if any, so the hashed
+  // bits match the ones of the queries. `type` is the feature type of the
+  // database, it sets how the values are binarized.
+  void train(const std::string &featuresDir, int numThreads = 0,
+             const features::Projection *projection = nullptr,
+             features::FeatureType type = features::Cnn_Feature);
+  /** Adds features appended to the reference after training, see
+   * LshIndex::add(). **/
+  void addFeatures(
+      const std::vector<std::unique_ptr<features::iFeature>> &features);
+
+  /** Writes the trained index with the fingerprint of the reference it
+   * was trained on, see LshIndex::save(). **/
+  void save(const std::string &filename, uint64_t referenceFingerprint) const;
+  /**
+   * @brief      Maps an index written by save() instead of training. Returns
+   * false and leaves the hashing as it was if the file does not exist, or if
+   * the index was built from features with another fingerprint or with other
+   * options than the ones of the hashing.
+   */
+  bool load(const std::string &filename, uint64_t referenceFingerprint);
+
+  std::vector<int> candidatesFor(const features::iFeature &feature) const;
+  const features::LshIndex &index() const;
+
+private:
+  database::OnlineDatabase *database_ = nullptr;
+  features::LshOptions options_;
+  int numCandidates_ = 5;
+  std::unique_ptr<features::LshIndex> index_;
+};
+
+/**
+ * @brief      The reference fingerprint that LshHashing::save() and load()
+ * expect for an index of the features with `featuresFingerprint`, e.g.
+ * database::fingerprintFeatures(), hashed through the projection in
+ * `projectionFile`, if any, and binarized as features of `type`.
+ */
+uint64_t indexFingerprint(uint64_t featuresFingerprint,
+                          const std::string &projectionFile = "",
+                          features::FeatureType type = features::Cnn_Feature);
+
+} // namespace localization::relocalizers
+
+#endif // SRC_RELOCALIZERS_LSH_HASHING_H_
@@ -31,6 +31,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <vector>
 using std::vector;
 
 namespace localization::successor_manager {
@@ -111,10 +112,15 @@ void SuccessorManager::getSuccessorFanOut(int quId, int refId) {
   int left_ref = std::max(refId - fanOut_, 0);
   int right_ref = std::min(refId + fanOut_, database_->refSize() - 1);
 
+  // All successors are scored in one batch.
+  std::vector<int> succRefs;
   for (int succ_ref = left_ref; succ_ref <= right_ref; ++succ_ref) {
+    succRefs.push_back(succ_ref);
+  }
+  const std::vector<double> succCosts = database_->getCosts(quId + 1, succRefs);
+  for (size_t idx = 0; idx < succRefs.size(); ++idx) {
     Node succ;
-    double succ_cost = database_->getCost(quId + 1, succ_ref);
-    succ.set(quId + 1, succ_ref, succ_cost);
+    succ.set(quId + 1, succRefs[idx], succCosts[idx]);
     _successors.insert(succ);
   }
 }
@@ -161,10 +167,11 @@ SuccessorManager::getSuccessorsIfLost(const Node &node) {
     succ.set(succ_qu_id, node.refId, succ_cost);
     _successors.insert(succ);
   } else {
-    for (const auto &candId : candidates) {
+    const std::vector<double> candCosts =
+        database_->getCosts(succ_qu_id, candidates);
+    for (size_t idx = 0; idx < candidates.size(); ++idx) {
       Node succ;
-      double succ_cost = database_->getCost(succ_qu_id, candId);
-      succ.set(succ_qu_id, candId, succ_cost);
+      succ.set(succ_qu_id, candidates[idx], candCosts[idx]);
       _successors.insert(succ);
       succ.print();
     }
@@ -122,6 +122,7 @@ void ConfigParser::print() const {
     printf("== Read parameters ==\n");
     printf("== Path2query: %s\n", path2qu.c_str());
     printf("== Path2ref: %s\n", path2ref.c_str());
+    printf("== appendToReference: %s\n", appendToReference.c_str());
 
     printf("== Query size: %d\n", querySize);
     printf("== matchingThreshold: %3.4f\n", matchingThreshold);
@@ -132,10 +133,26 @@ void ConfigParser::print() const {
     printf("== Path2reference images: %s\n", path2refImg.c_str());
     printf("== Image extension: %s\n", imgExt.c_str());
     printf("== Buffer size: %d\n", bufferSize);
+    printf("== Buffer memory: %d MB\n", bufferMemoryMb);
+    printf("== Prefetch lookahead: %d\n", prefetchLookahead);
+    printf("== Number of shards: %d\n", numShards);
 
     printf("== similarityMatrix: %s\n", similarityMatrix.c_str());
     printf("== matchingResult: %s\n", matchingResult.c_str());
     printf("== simPlaces: %s\n", simPlaces.c_str());
+    printf("== costCache: %s\n", costCache.c_str());
+    printf("== pqStore: %s\n", pqStore.c_str());
+    printf("== featureProjection: %s\n", featureProjection.c_str());
+    printf("== dnnModel: %s\n", dnnModel.c_str());
+    printf("== DNN input size: %d\n", dnnInputSize);
+    printf("== DNN batch size: %d\n", dnnBatchSize);
+    printf("== featureType: %s\n", featureType.c_str());
+    printf("== relocalizer: %s\n", relocalizer.c_str());
+    printf("== LSH tables: %d\n", lshNumTables);
+    printf("== LSH key size: %d\n", lshKeySize);
+    printf("== LSH multi-probe level: %d\n", lshMultiProbeLevel);
+    printf("== relocalization candidates: %d\n", relocalizationCandidates);
+    printf("== hashTable: %s\n", hashTable.c_str());
 }
 
 bool ConfigParser::parseYaml(const std::string &yamlFile) {
@@ -153,6 +170,9 @@ bool ConfigParser::parseYaml(const std::string &yamlFile) {
     if (config["path2qu"]) {
         path2qu = config["path2qu"].as<std::string>();
     }
+    if (config["appendToReference"]) {
+        appendToReference = config["appendToReference"].as<std::string>();
+    }
     if (config["querySize"]) {
         querySize = config["querySize"].as<int>();
     }
@@ -178,6 +198,15 @@ bool ConfigParser::parseYaml(const std::string &yamlFile) {
     if (config["bufferSize"]) {
         bufferSize = config["bufferSize"].as<int>();
     }
+    if (config["bufferMemoryMb"]) {
+        bufferMemoryMb = config["bufferMemoryMb"].as<int>();
+    }
+    if (config["prefetchLookahead"]) {
+        prefetchLookahead = config["prefetchLookahead"].as<int>();
+    }
+    if (config["numShards"]) {
+        numShards = config["numShards"].as<int>();
+    }
     if (config["similarityMatrix"]) {
         similarityMatrix = config["similarityMatrix"].as<std::string>();
     }
@@ -188,9 +217,68 @@ bool ConfigParser::parseYaml(const std::string &yamlFile) {
     if (config["hashTable"]) {
         hashTable = config["hashTable"].as<std::string>();
     }
+    if (config["costCache"]) {
+        costCache = config["costCache"].as<std::string>();
+    }
+    if (config["pqStore"]) {
+        pqStore = config["pqStore"].as<std::string>();
+    }
+    if (config["featureProjection"]) {
+        featureProjection = config["featureProjection"].as<std::string>();
+    }
+    if (config["dnnModel"]) {
+        dnnModel = config["dnnModel"].as<std::string>();
+    }
+    if (config["dnnInputSize"]) {
+        dnnInputSize = config["dnnInputSize"].as<int>();
+    }
+    if (config["dnnBatchSize"]) {
+        dnnBatchSize = config["dnnBatchSize"].as<int>();
+    }
+    if (config["featureType"]) {
+        featureType = config["featureType"].as<std::string>();
+    }
+    if (config["relocalizer"]) {
+        relocalizer = config["relocalizer"].as<std::string>();
+    }
+    if (config["lshNumTables"]) {
+        lshNumTables = config["lshNumTables"].as<int>();
+    }
+    if (config["lshKeySize"]) {
+        lshKeySize = config["lshKeySize"].as<int>();
+    }
+    if (config["lshMultiProbeLevel"]) {
+        lshMultiProbeLevel = config["lshMultiProbeLevel"].as<int>();
+    }
+    if (config["relocalizationCandidates"]) {
+        relocalizationCandidates = config["relocalizationCandidates"].as<int>();
+    }
     if (config["matchingResult"]) {
         matchingResult = config["matchingResult"].as<std::string>();
     }
 
+    if (lshNumTables < 1 || lshKeySize < 1 || lshKeySize > 32) {
+        printf("[ERROR][ConfigParser] lshNumTables should be positive and "
+               "lshKeySize in [1, 32], got %d and %d\n",
+               lshNumTables, lshKeySize);
+        return false;
+    }
+    // The buckets within lshMultiProbeLevel bits of a key, LshIndex probes
+    // at most 2^16 of them per table.
+    long long probes = 0;
+    long long keys = 1;
+    for (int bits = 0; bits <= lshMultiProbeLevel && probes <= (1 << 16);
+         ++bits) {
+        probes += keys;
+        keys = keys * (lshKeySize - bits) / (bits + 1);
+    }
+    if (lshMultiProbeLevel < 0 || lshMultiProbeLevel > lshKeySize ||
+        probes > (1 << 16)) {
+        printf("[ERROR][ConfigParser] lshMultiProbeLevel %d probes too many "
+               "buckets with %d bit keys, use at most 2^16 per table\n",
+               lshMultiProbeLevel, lshKeySize);
+        return false;
+    }
+
     return true;
 }
@@ -38,17 +38,33 @@ class ConfigParser {
 
     std::string path2qu = "";
     std::string path2ref = "";
+    std::string appendToReference = "";
     std::string path2quImg = "";
     std::string path2refImg = "";
     std::string imgExt = "";
     std::string similarityMatrix = "";
     std::string simPlaces = "";
     std::string hashTable = "";
+    std::string costCache = "";
+    std::string pqStore = "";
+    std::string featureProjection = "";
+    std::string dnnModel = "";
+    std::string featureType = "Cnn_Feature";
+    std::string relocalizer = "lsh";
     std::string matchingResult = "matches.MatchingResult.pb";
 
     int querySize = -1;
     int fanOut = -1;
     int bufferSize = -1;
+    int bufferMemoryMb = 0;
+    int prefetchLookahead = 0;
+    int numShards = 1;
+    int dnnInputSize = 224;
+    int dnnBatchSize = 16;
+    int lshNumTables = 1;
+    int lshKeySize = 12;
+    int lshMultiProbeLevel = 2;
+    int relocalizationCandidates = 5;
     double matchingThreshold = -1.0;
     double expansionRate = -1.0;
 };
@@ -59,6 +75,11 @@ class ConfigParser {
 /*! \var std::string ConfigParser::path2ref
     \brief stores path to the folder with reference features.
 */
+/*! \var std::string ConfigParser::appendToReference
+    \brief stores path to the folder with the features of a new mapping run.
+   If set, they are appended to the reference after `path2ref` without
+   rebuilding the database, the cost cache or the relocalizer.
+*/
 
 /*! \var std::string ConfigParser::path2quImg
     \brief stores path to the folder with query images.
@@ -73,8 +94,41 @@ class ConfigParser {
     \brief stores path to precomputed similarity matrix.
 */
 /*! \var std::string ConfigParser::hashTable
-    \brief stores the name of the file to read hash table from.
-   matching.
+    \brief stores path to a `.LshIndex.bin` file of the `lsh` relocalizer,
+   e.g. built with `build_relocalization_index`. If set, the index is mapped
+   instead of hashing the reference features, and rebuilt and saved there if
+   it is missing or was built from other features or options.
+*/
+
+/*! \var std::string ConfigParser::costCache
+    \brief stores path to the directory of the persistent cost cache. If set,
+   the costs computed from features are stored there and reused by later runs
+   on the same features.
+*/
+/*! \var std::string ConfigParser::pqStore
+    \brief stores path to a `.PqStore.bin` file of the reference features,
+   e.g. written by `convert_features_to_pq_store`. If set, the matching costs
+   are computed from its compressed codes, `path2ref` is still used by the
+   relocalizer.
+*/
+/*! \var std::string ConfigParser::featureProjection
+    \brief stores path to a `.Projection.bin` file, e.g. trained with
+   `train_projection`. If set, the features are projected to fewer dimensions
+   when they are loaded.
+*/
+/*! \var std::string ConfigParser::dnnModel
+    \brief stores path to an ONNX model. If set, the descriptors of the images
+   in `path2quImg` and `path2refImg` are computed in the localizer and
+   `path2qu`, `path2ref` are not read.
+*/
+/*! \var std::string ConfigParser::featureType
+    \brief how the `.Feature.pb` files are loaded and compared, one of the
+   `localization::features::FeatureType` names, e.g. `Cnn_Feature` or
+   `Bow_Feature`.
+*/
+/*! \var std::string ConfigParser::relocalizer
+    \brief the relocalizer used when the robot is lost, `lsh`,
+   `dimension_hashing` or, for `Bow_Feature`, `bow`.
 */
 
 /*! \var int ConfigParser::querySize
@@ -90,6 +144,40 @@ class ConfigParser {
     \brief number of image features to be cached. Speeds up the computation for
    feature_based matching. Irrelevant for cost_matrix_based matching.
 */
+/*! \var int ConfigParser::bufferMemoryMb
+    \brief memory budget of each feature buffer in megabytes. The least
+   recently used features are evicted once either `bufferSize` or this budget
+   is exceeded. 0 means no memory limit.
+*/
+/*! \var int ConfigParser::prefetchLookahead
+    \brief number of upcoming query images for which the features are loaded
+   on a background thread ahead of the search. 0 disables prefetching.
+*/
+/*! \var int ConfigParser::numShards
+    \brief number of worker processes the reference features are split
+   between. Each worker loads and matches only its part of the reference.
+*/
+/*! \var int ConfigParser::dnnInputSize
+    \brief width and height the images are resized to for `dnnModel`.
+*/
+/*! \var int ConfigParser::dnnBatchSize
+    \brief number of images `dnnModel` processes at once.
+*/
+/*! \var int ConfigParser::lshNumTables
+    \brief number of hash tables of the `lsh` relocalizer.
+*/
+/*! \var int ConfigParser::lshKeySize
+    \brief number of bits sampled for the keys of the `lsh` relocalizer.
+*/
+/*! \var int ConfigParser::lshMultiProbeLevel
+    \brief the `lsh` relocalizer also probes the buckets whose keys differ in
+   up to this many bits. Levels that probe more than 2^16 buckets per table
+   are rejected, e.g. above 4 for 32 bit keys.
+*/
+/*! \var int ConfigParser::relocalizationCandidates
+    \brief number of reference images the relocalizer proposes when the robot
+   is lost.
+*/
 /*! \var double ConfigParser::matchingThreshold
     \brief maximum boundary for the matching cost to still be considered as a
    match. For example, if `matchingThreshold = 5.0` then every smaller cost should
@@ -0,0 +1,71 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "tools/parallel/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace localization::tools {
+
+int defaultNumThreads() {
+  return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+void parallelFor(int begin, int end, const std::function<void(int)> &func,
+                 int numThreads) {
+  if (begin >= end) {
+    return;
+  }
+  if (numThreads <= 0) {
+    numThreads = defaultNumThreads();
+  }
+  numThreads = std::min(numThreads, end - begin);
+  if (numThreads == 1) {
+    for (int idx = begin; idx < end; ++idx) {
+      func(idx);
+    }
+    return;
+  }
+
+  std::atomic<int> next{begin};
+  auto worker = [&]() {
+    for (int idx = next++; idx < end; idx = next++) {
+      func(idx);
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads - 1);
+  for (int t = 0; t < numThreads - 1; ++t) {
+    threads.emplace_back(worker);
+  }
+  // The calling thread does its share of work as well.
+  worker();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+} // namespace localization::tools
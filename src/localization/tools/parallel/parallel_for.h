@@ -0,0 +1,54 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#ifndef SRC_TOOLS_PARALLEL_PARALLEL_FOR_H_
+#define SRC_TOOLS_PARALLEL_PARALLEL_FOR_H_
+
+#include <functional>
+
+namespace localization::tools {
+
+/**
+ * @brief      Number of worker threads to use when the caller did not specify
+ * one. Equals to the number of hardware threads, but at least 1.
+ */
+int defaultNumThreads();
+
+/**
+ * @brief      Calls `func(idx)` for every idx in [begin, end) using
+ * `numThreads` worker threads. The indices are handed out dynamically, so
+ * the tasks do not need to have the same cost. Blocks until all the tasks are
+ * done.
+ *
+ * @param[in]  begin       The first index.
+ * @param[in]  end         The index after the last one.
+ * @param[in]  func        The function to call for every index.
+ * @param[in]  numThreads  The number of threads, <= 0 means
+ * defaultNumThreads().
+ */
+void parallelFor(int begin, int end, const std::function<void(int)> &func,
+                 int numThreads = 0);
+
+} // namespace localization::tools
+
+#endif // SRC_TOOLS_PARALLEL_PARALLEL_FOR_H_
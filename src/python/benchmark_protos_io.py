@@ -0,0 +1,47 @@
+import argparse
+import struct
+import time
+
+import numpy as np
+
+import protos_io
+import protos.localization_protos_pb2 as loc_protos
+
+
+def measure_parsing(serialized, message_type, repetitions):
+    """Returns the number of messages parsed and converted per second."""
+    start = time.perf_counter()
+    for _ in range(repetitions):
+        proto = message_type()
+        proto.ParseFromString(serialized)
+        protos_io.get_values(proto)
+    return repetitions / (time.perf_counter() - start)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Compares parsing of the Feature proto formats."
+    )
+    parser.add_argument("--dim", type=int, default=4096, help="Feature size.")
+    parser.add_argument("--repetitions", type=int, default=1000)
+    args = parser.parse_args()
+
+    values = np.random.rand(args.dim)
+    # Files written before the values were packed carry a tag per value.
+    unpacked = b"".join(b"\x09" + struct.pack("<d", value) for value in values)
+    rate = measure_parsing(unpacked, loc_protos.Feature, args.repetitions)
+    print("unpacked double: {} bytes, {:.0f} features/s".format(len(unpacked), rate))
+    for value_format in protos_io.VALUE_FORMATS:
+        proto = loc_protos.Feature()
+        protos_io.set_values(proto, values, value_format)
+        serialized = proto.SerializeToString()
+        rate = measure_parsing(serialized, loc_protos.Feature, args.repetitions)
+        print(
+            "{}: {} bytes, {:.0f} features/s".format(
+                value_format, len(serialized), rate
+            )
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -4,21 +4,18 @@ import argparse
 import protos_io
 
 
-def cosine_similarity(qu, db):
-    norm = np.linalg.norm(qu) * np.linalg.norm(db)
-    dist = np.dot(qu, db) / norm
-    return dist
+def normalize_rows(features):
+    norms = np.linalg.norm(features, axis=1, keepdims=True)
+    norms[norms == 0] = 1
+    return features / norms
 
 
 def compute_similarity_matrix(qu_features, db_features):
-    similarity_matrix = np.zeros((len(qu_features), len(db_features)))
-
     print("Computing similarity matrix...")
-    for q, query_feature in enumerate(qu_features):
-        for d, db_feature in enumerate(db_features):
-            # Compute cosine distance
-            similarity_matrix[q, d] = cosine_similarity(query_feature, db_feature)
-
+    # Cosine similarity of all pairs as one matrix product.
+    similarity_matrix = normalize_rows(np.asarray(qu_features)) @ normalize_rows(
+        np.asarray(db_features)
+    ).T
     print("Finished.")
     return similarity_matrix
 
@@ -6,7 +6,7 @@ import protos_io
 import protos.localization_protos_pb2 as loc_protos
 
 
-def convert_to_protos(features, feature_type):
+def convert_to_protos(features, feature_type, value_format="float32"):
     """Converts the numpy nd array to the features protos.
 
     Args:
@@ -14,6 +14,8 @@ def convert_to_protos(features, feature_type):
                                 Expected size NxD, where N is
                                 number of features and D is number
                                 of dimensions.
+        value_format (str): how the values are stored, one of
+                            protos_io.VALUE_FORMATS.
     Returns:
         [image_sequence_localizer.Feature]: list of feature protos.
                                             For details check
@@ -25,7 +27,7 @@ def convert_to_protos(features, feature_type):
         feature_proto = loc_protos.Feature()
         feature_proto.size = feature.shape[0]
         feature_proto.type = feature_type
-        feature_proto.values.extend(feature)
+        protos_io.set_values(feature_proto, feature, value_format)
         protos.append(feature_proto)
     return protos
 
@@ -63,6 +65,15 @@ def main():
     parser.add_argument(
         "--output_folder", required=True, type=Path, help="Path to db directory."
     )
+    parser.add_argument(
+        "--value_format",
+        required=False,
+        type=str,
+        default="float32",
+        choices=protos_io.VALUE_FORMATS,
+        help="How the values are stored. Use 'double' for readers that "
+        "only support the old format.",
+    )
     parser.add_argument(
         "--output_file_prefix",
         required=False,
@@ -78,7 +89,7 @@ def main():
     except:
         print("ERROR: Could not read features from", args.filename)
         return
-    protos = convert_to_protos(features, args.feature_type)
+    protos = convert_to_protos(features, args.feature_type, args.value_format)
     save_protos_to_files(args.output_folder, protos, args.output_file_prefix)
 
 
@@ -3,6 +3,7 @@ import numpy as np
 from pathlib import Path
 
 import convert_numpy_features_to_protos as converter
+import protos_io
 
 
 def test_convert_to_protos():
@@ -10,8 +11,8 @@ def test_convert_to_protos():
     feature_type = "Test"
 
     protos = converter.convert_to_protos(features, feature_type)
-    np.testing.assert_equal(protos[0].values, features[0, :])
-    np.testing.assert_equal(protos[1].values, features[1, :])
+    np.testing.assert_equal(protos_io.get_values(protos[0]), features[0, :])
+    np.testing.assert_equal(protos_io.get_values(protos[1]), features[1, :])
 
     assert protos[0].type == feature_type
     assert protos[1].type == feature_type
@@ -20,6 +21,14 @@ def test_convert_to_protos():
     assert protos[1].size == 3
 
 
+def test_convert_to_protos_in_old_format():
+    features = np.array([[1, 2, 3], [4, 5, 6]])
+
+    protos = converter.convert_to_protos(features, "Test", value_format="double")
+    np.testing.assert_equal(protos[0].values, features[0, :])
+    assert not protos[0].HasField("data")
+
+
 def test_convert_to_proto_not_valid():
     features = np.zeros((2, 3, 4))
     with pytest.raises(AssertionError):
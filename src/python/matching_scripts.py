@@ -97,16 +97,13 @@ def computeFeatures(image_dir, output_folder, dataset_name, feature_type):
 
 
 def computeSimilarityMatrix(run_params):
-    params = "--query_features {query_features} ".format(
-        query_features=run_params.path2qu
+    binary = "../../build/src/apps/similarity_matrix_computation/compute_similarity_matrix"
+    command = "{binary} {query_features} {reference_features} {similarity_matrix_file}".format(
+        binary=binary,
+        query_features=run_params.path2qu,
+        reference_features=run_params.path2ref,
+        similarity_matrix_file=run_params.similarityMatrix,
     )
-    params += "--db_features {reference_features} ".format(
-        reference_features=run_params.path2ref
-    )
-    params += "--similarity_matrix_file {cost_matrix_file} ".format(
-        cost_matrix_file=run_params.similarityMatrix
-    )
-    command = "python compute_similarity_matrix.py " + params
     print("Calling:", command)
     os.system(command)
 
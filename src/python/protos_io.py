@@ -1,6 +1,59 @@
 import numpy as np
 import protos.localization_protos_pb2 as loc_protos
 
+# Formats in which the values of Feature and SimilarityMatrix protos are written.
+# "double" is the version 1 format readable by old readers, "float32" and
+# "float64" store the values as raw little-endian bytes, which is much smaller
+# and faster to parse.
+VALUE_FORMATS = ("double", "float32", "float64")
+
+_RAW_DTYPES = {
+    loc_protos.VALUE_TYPE_FLOAT32: "f4",
+    loc_protos.VALUE_TYPE_FLOAT64: "f8",
+}
+
+
+def get_values(proto):
+    """Returns the values of a Feature or SimilarityMatrix proto of any version.
+
+    Args:
+        proto: Feature or SimilarityMatrix proto.
+    Returns:
+        numpy.ndarray: 1D array of the values.
+    """
+    if not proto.HasField("data"):
+        return np.array(proto.values)
+    assert proto.value_type in _RAW_DTYPES, "Unknown value type {}".format(
+        proto.value_type
+    )
+    byte_order = "<" if proto.byte_order == loc_protos.BYTE_ORDER_LITTLE_ENDIAN else ">"
+    values = np.frombuffer(proto.data, dtype=byte_order + _RAW_DTYPES[proto.value_type])
+    return values.astype(np.float64)
+
+
+def set_values(proto, values, value_format="float32"):
+    """Stores the values in a Feature or SimilarityMatrix proto.
+
+    Args:
+        proto: Feature or SimilarityMatrix proto.
+        values (numpy.ndarray): values, flattened in row-major order.
+        value_format (str): one of VALUE_FORMATS.
+    """
+    assert value_format in VALUE_FORMATS, "Unknown value format {}".format(
+        value_format
+    )
+    values = np.asarray(values).ravel()
+    if value_format == "double":
+        proto.values.extend(values.tolist())
+        return
+    if value_format == "float32":
+        proto.value_type = loc_protos.VALUE_TYPE_FLOAT32
+        proto.data = values.astype("<f4").tobytes()
+    else:
+        proto.value_type = loc_protos.VALUE_TYPE_FLOAT64
+        proto.data = values.astype("<f8").tobytes()
+    proto.byte_order = loc_protos.BYTE_ORDER_LITTLE_ENDIAN
+
 
 def read_feature(feature_filename):
     f = open(feature_filename, "rb")
@@ -8,7 +61,7 @@ def read_feature(feature_filename):
     feature_proto.ParseFromString(f.read())
     f.close()
 
-    return np.array(feature_proto.values)
+    return get_values(feature_proto)
 
 
 def write_feature(filename, proto):
@@ -17,13 +70,14 @@ def write_feature(filename, proto):
     f.close()
 
 
-def write_similarity_matrix(simlarity_matrix, similarity_matrix_file):
+def write_similarity_matrix(
+    simlarity_matrix, similarity_matrix_file, value_format="float32"
+):
 
     similarity_matrix_proto = loc_protos.SimilarityMatrix()
     similarity_matrix_proto.rows = simlarity_matrix.shape[0]
     similarity_matrix_proto.cols = simlarity_matrix.shape[1]
-    for row in simlarity_matrix:
-        similarity_matrix_proto.values.extend(row.tolist())
+    set_values(similarity_matrix_proto, simlarity_matrix, value_format)
 
     f = open(similarity_matrix_file, "wb")
     f.write(similarity_matrix_proto.SerializeToString())
@@ -35,7 +89,7 @@ def read_similarity_matrix(similarity_matrix_file):
     similarity_matrix_proto = loc_protos.SimilarityMatrix()
     similarity_matrix_proto.ParseFromString(f.read())
     f.close()
-    similarity_matrix = np.array(similarity_matrix_proto.values)
+    similarity_matrix = get_values(similarity_matrix_proto)
     similarity_matrix = np.reshape(
         similarity_matrix, (similarity_matrix_proto.rows, similarity_matrix_proto.cols)
     )
@@ -0,0 +1,42 @@
+import numpy as np
+
+import protos_io
+import protos.localization_protos_pb2 as loc_protos
+
+
+def test_similarity_matrix_round_trip(tmp_path):
+    similarity_matrix = np.array([[0.5, 0.25, 1.0], [0.125, 0.75, 2.0]])
+    for value_format in protos_io.VALUE_FORMATS:
+        filename = tmp_path / "matrix_{}.SimilarityMatrix.pb".format(value_format)
+        protos_io.write_similarity_matrix(similarity_matrix, filename, value_format)
+        np.testing.assert_equal(
+            protos_io.read_similarity_matrix(filename), similarity_matrix
+        )
+
+
+def test_read_old_feature(tmp_path):
+    feature_proto = loc_protos.Feature()
+    feature_proto.values.extend([1.5, 2.5, 3.5])
+    filename = tmp_path / "feature.Feature.pb"
+    protos_io.write_feature(filename, feature_proto)
+
+    np.testing.assert_equal(protos_io.read_feature(filename), [1.5, 2.5, 3.5])
+
+
+def test_get_big_endian_values():
+    feature_proto = loc_protos.Feature()
+    feature_proto.value_type = loc_protos.VALUE_TYPE_FLOAT32
+    feature_proto.byte_order = loc_protos.BYTE_ORDER_BIG_ENDIAN
+    feature_proto.data = np.array([1.5, -2.0], dtype=">f4").tobytes()
+
+    np.testing.assert_equal(protos_io.get_values(feature_proto), [1.5, -2.0])
+
+
+def test_raw_values_are_smaller():
+    values = np.random.rand(4096)
+    old_proto = loc_protos.Feature()
+    protos_io.set_values(old_proto, values, "double")
+    new_proto = loc_protos.Feature()
+    protos_io.set_values(new_proto, values, "float32")
+
+    assert new_proto.ByteSize() < 0.6 * old_proto.ByteSize()
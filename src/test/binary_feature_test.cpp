@@ -0,0 +1,117 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/binary_feature.h"
+#include "features/cnn_feature.h"
+#include "features/feature_factory.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+TEST(binaryFeature, midBinarizationMatchesCnnFeature) {
+  const std::filesystem::path tmp_dir = test::createFeatures();
+  for (const auto &name :
+       localization::database::listProtoDir(tmp_dir, ".Feature")) {
+    const loc_features::CnnFeature cnnFeature(name);
+    const loc_features::BinaryFeature binaryFeature(
+        name, loc_features::Binarization::Mid);
+    ASSERT_EQ(binaryFeature.numBits(), cnnFeature.bits.size());
+    for (int d = 0; d < binaryFeature.numBits(); ++d) {
+      EXPECT_EQ(binaryFeature.bit(d), cnnFeature.bits[d] == 1) << d;
+    }
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
+
+TEST(binaryFeature, meanAndMedianBinarization) {
+  const std::vector<double> values = {0.0, 1.0, 2.0, 10.0, 3.0};
+  // Mean 3.2, only 10 is above.
+  const loc_features::BinaryFeature mean(values,
+                                         loc_features::Binarization::Mean);
+  EXPECT_EQ(mean.words(), (std::vector<uint64_t>{0b01000}));
+  // Median 2, 10 and 3 are above.
+  const loc_features::BinaryFeature median(values,
+                                           loc_features::Binarization::Median);
+  EXPECT_EQ(median.words(), (std::vector<uint64_t>{0b11000}));
+}
+
+TEST(binaryFeature, packsIntoWords) {
+  std::vector<double> values(130, 0.0);
+  values[0] = values[64] = values[129] = 1.0;
+  const loc_features::BinaryFeature feature(values,
+                                            loc_features::Binarization::Mean);
+  EXPECT_EQ(feature.numBits(), 130);
+  EXPECT_EQ(feature.words(), (std::vector<uint64_t>{1, 1, 2}));
+  EXPECT_TRUE(feature.bit(129));
+  EXPECT_FALSE(feature.bit(128));
+}
+
+TEST(binaryFeature, hammingSimilarity) {
+  std::vector<double> lhsValues(100, 0.0), rhsValues(100, 0.0);
+  for (int d = 0; d < 50; ++d) {
+    lhsValues[d] = 1.0;
+  }
+  for (int d = 25; d < 75; ++d) {
+    rhsValues[d] = 1.0;
+  }
+  const loc_features::BinaryFeature lhs(lhsValues,
+                                        loc_features::Binarization::Mean);
+  const loc_features::BinaryFeature rhs(rhsValues,
+                                        loc_features::Binarization::Mean);
+  EXPECT_EQ(lhs.hammingDistance(rhs), 50);
+  EXPECT_DOUBLE_EQ(lhs.computeSimilarityScore(rhs), 0.5);
+  EXPECT_DOUBLE_EQ(lhs.computeSimilarityScore(lhs), 1.0);
+  EXPECT_DOUBLE_EQ(lhs.score2cost(0.5), 2.0);
+}
+
+TEST(binaryFeature, createdByFactory) {
+  const std::filesystem::path tmp_dir = test::createFeatures();
+  const auto names = localization::database::listProtoDir(tmp_dir, ".Feature");
+  const auto feature = loc_features::createFeature(
+      loc_features::FeatureType::Binary_Feature_Median, names[0]);
+  EXPECT_EQ(feature->type, "BinaryFeature");
+  EXPECT_DOUBLE_EQ(feature->computeSimilarityScore(*feature), 1.0);
+
+  // Large enough that the values outweigh the fixed size of a feature.
+  std::vector<double> values(1024);
+  for (size_t d = 0; d < values.size(); ++d) {
+    values[d] = d % 7;
+  }
+  createFeatureFile(tmp_dir, "large.Feature.pb", createFeatureProto(values));
+  const std::string large = (tmp_dir / "large.Feature.pb").string();
+  EXPECT_LT(loc_features::createFeature(
+                loc_features::FeatureType::Binary_Feature_Median, large)
+                ->memoryBytes(),
+            loc_features::CnnFeature(large).memoryBytes() / 8);
+  test::clearDataUnderPath(tmp_dir);
+}
+} // namespace test
@@ -0,0 +1,313 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/bow_feature.h"
+#include "features/bow_inverted_index.h"
+#include "features/bow_vocabulary.h"
+#include "relocalizers/bow_relocalizer.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+namespace fs = std::filesystem;
+
+namespace {
+
+double cosine(const std::vector<double> &lhs, const std::vector<double> &rhs) {
+  double dot = 0.0, lhsNorm = 0.0, rhsNorm = 0.0;
+  for (size_t idx = 0; idx < lhs.size(); ++idx) {
+    dot += lhs[idx] * rhs[idx];
+    lhsNorm += lhs[idx] * lhs[idx];
+    rhsNorm += rhs[idx] * rhs[idx];
+  }
+  if (lhsNorm == 0.0 || rhsNorm == 0.0) {
+    return 0.0;
+  }
+  return dot / std::sqrt(lhsNorm * rhsNorm);
+}
+
+std::vector<double> randomHistogram(int numWords, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> weight(0.1, 1.0);
+  std::bernoulli_distribution present(0.2);
+  std::vector<double> histogram(numWords, 0.0);
+  for (double &value : histogram) {
+    if (present(generator)) {
+      value = weight(generator);
+    }
+  }
+  return histogram;
+}
+
+// Descriptors scattered around `numCenters` random centers, with `noiseBits`
+// flipped bits each.
+std::vector<std::vector<loc_features::BinaryDescriptor>>
+clusteredDescriptors(const std::vector<loc_features::BinaryDescriptor> &centers,
+                     int numImages, int perImage, int noiseBits,
+                     std::mt19937 &generator) {
+  std::uniform_int_distribution<int> center(0, centers.size() - 1);
+  std::uniform_int_distribution<int> bit(0, 255);
+  std::vector<std::vector<loc_features::BinaryDescriptor>> images(numImages);
+  for (auto &image : images) {
+    for (int idx = 0; idx < perImage; ++idx) {
+      loc_features::BinaryDescriptor descriptor = centers[center(generator)];
+      for (int flip = 0; flip < noiseBits; ++flip) {
+        const int b = bit(generator);
+        descriptor[b / 64] ^= uint64_t{1} << (b % 64);
+      }
+      image.push_back(descriptor);
+    }
+  }
+  return images;
+}
+
+std::vector<loc_features::BinaryDescriptor> randomCenters(int numCenters,
+                                                          std::mt19937 &gen) {
+  std::vector<loc_features::BinaryDescriptor> centers(numCenters);
+  for (auto &center : centers) {
+    for (auto &word : center) {
+      word = (uint64_t{gen()} << 32) | gen();
+    }
+  }
+  return centers;
+}
+
+} // namespace
+
+TEST(bowFeature, sparseScoreEqualsDenseCosine) {
+  std::mt19937 generator(5);
+  for (int trial = 0; trial < 20; ++trial) {
+    const auto lhs = randomHistogram(50, generator);
+    const auto rhs = randomHistogram(50, generator);
+    const loc_features::BowFeature lhsFeature(lhs);
+    const loc_features::BowFeature rhsFeature(rhs);
+    EXPECT_NEAR(lhsFeature.computeSimilarityScore(rhsFeature),
+                cosine(lhs, rhs), 1e-6);
+  }
+}
+
+TEST(bowFeature, wordsAreSortedAndMerged) {
+  const loc_features::BowFeature feature(10, {7, 2, 7, 4}, {1.f, 2.f, 1.f, 0.f});
+  EXPECT_EQ(feature.numWords(), 10);
+  ASSERT_EQ(feature.size(), 2);
+  EXPECT_EQ(feature.words()[0], 2u);
+  EXPECT_EQ(feature.words()[1], 7u);
+  EXPECT_NEAR(feature.weights()[0], 1.0 / std::sqrt(2.0), 1e-6);
+  EXPECT_NEAR(feature.weights()[1], 1.0 / std::sqrt(2.0), 1e-6);
+  EXPECT_NEAR(feature.computeSimilarityScore(feature), 1.0, 1e-6);
+
+  const loc_features::BowFeature empty(std::vector<double>(10, 0.0));
+  EXPECT_EQ(empty.size(), 0);
+  EXPECT_DOUBLE_EQ(empty.computeSimilarityScore(feature), 0.0);
+}
+
+TEST(bowFeature, readsDenseHistogramFiles) {
+  const fs::path dir = fs::temp_directory_path() / "bow_feature_files";
+  fs::create_directories(dir);
+  createFeatureFile(dir, "feature.Feature.pb",
+                    createFeatureProto({0, 3, 0, 4}));
+  const loc_features::BowFeature feature(dir / "feature.Feature.pb");
+  EXPECT_EQ(feature.numWords(), 4);
+  const std::vector<double> expected = {0, 0.6, 0, 0.8};
+  const std::vector<double> dense = feature.toDense();
+  ASSERT_EQ(dense.size(), expected.size());
+  for (size_t idx = 0; idx < dense.size(); ++idx) {
+    EXPECT_NEAR(dense[idx], expected[idx], 1e-6);
+  }
+  clearDataUnderPath(dir);
+}
+
+TEST(bowInvertedIndex, scoresEqualBruteForce) {
+  std::mt19937 generator(7);
+  const int numWords = 64;
+  std::vector<std::unique_ptr<loc_features::BowFeature>> references;
+  loc_features::BowInvertedIndex index(numWords);
+  for (int idx = 0; idx < 200; ++idx) {
+    references.push_back(std::make_unique<loc_features::BowFeature>(
+        randomHistogram(numWords, generator)));
+    EXPECT_EQ(index.add(*references.back()), idx);
+  }
+  EXPECT_EQ(index.size(), 200);
+
+  for (int trial = 0; trial < 10; ++trial) {
+    const loc_features::BowFeature query(randomHistogram(numWords, generator));
+    std::vector<double> expected(references.size(), 0.0);
+    for (size_t ref = 0; ref < references.size(); ++ref) {
+      expected[ref] = sparseDotProduct(query, *references[ref]);
+    }
+    std::vector<double> actual(references.size(), 0.0);
+    int previousId = -1;
+    for (const auto &[featureId, score] : index.score(query)) {
+      EXPECT_GT(featureId, previousId);
+      previousId = featureId;
+      actual[featureId] = score;
+    }
+    for (size_t ref = 0; ref < references.size(); ++ref) {
+      EXPECT_NEAR(actual[ref], expected[ref], 1e-6);
+    }
+
+    const auto top = index.topK(query, 5);
+    ASSERT_EQ(top.size(), 5);
+    std::vector<double> sorted = expected;
+    std::sort(sorted.rbegin(), sorted.rend());
+    for (int k = 0; k < 5; ++k) {
+      EXPECT_NEAR(top[k].second, sorted[k], 1e-6);
+    }
+  }
+}
+
+TEST(bowVocabulary, trainingFindsTheClusters) {
+  std::mt19937 generator(11);
+  const auto centers = randomCenters(8, generator);
+  const auto images = clusteredDescriptors(centers, 20, 50, 10, generator);
+  loc_features::BowVocabularyOptions options;
+  options.numWords = 8;
+  options.iterations = 20;
+  options.seed = 3;
+  const auto vocabulary = loc_features::BowVocabulary::train(images, options);
+  ASSERT_EQ(vocabulary->numWords(), 8);
+
+  // Noisy copies of the same center end up in the same word, different
+  // centers in different words.
+  std::vector<int> words;
+  for (const auto &center : centers) {
+    words.push_back(vocabulary->quantize(center));
+  }
+  std::vector<int> unique = words;
+  std::sort(unique.begin(), unique.end());
+  unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+  EXPECT_GE(unique.size(), 7u);
+  for (const auto &image : images) {
+    for (const auto &descriptor : image) {
+      const int word = vocabulary->quantize(descriptor);
+      EXPECT_LE(loc_features::hammingDistance(descriptor.data(),
+                                              vocabulary->word(word).data(), 4),
+                40);
+    }
+  }
+
+  const fs::path file =
+      fs::temp_directory_path() / "bow_test.BowVocabulary.bin";
+  vocabulary->save(file);
+  const auto loaded = loc_features::BowVocabulary::load(file);
+  ASSERT_EQ(loaded->numWords(), vocabulary->numWords());
+  for (int word = 0; word < vocabulary->numWords(); ++word) {
+    EXPECT_EQ(loaded->word(word), vocabulary->word(word));
+    EXPECT_FLOAT_EQ(loaded->idf(word), vocabulary->idf(word));
+  }
+  for (const auto &descriptor : images[0]) {
+    EXPECT_EQ(loaded->quantize(descriptor), vocabulary->quantize(descriptor));
+  }
+  fs::remove(file);
+}
+
+TEST(bowVocabulary, damagedSizeDies) {
+  std::mt19937 generator(12);
+  const auto centers = randomCenters(4, generator);
+  loc_features::BowVocabularyOptions options;
+  options.numWords = 4;
+  const auto vocabulary = loc_features::BowVocabulary::train(
+      clusteredDescriptors(centers, 4, 10, 5, generator), options);
+  const fs::path file =
+      fs::temp_directory_path() / "bow_damaged.BowVocabulary.bin";
+  // The number of words follows the magic and the version.
+  for (int32_t numWords : {0, -1, 1 << 30}) {
+    vocabulary->save(file);
+    {
+      std::fstream out(file, std::ios::in | std::ios::out | std::ios::binary);
+      out.seekp(12);
+      out.write(reinterpret_cast<const char *>(&numWords), sizeof(numWords));
+    }
+    EXPECT_DEATH(loc_features::BowVocabulary::load(file),
+                 "truncated or damaged")
+        << numWords;
+  }
+  fs::remove(file);
+}
+
+TEST(bowVocabulary, wordsInEveryImageHaveNoWeight) {
+  std::mt19937 generator(13);
+  const auto centers = randomCenters(4, generator);
+  // The first two centers are in every image, the others in half of them.
+  std::vector<std::vector<loc_features::BinaryDescriptor>> images;
+  for (int image = 0; image < 8; ++image) {
+    images.push_back({centers[0], centers[1], centers[2 + image % 2]});
+  }
+  loc_features::BowVocabularyOptions options;
+  options.numWords = 4;
+  const auto vocabulary = loc_features::BowVocabulary::train(images, options);
+  EXPECT_FLOAT_EQ(vocabulary->idf(vocabulary->quantize(centers[0])), 0.f);
+  EXPECT_FLOAT_EQ(vocabulary->idf(vocabulary->quantize(centers[2])),
+                  std::log(2.f));
+
+  // Only the rare words remain, so images with different rare words are not
+  // similar at all.
+  const auto first = vocabulary->computeFeature(images[0]);
+  const auto second = vocabulary->computeFeature(images[1]);
+  const auto third = vocabulary->computeFeature(images[2]);
+  EXPECT_EQ(first->size(), 1);
+  EXPECT_NEAR(first->computeSimilarityScore(*third), 1.0, 1e-6);
+  EXPECT_DOUBLE_EQ(first->computeSimilarityScore(*second), 0.0);
+}
+
+TEST(bowRelocalizer, findsTheMatchingReference) {
+  const fs::path dir = fs::temp_directory_path() / "bow_relocalizer";
+  const fs::path queryDir = dir / "query";
+  const fs::path refDir = dir / "ref";
+  fs::create_directories(queryDir);
+  fs::create_directories(refDir);
+  createFeatureFile(refDir, "ref_0.Feature.pb",
+                    createFeatureProto({1, 1, 0, 0, 0, 0}));
+  createFeatureFile(refDir, "ref_1.Feature.pb",
+                    createFeatureProto({0, 0, 1, 1, 0, 0}));
+  createFeatureFile(refDir, "ref_2.Feature.pb",
+                    createFeatureProto({0, 0, 0, 1, 1, 1}));
+  createFeatureFile(queryDir, "query_0.Feature.pb",
+                    createFeatureProto({0, 0, 0, 0.5, 1, 1}));
+  createFeatureFile(queryDir, "query_1.Feature.pb",
+                    createFeatureProto({1, 0, 0, 0, 0, 0}));
+
+  localization::database::OnlineDatabase database(
+      queryDir, refDir, loc_features::FeatureType::Bow_Feature,
+      /*bufferSize=*/10);
+  localization::relocalizers::BowRelocalizer relocalizer(&database,
+                                                         /*numCandidates=*/2);
+  relocalizer.train(refDir);
+  EXPECT_EQ(relocalizer.getCandidates(0), (std::vector<int>{2, 1}));
+  EXPECT_EQ(relocalizer.getCandidates(1), (std::vector<int>{0}));
+  clearDataUnderPath(dir);
+}
+
+} // namespace test
@@ -0,0 +1,241 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/cost_cache_database.h"
+#include "database/list_dir.h"
+#include "database/online_database.h"
+#include "features/feature_store.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <filesystem>
+
+namespace test {
+
+namespace fs = std::filesystem;
+namespace loc_database = localization::database;
+
+using FeatureType = localization::features::FeatureType;
+
+// The expected similarities are rounded, which is amplified by cost = 1/score.
+constexpr auto kCostEpsilon = 1e-05;
+
+class CostCacheDatabaseTest : public ::testing::Test {
+protected:
+  void SetUp() {
+    tmp_dir = test::createFeatures();
+    cache_dir = fs::temp_directory_path() / "cost_cache";
+    test::clearDataUnderPath(cache_dir);
+  }
+  void TearDown() {
+    test::clearDataUnderPath(tmp_dir);
+    test::clearDataUnderPath(cache_dir);
+  }
+  fs::path tmp_dir = "";
+  fs::path cache_dir = "";
+};
+
+TEST_F(CostCacheDatabaseTest, SameCostsAsOnlineDatabase) {
+  loc_database::OnlineDatabase onlineDatabase(tmp_dir, tmp_dir,
+                                              FeatureType::Cnn_Feature, 10);
+  loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir, /*tileSize=*/3);
+  EXPECT_EQ(database.refSize(), 4);
+  for (int q = 0; q < 4; ++q) {
+    for (int r = 0; r < 4; ++r) {
+      EXPECT_NEAR(database.getCost(q, r), onlineDatabase.getCost(q, r),
+                  kTestEpsilon);
+    }
+  }
+  EXPECT_EQ(database.cacheStats().computed, 16);
+  EXPECT_EQ(database.cacheStats().hits, 0);
+  EXPECT_EQ(database.cacheStats().tilesLoaded, 4);
+  database.getCost(1, 1);
+  EXPECT_EQ(database.cacheStats().hits, 1);
+  ASSERT_DEATH(database.getCost(0, 4), "Reference feature 4 is out of range");
+}
+
+TEST_F(CostCacheDatabaseTest, GetCostsUsesCache) {
+  loc_database::OnlineDatabase onlineDatabase(tmp_dir, tmp_dir,
+                                              FeatureType::Cnn_Feature, 10);
+  loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir, /*tileSize=*/3);
+  database.getCost(2, 1);
+  const std::vector<int> refIds = {0, 1, 2, 3};
+  const std::vector<double> costs = database.getCosts(2, refIds);
+  for (size_t idx = 0; idx < refIds.size(); ++idx) {
+    EXPECT_NEAR(costs[idx], onlineDatabase.getCost(2, refIds[idx]),
+                kTestEpsilon);
+  }
+  EXPECT_EQ(database.cacheStats().computed, 4);
+  EXPECT_EQ(database.cacheStats().hits, 1);
+  database.getCosts(2, refIds);
+  EXPECT_EQ(database.cacheStats().computed, 4);
+  EXPECT_EQ(database.cacheStats().hits, 5);
+}
+
+TEST_F(CostCacheDatabaseTest, ReusesCacheOfPreviousRun) {
+  {
+    loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                             FeatureType::Cnn_Feature, 10,
+                                             cache_dir, /*tileSize=*/2);
+    database.getCost(0, 1);
+    database.getCost(3, 2);
+    EXPECT_EQ(database.cacheStats().computed, 2);
+  }
+  loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir, /*tileSize=*/2);
+  EXPECT_NEAR(database.getCost(0, 1), 1. / kSimilarityMatrix[0][1],
+              kCostEpsilon);
+  EXPECT_NEAR(database.getCost(3, 2), 1. / kSimilarityMatrix[3][2],
+              kCostEpsilon);
+  EXPECT_EQ(database.cacheStats().computed, 0);
+  EXPECT_EQ(database.cacheStats().hits, 2);
+  database.getCost(1, 1);
+  EXPECT_EQ(database.cacheStats().computed, 1);
+}
+
+TEST_F(CostCacheDatabaseTest, ClearsCacheOfChangedFeatures) {
+  {
+    loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                             FeatureType::Cnn_Feature, 10,
+                                             cache_dir);
+    database.getCost(0, 1);
+  }
+  // Same file name, different content.
+  createFeatureFile(tmp_dir, "feature_1.Feature.pb",
+                    createFeatureProto({0, 1, 2, 3}));
+  loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir);
+  EXPECT_NEAR(database.getCost(0, 1), 1.0, kTestEpsilon);
+  EXPECT_EQ(database.cacheStats().computed, 1);
+  EXPECT_EQ(database.cacheStats().hits, 0);
+}
+
+TEST_F(CostCacheDatabaseTest, KeepsCacheOfAppendedFeatures) {
+  const fs::path ref_dir = fs::temp_directory_path() / "cost_cache_refs";
+  fs::create_directories(ref_dir);
+  createFeatureFile(ref_dir, "feature_0.Feature.pb",
+                    createFeatureProto({0, 1, 2, 3}));
+  {
+    loc_database::CostCacheDatabase database(
+        tmp_dir, ref_dir, FeatureType::Cnn_Feature, 10, cache_dir);
+    database.getCost(2, 0);
+  }
+  createFeatureFile(ref_dir, "feature_1.Feature.pb",
+                    createFeatureProto({3, 4, 5, 6}));
+  loc_database::CostCacheDatabase database(tmp_dir, ref_dir,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir);
+  EXPECT_EQ(database.refSize(), 2);
+  database.getCost(2, 0);
+  EXPECT_EQ(database.cacheStats().hits, 1);
+  EXPECT_NEAR(database.getCost(2, 1), 1. / kSimilarityMatrix[2][1],
+              kCostEpsilon);
+  EXPECT_EQ(database.cacheStats().computed, 1);
+  test::clearDataUnderPath(ref_dir);
+}
+
+TEST_F(CostCacheDatabaseTest, CachesNanCosts) {
+  // A stored feature without a norm has no defined cosine similarity.
+  test::createFeatureFile(tmp_dir, "feature_4.Feature.pb",
+                          test::createFeatureProto({0, 0, 0, 0}));
+  const std::string storeFile =
+      (cache_dir.parent_path() / "cost_cache_nan.FeatureStore.bin").string();
+  localization::features::writeFeatureStore(
+      loc_database::listProtoDir(tmp_dir, ".Feature"), storeFile);
+  {
+    loc_database::CostCacheDatabase database(storeFile, storeFile,
+                                             FeatureType::Cnn_Feature, 10,
+                                             cache_dir, /*tileSize=*/3);
+    EXPECT_TRUE(std::isnan(database.getCost(4, 1)));
+    EXPECT_TRUE(std::isnan(database.getCost(4, 1)));
+    EXPECT_EQ(database.cacheStats().computed, 1);
+    EXPECT_EQ(database.cacheStats().hits, 1);
+  }
+  loc_database::CostCacheDatabase database(storeFile, storeFile,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir, /*tileSize=*/3);
+  EXPECT_TRUE(std::isnan(database.getCost(4, 1)));
+  EXPECT_EQ(database.cacheStats().computed, 0);
+  EXPECT_EQ(database.cacheStats().hits, 1);
+  fs::remove(storeFile);
+}
+
+TEST_F(CostCacheDatabaseTest, CachesFeaturesFromStore) {
+  const std::string storeFile =
+      (cache_dir.parent_path() / "cost_cache_test.FeatureStore.bin").string();
+  localization::features::writeFeatureStore(
+      loc_database::listProtoDir(tmp_dir, ".Feature"), storeFile);
+  {
+    loc_database::CostCacheDatabase database(storeFile, storeFile,
+                                             FeatureType::Cnn_Feature, 10,
+                                             cache_dir, /*tileSize=*/2);
+    EXPECT_NEAR(database.getCost(2, 3), 1. / kSimilarityMatrix[2][3],
+                kCostEpsilon);
+  }
+  loc_database::CostCacheDatabase database(storeFile, storeFile,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir, /*tileSize=*/2);
+  EXPECT_NEAR(database.getCost(2, 3), 1. / kSimilarityMatrix[2][3],
+              kCostEpsilon);
+  EXPECT_EQ(database.cacheStats().hits, 1);
+  fs::remove(storeFile);
+}
+
+TEST_F(CostCacheDatabaseTest, AppendReferenceFeatures) {
+  const fs::path new_dir = fs::temp_directory_path() / "new_features";
+  fs::create_directories(new_dir);
+  fs::rename(tmp_dir / "feature_3.Feature.pb",
+             new_dir / "feature_3.Feature.pb");
+  {
+    loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                             FeatureType::Cnn_Feature, 10,
+                                             cache_dir, /*tileSize=*/2);
+    database.getCost(0, 1);
+    database.appendReferenceFeatures(
+        {(new_dir / "feature_3.Feature.pb").string()});
+    EXPECT_NEAR(database.getCost(2, 3), 1. / kSimilarityMatrix[2][3],
+                kCostEpsilon);
+    EXPECT_EQ(database.cacheStats().computed, 2);
+  }
+  // The query grows as well, the cache written for the appended reference is
+  // still valid.
+  fs::rename(new_dir / "feature_3.Feature.pb",
+             tmp_dir / "feature_3.Feature.pb");
+  loc_database::CostCacheDatabase database(tmp_dir, tmp_dir,
+                                           FeatureType::Cnn_Feature, 10,
+                                           cache_dir, /*tileSize=*/2);
+  database.getCost(0, 1);
+  database.getCost(2, 3);
+  EXPECT_EQ(database.cacheStats().hits, 2);
+  EXPECT_EQ(database.cacheStats().computed, 0);
+  test::clearDataUnderPath(new_dir);
+}
+} // namespace test
@@ -0,0 +1,46 @@
+"""Writes the tiny ONNX model the DNN extractor tests run on.
+
+The model averages every channel of the image, so the descriptor of an image
+is its mean color. The batch dimension and the image size are dynamic.
+
+    python make_tiny_descriptor_model.py tiny_descriptor.onnx
+"""
+
+import argparse
+
+import onnx
+from onnx import TensorProto, helper
+
+
+def make_model():
+    image = helper.make_tensor_value_info(
+        "image", TensorProto.FLOAT, ["batch", 3, "height", "width"]
+    )
+    descriptor = helper.make_tensor_value_info(
+        "descriptor", TensorProto.FLOAT, ["batch", 3]
+    )
+    nodes = [
+        helper.make_node("GlobalAveragePool", ["image"], ["pooled"]),
+        helper.make_node("Flatten", ["pooled"], ["descriptor"], axis=1),
+    ]
+    graph = helper.make_graph(nodes, "tiny_descriptor", [image], [descriptor])
+    model = helper.make_model(
+        graph,
+        producer_name="image_sequence_localizer",
+        opset_imports=[helper.make_opsetid("", 11)],
+    )
+    # Readers that only know older IR versions still load the model.
+    model.ir_version = 6
+    onnx.checker.check_model(model)
+    return model
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("output", help="Output .onnx file")
+    args = parser.parse_args()
+    onnx.save(make_model(), args.output)
+
+
+if __name__ == "__main__":
+    main()
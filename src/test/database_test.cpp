@@ -24,16 +24,24 @@
 /* Updated by O. Vysotska in 2022 */
 
 #include "database/similarity_matrix_database.h"
+#include "database/concurrent_online_database.h"
+#include "database/feature_prefetcher.h"
 #include "database/online_database.h"
+#include "database/sharded_database.h"
 #include "localization_protos.pb.h"
 #include "test_utils.h"
 
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace test {
 
@@ -134,4 +142,240 @@ TEST_F(OnlineDatabaseTest, CostMatrixDatabaseGetCost) {
   ASSERT_DEATH(database.getCost(3, 0), "Row outside range 3");
   ASSERT_DEATH(database.getCost(0, 4), "Col outside range 4");
 }
+
+TEST_F(OnlineDatabaseTest, PrefetchingKeepsCosts) {
+  loc_database::OnlineDatabase database(/*queryFeaturesDir=*/tmp_dir,
+                                        /*refFeaturesDir=*/tmp_dir,
+                                        /*type=*/FeatureType::Cnn_Feature,
+                                        /*bufferSize=*/2);
+  database.enablePrefetching(/*lookahead=*/2);
+  for (int q = 0; q < 4; ++q) {
+    for (int r = std::max(q - 1, 0); r <= std::min(q + 1, 3); ++r) {
+      EXPECT_NEAR(database.getCost(q, r), 1. / kSimilarityMatrix[q][r],
+                  1e-05);
+    }
+  }
+}
+
+TEST_F(OnlineDatabaseTest, GetCostsScoresBatches) {
+  // The buffer is smaller than a batch, the batch keeps its features pinned.
+  loc_database::OnlineDatabase database(/*queryFeaturesDir=*/tmp_dir,
+                                        /*refFeaturesDir=*/tmp_dir,
+                                        /*type=*/FeatureType::Cnn_Feature,
+                                        /*bufferSize=*/2);
+  for (int q = 0; q < 4; ++q) {
+    const std::vector<double> costs = database.getCosts(q, {3, 0, 2, 1, 0});
+    ASSERT_EQ(costs.size(), 5);
+    const std::vector<int> refIds = {3, 0, 2, 1, 0};
+    for (size_t idx = 0; idx < refIds.size(); ++idx) {
+      EXPECT_NEAR(costs[idx], 1. / kSimilarityMatrix[q][refIds[idx]], 1e-05);
+      EXPECT_DOUBLE_EQ(database.getCost(q, refIds[idx]), costs[idx]);
+    }
+  }
+  ASSERT_DEATH(database.getCosts(0, {1, 4}),
+               "Reference feature 4 is out of range");
+}
+
+class DummyFeature : public localization::features::iFeature {
+public:
+  explicit DummyFeature(int id) { dimensions = {static_cast<double>(id)}; }
+  double computeSimilarityScore(const iFeature &rhs) const override {
+    return 0.0;
+  }
+  double score2cost(double score) const override { return 0.0; }
+};
+
+TEST(FeaturePrefetcher, loadsRequestedFeatures) {
+  std::atomic<int> loads{0};
+  loc_database::FeaturePrefetcher prefetcher(
+      [&loads](int id) {
+        ++loads;
+        return std::make_unique<DummyFeature>(id);
+      },
+      /*maxLoaded=*/4);
+  EXPECT_EQ(prefetcher.take(0), nullptr);
+  prefetcher.request(2, 5, [](int id) { return id == 3; });
+  prefetcher.waitUntilIdle();
+  EXPECT_EQ(loads.load(), 2);
+  EXPECT_EQ(prefetcher.stats().loaded, 2);
+  for (int id : {2, 4}) {
+    auto feature = prefetcher.take(id);
+    ASSERT_NE(feature, nullptr);
+    EXPECT_DOUBLE_EQ(feature->dimensions[0], id);
+  }
+  // Skipped and already taken features are left to the caller.
+  EXPECT_EQ(prefetcher.take(3), nullptr);
+  EXPECT_EQ(prefetcher.take(2), nullptr);
+  EXPECT_EQ(loads.load(), 2);
+  EXPECT_EQ(prefetcher.stats().used, 2);
+}
+
+TEST(FeaturePrefetcher, dropsFeaturesOutsideOfNewRequest) {
+  std::atomic<int> loads{0};
+  loc_database::FeaturePrefetcher prefetcher(
+      [&loads](int id) {
+        ++loads;
+        return std::make_unique<DummyFeature>(id);
+      },
+      /*maxLoaded=*/2);
+  prefetcher.request(0, 4, /*skip=*/nullptr);
+  // Only maxLoaded features are loaded ahead.
+  prefetcher.waitUntilIdle();
+  EXPECT_EQ(loads.load(), 2);
+  prefetcher.request(1, 4, /*skip=*/nullptr);
+  prefetcher.waitUntilIdle();
+  EXPECT_EQ(prefetcher.stats().dropped, 1);
+  EXPECT_EQ(prefetcher.take(0), nullptr);
+  for (int id : {1, 2}) {
+    auto feature = prefetcher.take(id);
+    ASSERT_NE(feature, nullptr);
+    EXPECT_DOUBLE_EQ(feature->dimensions[0], id);
+  }
+  prefetcher.waitUntilIdle();
+  EXPECT_NE(prefetcher.take(3), nullptr);
+  // Feature 0 was loaded before it was dropped, the others once each.
+  EXPECT_EQ(loads.load(), 4);
+}
+
+TEST_F(OnlineDatabaseTest, AppendReferenceFeatures) {
+  const fs::path new_dir = fs::temp_directory_path() / "new_features";
+  fs::create_directories(new_dir);
+  fs::rename(tmp_dir / "feature_3.Feature.pb",
+             new_dir / "feature_3.Feature.pb");
+  loc_database::OnlineDatabase database(/*queryFeaturesDir=*/tmp_dir,
+                                        /*refFeaturesDir=*/tmp_dir,
+                                        /*type=*/FeatureType::Cnn_Feature,
+                                        /*bufferSize=*/10);
+  ASSERT_EQ(database.refSize(), 3);
+  const double cost = database.getCost(1, 2);
+  ASSERT_DEATH(database.getCost(0, 3), "Reference feature 3 is out of range");
+
+  database.appendReferenceFeatures(
+      {(new_dir / "feature_3.Feature.pb").string()});
+  EXPECT_EQ(database.refSize(), 4);
+  EXPECT_DOUBLE_EQ(database.getCost(1, 2), cost);
+  for (int q = 0; q < 3; ++q) {
+    EXPECT_NEAR(database.getCost(q, 3), 1. / kSimilarityMatrix[q][3], 1e-05);
+  }
+  test::clearDataUnderPath(new_dir);
+}
+
+// The sharded database forks its workers, so it runs in a child process of
+// its own instead of forking the test binary. Failures are reported through
+// the exit code of the child.
+TEST_F(OnlineDatabaseTest, ShardedDatabase) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  loc_database::ShardedDatabaseOptions options;
+  options.numShards = 3;
+  options.bufferSize = 2;
+  options.batchRadius = 1;
+  EXPECT_EXIT(
+      {
+        loc_database::ShardedDatabase database(
+            tmp_dir, tmp_dir, FeatureType::Cnn_Feature, options);
+        int failures = 0;
+        failures += database.refSize() != 4;
+        failures += database.querySize() != 4;
+        failures += database.numShards() != 2;
+        for (int q = 0; q < 4; ++q) {
+          for (int r = 0; r < 4; ++r) {
+            failures += std::abs(database.getCost(q, r) -
+                                 1. / kSimilarityMatrix[q][r]) > 1e-05;
+          }
+        }
+        // Ids from both shards in one request.
+        const std::vector<double> costs = database.getCosts(2, {3, 0, 2});
+        failures += costs.size() != 3 ||
+                    std::abs(costs[0] - 1. / kSimilarityMatrix[2][3]) > 1e-05 ||
+                    std::abs(costs[1] - 1. / kSimilarityMatrix[2][0]) > 1e-05 ||
+                    std::abs(costs[2] - 1. / kSimilarityMatrix[2][2]) > 1e-05;
+        std::exit(failures == 0 ? 0 : 1);
+      },
+      ::testing::ExitedWithCode(0), "");
+  EXPECT_DEATH(
+      {
+        loc_database::ShardedDatabase database(
+            tmp_dir, tmp_dir, FeatureType::Cnn_Feature, options);
+        database.getCost(0, 4);
+      },
+      "Reference feature 4 is out of range");
+}
+
+TEST_F(OnlineDatabaseTest, ShardedDatabaseProjectsFeatures) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  const auto projection =
+      localization::features::Projection::randomOrthogonal(4, 2, /*seed=*/3);
+  loc_database::ShardedDatabaseOptions options;
+  options.numShards = 2;
+  options.bufferSize = 2;
+  options.projection = projection;
+  EXPECT_EXIT(
+      {
+        loc_database::OnlineDatabase expected(
+            tmp_dir, tmp_dir, FeatureType::Cnn_Feature, /*bufferSize=*/4);
+        expected.setFeatureProjection(projection);
+        loc_database::ShardedDatabase database(
+            tmp_dir, tmp_dir, FeatureType::Cnn_Feature, options);
+        int failures = 0;
+        for (int q = 0; q < 4; ++q) {
+          for (int r = 0; r < 4; ++r) {
+            failures +=
+                std::abs(database.getCost(q, r) - expected.getCost(q, r)) >
+                1e-05;
+          }
+        }
+        std::exit(failures == 0 ? 0 : 1);
+      },
+      ::testing::ExitedWithCode(0), "");
+}
+
+TEST_F(OnlineDatabaseTest, ConcurrentOnlineDatabase) {
+  loc_database::ConcurrentOnlineDatabase database(
+      /*queryFeaturesDir=*/tmp_dir, /*refFeaturesDir=*/tmp_dir,
+      FeatureType::Cnn_Feature, /*bufferSize=*/2, /*numShards=*/2);
+  EXPECT_TRUE(database.isThreadSafe());
+  EXPECT_EQ(database.refSize(), 4);
+  // Every thread walks the whole matrix several times in a different order,
+  // so the threads race on the same costs and features.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&database, t]() {
+      for (int round = 0; round < 50; ++round) {
+        for (int i = 0; i < 16; ++i) {
+          const int cell = (i * 5 + t + round) % 16;
+          const int q = cell / 4;
+          const int r = cell % 4;
+          ASSERT_NEAR(database.getCost(q, r), 1. / kSimilarityMatrix[q][r],
+                      1e-05);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(database.computedCosts(), 16);
+  EXPECT_LE(database.refBufferStats().evictions +
+                database.queryBufferStats().evictions,
+            database.refBufferStats().misses +
+                database.queryBufferStats().misses);
+  ASSERT_DEATH(database.getCost(0, 4), "Reference feature 4 is out of range");
+}
+
+TEST_F(OnlineDatabaseTest, SimilarityMatrixDatabaseIsThreadSafe) {
+  const std::string cost_matrix_name = createSimilarityMatrixProto(tmp_dir);
+  const loc_database::SimilarityMatrixDatabase database(cost_matrix_name);
+  EXPECT_TRUE(database.isThreadSafe());
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&database]() {
+      for (int i = 0; i < 1000; ++i) {
+        ASSERT_DOUBLE_EQ(database.cost(1, i % 3), 1. / (4 + i % 3));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
 } // namespace test
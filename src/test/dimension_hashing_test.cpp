@@ -0,0 +1,204 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/dimension_index.h"
+#include "features/feature_factory.h"
+#include "features/similarity_kernels.h"
+#include "relocalizers/dimension_hashing.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+namespace fs = std::filesystem;
+
+namespace {
+// Random active dimensions, dimension d is active with probability
+// densities[d].
+std::vector<int> randomDimensions(const std::vector<double> &densities,
+                                  std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<int> dimensions;
+  for (size_t d = 0; d < densities.size(); ++d) {
+    if (distribution(generator) < densities[d]) {
+      dimensions.push_back(d);
+    }
+  }
+  return dimensions;
+}
+
+int sharedDimensions(const std::vector<int> &lhs, const std::vector<int> &rhs) {
+  int shared = 0;
+  for (int d : lhs) {
+    shared += std::find(rhs.begin(), rhs.end(), d) != rhs.end();
+  }
+  return shared;
+}
+} // namespace
+
+TEST(dimensionHashing, voteKernelsAreExact) {
+  std::mt19937_64 generator(2);
+  for (int words : {0, 1, 2, 3, 17}) {
+    std::vector<uint64_t> bitmap(words);
+    for (uint64_t &word : bitmap) {
+      word = generator();
+    }
+    if (words > 1) {
+      bitmap[1] = 0;
+    }
+    std::vector<uint16_t> initial(64 * words);
+    for (uint16_t &vote : initial) {
+      vote = generator() % 1000;
+    }
+    std::vector<uint16_t> expected = initial;
+    for (int i = 0; i < 64 * words; ++i) {
+      expected[i] += (bitmap[i / 64] >> (i % 64)) & 1;
+    }
+    for (const auto level : loc_features::supportedSimdLevels()) {
+      std::vector<uint16_t> votes = initial;
+      loc_features::addBitmapVotes(bitmap.data(), words, votes.data(), level);
+      EXPECT_EQ(votes, expected)
+          << loc_features::simdLevelName(level) << ", " << words << " words";
+    }
+  }
+}
+
+TEST(dimensionHashing, votesCountSharedDimensions) {
+  std::mt19937 generator(7);
+  // Rare dimensions stay delta-encoded, frequent ones become bitmaps.
+  std::vector<double> densities(64);
+  for (size_t d = 0; d < densities.size(); ++d) {
+    densities[d] = d < 32 ? 0.01 : 0.5;
+  }
+  loc_features::DimensionIndex index(densities.size());
+  std::vector<std::vector<int>> features;
+  for (int f = 0; f < 1000; ++f) {
+    features.push_back(randomDimensions(densities, generator));
+    EXPECT_EQ(index.add(features.back()), f);
+  }
+  EXPECT_EQ(index.size(), 1000);
+  EXPECT_EQ(index.numBitmapLists(), 32);
+  // The dense lists take a bit per feature, not an int.
+  EXPECT_LT(index.memoryBytes(), 32 * 1000 / 8 + 32 * 40 + 64 * 80);
+
+  std::vector<uint16_t> votes;
+  for (int q = 0; q < 10; ++q) {
+    const std::vector<int> query = randomDimensions(densities, generator);
+    index.vote(query, &votes);
+    ASSERT_EQ(votes.size(), 1024);
+    for (int f = 0; f < index.size(); ++f) {
+      ASSERT_EQ(votes[f], sharedDimensions(query, features[f]));
+    }
+    EXPECT_EQ(votes[1000], 0);
+  }
+}
+
+TEST(dimensionHashing, largeIdGaps) {
+  // Differences of more than 127 ids take several bytes.
+  loc_features::DimensionIndex index(2);
+  for (int f = 0; f < 100000; ++f) {
+    index.add(f % 20000 == 3 ? std::vector<int>{0, 1} : std::vector<int>{1});
+  }
+  EXPECT_EQ(index.numBitmapLists(), 1);
+  std::vector<uint16_t> votes;
+  index.vote({0}, &votes);
+  for (int f = 0; f < index.size(); ++f) {
+    ASSERT_EQ(votes[f], f % 20000 == 3 ? 1 : 0) << f;
+  }
+}
+
+TEST(dimensionHashing, topK) {
+  loc_features::DimensionIndex index(4);
+  index.add({0, 1});
+  index.add({2});
+  index.add({0, 1, 2});
+  index.add({3});
+  index.add({1, 0});
+  using Result = std::vector<std::pair<int, int>>;
+  EXPECT_EQ(index.topK({0, 1, 2}, 2), (Result{{2, 3}, {0, 2}}));
+  EXPECT_EQ(index.topK({0, 1, 2}, 3), (Result{{2, 3}, {0, 2}, {4, 2}}));
+  // Features without votes are not candidates.
+  EXPECT_EQ(index.topK({2}, 5), (Result{{1, 1}, {2, 1}}));
+  EXPECT_TRUE(index.topK({}, 5).empty());
+}
+
+TEST(dimensionHashing, binaryFeaturesHaveTheBitsOfCnnFeatures) {
+  std::mt19937 generator(11);
+  std::normal_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> values(300);
+  for (double &value : values) {
+    value = distribution(generator);
+  }
+  const auto cnn = loc_features::createFeature(loc_features::Cnn_Feature,
+                                               values);
+  const auto binary = loc_features::createFeature(
+      loc_features::Binary_Feature_Mid, values);
+  const std::vector<int> dimensions =
+      localization::relocalizers::activeDimensions(*cnn);
+  EXPECT_GT(dimensions.size(), 0);
+  EXPECT_EQ(localization::relocalizers::activeDimensions(*binary), dimensions);
+}
+
+TEST(dimensionHashing, findsTheMatchingReference) {
+  const fs::path dir = fs::temp_directory_path() / "dimension_hashing";
+  const fs::path queryDir = dir / "query";
+  const fs::path refDir = dir / "ref";
+  fs::create_directories(queryDir);
+  fs::create_directories(refDir);
+  createFeatureFile(refDir, "ref_0.Feature.pb",
+                    createFeatureProto({1, 1, 0, 0, 0, 0}));
+  createFeatureFile(refDir, "ref_1.Feature.pb",
+                    createFeatureProto({0, 0, 1, 1, 0, 0}));
+  createFeatureFile(refDir, "ref_2.Feature.pb",
+                    createFeatureProto({0, 0, 0, 1, 1, 1}));
+  createFeatureFile(queryDir, "query_0.Feature.pb",
+                    createFeatureProto({0, 0, 0, 0.6, 1, 1}));
+  createFeatureFile(queryDir, "query_1.Feature.pb",
+                    createFeatureProto({1, 0, 0, 0, 0, 0}));
+
+  localization::database::OnlineDatabase database(
+      queryDir, refDir, loc_features::FeatureType::Cnn_Feature,
+      /*bufferSize=*/10);
+  localization::relocalizers::DimensionHashing relocalizer(
+      &database, /*topFraction=*/1.0, /*maxCandidates=*/2);
+  relocalizer.train(refDir);
+  EXPECT_EQ(relocalizer.getCandidates(0), (std::vector<int>{2, 1}));
+  EXPECT_EQ(relocalizer.getCandidates(1), (std::vector<int>{0}));
+
+  // A third of the reference is one candidate.
+  localization::relocalizers::DimensionHashing fraction(
+      &database, /*topFraction=*/0.3, /*maxCandidates=*/5);
+  fraction.train(refDir);
+  EXPECT_EQ(fraction.getCandidates(0), (std::vector<int>{2}));
+  clearDataUnderPath(dir);
+}
+
+} // namespace test
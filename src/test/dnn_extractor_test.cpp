@@ -0,0 +1,146 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/dnn_extractor.h"
+#include "test_utils.h"
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+
+#include "gtest/gtest.h"
+
+#include <array>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace fs = std::filesystem;
+namespace loc_features = localization::features;
+
+namespace {
+// The model averages every channel, a descriptor is the mean RGB color of the
+// preprocessed image. See data/make_tiny_descriptor_model.py.
+const std::string kTinyModel = TINY_DESCRIPTOR_MODEL;
+
+// RGB colors of the test images.
+const std::vector<std::array<int, 3>> kColors = {
+    {255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {51, 102, 204}, {255, 255, 255}};
+} // namespace
+
+class DnnExtractorTest : public ::testing::Test {
+protected:
+  void SetUp() {
+    imageDir = fs::temp_directory_path() / "dnn_extractor_images";
+    fs::create_directories(imageDir);
+    for (size_t idx = 0; idx < kColors.size(); ++idx) {
+      const auto &[r, g, b] = kColors[idx];
+      // Images of different sizes, all of them are resized to the input.
+      const cv::Mat image(20 + 10 * idx, 30, CV_8UC3, cv::Scalar(b, g, r));
+      imageFiles.push_back(imageDir / ("image_" + std::to_string(idx) + ".png"));
+      ASSERT_TRUE(cv::imwrite(imageFiles.back(), image));
+    }
+  }
+  void TearDown() { clearDataUnderPath(imageDir); }
+
+  loc_features::DnnExtractorOptions options() const {
+    loc_features::DnnExtractorOptions options;
+    options.modelFile = kTinyModel;
+    options.inputWidth = 16;
+    options.inputHeight = 8;
+    options.batchSize = 2;
+    options.numThreads = 2;
+    return options;
+  }
+
+  fs::path imageDir = "";
+  std::vector<std::string> imageFiles;
+};
+
+TEST_F(DnnExtractorTest, DescriptorsAreMeanColors) {
+  loc_features::DnnExtractor extractor(options());
+  const std::vector<float> descriptors = extractor.extract(imageFiles);
+  ASSERT_EQ(extractor.dim(), 3);
+  ASSERT_EQ(descriptors.size(), kColors.size() * 3);
+  for (size_t idx = 0; idx < kColors.size(); ++idx) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_NEAR(descriptors[idx * 3 + c], kColors[idx][c] / 255.f, 1e-5)
+          << "image " << idx << ", channel " << c;
+    }
+  }
+  EXPECT_EQ(extractor.stats().images, static_cast<int>(kColors.size()));
+  EXPECT_GT(extractor.stats().imagesPerSecond(), 0.0);
+}
+
+TEST_F(DnnExtractorTest, NormalizesChannels) {
+  auto normalized = options();
+  normalized.mean = {0.5f, 0.5f, 0.5f};
+  normalized.std = {0.5f, 0.25f, 1.f};
+  loc_features::DnnExtractor extractor(normalized);
+  const std::vector<float> descriptors = extractor.extract({imageFiles[3]});
+  ASSERT_EQ(descriptors.size(), 3u);
+  for (int c = 0; c < 3; ++c) {
+    EXPECT_NEAR(descriptors[c],
+                (kColors[3][c] / 255.f - normalized.mean[c]) /
+                    normalized.std[c],
+                1e-5);
+  }
+}
+
+TEST_F(DnnExtractorTest, BatchSizeDoesNotChangeDescriptors) {
+  loc_features::DnnExtractor single(options());
+  auto batched = options();
+  batched.batchSize = 16;
+  loc_features::DnnExtractor together(batched);
+  const std::vector<float> expected = single.extract(imageFiles);
+  const std::vector<float> actual = together.extract(imageFiles);
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t idx = 0; idx < actual.size(); ++idx) {
+    EXPECT_FLOAT_EQ(actual[idx], expected[idx]);
+  }
+}
+
+TEST_F(DnnExtractorTest, FeedsTheDatabase) {
+  loc_features::DnnExtractor extractor(options());
+  const auto store = extractor.extractFeatureStore(imageFiles);
+  ASSERT_EQ(store->size(), static_cast<int>(kColors.size()));
+  EXPECT_EQ(store->name(1), "image_1.png");
+
+  localization::database::OnlineDatabase database(store, store,
+                                                  /*bufferSize=*/3);
+  EXPECT_EQ(database.refSize(), static_cast<int>(kColors.size()));
+  EXPECT_NEAR(database.getCost(0, 0), 1.0, 1e-5);
+  // Red and green do not share a channel.
+  EXPECT_GT(database.getCost(0, 1), 1e3);
+  EXPECT_LT(database.getCost(3, 3), database.getCost(3, 0));
+}
+
+TEST_F(DnnExtractorTest, DiesOnMissingImages) {
+  loc_features::DnnExtractor extractor(options());
+  ASSERT_DEATH(extractor.extract({(imageDir / "missing.png").string()}),
+               "The image cannot be read");
+}
+
+} // namespace test
@@ -22,6 +22,7 @@
 **/
 
 #include "features/cnn_feature.h"
+#include "features/concurrent_feature_buffer.h"
 #include "features/feature_buffer.h"
 #include "features/ifeature.h"
 
@@ -29,6 +30,7 @@
 
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 
 namespace test {
@@ -51,15 +53,15 @@ TEST(featureBuffer, addFeature) {
                     std::make_unique<DummyFeature>(std::vector{1.0, 2.0, 3.0}));
   buffer.addFeature(1,
                     std::make_unique<DummyFeature>(std::vector{4.0, 5.0, 6.0}));
-  EXPECT_EQ(buffer.featureMap.size(), 2);
-  EXPECT_EQ(buffer.ids[0], 0);
-  EXPECT_EQ(buffer.ids[1], 1);
+  EXPECT_EQ(buffer.size(), 2);
+  EXPECT_EQ(buffer.ids()[0], 0);
+  EXPECT_EQ(buffer.ids()[1], 1);
 
   buffer.addFeature(3,
                     std::make_unique<DummyFeature>(std::vector{7.0, 8.0, 9.0}));
-  EXPECT_EQ(buffer.featureMap.size(), 2);
-  EXPECT_EQ(buffer.ids[0], 1);
-  EXPECT_EQ(buffer.ids[1], 3);
+  EXPECT_EQ(buffer.size(), 2);
+  EXPECT_EQ(buffer.ids()[0], 1);
+  EXPECT_EQ(buffer.ids()[1], 3);
 }
 
 TEST(featureBuffer, inBuffer) {
@@ -81,4 +83,96 @@ TEST(featureBuffer, getFeature) {
   EXPECT_DOUBLE_EQ(feature.dimensions[1], 5);
   EXPECT_DOUBLE_EQ(feature.dimensions[2], 6);
 }
+TEST(featureBuffer, evictsLeastRecentlyUsed) {
+  loc_features::FeatureBuffer buffer(2);
+  buffer.addFeature(0, std::make_unique<DummyFeature>(std::vector{1.0}));
+  buffer.addFeature(1, std::make_unique<DummyFeature>(std::vector{2.0}));
+  ASSERT_NE(buffer.findFeature(0), nullptr);
+  buffer.addFeature(2, std::make_unique<DummyFeature>(std::vector{3.0}));
+  EXPECT_TRUE(buffer.inBuffer(0));
+  EXPECT_FALSE(buffer.inBuffer(1));
+  EXPECT_TRUE(buffer.inBuffer(2));
+  EXPECT_EQ(buffer.findFeature(1), nullptr);
+  EXPECT_EQ(buffer.stats().hits, 1);
+  EXPECT_EQ(buffer.stats().misses, 1);
+  EXPECT_EQ(buffer.stats().evictions, 1);
+}
+
+TEST(featureBuffer, keepsPinnedFeatures) {
+  loc_features::FeatureBuffer buffer(2);
+  buffer.addFeature(0, std::make_unique<DummyFeature>(std::vector{1.0}));
+  buffer.pin(0);
+  buffer.addFeature(1, std::make_unique<DummyFeature>(std::vector{2.0}));
+  buffer.addFeature(2, std::make_unique<DummyFeature>(std::vector{3.0}));
+  EXPECT_TRUE(buffer.inBuffer(0));
+  EXPECT_FALSE(buffer.inBuffer(1));
+  // Pinned features are listed after the ones that can be evicted.
+  EXPECT_EQ(buffer.ids(), (std::vector<int>{2, 0}));
+  buffer.unpin(0);
+  buffer.addFeature(3, std::make_unique<DummyFeature>(std::vector{4.0}));
+  EXPECT_FALSE(buffer.inBuffer(2));
+  EXPECT_TRUE(buffer.inBuffer(0));
+}
+
+TEST(featureBuffer, respectsByteBudget) {
+  const size_t featureBytes =
+      DummyFeature(std::vector(100, 1.0)).memoryBytes();
+  loc_features::FeatureBuffer buffer(/*size=*/10,
+                                     /*byteBudget=*/2 * featureBytes);
+  for (int id = 0; id < 4; ++id) {
+    buffer.addFeature(id,
+                      std::make_unique<DummyFeature>(std::vector(100, 1.0)));
+  }
+  EXPECT_EQ(buffer.size(), 2);
+  EXPECT_LE(buffer.bytes(), 2 * featureBytes);
+  EXPECT_TRUE(buffer.inBuffer(2));
+  EXPECT_TRUE(buffer.inBuffer(3));
+}
+
+TEST(concurrentFeatureBuffer, keepsFirstAddedFeature) {
+  loc_features::ConcurrentFeatureBuffer buffer(/*size=*/4, /*numShards=*/2);
+  EXPECT_EQ(buffer.findFeature(0), nullptr);
+  const auto first = buffer.addFeature(
+      0, std::make_unique<DummyFeature>(std::vector{1.0, 2.0}));
+  const auto second = buffer.addFeature(
+      0, std::make_unique<DummyFeature>(std::vector{3.0, 4.0}));
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(buffer.findFeature(0), first);
+  EXPECT_EQ(buffer.stats().hits, 1);
+  EXPECT_EQ(buffer.stats().misses, 1);
+}
+
+TEST(concurrentFeatureBuffer, evictedFeaturesStayValid) {
+  loc_features::ConcurrentFeatureBuffer buffer(/*size=*/1, /*numShards=*/1);
+  const auto feature = buffer.addFeature(
+      0, std::make_unique<DummyFeature>(std::vector{1.0, 2.0}));
+  buffer.addFeature(1, std::make_unique<DummyFeature>(std::vector{3.0}));
+  EXPECT_EQ(buffer.size(), 1);
+  EXPECT_EQ(buffer.findFeature(0), nullptr);
+  EXPECT_EQ(buffer.stats().evictions, 1);
+  EXPECT_EQ(feature->dimensions, (std::vector{1.0, 2.0}));
+}
+
+TEST(concurrentFeatureBuffer, addsFromSeveralThreads) {
+  loc_features::ConcurrentFeatureBuffer buffer(/*size=*/16, /*numShards=*/4);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&buffer]() {
+      for (int i = 0; i < 1000; ++i) {
+        const int id = i % 32;
+        auto feature = buffer.findFeature(id);
+        if (!feature) {
+          feature = buffer.addFeature(
+              id, std::make_unique<DummyFeature>(std::vector{double(id)}));
+        }
+        ASSERT_EQ(feature->dimensions[0], id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(buffer.size(), 16);
+  EXPECT_EQ(buffer.stats().hits + buffer.stats().misses, 4000);
+}
 } // namespace test
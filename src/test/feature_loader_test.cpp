@@ -0,0 +1,69 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/cnn_feature.h"
+#include "features/feature_loader.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+TEST(featureLoader, loadsInOrder) {
+  const std::filesystem::path tmp_dir = test::createFeatures();
+  const std::vector<std::string> featureNames =
+      localization::database::listProtoDir(tmp_dir, ".Feature");
+
+  loc_features::FeatureLoadStats stats;
+  const auto features = loc_features::loadFeatures(
+      tmp_dir, loc_features::FeatureType::Cnn_Feature, /*numThreads=*/3,
+      &stats);
+  ASSERT_EQ(features.size(), featureNames.size());
+  EXPECT_EQ(stats.featuresLoaded, featureNames.size());
+  for (size_t i = 0; i < features.size(); ++i) {
+    const loc_features::CnnFeature expected(featureNames[i]);
+    EXPECT_EQ(features[i]->type, expected.type);
+    EXPECT_NEAR(features[i]->computeSimilarityScore(expected), 1.0, 1e-6);
+    EXPECT_EQ(features[i]->bits, expected.bits);
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
+
+TEST(featureLoader, emptyDirectory) {
+  const std::filesystem::path tmp_dir =
+      std::filesystem::temp_directory_path() / "no_features";
+  std::filesystem::create_directories(tmp_dir);
+  EXPECT_TRUE(loc_features::loadFeatures(
+                  tmp_dir, loc_features::FeatureType::Cnn_Feature)
+                  .empty());
+  test::clearDataUnderPath(tmp_dir);
+}
+
+} // namespace test
@@ -0,0 +1,339 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "database/online_database.h"
+#include "database/sharded_database.h"
+#include "features/binary_feature.h"
+#include "features/cnn_feature.h"
+#include "features/feature_loader.h"
+#include "features/feature_matrix.h"
+#include "features/feature_store.h"
+#include "features/stored_feature.h"
+#include "relocalizers/dimension_hashing.h"
+#include "relocalizers/lsh_hashing.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <unistd.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace fs = std::filesystem;
+namespace loc_features = localization::features;
+
+class FeatureStoreTest : public ::testing::Test {
+protected:
+  void SetUp() {
+    tmp_dir = test::createFeatures();
+    store_dir = fs::temp_directory_path() / "feature_store";
+    fs::create_directories(store_dir);
+    storeFile = store_dir / "features.FeatureStore.bin";
+    loc_features::writeFeatureStore(
+        localization::database::listProtoDir(tmp_dir, ".Feature"), storeFile,
+        /*numThreads=*/2);
+  }
+  void TearDown() {
+    test::clearDataUnderPath(tmp_dir);
+    test::clearDataUnderPath(store_dir);
+  }
+  fs::path tmp_dir = "";
+  fs::path store_dir = "";
+  std::string storeFile = "";
+};
+
+TEST_F(FeatureStoreTest, ReadsConvertedFeatures) {
+  const auto store = loc_features::FeatureStore::open(storeFile);
+  ASSERT_EQ(store->size(), 4);
+  ASSERT_EQ(store->dim(), 4);
+  EXPECT_EQ(store->name(0), "feature_0.Feature.pb");
+  EXPECT_EQ(store->name(3), "feature_3.Feature.pb");
+  const std::vector<float> expected = {3, 4, 5, 6};
+  for (int d = 0; d < store->dim(); ++d) {
+    EXPECT_FLOAT_EQ(store->row(1)[d], expected[d]);
+  }
+  EXPECT_NEAR(store->norm(1), std::sqrt(86.0), kTestEpsilon);
+  ASSERT_DEATH(store->row(4), "Feature 4 is out of range");
+}
+
+TEST_F(FeatureStoreTest, OpensRowRange) {
+  const auto store = loc_features::FeatureStore::open(storeFile, 1, 3);
+  ASSERT_EQ(store->size(), 2);
+  EXPECT_EQ(store->name(0), "feature_1.Feature.pb");
+  EXPECT_EQ(store->name(1), "feature_2.Feature.pb");
+  const std::vector<float> expected = {3, 4, 5, 6};
+  for (int d = 0; d < store->dim(); ++d) {
+    EXPECT_FLOAT_EQ(store->row(0)[d], expected[d]);
+  }
+  EXPECT_NEAR(store->norm(0), std::sqrt(86.0), kTestEpsilon);
+  ASSERT_DEATH(store->row(2), "Feature 2 is out of range");
+  ASSERT_DEATH(loc_features::FeatureStore::open(storeFile, 2, 5),
+               "out of range");
+}
+
+TEST_F(FeatureStoreTest, ShardedDatabaseFromStore) {
+  ::testing::FLAGS_gtest_death_test_style = "threadsafe";
+  localization::database::ShardedDatabaseOptions options;
+  options.numShards = 2;
+  options.bufferSize = 2;
+  // Every worker maps only its half of the store, the ids stay global.
+  EXPECT_EXIT(
+      {
+        localization::database::ShardedDatabase database(
+            storeFile, storeFile, loc_features::Cnn_Feature, options);
+        int failures = database.numShards() != 2;
+        for (int q = 0; q < 4; ++q) {
+          for (int r = 0; r < 4; ++r) {
+            failures += std::abs(database.getCost(q, r) -
+                                 1. / kSimilarityMatrix[q][r]) > 1e-05;
+          }
+        }
+        std::exit(failures == 0 ? 0 : 1);
+      },
+      ::testing::ExitedWithCode(0), "");
+}
+
+TEST_F(FeatureStoreTest, RejectsDamagedSections) {
+  const auto damage = [&](size_t offset, uint64_t value) {
+    const std::string damaged = (store_dir / "damaged.FeatureStore.bin");
+    fs::copy_file(storeFile, damaged, fs::copy_options::overwrite_existing);
+    std::fstream file(damaged, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(offset);
+    file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    return damaged;
+  };
+  const size_t fileSize = fs::file_size(storeFile);
+  EXPECT_DEATH(loc_features::FeatureStore::open(damage(
+                   offsetof(loc_features::FeatureStoreHeader, rows), 1 << 30)),
+               "truncated or damaged");
+  EXPECT_DEATH(loc_features::FeatureStore::open(damage(
+                   offsetof(loc_features::FeatureStoreHeader, normsOffset),
+                   fileSize - 4)),
+               "out of bounds");
+  EXPECT_DEATH(loc_features::FeatureStore::open(damage(
+                   offsetof(loc_features::FeatureStoreHeader, dataOffset), 8)),
+               "out of bounds");
+  loc_features::FeatureStoreHeader header;
+  std::ifstream(storeFile, std::ios::binary)
+      .read(reinterpret_cast<char *>(&header), sizeof(header));
+  // The end of the third name points past the names.
+  const size_t nameOffsets = header.namesOffset;
+  EXPECT_DEATH(loc_features::FeatureStore::open(
+                   damage(nameOffsets + 2 * sizeof(uint64_t), fileSize)),
+               "names are damaged");
+}
+
+TEST_F(FeatureStoreTest, LoadsFeaturesFromStore) {
+  const auto stored = loc_features::loadFeatures(
+      storeFile, loc_features::Cnn_Feature, /*numThreads=*/2);
+  const auto parsed = loc_features::loadFeatures(
+      tmp_dir, loc_features::Cnn_Feature, /*numThreads=*/2);
+  ASSERT_EQ(stored.size(), parsed.size());
+  for (size_t f = 0; f < stored.size(); ++f) {
+    EXPECT_EQ(stored[f]->type, "StoredFeature");
+    // Stored features binarize like the parsed ones, so the relocalizers
+    // hash them the same way.
+    EXPECT_EQ(loc_features::numFeatureBits(*stored[f]),
+              loc_features::numFeatureBits(*parsed[f]));
+    EXPECT_EQ(loc_features::packedFeatureBits(*stored[f]),
+              loc_features::packedFeatureBits(*parsed[f]));
+  }
+  EXPECT_DEATH(loc_features::loadFeatures(storeFile,
+                                          loc_features::Bow_Feature),
+               "Feature stores hold float features");
+  EXPECT_DEATH(localization::database::OnlineDatabase(
+                   storeFile, storeFile, loc_features::Bow_Feature,
+                   /*bufferSize=*/2),
+               "Feature stores hold float features");
+}
+
+TEST_F(FeatureStoreTest, StoredFeaturesViewRows) {
+  const auto store = loc_features::FeatureStore::open(storeFile);
+  for (int r = 0; r < store->size(); ++r) {
+    const loc_features::StoredFeature feature(store, r);
+    EXPECT_EQ(feature.data(), store->row(r));
+    for (int c = 0; c < store->size(); ++c) {
+      EXPECT_NEAR(feature.computeSimilarityScore(
+                      loc_features::StoredFeature(store, c)),
+                  kSimilarityMatrix[r][c], kTestEpsilon);
+    }
+  }
+}
+
+TEST_F(FeatureStoreTest, FeatureMatrixFromStore) {
+  const auto matrix = loc_features::FeatureMatrix::load(storeFile);
+  const auto expected = loc_features::FeatureMatrix::load(tmp_dir);
+  ASSERT_EQ(matrix.rows(), expected.rows());
+  ASSERT_EQ(matrix.dim(), expected.dim());
+  for (int r = 0; r < matrix.rows(); ++r) {
+    for (int d = 0; d < matrix.dim(); ++d) {
+      EXPECT_NEAR(matrix.row(r)[d], expected.row(r)[d], kTestEpsilon);
+    }
+  }
+}
+
+TEST_F(FeatureStoreTest, OnlineDatabaseFromStore) {
+  localization::database::OnlineDatabase database(
+      /*queryFeaturesDir=*/storeFile, /*refFeaturesDir=*/storeFile,
+      localization::features::FeatureType::Cnn_Feature, /*bufferSize=*/2);
+  EXPECT_EQ(database.refSize(), 4);
+  for (int q = 0; q < 4; ++q) {
+    for (int r = 0; r < 4; ++r) {
+      EXPECT_NEAR(database.getCost(q, r), 1. / kSimilarityMatrix[q][r],
+                  1e-05);
+    }
+  }
+}
+
+TEST_F(FeatureStoreTest, StoreInMemory) {
+  const auto file = loc_features::FeatureStore::open(storeFile);
+  std::vector<std::string> names;
+  std::vector<float> values;
+  for (int r = 0; r < file->size(); ++r) {
+    names.emplace_back(file->name(r));
+    values.insert(values.end(), file->row(r), file->row(r) + file->dim());
+  }
+  const auto memory = loc_features::FeatureStore::fromValues(
+      "in_memory", names, values, file->dim());
+  ASSERT_EQ(memory->size(), file->size());
+  ASSERT_EQ(memory->dim(), file->dim());
+  for (int r = 0; r < memory->size(); ++r) {
+    EXPECT_EQ(memory->name(r), file->name(r));
+    EXPECT_FLOAT_EQ(memory->norm(r), file->norm(r));
+    for (int d = 0; d < memory->dim(); ++d) {
+      EXPECT_FLOAT_EQ(memory->row(r)[d], file->row(r)[d]);
+    }
+  }
+  ASSERT_DEATH(loc_features::FeatureStore::fromValues("in_memory", names,
+                                                      values, 3),
+               "Expected 4 features of size 3");
+
+  localization::database::OnlineDatabase database(memory, memory,
+                                                  /*bufferSize=*/2);
+  EXPECT_EQ(database.refSize(), 4);
+  for (int q = 0; q < 4; ++q) {
+    for (int r = 0; r < 4; ++r) {
+      EXPECT_NEAR(database.getCost(q, r), 1. / kSimilarityMatrix[q][r],
+                  1e-05);
+    }
+  }
+}
+
+TEST_F(FeatureStoreTest, SharedStore) {
+  const std::string name =
+      "shm:feature_store_test_" + std::to_string(::getpid());
+  loc_features::publishSharedFeatureStore(
+      localization::database::listProtoDir(tmp_dir, ".Feature"), name);
+  {
+    const auto shared = loc_features::FeatureStore::open(name);
+    const auto file = loc_features::FeatureStore::open(storeFile);
+    ASSERT_EQ(shared->size(), file->size());
+    ASSERT_EQ(shared->dim(), file->dim());
+    for (int r = 0; r < shared->size(); ++r) {
+      EXPECT_EQ(shared->name(r), file->name(r));
+      EXPECT_FLOAT_EQ(shared->norm(r), file->norm(r));
+      for (int d = 0; d < shared->dim(); ++d) {
+        EXPECT_FLOAT_EQ(shared->row(r)[d], file->row(r)[d]);
+      }
+    }
+    localization::database::OnlineDatabase database(
+        /*queryFeaturesDir=*/storeFile, /*refFeaturesDir=*/name,
+        localization::features::FeatureType::Cnn_Feature, /*bufferSize=*/2);
+    EXPECT_NEAR(database.getCost(1, 2), 1. / kSimilarityMatrix[1][2], 1e-05);
+    // Already published stores are not overwritten.
+    ASSERT_DEATH(loc_features::publishSharedFeatureStore(
+                     localization::database::listProtoDir(tmp_dir, ".Feature"),
+                     name),
+                 "cannot be created");
+  }
+  loc_features::removeSharedFeatureStore(name);
+  ASSERT_DEATH(loc_features::FeatureStore::open(name), "cannot be opened");
+}
+
+TEST_F(FeatureStoreTest, RewritingKeepsMappedStores) {
+  const auto mapped = loc_features::FeatureStore::open(storeFile);
+  auto files = localization::database::listProtoDir(tmp_dir, ".Feature");
+  files.resize(2);
+  loc_features::writeFeatureStore(files, storeFile);
+  // The old store is replaced, not overwritten under its readers.
+  ASSERT_EQ(mapped->size(), 4);
+  const std::vector<float> expected = {0, 1, 2.5, 3};
+  for (int d = 0; d < mapped->dim(); ++d) {
+    EXPECT_FLOAT_EQ(mapped->row(3)[d], expected[d]);
+  }
+  EXPECT_EQ(loc_features::FeatureStore::open(storeFile)->size(), 2);
+  EXPECT_FALSE(fs::exists(storeFile + ".tmp"));
+}
+
+// With features from stores the queries are StoredFeatures, which have no
+// bits of their own. The relocalizers binarize them like CnnFeatures.
+TEST(FeatureStoreRelocalization, RelocalizesStoreBackedQueries) {
+  const std::vector<std::vector<float>> refValues = {
+      {1, 1, 0, 0, 0, 0}, {0, 0, 1, 1, 0, 0}, {0, 0, 0, 1, 1, 1}};
+  const std::vector<float> queryValues = {0, 0, 0, 0.6, 1, 1};
+  std::vector<float> packedRefs;
+  for (const auto &values : refValues) {
+    packedRefs.insert(packedRefs.end(), values.begin(), values.end());
+  }
+  const auto refStore = loc_features::FeatureStore::fromValues(
+      "ref", {"ref_0", "ref_1", "ref_2"}, packedRefs, /*dim=*/6);
+  const auto queryStore = loc_features::FeatureStore::fromValues(
+      "query", {"query_0"}, queryValues, /*dim=*/6);
+  localization::database::OnlineDatabase database(queryStore, refStore,
+                                                  /*bufferSize=*/4);
+  ASSERT_EQ(database.getQueryFeature(0).type, "StoredFeature");
+  std::vector<std::unique_ptr<loc_features::iFeature>> refs;
+  for (int r = 0; r < refStore->size(); ++r) {
+    refs.push_back(std::make_unique<loc_features::StoredFeature>(refStore, r));
+  }
+  const loc_features::CnnFeature cnnQuery(
+      std::vector<double>(queryValues.begin(), queryValues.end()));
+
+  loc_features::LshOptions options;
+  options.numTables = 2;
+  options.keySize = 3;
+  options.multiProbeLevel = 3;
+  localization::relocalizers::LshHashing lsh(&database, options,
+                                             /*numCandidates=*/2);
+  lsh.train(refs);
+  EXPECT_EQ(lsh.getCandidates(0), (std::vector<int>{2, 1}));
+  EXPECT_EQ(lsh.getCandidates(0), lsh.candidatesFor(cnnQuery));
+
+  localization::relocalizers::DimensionHashing dimensionHashing(
+      &database, /*topFraction=*/1.0, /*maxCandidates=*/1);
+  dimensionHashing.train(refs);
+  EXPECT_EQ(dimensionHashing.getCandidates(0), (std::vector<int>{2}));
+  EXPECT_EQ(dimensionHashing.getCandidates(0),
+            dimensionHashing.candidatesFor(cnnQuery));
+}
+
+} // namespace test
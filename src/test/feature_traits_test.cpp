@@ -0,0 +1,166 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/binary_feature.h"
+#include "features/cnn_feature.h"
+#include "features/feature_factory.h"
+#include "features/feature_store.h"
+#include "features/feature_traits.h"
+#include "features/int8_feature.h"
+#include "features/stored_feature.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+namespace {
+std::vector<double> randomValues(int dim, std::mt19937 &generator) {
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> values(dim);
+  for (double &value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+} // namespace
+
+TEST(featureTraits, staticCostEqualsVirtualCost) {
+  std::mt19937 generator(11);
+  for (const auto type :
+       {loc_features::Cnn_Feature, loc_features::Binary_Feature_Mid,
+        loc_features::Binary_Feature_Mean, loc_features::Binary_Feature_Median,
+        loc_features::Int8_Feature, loc_features::Patch_Feature}) {
+    const auto query = loc_features::createFeature(type, randomValues(100, generator));
+    const auto ref = loc_features::createFeature(type, randomValues(100, generator));
+    const loc_features::MatchingCostFunction cost =
+        loc_features::matchingCostFunction(type);
+    EXPECT_NE(cost, loc_features::dynamicMatchingCost);
+    EXPECT_DOUBLE_EQ(cost(*query, *ref),
+                     loc_features::dynamicMatchingCost(*query, *ref))
+        << "Feature type " << type;
+  }
+}
+
+TEST(featureTraits, typeNames) {
+  std::mt19937 generator(13);
+  for (const auto type :
+       {loc_features::Cnn_Feature, loc_features::Binary_Feature_Mid,
+        loc_features::Binary_Feature_Mean, loc_features::Binary_Feature_Median,
+        loc_features::Int8_Feature, loc_features::Bow_Feature,
+        loc_features::Patch_Feature}) {
+    EXPECT_EQ(loc_features::featureTypeFromName(
+                  loc_features::featureTypeName(type)),
+              type);
+    const auto feature =
+        loc_features::createFeature(type, randomValues(100, generator));
+    EXPECT_EQ(loc_features::hasFeatureBits(type),
+              loc_features::numFeatureBits(*feature) > 0)
+        << "Feature type " << type;
+  }
+  EXPECT_EQ(loc_features::featureTypeName(loc_features::Bow_Feature),
+            "Bow_Feature");
+  ASSERT_DEATH(loc_features::featureTypeFromName("cnn"),
+               "Unknown feature type cnn, use one of Cnn_Feature");
+}
+
+TEST(featureTraits, batchedCostsEqualSingleCosts) {
+  std::mt19937 generator(12);
+  for (const auto type :
+       {loc_features::Cnn_Feature, loc_features::Binary_Feature_Median,
+        loc_features::Int8_Feature, loc_features::Patch_Feature}) {
+    const auto query =
+        loc_features::createFeature(type, randomValues(37, generator));
+    std::vector<std::unique_ptr<loc_features::iFeature>> refs;
+    std::vector<const loc_features::iFeature *> refPointers;
+    for (int r = 0; r < 7; ++r) {
+      refs.push_back(
+          loc_features::createFeature(type, randomValues(37, generator)));
+      refPointers.push_back(refs.back().get());
+    }
+    std::vector<double> costs(refs.size());
+    loc_features::matchingCostsFunction(type)(*query, refPointers.data(),
+                                              refPointers.size(), costs.data());
+    for (size_t r = 0; r < refs.size(); ++r) {
+      EXPECT_NEAR(costs[r], loc_features::dynamicMatchingCost(*query, *refs[r]),
+                  1e-5 * costs[r])
+          << "Feature type " << type;
+    }
+  }
+}
+
+TEST(featureTraits, typedScores) {
+  const loc_features::CnnFeature cnn(std::vector<double>{3, 4});
+  EXPECT_EQ(cnn.size(), 2);
+  EXPECT_NEAR(loc_features::FeatureTraits<loc_features::CnnFeature>::score(
+                  cnn, cnn),
+              1.0, kTestEpsilon);
+  EXPECT_NEAR(loc_features::matchingCost(cnn, cnn), 1.0, kTestEpsilon);
+
+  const loc_features::BinaryFeature lhs(std::vector<double>{0, 1, 0, 1},
+                                        loc_features::Binarization::Mid);
+  const loc_features::BinaryFeature rhs(std::vector<double>{0, 1, 1, 0},
+                                        loc_features::Binarization::Mid);
+  EXPECT_DOUBLE_EQ(
+      loc_features::FeatureTraits<loc_features::BinaryFeature>::score(lhs,
+                                                                      rhs),
+      0.5);
+  EXPECT_DOUBLE_EQ(loc_features::matchingCost(lhs, rhs), 2.0);
+  EXPECT_EQ(loc_features::inverseScoreCost(0.0),
+            std::numeric_limits<double>::max());
+}
+
+TEST(featureTraits, storedFeatures) {
+  const fs::path tmp_dir = test::createFeatures();
+  const fs::path storeFile =
+      fs::temp_directory_path() / "feature_traits_test.FeatureStore.bin";
+  const auto files = localization::database::listProtoDir(tmp_dir, ".Feature");
+  loc_features::writeFeatureStore(files, storeFile, /*numThreads=*/1);
+  const auto store = loc_features::FeatureStore::open(storeFile);
+  const loc_features::StoredFeature query(store, 0);
+  const loc_features::StoredFeature ref(store, 1);
+  const auto cost = loc_features::matchingCostFunction(
+      loc_features::Cnn_Feature, /*stored=*/true);
+  EXPECT_DOUBLE_EQ(cost(query, ref),
+                   loc_features::dynamicMatchingCost(query, ref));
+  EXPECT_NEAR(cost(query, query), 1.0, kTestEpsilon);
+  const std::vector<const loc_features::iFeature *> refs = {&ref, &query};
+  std::vector<double> costs(refs.size());
+  loc_features::matchingCostsFunction(loc_features::Cnn_Feature,
+                                      /*stored=*/true)(query, refs.data(),
+                                                       refs.size(),
+                                                       costs.data());
+  EXPECT_NEAR(costs[0], cost(query, ref), 1e-5 * costs[0]);
+  EXPECT_NEAR(costs[1], 1.0, 1e-5);
+  fs::remove(storeFile);
+  test::clearDataUnderPath(tmp_dir);
+}
+
+} // namespace test
@@ -0,0 +1,103 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/aligned_allocator.h"
+#include "features/cnn_feature.h"
+#include "features/feature_factory.h"
+#include "features/int8_feature.h"
+#include "features/similarity_kernels.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+TEST(int8Feature, kernelsAreExact) {
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<int> distribution(-127, 127);
+  for (int dim : {0, 1, 15, 31, 32, 33, 63, 64, 65, 100, 4096, 4099}) {
+    loc_features::AlignedInt8Vector lhs(dim), rhs(dim);
+    int32_t expected = 0;
+    for (int d = 0; d < dim; ++d) {
+      lhs[d] = distribution(generator);
+      rhs[d] = distribution(generator);
+      expected += lhs[d] * rhs[d];
+    }
+    for (const auto level : loc_features::supportedSimdLevels()) {
+      EXPECT_EQ(loc_features::dotProductInt8(lhs.data(), rhs.data(), dim,
+                                             level),
+                expected)
+          << loc_features::simdLevelName(level) << ", dim " << dim;
+    }
+  }
+}
+
+TEST(int8Feature, extremeValuesDoNotSaturate) {
+  const int dim = 256;
+  loc_features::AlignedInt8Vector lhs(dim, -127), rhs(dim, -127);
+  for (const auto level : loc_features::supportedSimdLevels()) {
+    EXPECT_EQ(loc_features::dotProductInt8(lhs.data(), rhs.data(), dim, level),
+              dim * 127 * 127)
+        << loc_features::simdLevelName(level);
+  }
+}
+
+TEST(int8Feature, quantization) {
+  const loc_features::Int8Feature feature(std::vector{3.0, -4.0, 0.0});
+  ASSERT_EQ(feature.size(), 3);
+  EXPECT_EQ(feature.data()[0], 95);
+  EXPECT_EQ(feature.data()[1], -127);
+  EXPECT_EQ(feature.data()[2], 0);
+  EXPECT_NEAR(feature.computeSimilarityScore(feature), 1.0, 1e-2);
+  const loc_features::Int8Feature zero(std::vector{0.0, 0.0});
+  EXPECT_DOUBLE_EQ(zero.computeSimilarityScore(zero), 0.0);
+}
+
+TEST(int8Feature, closeToCnnFeature) {
+  const std::filesystem::path tmp_dir = test::createFeatures();
+  const auto names = localization::database::listProtoDir(tmp_dir, ".Feature");
+  for (const auto &queryName : names) {
+    const auto query =
+        loc_features::createFeature(loc_features::Int8_Feature, queryName);
+    const loc_features::CnnFeature cnnQuery(queryName);
+    EXPECT_EQ(query->type, "Int8Feature");
+    EXPECT_LT(8 * query->memoryBytes(), cnnQuery.memoryBytes() + 8 * 128);
+    for (const auto &refName : names) {
+      const loc_features::Int8Feature ref(refName);
+      EXPECT_NEAR(query->computeSimilarityScore(ref),
+                  cnnQuery.computeSimilarityScore(
+                      loc_features::CnnFeature(refName)),
+                  1e-2);
+    }
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
+} // namespace test
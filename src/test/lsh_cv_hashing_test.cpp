@@ -0,0 +1,129 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/cnn_feature.h"
+#include "features/feature_store.h"
+#include "features/stored_feature.h"
+#include "relocalizers/lsh_cv_hashing.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+namespace fs = std::filesystem;
+
+namespace {
+// Features of 64 random values, their bits are random as well.
+std::vector<std::unique_ptr<loc_features::iFeature>>
+randomFeatures(int count, std::mt19937 &generator, double scale = 1.0) {
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<std::unique_ptr<loc_features::iFeature>> features;
+  for (int f = 0; f < count; ++f) {
+    std::vector<double> values(64);
+    for (double &value : values) {
+      value = scale * distribution(generator);
+    }
+    features.push_back(std::make_unique<loc_features::CnnFeature>(values));
+  }
+  return features;
+}
+} // namespace
+
+TEST(lshCvHashing, findsAppendedReference) {
+  const fs::path dir = fs::temp_directory_path() / "lsh_cv_hashing";
+  fs::create_directories(dir);
+  createFeatureFile(dir, "feature_0.Feature.pb",
+                    createFeatureProto({1, 1, 0, 0}));
+  localization::database::OnlineDatabase database(
+      dir, dir, loc_features::FeatureType::Cnn_Feature, /*bufferSize=*/10);
+  localization::relocalizers::LshCvHashing hashing(
+      &database, /*tableNum=*/4, /*keySize=*/12, /*multiProbeLevel=*/2);
+  std::mt19937 generator(7);
+  hashing.train(randomFeatures(20, generator));
+
+  // A scaled copy of the appended feature has the same bits.
+  std::mt19937 appendedGenerator(11);
+  const auto appended = randomFeatures(1, appendedGenerator);
+  appendedGenerator.seed(11);
+  const auto query = randomFeatures(1, appendedGenerator, /*scale=*/2.0);
+  ASSERT_EQ(query[0]->bits, appended[0]->bits);
+
+  // One added feature is below the share that rebuilds the index, it is
+  // matched exhaustively. It follows the 20 trained ones.
+  hashing.addFeatures(appended);
+  std::vector<int> candidates = hashing.hashFeature(*query[0]);
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(candidates[0], 20);
+
+  // More added features rebuild the index, the ids stay the same.
+  hashing.addFeatures(randomFeatures(2, generator));
+  candidates = hashing.hashFeature(*query[0]);
+  ASSERT_FALSE(candidates.empty());
+  EXPECT_EQ(candidates[0], 20);
+  clearDataUnderPath(dir);
+}
+
+TEST(lshCvHashing, hashesStoredFeatures) {
+  // StoredFeatures have no bits of their own, they are binarized like the
+  // CnnFeatures of the same values.
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<float> values(20 * 64);
+  for (float &value : values) {
+    value = distribution(generator);
+  }
+  std::vector<std::string> names;
+  for (int f = 0; f < 20; ++f) {
+    names.push_back("feature_" + std::to_string(f));
+  }
+  const auto store =
+      loc_features::FeatureStore::fromValues("ref", names, values, /*dim=*/64);
+  localization::database::OnlineDatabase database(store, store,
+                                                  /*bufferSize=*/10);
+  std::vector<std::unique_ptr<loc_features::iFeature>> stored;
+  for (int f = 0; f < store->size(); ++f) {
+    stored.push_back(std::make_unique<loc_features::StoredFeature>(store, f));
+  }
+  localization::relocalizers::LshCvHashing hashing(
+      &database, /*tableNum=*/4, /*keySize=*/12, /*multiProbeLevel=*/2);
+  hashing.train(stored);
+  for (int q : {0, 7, 19}) {
+    const std::vector<int> candidates = hashing.getCandidates(q);
+    ASSERT_FALSE(candidates.empty());
+    EXPECT_EQ(candidates[0], q);
+    const loc_features::CnnFeature cnnQuery(
+        std::vector<double>(store->row(q), store->row(q) + 64));
+    EXPECT_EQ(hashing.hashFeature(cnnQuery), candidates);
+  }
+}
+
+} // namespace test
@@ -0,0 +1,431 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/cnn_feature.h"
+#include "features/feature_loader.h"
+#include "features/lsh_index.h"
+#include "features/similarity_kernels.h"
+#include "relocalizers/lsh_hashing.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+namespace fs = std::filesystem;
+
+namespace {
+std::vector<uint64_t> randomCode(int words, std::mt19937_64 &generator) {
+  std::vector<uint64_t> code(words);
+  for (uint64_t &word : code) {
+    word = generator();
+  }
+  return code;
+}
+
+std::vector<uint64_t> flipBits(std::vector<uint64_t> code,
+                               const std::vector<int> &bits) {
+  for (int b : bits) {
+    code[b / 64] ^= uint64_t{1} << (b % 64);
+  }
+  return code;
+}
+} // namespace
+
+TEST(lshIndex, findsNearDuplicates) {
+  std::mt19937_64 generator(3);
+  loc_features::LshOptions options;
+  options.numTables = 8;
+  options.keySize = 12;
+  options.multiProbeLevel = 1;
+  loc_features::LshIndex index(256, options);
+  std::vector<std::vector<uint64_t>> codes;
+  for (int id = 0; id < 2000; ++id) {
+    codes.push_back(randomCode(4, generator));
+    EXPECT_EQ(index.add(codes.back().data()), id);
+  }
+  index.rebuild();
+  EXPECT_EQ(index.numHashed(), 2000);
+  for (int id = 0; id < 2000; id += 97) {
+    const auto query = flipBits(codes[id], {id % 256, (id * 7) % 256});
+    const auto neighbours = index.knn(query.data(), 3);
+    ASSERT_FALSE(neighbours.empty());
+    EXPECT_EQ(neighbours[0].first, id);
+    EXPECT_LE(neighbours[0].second, 2);
+    for (size_t n = 0; n < neighbours.size(); ++n) {
+      EXPECT_EQ(neighbours[n].second,
+                loc_features::hammingDistance(
+                    query.data(), codes[neighbours[n].first].data(), 4));
+      if (n > 0) {
+        EXPECT_LE(neighbours[n - 1].second, neighbours[n].second);
+      }
+    }
+  }
+}
+
+TEST(lshIndex, multiProbing) {
+  // The key samples all bits of the codes, only probing finds a code with
+  // other bits.
+  std::mt19937_64 generator(5);
+  for (int keySize : {16, 20}) {
+    const uint64_t mask = (uint64_t{1} << keySize) - 1;
+    const uint64_t code = generator() & mask;
+    const std::vector<uint64_t> query = {code ^ 0b101};
+    for (int level = 0; level <= 2; ++level) {
+      loc_features::LshOptions options;
+      options.numTables = 1;
+      options.keySize = keySize;
+      options.multiProbeLevel = level;
+      loc_features::LshIndex index(keySize, options);
+      index.add(&code);
+      index.rebuild();
+      const auto neighbours = index.knn(query.data(), 1);
+      if (level < 2) {
+        EXPECT_TRUE(neighbours.empty()) << keySize << " bits, level " << level;
+      } else {
+        ASSERT_EQ(neighbours.size(), 1) << keySize << " bits";
+        EXPECT_EQ(neighbours[0], std::make_pair(0, 2));
+      }
+    }
+  }
+}
+
+TEST(lshIndex, tooManyProbesDie) {
+  loc_features::LshOptions options;
+  options.keySize = 32;
+  // 41449 probes per table.
+  options.multiProbeLevel = 4;
+  loc_features::LshIndex index(64, options);
+  options.multiProbeLevel = 8;
+  ASSERT_DEATH(loc_features::LshIndex(64, options), "use a lower level");
+}
+
+TEST(lshIndex, parallelProbingFindsTheSameNeighbours) {
+  std::mt19937_64 generator(8);
+  loc_features::LshOptions options;
+  options.numTables = 6;
+  options.keySize = 10;
+  loc_features::LshIndex serial(128, options);
+  options.numThreads = 3;
+  loc_features::LshIndex parallel(128, options);
+  for (int id = 0; id < 500; ++id) {
+    const auto code = randomCode(2, generator);
+    serial.add(code.data());
+    parallel.add(code.data());
+  }
+  serial.rebuild();
+  parallel.rebuild();
+  for (int q = 0; q < 20; ++q) {
+    const auto query = randomCode(2, generator);
+    EXPECT_EQ(serial.knn(query.data(), 5), parallel.knn(query.data(), 5));
+  }
+}
+
+TEST(lshIndex, addedCodes) {
+  std::mt19937_64 generator(13);
+  loc_features::LshOptions options;
+  options.numTables = 4;
+  options.keySize = 8;
+  loc_features::LshIndex index(64, options);
+  for (int id = 0; id < 100; ++id) {
+    index.add(randomCode(1, generator).data());
+  }
+  index.rebuild();
+  // Not hashed yet, found by the exhaustive search.
+  const auto added = randomCode(1, generator);
+  EXPECT_EQ(index.add(added.data()), 100);
+  EXPECT_EQ(index.numHashed(), 100);
+  EXPECT_EQ(index.knn(added.data(), 1)[0], std::make_pair(100, 0));
+  for (int id = 0; id < 10; ++id) {
+    index.add(randomCode(1, generator).data());
+  }
+  // More than a tenth of the codes were added, the tables were rebuilt.
+  EXPECT_EQ(index.numHashed(), index.size());
+  EXPECT_EQ(index.knn(added.data(), 1)[0], std::make_pair(100, 0));
+}
+
+TEST(lshIndex, savedIndexFindsTheSameNeighbours) {
+  const fs::path file = fs::temp_directory_path() / "lsh_test.LshIndex.bin";
+  std::mt19937_64 generator(21);
+  // Direct and sorted tables.
+  for (int keySize : {10, 20}) {
+    loc_features::LshOptions options;
+    options.numTables = 3;
+    options.keySize = keySize;
+    options.seed = 7;
+    loc_features::LshIndex index(192, options);
+    for (int id = 0; id < 300; ++id) {
+      index.add(randomCode(3, generator).data());
+    }
+    index.rebuild();
+    // Saved as pending codes.
+    index.add(randomCode(3, generator).data());
+    index.save(file, /*referenceFingerprint=*/42);
+
+    const auto opened = loc_features::LshIndex::open(file, /*numThreads=*/2);
+    EXPECT_EQ(opened->size(), 301);
+    EXPECT_EQ(opened->numHashed(), 300);
+    EXPECT_EQ(opened->referenceFingerprint(), 42);
+    EXPECT_EQ(opened->options().keySize, keySize);
+    EXPECT_EQ(opened->options().seed, 7);
+    EXPECT_EQ(opened->options().numThreads, 2);
+    for (int q = 0; q < 20; ++q) {
+      const auto query = randomCode(3, generator);
+      EXPECT_EQ(index.knn(query.data(), 5), opened->knn(query.data(), 5))
+          << keySize << " bits";
+    }
+    // Adding to a mapped index copies it.
+    const auto added = randomCode(3, generator);
+    EXPECT_EQ(opened->add(added.data()), 301);
+    EXPECT_EQ(opened->knn(added.data(), 1)[0], std::make_pair(301, 0));
+  }
+  fs::remove(file);
+}
+
+TEST(lshIndex, savedIndexWithoutTables) {
+  const fs::path file = fs::temp_directory_path() / "lsh_empty.LshIndex.bin";
+  std::mt19937_64 generator(22);
+  loc_features::LshIndex index(64);
+  const auto code = randomCode(1, generator);
+  index.add(code.data());
+  index.save(file);
+  const auto opened = loc_features::LshIndex::open(file);
+  EXPECT_EQ(opened->numHashed(), 0);
+  EXPECT_EQ(opened->knn(code.data(), 1)[0], std::make_pair(0, 0));
+  fs::remove(file);
+}
+
+TEST(lshIndex, otherFileDies) {
+  const fs::path file = fs::temp_directory_path() / "lsh_bad.LshIndex.bin";
+  {
+    std::ofstream out(file, std::ios::binary);
+    out << std::string(256, 'x');
+  }
+  EXPECT_DEATH(loc_features::LshIndex::open(file), "Not an LSH index");
+  fs::remove(file);
+}
+
+TEST(lshIndex, damagedSectionsDie) {
+  const fs::path file = fs::temp_directory_path() / "lsh_damaged.LshIndex.bin";
+  std::mt19937_64 generator(23);
+  // Direct and sorted tables.
+  for (int keySize : {10, 20}) {
+    loc_features::LshOptions options;
+    options.numTables = 2;
+    options.keySize = keySize;
+    loc_features::LshIndex index(64, options);
+    for (int id = 0; id < 50; ++id) {
+      index.add(randomCode(1, generator).data());
+    }
+    index.rebuild();
+    index.save(file);
+    loc_features::LshIndexHeader header;
+    {
+      std::ifstream in(file, std::ios::binary);
+      in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    }
+    const auto damage = [&file](uint64_t offset, uint32_t value) {
+      const fs::path damaged =
+          fs::temp_directory_path() / "lsh_damaged_copy.LshIndex.bin";
+      fs::copy_file(file, damaged, fs::copy_options::overwrite_existing);
+      std::fstream out(damaged, std::ios::binary | std::ios::in | std::ios::out);
+      out.seekp(offset);
+      out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+      return damaged;
+    };
+    // Options that would allocate past the file.
+    EXPECT_DEATH(loc_features::LshIndex::open(damage(
+                     offsetof(loc_features::LshIndexHeader, numTables),
+                     1 << 30)),
+                 "truncated or damaged");
+    EXPECT_DEATH(loc_features::LshIndex::open(damage(
+                     offsetof(loc_features::LshIndexHeader, multiProbeLevel),
+                     33)),
+                 "truncated or damaged");
+    // A sampled bit past the code.
+    EXPECT_DEATH(loc_features::LshIndex::open(
+                     damage(header.sampledBitsOffset + 4, 64)),
+                 "truncated or damaged");
+    // An id past the hashed codes.
+    EXPECT_DEATH(
+        loc_features::LshIndex::open(damage(header.bucketIdsOffset, 50)),
+        "truncated or damaged");
+    if (keySize == 10) {
+      // Offsets that decrease or point past the ids of the table.
+      EXPECT_DEATH(loc_features::LshIndex::open(
+                       damage(header.bucketOffsetsOffset + 4, 40)),
+                   "truncated or damaged");
+      EXPECT_DEATH(loc_features::LshIndex::open(damage(
+                       header.bucketOffsetsOffset + 1024 * 4, 51)),
+                   "truncated or damaged");
+    } else {
+      // Keys out of order.
+      EXPECT_DEATH(loc_features::LshIndex::open(
+                       damage(header.bucketKeysOffset, 0xffffffff)),
+                   "truncated or damaged");
+    }
+  }
+  fs::remove(file);
+  fs::remove(fs::temp_directory_path() / "lsh_damaged_copy.LshIndex.bin");
+}
+
+TEST(lshHashing, findsTheMatchingReference) {
+  const fs::path dir = fs::temp_directory_path() / "lsh_hashing";
+  const fs::path queryDir = dir / "query";
+  const fs::path refDir = dir / "ref";
+  fs::create_directories(queryDir);
+  fs::create_directories(refDir);
+  createFeatureFile(refDir, "ref_0.Feature.pb",
+                    createFeatureProto({1, 1, 0, 0, 0, 0}));
+  createFeatureFile(refDir, "ref_1.Feature.pb",
+                    createFeatureProto({0, 0, 1, 1, 0, 0}));
+  createFeatureFile(refDir, "ref_2.Feature.pb",
+                    createFeatureProto({0, 0, 0, 1, 1, 1}));
+  createFeatureFile(queryDir, "query_0.Feature.pb",
+                    createFeatureProto({0, 0, 0, 0.6, 1, 1}));
+
+  localization::database::OnlineDatabase database(
+      queryDir, refDir, loc_features::FeatureType::Cnn_Feature,
+      /*bufferSize=*/10);
+  loc_features::LshOptions options;
+  options.numTables = 2;
+  options.keySize = 3;
+  options.multiProbeLevel = 3;
+  localization::relocalizers::LshHashing relocalizer(&database, options,
+                                                     /*numCandidates=*/2);
+  relocalizer.train(refDir);
+  // Probing every bucket ranks all references by their Hamming distance.
+  EXPECT_EQ(relocalizer.getCandidates(0), (std::vector<int>{2, 1}));
+
+  // A saved index is only loaded for the same reference and options.
+  const std::string indexFile = dir / "ref.LshIndex.bin";
+  relocalizer.save(indexFile, /*referenceFingerprint=*/5);
+  localization::relocalizers::LshHashing loaded(&database, options,
+                                                /*numCandidates=*/2);
+  EXPECT_FALSE(loaded.load(dir / "missing.LshIndex.bin", 5));
+  EXPECT_FALSE(loaded.load(indexFile, 6));
+  ASSERT_TRUE(loaded.load(indexFile, 5));
+  EXPECT_EQ(loaded.getCandidates(0), (std::vector<int>{2, 1}));
+  options.multiProbeLevel = 2;
+  localization::relocalizers::LshHashing otherOptions(&database, options,
+                                                      /*numCandidates=*/2);
+  EXPECT_FALSE(otherOptions.load(indexFile, 5));
+  clearDataUnderPath(dir);
+}
+
+TEST(lshHashing, findsAppendedReference) {
+  const fs::path dir = fs::temp_directory_path() / "lsh_hashing_append";
+  const fs::path queryDir = dir / "query";
+  const fs::path refDir = dir / "ref";
+  const fs::path newRefDir = dir / "new_ref";
+  for (const auto &path : {queryDir, refDir, newRefDir}) {
+    fs::create_directories(path);
+  }
+  createFeatureFile(refDir, "ref_0.Feature.pb",
+                    createFeatureProto({1, 1, 0, 0, 0, 0}));
+  createFeatureFile(refDir, "ref_1.Feature.pb",
+                    createFeatureProto({0, 0, 1, 1, 0, 0}));
+  createFeatureFile(newRefDir, "ref_2.Feature.pb",
+                    createFeatureProto({0, 0, 0, 1, 1, 1}));
+  createFeatureFile(queryDir, "query_0.Feature.pb",
+                    createFeatureProto({0, 0, 0, 0.6, 1, 1}));
+
+  localization::database::OnlineDatabase database(
+      queryDir, refDir, loc_features::FeatureType::Cnn_Feature,
+      /*bufferSize=*/10);
+  loc_features::LshOptions options;
+  options.numTables = 2;
+  options.keySize = 3;
+  options.multiProbeLevel = 3;
+  localization::relocalizers::LshHashing relocalizer(&database, options,
+                                                     /*numCandidates=*/2);
+  relocalizer.train(refDir);
+  EXPECT_EQ(relocalizer.getCandidates(0), (std::vector<int>{1, 0}));
+
+  // A new mapping run extends the database and the index, like
+  // appendToReference in the localizer.
+  database.appendReferenceFeatures(
+      {(newRefDir / "ref_2.Feature.pb").string()});
+  relocalizer.addFeatures(loc_features::loadFeatures(
+      newRefDir, loc_features::FeatureType::Cnn_Feature));
+  EXPECT_EQ(relocalizer.getCandidates(0), (std::vector<int>{2, 1}));
+  EXPECT_NEAR(database.getCost(0, 2),
+              1.0 / loc_features::CnnFeature(
+                        std::vector<double>{0, 0, 0, 0.6, 1, 1})
+                        .computeSimilarityScore(loc_features::CnnFeature(
+                            std::vector<double>{0, 0, 0, 1, 1, 1})),
+              1e-05);
+  clearDataUnderPath(dir);
+}
+
+TEST(lshHashing, hashesTheBinarizationOfTheDatabase) {
+  const fs::path dir = fs::temp_directory_path() / "lsh_hashing_type";
+  const fs::path queryDir = dir / "query";
+  const fs::path refDir = dir / "ref";
+  fs::create_directories(queryDir);
+  fs::create_directories(refDir);
+  createFeatureFile(refDir, "ref_0.Feature.pb",
+                    createFeatureProto({1, 1, 0, 0, 0, 0}));
+  createFeatureFile(refDir, "ref_1.Feature.pb",
+                    createFeatureProto({0, 0, 1, 1, 0, 0}));
+  createFeatureFile(refDir, "ref_2.Feature.pb",
+                    createFeatureProto({0, 0, 0, 1, 1, 1}));
+  createFeatureFile(queryDir, "query_0.Feature.pb",
+                    createFeatureProto({0, 0, 0, 0.6, 1, 1}));
+
+  localization::database::OnlineDatabase database(
+      queryDir, refDir, loc_features::Binary_Feature_Median,
+      /*bufferSize=*/10);
+  loc_features::LshOptions options;
+  options.numTables = 2;
+  options.keySize = 3;
+  options.multiProbeLevel = 3;
+  localization::relocalizers::LshHashing relocalizer(&database, options,
+                                                     /*numCandidates=*/1);
+  relocalizer.train(refDir, /*numThreads=*/1, /*projection=*/nullptr,
+                    loc_features::Binary_Feature_Median);
+  EXPECT_EQ(relocalizer.getCandidates(0), (std::vector<int>{2}));
+  ASSERT_DEATH(relocalizer.train(refDir, /*numThreads=*/1,
+                                 /*projection=*/nullptr,
+                                 loc_features::Int8_Feature),
+               "Int8_Feature features have none");
+
+  // A saved index is only reused for the same binarization.
+  EXPECT_EQ(localization::relocalizers::indexFingerprint(7),
+            localization::relocalizers::indexFingerprint(
+                7, "", loc_features::Cnn_Feature));
+  EXPECT_NE(localization::relocalizers::indexFingerprint(7),
+            localization::relocalizers::indexFingerprint(
+                7, "", loc_features::Binary_Feature_Median));
+  clearDataUnderPath(dir);
+}
+
+} // namespace test
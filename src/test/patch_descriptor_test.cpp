@@ -0,0 +1,122 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/patch_descriptor.h"
+
+#include <opencv2/core.hpp>
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+namespace {
+// Random gray levels in [0, 100], an image of the descriptor size is not
+// resampled.
+cv::Mat randomImage(int width, int height, std::mt19937 &generator) {
+  std::uniform_int_distribution<int> distribution(0, 100);
+  cv::Mat image(height, width, CV_8UC1, cv::Scalar(0));
+  for (int y = 0; y < height; ++y) {
+    uchar *row = image.ptr<uchar>(y);
+    for (int x = 0; x < width; ++x) {
+      row[x] = distribution(generator);
+    }
+  }
+  return image;
+}
+} // namespace
+
+TEST(patchDescriptor, patchesAreNormalized) {
+  std::mt19937 generator(3);
+  const loc_features::PatchDescriptorOptions options;
+  const auto values = loc_features::computePatchDescriptor(
+      randomImage(2 * options.width, 2 * options.height, generator), options);
+  ASSERT_EQ(values.size(), options.width * options.height);
+  for (int py = 0; py < options.height; py += options.patchSize) {
+    for (int px = 0; px < options.width; px += options.patchSize) {
+      double sum = 0.0;
+      double squaredSum = 0.0;
+      for (int y = py; y < py + options.patchSize; ++y) {
+        for (int x = px; x < px + options.patchSize; ++x) {
+          sum += values[y * options.width + x];
+          squaredSum += values[y * options.width + x] *
+                        values[y * options.width + x];
+        }
+      }
+      const int pixels = options.patchSize * options.patchSize;
+      EXPECT_NEAR(sum / pixels, 0.0, 1e-9);
+      EXPECT_NEAR(squaredSum / pixels, 1.0, 1e-9);
+    }
+  }
+}
+
+TEST(patchDescriptor, invariantToBrightnessAndContrast) {
+  std::mt19937 generator(4);
+  const loc_features::PatchDescriptorOptions options;
+  const cv::Mat image = randomImage(options.width, options.height, generator);
+  cv::Mat brighter = image.clone();
+  for (int y = 0; y < brighter.rows; ++y) {
+    uchar *row = brighter.ptr<uchar>(y);
+    for (int x = 0; x < brighter.cols; ++x) {
+      row[x] = 2 * row[x] + 30;
+    }
+  }
+  const auto values = loc_features::computePatchDescriptor(image, options);
+  const auto brighterValues =
+      loc_features::computePatchDescriptor(brighter, options);
+  ASSERT_EQ(values.size(), brighterValues.size());
+  for (size_t idx = 0; idx < values.size(); ++idx) {
+    EXPECT_NEAR(values[idx], brighterValues[idx], 1e-9);
+  }
+}
+
+TEST(patchDescriptor, flatImage) {
+  const cv::Mat image(48, 96, CV_8UC3, cv::Scalar(40, 80, 120));
+  for (double value : loc_features::computePatchDescriptor(image)) {
+    EXPECT_EQ(value, 0.0);
+  }
+}
+
+TEST(patchDescriptor, patchSizeHasToDivideTheSize) {
+  const cv::Mat image(32, 64, CV_8UC1, cv::Scalar(0));
+  loc_features::PatchDescriptorOptions options;
+  options.patchSize = 5;
+  ASSERT_DEATH(loc_features::computePatchDescriptor(image, options),
+               "does not divide the descriptor size");
+}
+
+TEST(patchDescriptor, needsEightBitImages) {
+  ASSERT_DEATH(loc_features::computePatchDescriptor(
+                   cv::Mat(32, 64, CV_16UC1, cv::Scalar(1000))),
+               "computed from 8-bit images");
+  ASSERT_DEATH(loc_features::computePatchDescriptor(
+                   cv::Mat(32, 64, CV_32FC1, cv::Scalar(0.5))),
+               "computed from 8-bit images");
+}
+
+} // namespace test
@@ -0,0 +1,170 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/online_database.h"
+#include "features/binary_feature.h"
+#include "features/feature_factory.h"
+#include "features/patch_feature.h"
+#include "features/similarity_kernels.h"
+#include "relocalizers/dimension_hashing.h"
+#include "relocalizers/lsh_hashing.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+namespace {
+std::vector<double> gaussianValues(int dim, std::mt19937 &generator) {
+  std::normal_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> values(dim);
+  for (double &value : values) {
+    value = distribution(generator);
+  }
+  return values;
+}
+} // namespace
+
+TEST(patchFeature, kernelsAreExact) {
+  std::mt19937 generator(5);
+  std::uniform_int_distribution<int> distribution(0, 255);
+  for (int dim : {0, 1, 15, 31, 32, 33, 63, 64, 65, 100, 2048, 2051}) {
+    loc_features::AlignedUint8Vector lhs(dim), rhs(dim);
+    uint32_t expected = 0;
+    for (int d = 0; d < dim; ++d) {
+      lhs[d] = distribution(generator);
+      rhs[d] = distribution(generator);
+      expected += std::abs(lhs[d] - rhs[d]);
+    }
+    for (const auto level : loc_features::supportedSimdLevels()) {
+      EXPECT_EQ(loc_features::sumAbsDiffUint8(lhs.data(), rhs.data(), dim,
+                                              level),
+                expected)
+          << loc_features::simdLevelName(level) << ", dim " << dim;
+    }
+  }
+}
+
+TEST(patchFeature, largeDifferencesDoNotOverflow) {
+  const int dim = 100000;
+  loc_features::AlignedUint8Vector lhs(dim, 0), rhs(dim, 255);
+  for (const auto level : loc_features::supportedSimdLevels()) {
+    EXPECT_EQ(loc_features::sumAbsDiffUint8(lhs.data(), rhs.data(), dim, level),
+              255u * dim)
+        << loc_features::simdLevelName(level);
+  }
+}
+
+TEST(patchFeature, quantization) {
+  const loc_features::PatchFeature feature(std::vector{0.0, 1.0, -2.5, 10.0,
+                                                       -10.0});
+  ASSERT_EQ(feature.size(), 5);
+  EXPECT_EQ(feature.data()[0], 128);
+  EXPECT_EQ(feature.data()[1], 160);
+  EXPECT_EQ(feature.data()[2], 48);
+  // Clipped to the range of a byte.
+  EXPECT_EQ(feature.data()[3], 255);
+  EXPECT_EQ(feature.data()[4], 0);
+  EXPECT_LT(feature.memoryBytes(), sizeof(feature) + 64 + 128);
+}
+
+TEST(patchFeature, scores) {
+  std::mt19937 generator(9);
+  const auto values = gaussianValues(4096, generator);
+  const auto query = loc_features::createFeature(loc_features::Patch_Feature,
+                                                 values);
+  EXPECT_EQ(query->type, "PatchFeature");
+  EXPECT_DOUBLE_EQ(query->computeSimilarityScore(*query), 1.0);
+  EXPECT_DOUBLE_EQ(query->score2cost(1.0), 1.0);
+
+  // Unrelated patches score about 0, like the cosine of unrelated features.
+  const loc_features::PatchFeature unrelated(gaussianValues(4096, generator));
+  EXPECT_NEAR(query->computeSimilarityScore(unrelated), 0.0, 0.05);
+
+  std::vector<double> noisy = values;
+  std::normal_distribution<double> noise(0.0, 0.1);
+  for (double &value : noisy) {
+    value += noise(generator);
+  }
+  const double noisyScore =
+      query->computeSimilarityScore(loc_features::PatchFeature(noisy));
+  EXPECT_GT(noisyScore, 0.85);
+  EXPECT_LT(noisyScore, 1.0);
+
+  std::vector<double> inverted = values;
+  for (double &value : inverted) {
+    value = -value;
+  }
+  EXPECT_DOUBLE_EQ(
+      query->computeSimilarityScore(loc_features::PatchFeature(inverted)), 0.0);
+  EXPECT_DOUBLE_EQ(loc_features::patchScore(0, 0), 0.0);
+}
+
+TEST(patchFeature, bitsAreSignsOfThePixels) {
+  const loc_features::PatchFeature feature(
+      std::vector{0.0, 1.0, -2.5, 0.01, -0.01, 3.0});
+  EXPECT_EQ(loc_features::numFeatureBits(feature), 6);
+  // 0.01 quantizes to 128, the mean of the patch.
+  EXPECT_EQ(loc_features::packedFeatureBits(feature),
+            (std::vector<uint64_t>{0b100010}));
+}
+
+TEST(patchFeature, relocalizersFindTheMatchingReference) {
+  const std::filesystem::path dir =
+      std::filesystem::temp_directory_path() / "patch_relocalization";
+  std::filesystem::create_directories(dir);
+  std::mt19937 generator(3);
+  for (int f = 0; f < 8; ++f) {
+    createFeatureFile(dir, "feature_" + std::to_string(f) + ".Feature.pb",
+                      createFeatureProto(gaussianValues(256, generator)));
+  }
+  localization::database::OnlineDatabase database(
+      dir, dir, loc_features::Patch_Feature, /*bufferSize=*/8);
+  loc_features::LshOptions options;
+  options.numTables = 4;
+  options.keySize = 8;
+  localization::relocalizers::LshHashing lsh(&database, options,
+                                             /*numCandidates=*/1);
+  lsh.train(dir, /*numThreads=*/1, /*projection=*/nullptr,
+            loc_features::Patch_Feature);
+  localization::relocalizers::DimensionHashing dimensionHashing(
+      &database, /*topFraction=*/1.0, /*maxCandidates=*/1);
+  dimensionHashing.train(dir, /*numThreads=*/1, /*projection=*/nullptr,
+                         loc_features::Patch_Feature);
+  for (int q = 0; q < 8; ++q) {
+    EXPECT_EQ(lsh.getCandidates(q), (std::vector<int>{q}));
+    EXPECT_EQ(dimensionHashing.getCandidates(q), (std::vector<int>{q}));
+  }
+  clearDataUnderPath(dir);
+}
+
+} // namespace test
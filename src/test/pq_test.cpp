@@ -0,0 +1,187 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/pq_database.h"
+#include "features/feature_matrix.h"
+#include "features/pq_codebook.h"
+#include "features/pq_feature.h"
+#include "features/pq_store.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace fs = std::filesystem;
+namespace loc_features = localization::features;
+
+namespace {
+loc_features::FeatureMatrix randomFeatures(int rows, int dim) {
+  std::mt19937 generator(7);
+  std::normal_distribution<double> distribution;
+  loc_features::FeatureMatrix features(rows, dim);
+  for (int r = 0; r < rows; ++r) {
+    std::vector<double> values(dim);
+    for (double &value : values) {
+      value = distribution(generator);
+    }
+    features.setRow(r, values);
+  }
+  return features;
+}
+} // namespace
+
+TEST(productQuantization, tableScoreMatchesDecodedDotProduct) {
+  const auto features = randomFeatures(/*rows=*/200, /*dim=*/30);
+  loc_features::PqTrainOptions options;
+  // 30 dimensions in 4 subspaces, the sizes are not equal.
+  options.numSubspaces = 4;
+  options.numCentroids = 16;
+  const auto codebook = loc_features::PqCodebook::train(features, options);
+  EXPECT_EQ(codebook.subspaceBegin(4), 30);
+
+  std::vector<uint8_t> code(codebook.numSubspaces());
+  std::vector<float> decoded(codebook.dim());
+  std::vector<float> table(codebook.numSubspaces() * codebook.numCentroids());
+  codebook.innerProductTable(features.row(0), table.data());
+  for (int r = 0; r < features.rows(); ++r) {
+    codebook.encode(features.row(r), code.data());
+    codebook.decode(code.data(), decoded.data());
+    double expected = 0.0;
+    for (int d = 0; d < codebook.dim(); ++d) {
+      expected += features.row(0)[d] * decoded[d];
+    }
+    EXPECT_NEAR(codebook.score(table.data(), code.data()), expected, 1e-5);
+  }
+}
+
+TEST(productQuantization, encodingReducesError) {
+  const auto features = randomFeatures(/*rows=*/300, /*dim=*/32);
+  loc_features::PqTrainOptions options;
+  options.numSubspaces = 8;
+  double previousError = 1e9;
+  for (int numCentroids : {2, 16, 64}) {
+    options.numCentroids = numCentroids;
+    const auto codebook = loc_features::PqCodebook::train(features, options);
+    std::vector<uint8_t> code(codebook.numSubspaces());
+    std::vector<float> decoded(codebook.dim());
+    double error = 0.0;
+    for (int r = 0; r < features.rows(); ++r) {
+      codebook.encode(features.row(r), code.data());
+      codebook.decode(code.data(), decoded.data());
+      for (int d = 0; d < codebook.dim(); ++d) {
+        error += (features.row(r)[d] - decoded[d]) *
+                 (features.row(r)[d] - decoded[d]);
+      }
+    }
+    EXPECT_LT(error, previousError) << numCentroids << " centroids";
+    previousError = error;
+  }
+}
+
+TEST(productQuantization, storeRoundTrip) {
+  const auto features = randomFeatures(/*rows=*/20, /*dim=*/8);
+  loc_features::PqTrainOptions options;
+  options.numSubspaces = 2;
+  options.numCentroids = 4;
+  std::vector<std::string> names;
+  for (int r = 0; r < features.rows(); ++r) {
+    names.push_back("feature_" + std::to_string(r));
+  }
+  const auto store = loc_features::PqStore::encode(
+      loc_features::PqCodebook::train(features, options), features, names);
+  const fs::path file = fs::temp_directory_path() / "test.PqStore.bin";
+  EXPECT_TRUE(loc_features::isPqStoreFile(file));
+  store->save(file);
+  const auto loaded = loc_features::PqStore::open(file);
+  ASSERT_EQ(loaded->size(), 20);
+  EXPECT_EQ(loaded->name(19), "feature_19");
+  for (int r = 0; r < features.rows(); ++r) {
+    EXPECT_EQ(loaded->code(r)[0], store->code(r)[0]);
+    EXPECT_EQ(loaded->code(r)[1], store->code(r)[1]);
+  }
+  EXPECT_FLOAT_EQ(loaded->codebook().centroid(1, 3)[2],
+                  store->codebook().centroid(1, 3)[2]);
+  EXPECT_EQ(loaded->memoryBytes(), store->memoryBytes());
+
+  // magic | version | rows @12 | codebook dim @20, subspaces, centroids | ...
+  const auto damage = [&](size_t offset, int64_t value, size_t size) {
+    const fs::path damaged = fs::temp_directory_path() / "damaged.PqStore.bin";
+    fs::copy_file(file, damaged, fs::copy_options::overwrite_existing);
+    std::fstream out(damaged, std::ios::in | std::ios::out | std::ios::binary);
+    out.seekp(offset);
+    out.write(reinterpret_cast<const char *>(&value), size);
+    return damaged.string();
+  };
+  EXPECT_DEATH(loc_features::PqStore::open(damage(12, int64_t{1} << 40, 8)),
+               "PQ store is truncated or damaged");
+  EXPECT_DEATH(loc_features::PqStore::open(damage(12, -1, 8)),
+               "PQ store is truncated or damaged");
+  EXPECT_DEATH(loc_features::PqStore::open(damage(20, 1 << 30, 4)),
+               "codebook is truncated or damaged");
+  const std::string truncated = damage(0, 0, 0);
+  fs::resize_file(truncated, fs::file_size(file) - 3);
+  EXPECT_DEATH(loc_features::PqStore::open(truncated),
+               "PQ store is truncated or damaged");
+  fs::remove(truncated);
+  fs::remove(file);
+}
+
+TEST(productQuantization, database) {
+  const fs::path tmp_dir = test::createFeatures();
+  // With as many centroids as features every feature is its own centroid
+  // and the costs are exact.
+  loc_features::PqTrainOptions options;
+  options.numSubspaces = 1;
+  options.numCentroids = 4;
+  const fs::path pqFile = tmp_dir / "reference.PqStore.bin";
+  loc_features::buildPqStore(tmp_dir, options)->save(pqFile);
+
+  localization::database::PqDatabase database(tmp_dir, pqFile,
+                                              /*bufferSize=*/2);
+  EXPECT_EQ(database.refSize(), 4);
+  for (int q = 0; q < 4; ++q) {
+    for (int r = 0; r < 4; ++r) {
+      EXPECT_NEAR(database.getCost(q, r), 1. / kSimilarityMatrix[q][r], 1e-4);
+    }
+  }
+  const std::vector<double> costs = database.getCosts(1, {2, 0});
+  EXPECT_NEAR(costs[0], 1. / kSimilarityMatrix[1][2], 1e-4);
+  EXPECT_NEAR(costs[1], 1. / kSimilarityMatrix[1][0], 1e-4);
+
+  auto store = loc_features::PqStore::open(pqFile);
+  const loc_features::PqFeature feature0(store, 0);
+  const loc_features::PqFeature feature3(store, 3);
+  EXPECT_NEAR(feature0.computeSimilarityScore(feature3), kSimilarityMatrix[0][3],
+              1e-4);
+  ASSERT_DEATH(database.getCost(0, 4), "Reference feature 4 is out of range");
+  test::clearDataUnderPath(tmp_dir);
+}
+} // namespace test
@@ -0,0 +1,221 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/list_dir.h"
+#include "features/cnn_feature.h"
+#include "features/feature_factory.h"
+#include "features/feature_matrix.h"
+#include "features/feature_store.h"
+#include "features/projection.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+namespace {
+// Column `d` of the projection matrix is the projection of the unit vector,
+// minus the projected origin that carries the mean.
+std::vector<std::vector<double>>
+projectionMatrix(const loc_features::Projection &projection) {
+  std::vector<std::vector<double>> rows(
+      projection.outputDim(), std::vector<double>(projection.inputDim()));
+  const std::vector<double> origin =
+      projection.apply(std::vector<double>(projection.inputDim(), 0.0));
+  for (int d = 0; d < projection.inputDim(); ++d) {
+    std::vector<double> unit(projection.inputDim(), 0.0);
+    unit[d] = 1.0;
+    const std::vector<double> column = projection.apply(unit);
+    for (int k = 0; k < projection.outputDim(); ++k) {
+      rows[k][d] = column[k] - origin[k];
+    }
+  }
+  return rows;
+}
+
+void expectOrthonormalRows(const std::vector<std::vector<double>> &rows) {
+  for (size_t i = 0; i < rows.size(); ++i) {
+    for (size_t j = 0; j < rows.size(); ++j) {
+      double product = 0.0;
+      for (size_t d = 0; d < rows[i].size(); ++d) {
+        product += rows[i][d] * rows[j][d];
+      }
+      EXPECT_NEAR(product, i == j ? 1.0 : 0.0, 1e-4) << i << ", " << j;
+    }
+  }
+}
+
+// Features spanning only `rank` directions of a `dim` dimensional space.
+loc_features::FeatureMatrix lowRankFeatures(int rows, int dim, int rank) {
+  std::mt19937 generator(5);
+  std::normal_distribution<double> distribution;
+  std::vector<std::vector<double>> basis(rank, std::vector<double>(dim));
+  for (auto &direction : basis) {
+    for (double &value : direction) {
+      value = distribution(generator);
+    }
+  }
+  loc_features::FeatureMatrix features(rows, dim);
+  for (int row = 0; row < rows; ++row) {
+    std::vector<double> values(dim, 1.0);
+    for (const auto &direction : basis) {
+      const double weight = distribution(generator);
+      for (int d = 0; d < dim; ++d) {
+        values[d] += weight * direction[d];
+      }
+    }
+    features.setRow(row, values);
+  }
+  return features;
+}
+} // namespace
+
+TEST(projection, randomOrthogonalHasOrthonormalRows) {
+  const auto projection = loc_features::Projection::randomOrthogonal(
+      /*inputDim=*/40, /*outputDim=*/12, /*seed=*/1);
+  EXPECT_EQ(projection->inputDim(), 40);
+  EXPECT_EQ(projection->outputDim(), 12);
+  expectOrthonormalRows(projectionMatrix(*projection));
+}
+
+TEST(projection, pcaKeepsLowRankData) {
+  const loc_features::FeatureMatrix features =
+      lowRankFeatures(/*rows=*/200, /*dim=*/64, /*rank=*/6);
+  const auto projection =
+      loc_features::Projection::trainPca(features, /*outputDim=*/8);
+  EXPECT_NEAR(projection->explainedVariance(), 1.0, 1e-6);
+  expectOrthonormalRows(projectionMatrix(*projection));
+
+  // Orthonormal rows spanning the data keep the distances between features.
+  std::vector<double> lhs(features.row(0), features.row(0) + 64);
+  std::vector<double> rhs(features.row(1), features.row(1) + 64);
+  double distance = 0.0;
+  for (int d = 0; d < 64; ++d) {
+    distance += (lhs[d] - rhs[d]) * (lhs[d] - rhs[d]);
+  }
+  const std::vector<double> projectedLhs = projection->apply(lhs);
+  const std::vector<double> projectedRhs = projection->apply(rhs);
+  double projectedDistance = 0.0;
+  for (int k = 0; k < 8; ++k) {
+    projectedDistance += (projectedLhs[k] - projectedRhs[k]) *
+                         (projectedLhs[k] - projectedRhs[k]);
+  }
+  EXPECT_NEAR(projectedDistance, distance, 1e-3 * distance);
+}
+
+TEST(projection, inputIsNormalizedLikeTrainingRows) {
+  // The PCA learns from the normalized FeatureMatrix rows, raw feature
+  // values of any scale are projected the same way.
+  const loc_features::FeatureMatrix features =
+      lowRankFeatures(/*rows=*/100, /*dim=*/32, /*rank=*/4);
+  const auto projection =
+      loc_features::Projection::trainPca(features, /*outputDim=*/4);
+  const std::vector<double> normalized(features.row(3), features.row(3) + 32);
+  std::vector<double> raw = normalized;
+  for (double &value : raw) {
+    value *= 250.0;
+  }
+  const std::vector<double> expected = projection->apply(normalized);
+  const std::vector<double> actual = projection->apply(raw);
+  for (int k = 0; k < 4; ++k) {
+    EXPECT_NEAR(actual[k], expected[k], 1e-5);
+  }
+}
+
+TEST(projection, saveAndLoad) {
+  const auto projection =
+      loc_features::Projection::trainPca(lowRankFeatures(50, 16, 3), 4);
+  const fs::path file =
+      fs::temp_directory_path() / "projection_test.Projection.bin";
+  EXPECT_TRUE(loc_features::isProjectionFile(file));
+  EXPECT_FALSE(loc_features::isProjectionFile("projection.bin"));
+  projection->save(file);
+  const auto loaded = loc_features::Projection::load(file);
+  EXPECT_EQ(loaded->inputDim(), 16);
+  EXPECT_EQ(loaded->outputDim(), 4);
+  const std::vector<double> values(16, 0.5);
+  const std::vector<double> expected = projection->apply(values);
+  const std::vector<double> actual = loaded->apply(values);
+  for (int k = 0; k < 4; ++k) {
+    EXPECT_DOUBLE_EQ(actual[k], expected[k]);
+  }
+  fs::remove(file);
+}
+
+TEST(projection, damagedSizesDie) {
+  const fs::path file =
+      fs::temp_directory_path() / "projection_damaged.Projection.bin";
+  // The input and output dimension follow the magic and the version.
+  for (const auto &sizes : std::vector<std::vector<int32_t>>{
+           {1 << 30, 1 << 10}, {-16, 4}, {16, 0}, {4, 16}}) {
+    loc_features::Projection::randomOrthogonal(16, 4)->save(file);
+    {
+      std::fstream out(file, std::ios::in | std::ios::out | std::ios::binary);
+      out.seekp(12);
+      out.write(reinterpret_cast<const char *>(sizes.data()),
+                sizes.size() * sizeof(int32_t));
+    }
+    EXPECT_DEATH(loc_features::Projection::load(file), "truncated or damaged")
+        << sizes[0] << " x " << sizes[1];
+  }
+  fs::remove(file);
+}
+
+TEST(projection, featuresAreProjectedWhenLoaded) {
+  const fs::path tmp_dir = test::createFeatures();
+  const auto projection = loc_features::Projection::randomOrthogonal(4, 2);
+  const auto files = localization::database::listProtoDir(tmp_dir, ".Feature");
+  ASSERT_FALSE(files.empty());
+
+  const auto feature = loc_features::createFeature(
+      loc_features::Cnn_Feature, files[0], projection.get());
+  const std::vector<double> projected =
+      projection->apply(std::vector<double>{0, 1, 2, 3});
+  const loc_features::CnnFeature expected(projected);
+  EXPECT_EQ(feature->bits.size(), 2);
+  EXPECT_NEAR(feature->computeSimilarityScore(expected), 1.0, kTestEpsilon);
+
+  const fs::path storeFile =
+      fs::temp_directory_path() / "projection_test.FeatureStore.bin";
+  loc_features::writeFeatureStore(files, storeFile, /*numThreads=*/1,
+                                  projection.get());
+  const auto store = loc_features::FeatureStore::open(storeFile);
+  EXPECT_EQ(store->dim(), 2);
+  for (int k = 0; k < 2; ++k) {
+    EXPECT_NEAR(store->row(0)[k], projected[k], 1e-5);
+  }
+  fs::remove(storeFile);
+  test::clearDataUnderPath(tmp_dir);
+}
+
+} // namespace test
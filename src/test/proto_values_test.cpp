@@ -0,0 +1,152 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "database/similarity_matrix.h"
+#include "features/feature_io.h"
+#include "features/proto_values.h"
+#include "localization_protos.pb.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace loc_features = localization::features;
+using loc_features::ProtoValuesFormat;
+
+namespace {
+const std::vector<double> kValues = {0.25, -1.5, 3.125, 1e-3, 42.0};
+
+std::string bigEndianFloats(const std::vector<double> &values) {
+  std::string data;
+  for (double value : values) {
+    const float stored = value;
+    char bytes[sizeof(float)];
+    std::memcpy(bytes, &stored, sizeof(float));
+    std::reverse(bytes, bytes + sizeof(float));
+    data.append(bytes, sizeof(float));
+  }
+  return data;
+}
+} // namespace
+
+TEST(ProtoValues, featureRoundTripInAllFormats) {
+  const fs::path tmp_dir = fs::temp_directory_path() / "proto_values";
+  fs::create_directories(tmp_dir);
+  const std::string filename = tmp_dir / "feature.Feature.pb";
+
+  for (ProtoValuesFormat format :
+       {ProtoValuesFormat::RepeatedDouble, ProtoValuesFormat::RawFloat32,
+        ProtoValuesFormat::RawFloat64}) {
+    loc_features::writeFeatureValues(filename, kValues, "debug", format);
+    const std::vector<double> values =
+        loc_features::readFeatureValues(filename);
+    ASSERT_EQ(values.size(), kValues.size());
+    for (size_t idx = 0; idx < values.size(); ++idx) {
+      if (format == ProtoValuesFormat::RawFloat32) {
+        EXPECT_FLOAT_EQ(values[idx], kValues[idx]);
+      } else {
+        EXPECT_DOUBLE_EQ(values[idx], kValues[idx]);
+      }
+    }
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
+
+TEST(ProtoValues, readsUnpackedVersionOneFeatures) {
+  // Old writers store every value with its own tag: field 1, wire type 1.
+  std::string wire;
+  for (double value : kValues) {
+    wire.push_back(0x09);
+    char bytes[sizeof(double)];
+    std::memcpy(bytes, &value, sizeof(double));
+    wire.append(bytes, sizeof(double));
+  }
+  const fs::path tmp_dir = fs::temp_directory_path() / "proto_values";
+  fs::create_directories(tmp_dir);
+  const std::string filename = tmp_dir / "unpacked.Feature.pb";
+  std::ofstream(filename, std::ios::binary) << wire;
+
+  EXPECT_EQ(loc_features::readFeatureValues(filename), kValues);
+  test::clearDataUnderPath(tmp_dir);
+}
+
+TEST(ProtoValues, decodesBigEndianData) {
+  image_sequence_localizer::Feature proto;
+  proto.set_value_type(image_sequence_localizer::VALUE_TYPE_FLOAT32);
+  proto.set_byte_order(image_sequence_localizer::BYTE_ORDER_BIG_ENDIAN);
+  proto.set_data(bigEndianFloats(kValues));
+
+  ASSERT_EQ(loc_features::protoValuesSize(proto), kValues.size());
+  std::vector<double> tail(2);
+  loc_features::copyProtoValues(proto, 3, 2, tail.data());
+  EXPECT_FLOAT_EQ(tail[0], kValues[3]);
+  EXPECT_FLOAT_EQ(tail[1], kValues[4]);
+}
+
+TEST(ProtoValues, appendsInChunks) {
+  image_sequence_localizer::SimilarityMatrix proto;
+  const std::vector<float> first = {1.f, 2.f};
+  const std::vector<double> second = {3., 4., 5.};
+  loc_features::appendProtoValues(first.data(), first.size(),
+                                  ProtoValuesFormat::RawFloat32, &proto);
+  loc_features::appendProtoValues(second.data(), second.size(),
+                                  ProtoValuesFormat::RawFloat32, &proto);
+  EXPECT_EQ(loc_features::protoValues(proto),
+            std::vector<double>({1., 2., 3., 4., 5.}));
+  EXPECT_DEATH(loc_features::appendProtoValues(second.data(), second.size(),
+                                               ProtoValuesFormat::RepeatedDouble,
+                                               &proto),
+               "");
+}
+
+TEST(ProtoValues, dataWithoutValueTypeDies) {
+  image_sequence_localizer::Feature proto;
+  proto.set_data(std::string(8, '\0'));
+  EXPECT_DEATH(loc_features::protoValues(proto), "");
+}
+
+TEST(ProtoValues, similarityMatrixRoundTrip) {
+  const localization::database::SimilarityMatrix::Matrix scores = {
+      {0.5, 0.25, 1.0}, {0.125, 0.75, 2.0}};
+  const localization::database::SimilarityMatrix matrix(scores);
+  const fs::path tmp_dir = fs::temp_directory_path() / "proto_values";
+  fs::create_directories(tmp_dir);
+  const std::string filename = tmp_dir / "matrix.SimilarityMatrix.pb";
+
+  for (ProtoValuesFormat format :
+       {ProtoValuesFormat::RepeatedDouble, ProtoValuesFormat::RawFloat32}) {
+    matrix.saveToProto(filename, format);
+    const localization::database::SimilarityMatrix loaded(filename);
+    EXPECT_EQ(loaded.rows(), 2);
+    EXPECT_EQ(loaded.cols(), 3);
+    EXPECT_EQ(loaded.getScores(), scores);
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
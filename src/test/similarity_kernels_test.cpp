@@ -0,0 +1,167 @@
+/** vpr_relocalization: a library for visual place recognition in changing
+** environments with efficient relocalization step.
+** Copyright (c) 2017 O. Vysotska, C. Stachniss, University of Bonn
+**
+** Permission is hereby granted, free of charge, to any person obtaining a copy
+** of this software and associated documentation files (the "Software"), to deal
+** in the Software without restriction, including without limitation the rights
+** to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+** copies of the Software, and to permit persons to whom the Software is
+** furnished to do so, subject to the following conditions:
+**
+** The above copyright notice and this permission notice shall be included in
+** all copies or substantial portions of the Software.
+**
+** THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+** IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+** FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+** AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+** LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+** OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+** SOFTWARE.
+**/
+
+#include "features/aligned_allocator.h"
+#include "features/cnn_feature.h"
+#include "features/feature_io.h"
+#include "features/similarity_kernels.h"
+#include "database/list_dir.h"
+#include "test_utils.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace test {
+
+namespace loc_features = localization::features;
+
+TEST(similarityKernels, scalarIsAlwaysSupported) {
+  const auto levels = loc_features::supportedSimdLevels();
+  ASSERT_FALSE(levels.empty());
+  EXPECT_EQ(levels.front(), loc_features::SimdLevel::Scalar);
+  EXPECT_EQ(levels.back(), loc_features::bestSimdLevel());
+}
+
+TEST(similarityKernels, agreeWithDoublePrecision) {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  // Sizes around the vector widths exercise the remainder handling.
+  for (int dim : {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 63, 100, 1000,
+                  4096, 32768}) {
+    loc_features::AlignedFloatVector lhs(dim), rhs(dim);
+    double expected = 0.0;
+    double magnitude = 0.0;
+    for (int d = 0; d < dim; ++d) {
+      lhs[d] = distribution(generator);
+      rhs[d] = distribution(generator);
+      expected += static_cast<double>(lhs[d]) * rhs[d];
+      magnitude += std::abs(static_cast<double>(lhs[d]) * rhs[d]);
+    }
+    for (const auto level : loc_features::supportedSimdLevels()) {
+      // Unaligned inputs are valid too.
+      for (int offset : {0, 1}) {
+        if (offset > dim) {
+          continue;
+        }
+        double shiftedExpected = 0.0;
+        for (int d = offset; d < dim; ++d) {
+          shiftedExpected += static_cast<double>(lhs[d]) * rhs[d];
+        }
+        EXPECT_NEAR(loc_features::dotProduct(lhs.data() + offset,
+                                             rhs.data() + offset, dim - offset,
+                                             level),
+                    offset == 0 ? expected : shiftedExpected,
+                    1e-5 * (magnitude + 1.0))
+            << loc_features::simdLevelName(level) << ", dim " << dim
+            << ", offset " << offset;
+      }
+    }
+    EXPECT_NEAR(loc_features::dotProduct(lhs.data(), rhs.data(), dim),
+                expected, 1e-5 * (magnitude + 1.0));
+  }
+}
+
+TEST(similarityKernels, batchAgreesWithPairs) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<float> distribution(-1.f, 1.f);
+  // Batch sizes around the register blocks exercise the remainders.
+  for (int dim : {0, 1, 5, 16, 17, 100, 1024}) {
+    for (int numQueries : {1, 2, 3, 5}) {
+      for (int numRefs : {1, 3, 4, 9}) {
+        std::vector<loc_features::AlignedFloatVector> queries(
+            numQueries, loc_features::AlignedFloatVector(dim));
+        std::vector<loc_features::AlignedFloatVector> refs(
+            numRefs, loc_features::AlignedFloatVector(dim));
+        std::vector<const float *> queryRows, refRows;
+        for (auto &query : queries) {
+          std::generate(query.begin(), query.end(),
+                        [&]() { return distribution(generator); });
+          queryRows.push_back(query.data());
+        }
+        for (auto &ref : refs) {
+          std::generate(ref.begin(), ref.end(),
+                        [&]() { return distribution(generator); });
+          refRows.push_back(ref.data());
+        }
+        for (const auto level : loc_features::supportedSimdLevels()) {
+          std::vector<float> scores(numQueries * numRefs, -1.f);
+          loc_features::dotProductBatch(queryRows.data(), numQueries,
+                                        refRows.data(), numRefs, dim,
+                                        scores.data(), level);
+          for (int q = 0; q < numQueries; ++q) {
+            for (int r = 0; r < numRefs; ++r) {
+              EXPECT_NEAR(scores[q * numRefs + r],
+                          loc_features::dotProduct(queryRows[q], refRows[r],
+                                                   dim, level),
+                          1e-4)
+                  << loc_features::simdLevelName(level) << ", dim " << dim
+                  << ", " << numQueries << "x" << numRefs;
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(similarityKernels, alignedVector) {
+  const loc_features::AlignedFloatVector values(5, 1.f);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(values.data()) % 64, 0);
+}
+
+TEST(similarityKernels, cnnFeatureCosineSimilarity) {
+  const std::filesystem::path tmp_dir = test::createFeatures();
+  const std::vector<std::string> featureNames =
+      localization::database::listProtoDir(tmp_dir, ".Feature");
+  for (const auto &queryName : featureNames) {
+    const loc_features::CnnFeature query(queryName);
+    const std::vector<double> queryValues =
+        loc_features::readFeatureValues(queryName);
+    for (const auto &refName : featureNames) {
+      const loc_features::CnnFeature ref(refName);
+      const std::vector<double> refValues =
+          loc_features::readFeatureValues(refName);
+      const long double dot =
+          std::inner_product(queryValues.begin(), queryValues.end(),
+                             refValues.begin(), 0.0L);
+      const long double queryNorm =
+          std::inner_product(queryValues.begin(), queryValues.end(),
+                             queryValues.begin(), 0.0L);
+      const long double refNorm = std::inner_product(
+          refValues.begin(), refValues.end(), refValues.begin(), 0.0L);
+      EXPECT_NEAR(query.computeSimilarityScore(ref),
+                  static_cast<double>(dot / std::sqrt(queryNorm * refNorm)),
+                  1e-6);
+    }
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
+} // namespace test
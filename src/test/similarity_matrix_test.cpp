@@ -1,6 +1,9 @@
 /* By O. Vysotska in 2023 */
 
 #include "database/similarity_matrix.h"
+#include "database/similarity_matrix_builder.h"
+#include "database/tiled_similarity_matrix_builder.h"
+#include "features/feature_matrix.h"
 #include "localization_protos.pb.h"
 #include "test_utils.h"
 
@@ -95,4 +98,149 @@ TEST(CostMatrixComputation, createCostMatrixFromFeatures) {
     }
   }
 }
-} // namespace test
\ No newline at end of file
+
+TEST_F(SimilarityMatrixTest, saveAndLoadBinary) {
+  auto similarityMatrix =
+      localization::database::SimilarityMatrix(similarityMatrixFile);
+  const std::string binaryFile = tmp_dir / "test.SimilarityMatrix.bin";
+  similarityMatrix.saveToBinary(binaryFile);
+
+  auto binaryMatrix = localization::database::SimilarityMatrix(binaryFile);
+  ASSERT_EQ(binaryMatrix.rows(), similarityMatrix.rows());
+  ASSERT_EQ(binaryMatrix.cols(), similarityMatrix.cols());
+  for (int r = 0; r < binaryMatrix.rows(); ++r) {
+    for (int c = 0; c < binaryMatrix.cols(); ++c) {
+      EXPECT_NEAR(binaryMatrix.at(r, c), similarityMatrixValues[r][c],
+                  kTestEpsilon);
+    }
+  }
+  std::filesystem::remove(binaryFile);
+}
+
+TEST(CostMatrixComputation, blockedComputationMatchesPairwise) {
+  const fs::path tmp_dir = test::createFeatures();
+  const auto features =
+      localization::features::FeatureMatrix::fromFeatureDir(tmp_dir);
+  ASSERT_EQ(features.rows(), 4);
+  ASSERT_EQ(features.dim(), 4);
+
+  // Blocks that do not divide the sizes exercise the borders of the tiles.
+  localization::database::SimilarityMatrixBuildOptions options;
+  options.numThreads = 2;
+  options.queryBlock = 3;
+  options.refBlock = 3;
+  options.dimBlock = 3;
+  const auto similarityMatrix = localization::database::computeSimilarityMatrix(
+      features, features, options);
+  ASSERT_EQ(similarityMatrix.rows(), 4);
+  ASSERT_EQ(similarityMatrix.cols(), 4);
+  for (int r = 0; r < similarityMatrix.rows(); ++r) {
+    for (int c = 0; c < similarityMatrix.cols(); ++c) {
+      EXPECT_NEAR(similarityMatrix.at(r, c), kSimilarityMatrix[r][c],
+                  kTestEpsilon);
+    }
+  }
+  test::clearDataUnderPath(tmp_dir);
+}
+
+TEST(CostMatrixComputation, writeSimilarityMatrix) {
+  const fs::path tmp_dir = test::createFeatures();
+  const auto features =
+      localization::features::FeatureMatrix::fromFeatureDir(tmp_dir);
+  const fs::path output_dir = fs::temp_directory_path() / "similarity_output";
+  fs::create_directories(output_dir);
+
+  for (const std::string name :
+       {"written.SimilarityMatrix.pb", "written.SimilarityMatrix.bin"}) {
+    const std::string outputFile = output_dir / name;
+    localization::database::writeSimilarityMatrix(features, features,
+                                                  outputFile);
+    const auto similarityMatrix =
+        localization::database::SimilarityMatrix(outputFile);
+    ASSERT_EQ(similarityMatrix.rows(), 4);
+    ASSERT_EQ(similarityMatrix.cols(), 4);
+    for (int r = 0; r < similarityMatrix.rows(); ++r) {
+      for (int c = 0; c < similarityMatrix.cols(); ++c) {
+        EXPECT_NEAR(similarityMatrix.at(r, c), kSimilarityMatrix[r][c],
+                    kTestEpsilon);
+      }
+    }
+  }
+  test::clearDataUnderPath(output_dir);
+  test::clearDataUnderPath(tmp_dir);
+}
+
+TEST(CostMatrixComputation, tiledComputationResumes) {
+  const fs::path tmp_dir = test::createFeatures();
+  const fs::path output_dir = fs::temp_directory_path() / "tiled_output";
+  fs::create_directories(output_dir);
+  const std::string outputFile = output_dir / "tiled.SimilarityMatrix.bin";
+  const std::string manifestFile = outputFile + ".manifest";
+
+  auto expectMatrixIsCorrect = [&outputFile]() {
+    const auto similarityMatrix =
+        localization::database::SimilarityMatrix(outputFile);
+    ASSERT_EQ(similarityMatrix.rows(), 4);
+    ASSERT_EQ(similarityMatrix.cols(), 4);
+    for (int r = 0; r < similarityMatrix.rows(); ++r) {
+      for (int c = 0; c < similarityMatrix.cols(); ++c) {
+        EXPECT_NEAR(similarityMatrix.at(r, c), kSimilarityMatrix[r][c],
+                    kTestEpsilon);
+      }
+    }
+  };
+
+  localization::database::TiledBuildOptions options;
+  options.tileRows = 3;
+  options.tileCols = 2;
+  options.numThreads = 2;
+  auto stats = localization::database::buildSimilarityMatrixTiled(
+      tmp_dir, tmp_dir, outputFile, options);
+  EXPECT_EQ(stats.tilesTotal, 4);
+  EXPECT_EQ(stats.tilesComputed, 4);
+  EXPECT_EQ(stats.tilesSkipped, 0);
+  expectMatrixIsCorrect();
+
+  // Pretend the run was interrupted before the last tile was recorded.
+  std::vector<std::string> lines;
+  {
+    std::ifstream in(manifestFile);
+    for (std::string line; std::getline(in, line);) {
+      lines.push_back(line);
+    }
+  }
+  ASSERT_EQ(lines.size(), 5);
+  {
+    std::ofstream out(manifestFile, std::ios::trunc);
+    for (int idx = 0; idx < 4; ++idx) {
+      out << lines[idx] << std::endl;
+    }
+    out << "tile 3"; // A line cut by the crash.
+  }
+  stats = localization::database::buildSimilarityMatrixTiled(
+      tmp_dir, tmp_dir, outputFile, options);
+  EXPECT_EQ(stats.tilesComputed, 1);
+  EXPECT_EQ(stats.tilesSkipped, 3);
+  expectMatrixIsCorrect();
+
+  // The cut line was dropped, the recomputed tile is recorded and not
+  // computed again.
+  stats = localization::database::buildSimilarityMatrixTiled(
+      tmp_dir, tmp_dir, outputFile, options);
+  EXPECT_EQ(stats.tilesComputed, 0);
+  EXPECT_EQ(stats.tilesSkipped, 4);
+  expectMatrixIsCorrect();
+
+  // A different tiling does not match the manifest and starts from scratch.
+  options.tileCols = 4;
+  stats = localization::database::buildSimilarityMatrixTiled(
+      tmp_dir, tmp_dir, outputFile, options);
+  EXPECT_EQ(stats.tilesTotal, 2);
+  EXPECT_EQ(stats.tilesComputed, 2);
+  EXPECT_EQ(stats.tilesSkipped, 0);
+  expectMatrixIsCorrect();
+
+  test::clearDataUnderPath(output_dir);
+  test::clearDataUnderPath(tmp_dir);
+}
+} // namespace test
@@ -4,6 +4,38 @@ type CostMatrixElement = {
   value: number;
 };
 
+// Values of ValueType and ByteOrder in localization_protos.proto.
+const VALUE_TYPE_FLOAT32 = 1;
+const VALUE_TYPE_FLOAT64 = 2;
+const BYTE_ORDER_LITTLE_ENDIAN = 0;
+
+// The matrix values are either in `values` or, in the newer format, raw bytes
+// in `data`.
+function protoValues(costMatrixProto: any): ArrayLike<number> {
+  const data: Uint8Array | undefined = costMatrixProto.data;
+  if (data == null || data.length === 0) {
+    return costMatrixProto.values;
+  }
+  const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+  const littleEndian = costMatrixProto.byteOrder === BYTE_ORDER_LITTLE_ENDIAN;
+  if (costMatrixProto.valueType === VALUE_TYPE_FLOAT32) {
+    const values = new Float32Array(data.byteLength / 4);
+    for (let i = 0; i < values.length; i++) {
+      values[i] = view.getFloat32(i * 4, littleEndian);
+    }
+    return values;
+  }
+  if (costMatrixProto.valueType === VALUE_TYPE_FLOAT64) {
+    const values = new Float64Array(data.byteLength / 8);
+    for (let i = 0; i < values.length; i++) {
+      values[i] = view.getFloat64(i * 8, littleEndian);
+    }
+    return values;
+  }
+  console.warn("Unknown value type of the cost matrix", costMatrixProto.valueType);
+  return [];
+}
+
 class CostMatrix {
   rows: number;
   cols: number;
@@ -16,6 +48,7 @@ class CostMatrix {
       this.valuesArray = [];
       return;
     }
+    const values = protoValues(costMatrixProto);
     const costMatrixValues: CostMatrixElement[] = [];
     let valueIter = 0;
     for (let r = 0; r < costMatrixProto.rows; r += 1) {
@@ -23,7 +56,7 @@ class CostMatrix {
         costMatrixValues.push({
           queryId: r,
           refId: c,
-          value: costMatrixProto.values[valueIter],
+          value: values[valueIter],
         });
         valueIter += 1;
       }